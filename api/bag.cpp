@@ -32,6 +32,7 @@
 #include <sstream>
 #include <string>
 #include <string.h>
+#include <tuple>
 
 #ifdef _MSC_VER
 #pragma warning(pop)
@@ -1732,19 +1733,12 @@ BagError bagReadTrackingListNode(
 
     const auto& trackingList = handle->dataset->getTrackingList();
 
-    using std::cbegin;  using std::cend;
-    std::vector<BAG::TrackingItem> results;
-
-    std::copy_if(cbegin(trackingList), cend(trackingList),
-        std::back_inserter(results),
-        [row, col](const BAG::TrackingItem& item) {
-            return item.row == row && item.col == col;
-        });
+    const auto results = trackingList.findNode(row, col);
 
     *numItems = static_cast<uint32_t>(results.size());
 
     *items = new BAG::TrackingItem[*numItems];
-    memcpy(*items, results.data(), *numItems);
+    std::copy(results.begin(), results.end(), *items);
 
     return BAG_SUCCESS;
 }
@@ -1781,19 +1775,12 @@ BagError bagReadTrackingListCode(
 
     const auto& trackingList = handle->dataset->getTrackingList();
 
-    using std::cbegin;  using std::cend;
-    std::vector<BAG::TrackingItem> results;
-
-    std::copy_if(cbegin(trackingList), cend(trackingList),
-        std::back_inserter(results),
-        [code](const BAG::TrackingItem& item) {
-            return item.track_code == code;
-        });
+    const auto results = trackingList.findCode(code);
 
     *numItems = static_cast<uint32_t>(results.size());
 
     *items = new BAG::TrackingItem[*numItems];
-    memcpy(*items, results.data(), *numItems);
+    std::copy(results.begin(), results.end(), *items);
 
     return BAG_SUCCESS;
 }
@@ -1830,19 +1817,12 @@ BagError bagReadTrackingListSeries(
 
     const auto& trackingList = handle->dataset->getTrackingList();
 
-    using std::cbegin;  using std::cend;
-    std::vector<BAG::TrackingItem> results;
-
-    std::copy_if(cbegin(trackingList), cend(trackingList),
-        std::back_inserter(results),
-        [series](const BAG::TrackingItem& item) {
-            return item.list_series == series;
-        });
+    const auto results = trackingList.findSeries(series);
 
     *numItems = static_cast<uint32_t>(results.size());
 
     *items = new BAG::TrackingItem[*numItems];
-    memcpy(*items, results.data(), *numItems);
+    std::copy(results.begin(), results.end(), *items);
 
     return BAG_SUCCESS;
 }
@@ -1905,13 +1885,14 @@ BagError bagSortTrackingListByNode(BagHandle* handle)
 
     using std::begin;  using std::end;
 
-    std::sort(begin(trackingList), end(trackingList),
-        [](const BAG::TrackingItem& lhs, const BAG::TrackingItem& rhs) {
-            return (lhs.row >= rhs.row) && (lhs.col >= rhs.col);
-        });
-
     try
     {
+        std::stable_sort(begin(trackingList), end(trackingList),
+            [](const BAG::TrackingItem& lhs, const BAG::TrackingItem& rhs) {
+                return std::tie(lhs.row, lhs.col) > std::tie(rhs.row, rhs.col);
+            });
+        trackingList.markChanged(0, trackingList.size());
+        trackingList.markReordered();
         trackingList.write();
     }
     catch(const std::exception& /*e*/)
@@ -1941,13 +1922,14 @@ BagError bagSortTrackingListBySeries(BagHandle* handle)
 
     using std::begin;  using std::end;
 
-    std::sort(begin(trackingList), end(trackingList),
-        [](const BAG::TrackingItem& lhs, const BAG::TrackingItem& rhs) {
-            return lhs.list_series > rhs.list_series;
-        });
-
     try
     {
+        std::stable_sort(begin(trackingList), end(trackingList),
+            [](const BAG::TrackingItem& lhs, const BAG::TrackingItem& rhs) {
+                return lhs.list_series > rhs.list_series;
+            });
+        trackingList.markChanged(0, trackingList.size());
+        trackingList.markReordered();
         trackingList.write();
     }
     catch(const std::exception& /*e*/)
@@ -1977,13 +1959,14 @@ BagError bagSortTrackingListByCode(BagHandle* handle)
 
     using std::begin;  using std::end;
 
-    std::sort(begin(trackingList), end(trackingList),
-        [](const BAG::TrackingItem& lhs, const BAG::TrackingItem& rhs) {
-            return lhs.track_code > rhs.track_code;
-        });
-
     try
     {
+        std::stable_sort(begin(trackingList), end(trackingList),
+            [](const BAG::TrackingItem& lhs, const BAG::TrackingItem& rhs) {
+                return lhs.track_code > rhs.track_code;
+            });
+        trackingList.markChanged(0, trackingList.size());
+        trackingList.markReordered();
         trackingList.write();
     }
     catch(const std::exception& /*e*/)
@@ -3729,19 +3712,12 @@ BagError bagReadVRTrackingListNode(
     if (!vrTrackingList)
         return BAG_HDF_DATASET_OPEN_FAILURE;
 
-    using std::cbegin;  using std::cend;
-    std::vector<BAG::VRTrackingItem> results;
-
-    std::copy_if(cbegin(*vrTrackingList), cend(*vrTrackingList),
-        std::back_inserter(results),
-        [row, col](const BAG::VRTrackingItem& item) {
-            return item.row == row && item.col == col;
-        });
+    const auto results = vrTrackingList->findNode(row, col);
 
     *numItems = static_cast<uint32_t>(results.size());
 
     *items = new BAG::VRTrackingItem[*numItems];
-    memcpy(*items, results.data(), *numItems);
+    std::copy(results.begin(), results.end(), *items);
 
     return BAG_SUCCESS;
 }
@@ -3783,19 +3759,12 @@ BagError bagReadVRTrackingListSubNode(
     if (!vrTrackingList)
         return BAG_HDF_DATASET_OPEN_FAILURE;
 
-    using std::cbegin;  using std::cend;
-    std::vector<BAG::VRTrackingItem> results;
-
-    std::copy_if(cbegin(*vrTrackingList), cend(*vrTrackingList),
-        std::back_inserter(results),
-        [row, col](const BAG::VRTrackingItem& item) {
-            return item.sub_row == row && item.sub_col == col;
-        });
+    const auto results = vrTrackingList->findSubPosition(row, col);
 
     *numItems = static_cast<uint32_t>(results.size());
 
     *items = new BAG::VRTrackingItem[*numItems];
-    memcpy(*items, results.data(), *numItems);
+    std::copy(results.begin(), results.end(), *items);
 
     return BAG_SUCCESS;
 }
@@ -3834,19 +3803,12 @@ BagError bagReadVRTrackingListCode(
     if (!vrTrackingList)
         return BAG_HDF_DATASET_OPEN_FAILURE;
 
-    using std::cbegin;  using std::cend;
-    std::vector<BAG::VRTrackingItem> results;
-
-    std::copy_if(cbegin(*vrTrackingList), cend(*vrTrackingList),
-        std::back_inserter(results),
-        [code](const BAG::VRTrackingItem& item) {
-            return item.track_code == code;
-        });
+    const auto results = vrTrackingList->findCode(code);
 
     *numItems = static_cast<uint32_t>(results.size());
 
     *items = new BAG::VRTrackingItem[*numItems];
-    memcpy(*items, results.data(), *numItems);
+    std::copy(results.begin(), results.end(), *items);
 
     return BAG_SUCCESS;
 }
@@ -3885,19 +3847,12 @@ BagError bagReadVRTrackingListSeries(
     if (!vrTrackingList)
         return BAG_HDF_DATASET_OPEN_FAILURE;
 
-    using std::cbegin;  using std::cend;
-    std::vector<BAG::VRTrackingItem> results;
-
-    std::copy_if(cbegin(*vrTrackingList), cend(*vrTrackingList),
-        std::back_inserter(results),
-        [series](const BAG::VRTrackingItem& item) {
-            return item.list_series == series;
-        });
+    const auto results = vrTrackingList->findSeries(series);
 
     *numItems = static_cast<uint32_t>(results.size());
 
     *items = new BAG::VRTrackingItem[*numItems];
-    memcpy(*items, results.data(), *numItems);
+    std::copy(results.begin(), results.end(), *items);
 
     return BAG_SUCCESS;
 }
@@ -3973,13 +3928,16 @@ BagError bagSortVRTrackingListByNode(
 
     using std::begin;  using std::end;
 
-    std::sort(begin(*vrTrackingList), end(*vrTrackingList),
-        [](const BAG::VRTrackingItem& lhs, const BAG::VRTrackingItem& rhs) {
-            return (lhs.row >= rhs.row) && (lhs.col >= rhs.col);
-        });
-
     try
     {
+        std::stable_sort(begin(*vrTrackingList), end(*vrTrackingList),
+            [](const BAG::VRTrackingItem& lhs,
+                const BAG::VRTrackingItem& rhs) {
+                return std::tie(lhs.row, lhs.col, lhs.sub_row, lhs.sub_col) >
+                    std::tie(rhs.row, rhs.col, rhs.sub_row, rhs.sub_col);
+            });
+        vrTrackingList->markChanged(0, vrTrackingList->size());
+        vrTrackingList->markReordered();
         vrTrackingList->write();
     }
     catch(const BAG::DatasetNotFound& /*e*/)
@@ -4020,13 +3978,16 @@ BagError bagSortVRTrackingListBySubNode(
 
     using std::begin;  using std::end;
 
-    std::sort(begin(*vrTrackingList), end(*vrTrackingList),
-        [](const BAG::VRTrackingItem& lhs, const BAG::VRTrackingItem& rhs) {
-            return (lhs.sub_row >= rhs.sub_row) && (lhs.sub_col >= rhs.sub_col);
-        });
-
     try
     {
+        std::stable_sort(begin(*vrTrackingList), end(*vrTrackingList),
+            [](const BAG::VRTrackingItem& lhs,
+                const BAG::VRTrackingItem& rhs) {
+                return std::tie(lhs.sub_row, lhs.sub_col) >
+                    std::tie(rhs.sub_row, rhs.sub_col);
+            });
+        vrTrackingList->markChanged(0, vrTrackingList->size());
+        vrTrackingList->markReordered();
         vrTrackingList->write();
     }
     catch(const BAG::DatasetNotFound& /*e*/)
@@ -4067,13 +4028,15 @@ BagError bagSortVRTrackingListBySeries(
 
     using std::begin;  using std::end;
 
-    std::sort(begin(*vrTrackingList), end(*vrTrackingList),
-        [](const BAG::VRTrackingItem& lhs, const BAG::VRTrackingItem& rhs) {
-            return lhs.list_series > rhs.list_series;
-        });
-
     try
     {
+        std::stable_sort(begin(*vrTrackingList), end(*vrTrackingList),
+            [](const BAG::VRTrackingItem& lhs,
+                const BAG::VRTrackingItem& rhs) {
+                return lhs.list_series > rhs.list_series;
+            });
+        vrTrackingList->markChanged(0, vrTrackingList->size());
+        vrTrackingList->markReordered();
         vrTrackingList->write();
     }
     catch(const BAG::DatasetNotFound& /*e*/)
@@ -4114,13 +4077,15 @@ BagError bagSortVRTrackingListByCode(
 
     using std::begin;  using std::end;
 
-    std::sort(begin(*vrTrackingList), end(*vrTrackingList),
-        [](const BAG::VRTrackingItem& lhs, const BAG::VRTrackingItem& rhs) {
-            return lhs.track_code > rhs.track_code;
-        });
-
     try
     {
+        std::stable_sort(begin(*vrTrackingList), end(*vrTrackingList),
+            [](const BAG::VRTrackingItem& lhs,
+                const BAG::VRTrackingItem& rhs) {
+                return lhs.track_code > rhs.track_code;
+            });
+        vrTrackingList->markChanged(0, vrTrackingList->size());
+        vrTrackingList->markReordered();
         vrTrackingList->write();
     }
     catch(const BAG::DatasetNotFound& /*e*/)
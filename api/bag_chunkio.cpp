@@ -0,0 +1,970 @@
+
+#include "bag_chunkio.h"
+#include "bag_exceptions.h"
+#include "bag_parallel.h"
+
+#include <array>
+#include <cstring>
+#include <zlib.h>
+
+
+namespace BAG {
+
+namespace {
+
+//! The approximate size, in bytes, of a block of a contiguous DataSet.
+constexpr uint64_t kContiguousBlockSize = 1024 * 1024;
+
+//! Reverse the shuffle filter.
+/*!
+\param data
+    The shuffled bytes.
+\param elementSize
+    The size of an element.
+
+\return
+    The bytes in element order.
+*/
+std::vector<uint8_t> unshuffle(
+    const std::vector<uint8_t>& data,
+    size_t elementSize)
+{
+    if (elementSize <= 1)
+        return data;
+
+    std::vector<uint8_t> out(data.size());
+
+    const size_t numElements = data.size() / elementSize;
+    for (size_t byte = 0; byte < elementSize; ++byte)
+    {
+        const uint8_t* src = data.data() + byte * numElements;
+        for (size_t i = 0; i < numElements; ++i)
+            out[i * elementSize + byte] = src[i];
+    }
+
+    // Left over bytes are not shuffled.
+    const size_t done = numElements * elementSize;
+    std::copy(data.begin() + done, data.end(), out.begin() + done);
+
+    return out;
+}
+
+//! Apply the shuffle filter.
+/*!
+\param data
+    The bytes in element order.
+\param elementSize
+    The size of an element.
+
+\return
+    The shuffled bytes.
+*/
+std::vector<uint8_t> shuffle(
+    const std::vector<uint8_t>& data,
+    size_t elementSize)
+{
+    if (elementSize <= 1)
+        return data;
+
+    std::vector<uint8_t> out(data.size());
+
+    const size_t numElements = data.size() / elementSize;
+    for (size_t byte = 0; byte < elementSize; ++byte)
+    {
+        uint8_t* dst = out.data() + byte * numElements;
+        for (size_t i = 0; i < numElements; ++i)
+            dst[i] = data[i * elementSize + byte];
+    }
+
+    const size_t done = numElements * elementSize;
+    std::copy(data.begin() + done, data.end(), out.begin() + done);
+
+    return out;
+}
+
+//! Decompress a zlib stream.
+/*!
+\param data
+    The compressed bytes.
+\param expectedSize
+    The size of the decompressed data.
+
+\return
+    The decompressed bytes.
+*/
+std::vector<uint8_t> inflateBytes(
+    const std::vector<uint8_t>& data,
+    size_t expectedSize)
+{
+    std::vector<uint8_t> out(expectedSize);
+
+    auto outSize = static_cast<uLongf>(expectedSize);
+    const auto status = ::uncompress(out.data(), &outSize, data.data(),
+        static_cast<uLong>(data.size()));
+    if (status != Z_OK || outSize != expectedSize)
+        throw CorruptChunk{};
+
+    return out;
+}
+
+//! Compress bytes into a zlib stream, as the HDF5 deflate filter does.
+/*!
+\param data
+    The bytes to compress.
+\param level
+    The compression level.
+
+\return
+    The compressed bytes.
+*/
+std::vector<uint8_t> deflateBytes(
+    const std::vector<uint8_t>& data,
+    int level)
+{
+    auto outSize = ::compressBound(static_cast<uLong>(data.size()));
+    std::vector<uint8_t> out(outSize);
+
+    if (::compress2(out.data(), &outSize, data.data(),
+        static_cast<uLong>(data.size()), level) != Z_OK)
+        throw CorruptChunk{};
+
+    out.resize(outSize);
+
+    return out;
+}
+
+}  // namespace
+
+//! Compute the Fletcher32 checksum the same way the HDF5 filter does.
+/*!
+\param data
+    The bytes to checksum.
+\param length
+    The number of bytes.
+
+\return
+    The checksum.
+*/
+uint32_t computeFletcher32(
+    const uint8_t* data,
+    size_t length) noexcept
+{
+    size_t len = length / 2;
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+
+    while (len)
+    {
+        size_t tlen = len > 360 ? 360 : len;
+        len -= tlen;
+
+        do
+        {
+            sum1 += static_cast<uint32_t>((data[0] << 8) | data[1]);
+            data += 2;
+            sum2 += sum1;
+        } while (--tlen);
+
+        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+    }
+
+    if (length % 2)
+    {
+        sum1 += static_cast<uint32_t>(data[0] << 8);
+        sum2 += sum1;
+        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+    }
+
+    sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+    sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+
+    return (sum2 << 16) | sum1;
+}
+
+//! Constructor.
+/*!
+\param h5dataSet
+    The two dimensional HDF5 DataSet.
+*/
+ChunkedDataSet::ChunkedDataSet(
+    const ::H5::DataSet& h5dataSet)
+{
+    std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+    H5Iinc_ref(h5dataSet.getId());
+    this->init(h5dataSet.getId());
+}
+
+//! Constructor.
+/*!
+\param h5file
+    The HDF5 file containing the DataSet.
+\param path
+    The path of the two dimensional DataSet.
+*/
+ChunkedDataSet::ChunkedDataSet(
+    const ::H5::H5File& h5file,
+    const std::string& path)
+{
+    std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+    const auto id = H5Dopen2(h5file.getId(), path.c_str(), H5P_DEFAULT);
+    if (id < 0)
+        throw ::H5::DataSetIException{"ChunkedDataSet", "H5Dopen2 failed"};
+
+    this->init(id);
+}
+
+//! Destructor.
+ChunkedDataSet::~ChunkedDataSet() noexcept
+{
+    std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+    if (m_memType >= 0)
+        H5Tclose(m_memType);
+    if (m_fileType >= 0)
+        H5Tclose(m_fileType);
+    if (m_h5dataSet >= 0)
+        H5Dclose(m_h5dataSet);
+}
+
+//! Gather the layout of the DataSet.  The HDF5 mutex must be held.
+/*!
+\param h5dataSetId
+    The DataSet; ownership of the identifier is taken.
+*/
+void ChunkedDataSet::init(
+    hid_t h5dataSetId)
+{
+    m_h5dataSet = h5dataSetId;
+    m_fileType = H5Dget_type(m_h5dataSet);
+    m_memType = H5Tget_native_type(m_fileType, H5T_DIR_ASCEND);
+    m_elementSize = H5Tget_size(m_memType);
+    m_fileElementSize = H5Tget_size(m_fileType);
+
+    // Anything cached and dirty must reach the file before raw chunk reads.
+    H5Dflush(m_h5dataSet);
+
+    const auto fileSpace = H5Dget_space(m_h5dataSet);
+    const int rank = H5Sget_simple_extent_ndims(fileSpace);
+    m_rank = rank;
+    std::array<hsize_t, H5S_MAX_RANK> dims{};
+    H5Sget_simple_extent_dims(fileSpace, dims.data(), nullptr);
+    H5Sclose(fileSpace);
+
+    if (rank == 2)
+    {
+        m_dims[0] = dims[0];
+        m_dims[1] = dims[1];
+    }
+    else if (rank == 1)
+    {
+        m_dims[0] = 1;
+        m_dims[1] = dims[0];
+    }
+    else
+    {
+        H5Tclose(m_memType);
+        H5Tclose(m_fileType);
+        H5Dclose(m_h5dataSet);
+        m_memType = m_fileType = m_h5dataSet = -1;
+
+        throw UnsupportedElementSize{};
+    }
+
+    const auto createPlist = H5Dget_create_plist(m_h5dataSet);
+
+    m_chunked = H5Pget_layout(createPlist) == H5D_CHUNKED;
+    if (m_chunked)
+    {
+        std::array<hsize_t, H5S_MAX_RANK> chunkDims{};
+        H5Pget_chunk(createPlist, rank, chunkDims.data());
+        m_chunkDims[0] = rank == 2 ? chunkDims[0] : 1;
+        m_chunkDims[1] = rank == 2 ? chunkDims[1] : chunkDims[0];
+    }
+    else
+    {
+        // Blocks of whole rows.
+        const uint64_t rowSize = std::max<uint64_t>(m_dims[1] * m_elementSize, 1);
+        m_chunkDims[0] = std::max<uint64_t>(kContiguousBlockSize / rowSize, 1);
+        m_chunkDims[1] = std::max<uint64_t>(m_dims[1], 1);
+    }
+
+    // The filter pipeline.
+    m_filtersDecodable = m_chunked;
+
+    const int numFilters = H5Pget_nfilters(createPlist);
+    for (int i = 0; i < numFilters; ++i)
+    {
+        Filter filter;
+        std::array<unsigned int, 16> values{};
+        size_t numValues = values.size();
+        unsigned int filterConfig = 0;
+
+        filter.id = H5Pget_filter2(createPlist, static_cast<unsigned int>(i),
+            &filter.flags, &numValues, values.data(), 0, nullptr,
+            &filterConfig);
+        filter.values.assign(values.begin(),
+            values.begin() + std::min(numValues, values.size()));
+
+        if (filter.id != H5Z_FILTER_DEFLATE &&
+            filter.id != H5Z_FILTER_SHUFFLE &&
+            filter.id != H5Z_FILTER_FLETCHER32)
+            m_filtersDecodable = false;
+
+        m_filters.push_back(std::move(filter));
+    }
+
+    m_rawDecodable = m_filtersDecodable && H5Tequal(m_fileType, m_memType) > 0;
+
+    // The fill value.
+    m_fillValue.assign(m_elementSize, 0);
+    H5D_fill_value_t fillStatus = H5D_FILL_VALUE_UNDEFINED;
+    H5Pfill_value_defined(createPlist, &fillStatus);
+    if (fillStatus != H5D_FILL_VALUE_UNDEFINED)
+        H5Pget_fill_value(createPlist, m_memType, m_fillValue.data());
+
+    H5Pclose(createPlist);
+}
+
+//! \copydoc ChunkedDataSet::hasChecksum
+bool ChunkedDataSet::hasChecksum() const noexcept
+{
+    return std::any_of(m_filters.begin(), m_filters.end(),
+        [](const Filter& filter) {
+            return filter.id == H5Z_FILTER_FLETCHER32;
+        });
+}
+
+//! Retrieve the cells covered by a chunk, clipped to the DataSet extent.
+/*!
+\param chunkIndex
+    The chunk, numbered row major.
+
+\return
+    The cells covered by the chunk.
+*/
+GridWindow ChunkedDataSet::getChunkWindow(
+    uint64_t chunkIndex) const noexcept
+{
+    const auto numChunkColumns = this->getNumChunkColumns();
+    const auto chunkRow = chunkIndex / numChunkColumns;
+    const auto chunkColumn = chunkIndex % numChunkColumns;
+
+    GridWindow window;
+    window.rowStart = static_cast<uint32_t>(chunkRow * m_chunkDims[0]);
+    window.columnStart = static_cast<uint32_t>(chunkColumn * m_chunkDims[1]);
+    window.rowEnd = static_cast<uint32_t>(std::min(
+        (chunkRow + 1) * m_chunkDims[0], m_dims[0]) - 1);
+    window.columnEnd = static_cast<uint32_t>(std::min(
+        (chunkColumn + 1) * m_chunkDims[1], m_dims[1]) - 1);
+
+    return window;
+}
+
+//! Retrieve the chunks that share cells with a window.
+/*!
+\param window
+    The window; it must lie within the DataSet.
+
+\return
+    The chunk indices, row major.
+*/
+std::vector<uint64_t> ChunkedDataSet::getChunksIntersecting(
+    const GridWindow& window) const
+{
+    std::vector<uint64_t> chunks;
+
+    const auto numChunkColumns = this->getNumChunkColumns();
+
+    for (uint64_t chunkRow = window.rowStart / m_chunkDims[0];
+        chunkRow <= window.rowEnd / m_chunkDims[0]; ++chunkRow)
+        for (uint64_t chunkColumn = window.columnStart / m_chunkDims[1];
+            chunkColumn <= window.columnEnd / m_chunkDims[1]; ++chunkColumn)
+            chunks.push_back(chunkRow * numChunkColumns + chunkColumn);
+
+    return chunks;
+}
+
+//! Read one chunk.
+/*!
+\param chunkIndex
+    The chunk, numbered row major.
+
+\return
+    The values of the chunk window (see getChunkWindow()), row major.
+*/
+std::vector<uint8_t> ChunkedDataSet::readChunk(
+    uint64_t chunkIndex) const
+{
+    const auto window = this->getChunkWindow(chunkIndex);
+
+    if (!m_rawDecodable)
+        return this->readHyperslab(window);
+
+    RawChunk rawChunk;
+    std::vector<uint8_t> fullChunk;
+
+    if (this->readRawChunk(chunkIndex, rawChunk))
+        fullChunk = this->decodeRawChunk(rawChunk);
+
+    const size_t rowSize = window.columns() * m_elementSize;
+    std::vector<uint8_t> buffer(window.rows() * rowSize);
+
+    if (fullChunk.empty())
+    {
+        // Never written; every value is the fill value.
+        for (size_t i = 0; i < buffer.size(); i += m_elementSize)
+            std::memcpy(buffer.data() + i, m_fillValue.data(), m_elementSize);
+
+        return buffer;
+    }
+
+    const size_t chunkRowSize = m_chunkDims[1] * m_elementSize;
+    for (uint32_t row = 0; row < window.rows(); ++row)
+        std::memcpy(buffer.data() + row * rowSize,
+            fullChunk.data() + row * chunkRowSize, rowSize);
+
+    return buffer;
+}
+
+//! Read one chunk, converted to another memory type.
+/*!
+    Meant for compound DataSets read into a struct of the members wanted;
+    HDF5 matches the members by name.  Chunks already in that type are not
+    converted.
+
+\param chunkIndex
+    The chunk, numbered row major.
+\param memType
+    The HDF5 type to convert the values to.
+
+\return
+    The values of the chunk window (see getChunkWindow()), row major, in
+    memType.
+*/
+std::vector<uint8_t> ChunkedDataSet::readChunk(
+    uint64_t chunkIndex,
+    hid_t memType) const
+{
+    auto buffer = this->readChunk(chunkIndex);
+
+    std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+    if (H5Tequal(m_memType, memType) > 0)
+        return buffer;
+
+    const size_t numValues = buffer.size() / m_elementSize;
+    const size_t size = H5Tget_size(memType);
+
+    buffer.resize(numValues * std::max(size, m_elementSize));
+    std::vector<uint8_t> background(numValues * size);
+
+    if (H5Tconvert(m_memType, memType, numValues, buffer.data(),
+        background.data(), H5P_DEFAULT) < 0)
+        throw UnsupportedDataType{};
+
+    buffer.resize(numValues * size);
+
+    return buffer;
+}
+
+//! Read a window of any size, chunk by chunk.
+/*!
+    DataSets that are not raw decodable are read with a single hyperslab, so
+    a window spanning several row blocks of a contiguous DataSet reads each
+    row once.
+
+\param window
+    The window to read; it must lie within the DataSet.
+
+\return
+    The values of the window, row major.
+*/
+std::vector<uint8_t> ChunkedDataSet::read(
+    const GridWindow& window) const
+{
+    if (!m_rawDecodable)
+        return this->readHyperslab(window);
+
+    const size_t rowSize = window.columns() * m_elementSize;
+    std::vector<uint8_t> buffer(window.rows() * rowSize);
+
+    for (const auto chunkIndex : this->getChunksIntersecting(window))
+    {
+        const auto chunkWindow = this->getChunkWindow(chunkIndex);
+        const auto chunk = this->readChunk(chunkIndex);
+        const auto overlap = chunkWindow.intersection(window);
+
+        const size_t chunkRowSize = chunkWindow.columns() * m_elementSize;
+        const size_t overlapRowSize = overlap.columns() * m_elementSize;
+
+        for (uint32_t row = overlap.rowStart; row <= overlap.rowEnd; ++row)
+            std::memcpy(buffer.data() + (row - window.rowStart) * rowSize +
+                    (overlap.columnStart - window.columnStart) * m_elementSize,
+                chunk.data() + (row - chunkWindow.rowStart) * chunkRowSize +
+                    (overlap.columnStart - chunkWindow.columnStart) * m_elementSize,
+                overlapRowSize);
+    }
+
+    return buffer;
+}
+
+//! Read a window through the HDF5 filter pipeline, holding the HDF5 mutex.
+/*!
+\param window
+    The window to read; it must lie within the DataSet.
+
+\return
+    The values of the window, row major.
+*/
+std::vector<uint8_t> ChunkedDataSet::readHyperslab(
+    const GridWindow& window) const
+{
+    std::vector<uint8_t> buffer(
+        static_cast<size_t>(window.rows()) * window.columns() * m_elementSize);
+
+    const std::array<hsize_t, 2> count{window.rows(), window.columns()};
+    const std::array<hsize_t, 2> offset{window.rowStart, window.columnStart};
+
+    std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+    const auto fileSpace = H5Dget_space(m_h5dataSet);
+    const auto memSpace = H5Screate_simple(m_rank, this->trim(count.data()),
+        nullptr);
+    H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, this->trim(offset.data()),
+        nullptr, this->trim(count.data()), nullptr);
+
+    const auto status = H5Dread(m_h5dataSet, m_memType, memSpace, fileSpace,
+        H5P_DEFAULT, buffer.data());
+
+    H5Sclose(memSpace);
+    H5Sclose(fileSpace);
+
+    if (status < 0)
+        throw ::H5::DataSetIException{"ChunkedDataSet::readHyperslab",
+            "H5Dread failed"};
+
+    return buffer;
+}
+
+//! Write one chunk.
+/*!
+\param chunkIndex
+    The chunk, numbered row major.
+\param buffer
+    The values of the chunk window (see getChunkWindow()), row major.
+*/
+void ChunkedDataSet::writeChunk(
+    uint64_t chunkIndex,
+    const uint8_t* buffer)
+{
+    if (m_rawDecodable)
+    {
+        this->writeRawChunk(chunkIndex, this->encodeChunk(
+            this->makeFullChunk(chunkIndex, buffer).data()));
+        return;
+    }
+
+    this->write(this->getChunkWindow(chunkIndex), buffer);
+}
+
+//! Write a window of any size.
+/*!
+    A window that is exactly one raw decodable chunk is written with
+    writeChunk(); any other window with a hyperslab.
+
+\param window
+    The window to write; it must lie within the DataSet.
+\param buffer
+    The values of the window, row major.
+*/
+void ChunkedDataSet::write(
+    const GridWindow& window,
+    const uint8_t* buffer)
+{
+    if (m_rawDecodable && window.rowStart % m_chunkDims[0] == 0 &&
+        window.columnStart % m_chunkDims[1] == 0)
+    {
+        const uint64_t chunkIndex = window.rowStart / m_chunkDims[0] *
+            this->getNumChunkColumns() + window.columnStart / m_chunkDims[1];
+        const auto chunkWindow = this->getChunkWindow(chunkIndex);
+
+        if (chunkWindow.rowEnd == window.rowEnd &&
+            chunkWindow.columnEnd == window.columnEnd)
+        {
+            this->writeChunk(chunkIndex, buffer);
+            return;
+        }
+    }
+
+    const std::array<hsize_t, 2> count{window.rows(), window.columns()};
+    const std::array<hsize_t, 2> offset{window.rowStart, window.columnStart};
+
+    std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+    const auto fileSpace = H5Dget_space(m_h5dataSet);
+    const auto memSpace = H5Screate_simple(m_rank, this->trim(count.data()),
+        nullptr);
+    H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, this->trim(offset.data()),
+        nullptr, this->trim(count.data()), nullptr);
+
+    const auto status = H5Dwrite(m_h5dataSet, m_memType, memSpace, fileSpace,
+        H5P_DEFAULT, buffer);
+
+    H5Sclose(memSpace);
+    H5Sclose(fileSpace);
+
+    if (status < 0)
+        throw ::H5::DataSetIException{"ChunkedDataSet::write",
+            "H5Dwrite failed"};
+}
+
+//! Read a chunk as stored in the file.
+/*!
+\param chunkIndex
+    The chunk, numbered row major.
+\param rawChunk
+    Receives the stored bytes and filter mask.
+
+\return
+    \e true if the chunk is allocated in the file.
+    \e false if it was never written.
+*/
+bool ChunkedDataSet::readRawChunk(
+    uint64_t chunkIndex,
+    RawChunk& rawChunk) const
+{
+    const auto window = this->getChunkWindow(chunkIndex);
+    const std::array<hsize_t, 2> offset{window.rowStart, window.columnStart};
+
+    std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+    hsize_t storageSize = 0;
+    if (H5Dget_chunk_storage_size(m_h5dataSet, this->trim(offset.data()),
+        &storageSize) < 0)
+        throw ::H5::DataSetIException{"ChunkedDataSet::readRawChunk",
+            "H5Dget_chunk_storage_size failed"};
+
+    if (storageSize == 0)
+        return false;
+
+    rawChunk.bytes.resize(storageSize);
+    if (H5Dread_chunk(m_h5dataSet, H5P_DEFAULT, this->trim(offset.data()),
+        &rawChunk.filterMask, rawChunk.bytes.data()) < 0)
+        throw ::H5::DataSetIException{"ChunkedDataSet::readRawChunk",
+            "H5Dread_chunk failed"};
+
+    return true;
+}
+
+//! Write a chunk as it will be stored in the file.
+/*!
+\param chunkIndex
+    The chunk, numbered row major.
+\param rawChunk
+    The filtered bytes and filter mask.
+*/
+void ChunkedDataSet::writeRawChunk(
+    uint64_t chunkIndex,
+    const RawChunk& rawChunk)
+{
+    const auto window = this->getChunkWindow(chunkIndex);
+    const std::array<hsize_t, 2> offset{window.rowStart, window.columnStart};
+
+    std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+    if (H5Dwrite_chunk(m_h5dataSet, H5P_DEFAULT, rawChunk.filterMask,
+        this->trim(offset.data()), rawChunk.bytes.size(),
+        rawChunk.bytes.data()) < 0)
+        throw ::H5::DataSetIException{"ChunkedDataSet::writeRawChunk",
+            "H5Dwrite_chunk failed"};
+}
+
+//! Undo the filter pipeline on a raw chunk.
+/*!
+    Only valid if the pipeline is made of the deflate, shuffle and Fletcher32
+    filters, as it always is if isRawDecodable().  Does not use HDF5.
+
+\param rawChunk
+    The chunk as stored in the file.
+
+\return
+    The full chunk (chunk rows by chunk columns), row major, in the file type.
+
+\throws
+    CorruptChunk if a checksum does not match, or the data does not inflate.
+*/
+std::vector<uint8_t> ChunkedDataSet::decodeRawChunk(
+    const RawChunk& rawChunk) const
+{
+    const size_t chunkBytes = m_chunkDims[0] * m_chunkDims[1] * m_fileElementSize;
+
+    std::vector<uint8_t> data = rawChunk.bytes;
+
+    for (size_t i = m_filters.size(); i-- > 0; )
+    {
+        if (rawChunk.filterMask & (1u << i))
+            continue;
+
+        const auto& filter = m_filters[i];
+
+        switch (filter.id)
+        {
+        case H5Z_FILTER_FLETCHER32:
+        {
+            if (data.size() < 4)
+                throw CorruptChunk{};
+
+            const size_t length = data.size() - 4;
+            const uint8_t* stored = data.data() + length;
+            const uint32_t storedSum = static_cast<uint32_t>(stored[0]) |
+                (static_cast<uint32_t>(stored[1]) << 8) |
+                (static_cast<uint32_t>(stored[2]) << 16) |
+                (static_cast<uint32_t>(stored[3]) << 24);
+
+            const auto sum = computeFletcher32(data.data(), length);
+
+            // Files from before HDF5 1.6.3 stored the sum with the bytes of
+            // each 16 bit half swapped.
+            const uint32_t swappedSum = ((sum & 0x00ff00ff) << 8) |
+                ((sum >> 8) & 0x00ff00ff);
+
+            if (storedSum != sum && storedSum != swappedSum)
+                throw CorruptChunk{};
+
+            data.resize(length);
+            break;
+        }
+        case H5Z_FILTER_DEFLATE:
+            data = inflateBytes(data, chunkBytes);
+            break;
+        case H5Z_FILTER_SHUFFLE:
+            data = unshuffle(data, filter.values.empty() ?
+                m_fileElementSize : filter.values[0]);
+            break;
+        default:
+            throw CorruptChunk{};
+        }
+    }
+
+    if (data.size() != chunkBytes)
+        throw CorruptChunk{};
+
+    return data;
+}
+
+//! Check that one chunk can be read back intact.
+/*!
+    When the filter pipeline can be reversed here, the raw chunk is read
+    under the HDF5 mutex and checked (checksum and inflate) without it, so
+    many chunks can be checked at once.  Otherwise the chunk is read through
+    HDF5, which checks it.  A chunk that was never written is intact.
+
+\param chunkIndex
+    The chunk, numbered row major.
+
+\return
+    Empty if the chunk is intact, otherwise why it is not.
+*/
+std::string ChunkedDataSet::verifyChunk(
+    uint64_t chunkIndex) const
+{
+    try
+    {
+        if (m_filtersDecodable)
+        {
+            RawChunk rawChunk;
+            if (this->readRawChunk(chunkIndex, rawChunk))
+                this->decodeRawChunk(rawChunk);
+        }
+        else
+            this->readChunk(chunkIndex);
+    }
+    catch (const CorruptChunk& e)
+    {
+        return e.what();
+    }
+    catch (const ::H5::Exception& e)
+    {
+        return e.getDetailMsg();
+    }
+
+    return {};
+}
+
+//! Apply the filter pipeline to a full chunk.
+/*!
+    Only valid if isRawDecodable().  Does not use HDF5.
+
+\param buffer
+    The full chunk (chunk rows by chunk columns), row major.
+
+\return
+    The chunk as it is to be stored in the file.
+*/
+RawChunk ChunkedDataSet::encodeChunk(
+    const uint8_t* buffer) const
+{
+    const size_t chunkBytes = m_chunkDims[0] * m_chunkDims[1] * m_elementSize;
+
+    RawChunk rawChunk;
+    rawChunk.bytes.assign(buffer, buffer + chunkBytes);
+
+    for (const auto& filter : m_filters)
+    {
+        switch (filter.id)
+        {
+        case H5Z_FILTER_FLETCHER32:
+        {
+            const auto sum = computeFletcher32(rawChunk.bytes.data(),
+                rawChunk.bytes.size());
+
+            rawChunk.bytes.push_back(static_cast<uint8_t>(sum));
+            rawChunk.bytes.push_back(static_cast<uint8_t>(sum >> 8));
+            rawChunk.bytes.push_back(static_cast<uint8_t>(sum >> 16));
+            rawChunk.bytes.push_back(static_cast<uint8_t>(sum >> 24));
+            break;
+        }
+        case H5Z_FILTER_DEFLATE:
+            rawChunk.bytes = deflateBytes(rawChunk.bytes, filter.values.empty() ?
+                Z_DEFAULT_COMPRESSION : static_cast<int>(filter.values[0]));
+            break;
+        case H5Z_FILTER_SHUFFLE:
+            rawChunk.bytes = shuffle(rawChunk.bytes, filter.values.empty() ?
+                m_elementSize : filter.values[0]);
+            break;
+        default:
+            throw CorruptChunk{};
+        }
+    }
+
+    return rawChunk;
+}
+
+//! Pad a chunk window to a full chunk with the fill value.
+/*!
+\param chunkIndex
+    The chunk, numbered row major.
+\param buffer
+    The values of the chunk window (see getChunkWindow()), row major.
+
+\return
+    The full chunk (chunk rows by chunk columns), row major.
+*/
+std::vector<uint8_t> ChunkedDataSet::makeFullChunk(
+    uint64_t chunkIndex,
+    const uint8_t* buffer) const
+{
+    const auto window = this->getChunkWindow(chunkIndex);
+    const size_t chunkRowSize = m_chunkDims[1] * m_elementSize;
+    const size_t rowSize = window.columns() * m_elementSize;
+
+    if (rowSize == chunkRowSize && window.rows() == m_chunkDims[0])
+        return {buffer, buffer + window.rows() * rowSize};
+
+    std::vector<uint8_t> fullChunk(m_chunkDims[0] * chunkRowSize);
+    for (size_t i = 0; i < fullChunk.size(); i += m_elementSize)
+        std::memcpy(fullChunk.data() + i, m_fillValue.data(), m_elementSize);
+
+    for (uint32_t row = 0; row < window.rows(); ++row)
+        std::memcpy(fullChunk.data() + row * chunkRowSize,
+            buffer + row * rowSize, rowSize);
+
+    return fullChunk;
+}
+
+//! Determine if raw chunks can be copied unchanged to another DataSet.
+/*!
+\param other
+    The other DataSet.
+
+\return
+    \e true if both have the same type, extent, chunking and filters.
+*/
+bool ChunkedDataSet::hasSameStorage(
+    const ChunkedDataSet& other) const
+{
+    return m_dims[0] == other.m_dims[0] && m_dims[1] == other.m_dims[1] &&
+        this->hasSameChunking(other);
+}
+
+//! Determine if a raw chunk means the same values in another DataSet.
+/*!
+    Unlike hasSameStorage(), the extents may differ, so chunks can be copied
+    between a DataSet and a window of it that starts on a chunk boundary.
+
+\param other
+    The other DataSet.
+
+\return
+    \e true if both have the same type, chunking and filters.
+*/
+bool ChunkedDataSet::hasSameChunking(
+    const ChunkedDataSet& other) const
+{
+    if (!m_chunked || !other.m_chunked || m_rank != other.m_rank ||
+        m_chunkDims[0] != other.m_chunkDims[0] ||
+        m_chunkDims[1] != other.m_chunkDims[1] ||
+        m_filters.size() != other.m_filters.size())
+        return false;
+
+    for (size_t i = 0; i < m_filters.size(); ++i)
+        if (m_filters[i].id != other.m_filters[i].id ||
+            m_filters[i].values != other.m_filters[i].values)
+            return false;
+
+    std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+    return H5Tequal(m_fileType, other.m_fileType) > 0;
+}
+
+//! Widen a range to include values read from the DataSet.
+/*!
+    Only float and 32 bit unsigned integer DataSets have a range; null
+    elevations are skipped in float DataSets.
+
+\param values
+    The values, in the native type.
+\param rows
+    The number of rows of values.
+\param columns
+    The number of columns of values.
+\param stride
+    The number of elements between the starts of rows.
+\param range
+    The range to widen.
+*/
+void ChunkedDataSet::addToRange(
+    const uint8_t* values,
+    uint32_t rows,
+    uint32_t columns,
+    size_t stride,
+    ValueRange& range) const
+{
+    const bool isFloat = H5Tget_class(m_memType) == H5T_FLOAT;
+
+    for (uint32_t row = 0; row < rows; ++row)
+    {
+        if (isFloat)
+        {
+            const auto* first = reinterpret_cast<const float*>(values) +
+                row * stride;
+            std::for_each(first, first + columns,
+                [&range](float value) { range.add(value); });
+        }
+        else
+        {
+            const auto* first = reinterpret_cast<const uint32_t*>(values) +
+                row * stride;
+            const auto minMax = std::minmax_element(first, first + columns);
+            range.min = std::min(range.min, static_cast<float>(*minMax.first));
+            range.max = std::max(range.max, static_cast<float>(*minMax.second));
+        }
+    }
+}
+
+}  // namespace BAG
+
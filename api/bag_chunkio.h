@@ -0,0 +1,266 @@
+#ifndef BAG_CHUNKIO_H
+#define BAG_CHUNKIO_H
+
+#include "bag_c_types.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <H5Cpp.h>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+namespace BAG {
+
+//! An inclusive window of grid cells.
+struct GridWindow final
+{
+    //! The number of rows in the window.
+    uint32_t rows() const noexcept
+    {
+        return rowEnd - rowStart + 1;
+    }
+    //! The number of columns in the window.
+    uint32_t columns() const noexcept
+    {
+        return columnEnd - columnStart + 1;
+    }
+    //! Determine if the window shares any cells with another.
+    bool intersects(const GridWindow& other) const noexcept
+    {
+        return rowStart <= other.rowEnd && other.rowStart <= rowEnd &&
+            columnStart <= other.columnEnd && other.columnStart <= columnEnd;
+    }
+    //! The cells shared with another window; only valid if they intersect.
+    GridWindow intersection(const GridWindow& other) const noexcept
+    {
+        return {std::max(rowStart, other.rowStart),
+            std::max(columnStart, other.columnStart),
+            std::min(rowEnd, other.rowEnd),
+            std::min(columnEnd, other.columnEnd)};
+    }
+
+    //! The first row.
+    uint32_t rowStart = 0;
+    //! The first column.
+    uint32_t columnStart = 0;
+    //! The last row.
+    uint32_t rowEnd = 0;
+    //! The last column.
+    uint32_t columnEnd = 0;
+};
+
+//! A chunk as stored in the file; still compressed, with any checksum.
+struct RawChunk final
+{
+    //! The filtered bytes of the chunk.
+    std::vector<uint8_t> bytes;
+    //! The mask of filters that were skipped when the chunk was written.
+    uint32_t filterMask = 0;
+};
+
+//! The range of the non-null values written to a layer.
+struct ValueRange final
+{
+    //! Determine if a value is not the null value.
+    static bool isValid(float value) noexcept
+    {
+        return value != BAG_NULL_ELEVATION && value == value;
+    }
+    //! Widen the range to include a value, if it is not null.
+    void add(float value) noexcept
+    {
+        if (!isValid(value))
+            return;
+
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    //! Widen the range to include another range.
+    void merge(const ValueRange& other) noexcept
+    {
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+    //! Determine if no value was added.
+    bool empty() const noexcept
+    {
+        return min > max;
+    }
+
+    //! The smallest value.
+    float min = std::numeric_limits<float>::max();
+    //! The largest value.
+    float max = std::numeric_limits<float>::lowest();
+};
+
+//! Chunk at a time access to a two dimensional HDF5 DataSet.
+/*!
+    Reads and writes whole chunks so work can be spread over threads.  When
+    the DataSet only uses the deflate, shuffle and Fletcher32 filters, chunks
+    are moved with H5Dread_chunk()/H5Dwrite_chunk() while holding the HDF5
+    mutex, and are (de)compressed and checksummed by the calling thread
+    without it.  Any other filter pipeline falls back to hyperslab I/O under
+    the mutex.
+
+    Data is exchanged in the native form of the DataSet type, packed row major
+    and clipped to the DataSet extent.  Contiguous DataSets are presented as
+    blocks of whole rows.
+
+    Every member function is safe to call from worker threads.
+*/
+class ChunkedDataSet final
+{
+public:
+    explicit ChunkedDataSet(const ::H5::DataSet& h5dataSet);
+    ChunkedDataSet(const ::H5::H5File& h5file, const std::string& path);
+    ~ChunkedDataSet() noexcept;
+
+    ChunkedDataSet(const ChunkedDataSet&) = delete;
+    ChunkedDataSet(ChunkedDataSet&&) = delete;
+
+    ChunkedDataSet& operator=(const ChunkedDataSet&) = delete;
+    ChunkedDataSet& operator=(ChunkedDataSet&&) = delete;
+
+    //! The number of rows in the DataSet.
+    uint64_t getRows() const noexcept
+    {
+        return m_dims[0];
+    }
+    //! The number of columns in the DataSet.
+    uint64_t getColumns() const noexcept
+    {
+        return m_dims[1];
+    }
+    //! The number of rows in a chunk.
+    uint64_t getChunkRows() const noexcept
+    {
+        return m_chunkDims[0];
+    }
+    //! The number of columns in a chunk.
+    uint64_t getChunkColumns() const noexcept
+    {
+        return m_chunkDims[1];
+    }
+    //! The number of chunks down the DataSet.
+    uint64_t getNumChunkRows() const noexcept
+    {
+        return (m_dims[0] + m_chunkDims[0] - 1) / m_chunkDims[0];
+    }
+    //! The number of chunks across the DataSet.
+    uint64_t getNumChunkColumns() const noexcept
+    {
+        return (m_dims[1] + m_chunkDims[1] - 1) / m_chunkDims[1];
+    }
+    //! The number of chunks in the DataSet.
+    uint64_t getNumChunks() const noexcept
+    {
+        return getNumChunkRows() * getNumChunkColumns();
+    }
+    //! The size of one element, in bytes, of the native type.
+    size_t getElementSize() const noexcept
+    {
+        return m_elementSize;
+    }
+    //! The fill value of the DataSet, in the native type.
+    const std::vector<uint8_t>& getFillValue() const & noexcept
+    {
+        return m_fillValue;
+    }
+    //! Is the DataSet stored in chunks?
+    bool isChunked() const noexcept
+    {
+        return m_chunked;
+    }
+    //! Can raw chunks be decoded without the HDF5 filter pipeline?
+    bool isRawDecodable() const noexcept
+    {
+        return m_rawDecodable;
+    }
+    //! Does the DataSet carry a Fletcher32 checksum on each chunk?
+    bool hasChecksum() const noexcept;
+    //! The native HDF5 type data is exchanged in.
+    hid_t getMemType() const noexcept
+    {
+        return m_memType;
+    }
+
+    GridWindow getChunkWindow(uint64_t chunkIndex) const noexcept;
+    std::vector<uint64_t> getChunksIntersecting(const GridWindow& window) const;
+
+    std::vector<uint8_t> readChunk(uint64_t chunkIndex) const;
+    std::vector<uint8_t> readChunk(uint64_t chunkIndex, hid_t memType) const;
+    std::vector<uint8_t> read(const GridWindow& window) const;
+    void writeChunk(uint64_t chunkIndex, const uint8_t* buffer);
+    void write(const GridWindow& window, const uint8_t* buffer);
+
+    bool readRawChunk(uint64_t chunkIndex, RawChunk& rawChunk) const;
+    void writeRawChunk(uint64_t chunkIndex, const RawChunk& rawChunk);
+    std::vector<uint8_t> decodeRawChunk(const RawChunk& rawChunk) const;
+    std::string verifyChunk(uint64_t chunkIndex) const;
+    RawChunk encodeChunk(const uint8_t* buffer) const;
+
+    bool hasSameStorage(const ChunkedDataSet& other) const;
+    bool hasSameChunking(const ChunkedDataSet& other) const;
+
+    void addToRange(const uint8_t* values, uint32_t rows, uint32_t columns,
+        size_t stride, ValueRange& range) const;
+
+private:
+    void init(hid_t h5dataSetId);
+    std::vector<uint8_t> readHyperslab(const GridWindow& window) const;
+    std::vector<uint8_t> makeFullChunk(uint64_t chunkIndex,
+        const uint8_t* buffer) const;
+
+    //! Drop the row of a (row, column) pair for one dimensional DataSets.
+    const hsize_t* trim(const hsize_t* rowColumn) const noexcept
+    {
+        return m_rank == 2 ? rowColumn : rowColumn + 1;
+    }
+
+    //! A filter in the DataSet pipeline.
+    struct Filter final
+    {
+        //! The filter identifier.
+        H5Z_filter_t id = 0;
+        //! The filter flags.
+        unsigned int flags = 0;
+        //! The filter client data.
+        std::vector<unsigned int> values;
+    };
+
+    //! The HDF5 DataSet.
+    hid_t m_h5dataSet = -1;
+    //! The HDF5 type of the DataSet in the file.
+    hid_t m_fileType = -1;
+    //! The native HDF5 type data is exchanged in.
+    hid_t m_memType = -1;
+    //! The size of an element in the native type.
+    size_t m_elementSize = 0;
+    //! The size of an element in the file type.
+    size_t m_fileElementSize = 0;
+    //! The rank of the DataSet; one dimensional DataSets are a single row.
+    int m_rank = 2;
+    //! The DataSet dimensions.
+    uint64_t m_dims[2] = {};
+    //! The chunk dimensions (row blocks for contiguous DataSets).
+    uint64_t m_chunkDims[2] = {1, 1};
+    //! Is the DataSet chunked?
+    bool m_chunked = false;
+    //! Can raw chunks be decoded and encoded here?
+    bool m_rawDecodable = false;
+    //! Can the filter pipeline be reversed here (whatever the type)?
+    bool m_filtersDecodable = false;
+    //! The filter pipeline.
+    std::vector<Filter> m_filters;
+    //! The fill value in the native type.
+    std::vector<uint8_t> m_fillValue;
+};
+
+uint32_t computeFletcher32(const uint8_t* data, size_t length) noexcept;
+
+}  // namespace BAG
+
+#endif  // BAG_CHUNKIO_H
+
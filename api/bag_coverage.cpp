@@ -0,0 +1,716 @@
+
+#include "bag_chunkio.h"
+#include "bag_coverage.h"
+#include "bag_layerdescriptor.h"
+#include "bag_parallel.h"
+#include "bag_private.h"
+#include "bag_simplelayer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <H5Cpp.h>
+#include <numeric>
+#include <unordered_map>
+
+
+namespace BAG {
+
+namespace {
+
+//! The HDF5 DataSet chunk size.
+constexpr hsize_t kChunkSize = 4096;
+
+//! Make the HDF5 type of a coverage run.
+/*!
+\return
+    The HDF5 compound type of a CoverageRun.
+*/
+::H5::CompType makeDataType()
+{
+    const ::H5::CompType h5dataType{sizeof(CoverageRun)};
+
+    h5dataType.insertMember("row", HOFFSET(CoverageRun, row),
+        ::H5::PredType::NATIVE_UINT32);
+    h5dataType.insertMember("column_start", HOFFSET(CoverageRun, columnStart),
+        ::H5::PredType::NATIVE_UINT32);
+    h5dataType.insertMember("column_end", HOFFSET(CoverageRun, columnEnd),
+        ::H5::PredType::NATIVE_UINT32);
+
+    return h5dataType;
+}
+
+//! Determine if an elevation holds data.
+bool isValid(float value) noexcept
+{
+    return value != BAG_NULL_ELEVATION && !std::isnan(value);
+}
+
+//! A half open span of columns [start, end).
+struct Span final
+{
+    uint32_t start = 0;
+    uint32_t end = 0;
+};
+
+//! Find the parts of a span not covered by the runs of a row.
+/*!
+\param span
+    The span.
+\param begin
+    The first run of the row.
+\param end
+    One past the last run of the row.
+
+\return
+    The uncovered parts of the span.
+*/
+std::vector<Span> subtract(
+    Span span,
+    std::vector<CoverageRun>::const_iterator begin,
+    std::vector<CoverageRun>::const_iterator end)
+{
+    std::vector<Span> remaining;
+
+    uint32_t position = span.start;
+    for (auto run = begin; run != end && position < span.end; ++run)
+    {
+        if (run->columnEnd + 1 <= position)
+            continue;
+        if (run->columnStart >= span.end)
+            break;
+
+        if (run->columnStart > position)
+            remaining.push_back({position, run->columnStart});
+
+        position = std::max(position, run->columnEnd + 1);
+    }
+
+    if (position < span.end)
+        remaining.push_back({position, span.end});
+
+    return remaining;
+}
+
+//! A directed edge between grid vertices, with data on its left.
+struct Edge final
+{
+    uint32_t x0 = 0;
+    uint32_t y0 = 0;
+    uint32_t x1 = 0;
+    uint32_t y1 = 0;
+};
+
+//! The key of a grid vertex.
+uint64_t vertexKey(uint32_t x, uint32_t y) noexcept
+{
+    return (static_cast<uint64_t>(x) << 32) | y;
+}
+
+//! The sign of an edge delta.
+int sign(uint32_t from, uint32_t to) noexcept
+{
+    return to > from ? 1 : (to < from ? -1 : 0);
+}
+
+//! A disjoint set of gap runs, used to group holidays.
+struct DisjointSet final
+{
+    explicit DisjointSet(size_t size)
+        : parent(size)
+    {
+        std::iota(parent.begin(), parent.end(), size_t{0});
+    }
+
+    size_t find(size_t i) noexcept
+    {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+
+        return i;
+    }
+
+    void merge(size_t a, size_t b) noexcept
+    {
+        a = find(a);
+        b = find(b);
+
+        if (a != b)
+            parent[std::max(a, b)] = std::min(a, b);
+    }
+
+    std::vector<size_t> parent;
+};
+
+}  // namespace
+
+//! Constructor.
+/*!
+\param dataset
+    The BAG Dataset the coverage describes.
+\param runs
+    The runs, ordered by row then column.
+*/
+Coverage::Coverage(
+    const Dataset& dataset,
+    std::vector<CoverageRun>&& runs)
+    : m_runs(std::move(runs))
+{
+    const auto& metadata = dataset.getMetadata();
+
+    m_rows = metadata.rows();
+    m_columns = metadata.columns();
+    m_llCornerX = metadata.llCornerX();
+    m_llCornerY = metadata.llCornerY();
+    m_rowResolution = metadata.rowResolution();
+    m_columnResolution = metadata.columnResolution();
+}
+
+//! Compute the coverage of the elevation layer.
+/*!
+    Each chunk of the elevation layer is scanned for runs by its own task;
+    the runs are then joined across chunk boundaries.  The cached coverage is
+    neither read nor written; use Dataset::getCoverage() for that.
+
+\param dataset
+    The BAG Dataset.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The coverage.
+*/
+Coverage Coverage::compute(
+    const Dataset& dataset,
+    unsigned int numThreads)
+{
+    if (!dataset.getSimpleLayer(Elevation))
+        throw LayerNotFound{};
+
+    const ChunkedDataSet elevation{dataset.getH5file(),
+        Layer::getInternalPath(Elevation)};
+    if (elevation.getElementSize() != sizeof(float))
+        throw UnsupportedElementSize{};
+
+    const auto numChunks = elevation.getNumChunks();
+    std::vector<std::vector<CoverageRun>> chunkRuns(numChunks);
+
+    parallelFor(numChunks, numThreads, [&](size_t chunkIndex) {
+        const auto window = elevation.getChunkWindow(chunkIndex);
+        const auto buffer = elevation.readChunk(chunkIndex);
+        const auto* values = reinterpret_cast<const float*>(buffer.data());
+
+        auto& runs = chunkRuns[chunkIndex];
+
+        for (uint32_t row = 0; row < window.rows(); ++row)
+        {
+            const float* rowValues = values + row * window.columns();
+
+            uint32_t column = 0;
+            while (column < window.columns())
+            {
+                if (!isValid(rowValues[column]))
+                {
+                    ++column;
+                    continue;
+                }
+
+                const uint32_t start = column;
+                while (column < window.columns() && isValid(rowValues[column]))
+                    ++column;
+
+                runs.push_back({window.rowStart + row,
+                    window.columnStart + start,
+                    window.columnStart + column - 1});
+            }
+        }
+    });
+
+    std::vector<CoverageRun> runs;
+    runs.reserve(std::accumulate(chunkRuns.begin(), chunkRuns.end(), size_t{0},
+        [](size_t total, const std::vector<CoverageRun>& chunk) {
+            return total + chunk.size();
+        }));
+
+    for (auto& chunk : chunkRuns)
+    {
+        runs.insert(runs.end(), chunk.begin(), chunk.end());
+        std::vector<CoverageRun>{}.swap(chunk);
+    }
+
+    std::sort(runs.begin(), runs.end(),
+        [](const CoverageRun& lhs, const CoverageRun& rhs) noexcept {
+            return lhs.row < rhs.row ||
+                (lhs.row == rhs.row && lhs.columnStart < rhs.columnStart);
+        });
+
+    // Join runs that meet at a chunk boundary.
+    std::vector<CoverageRun> joined;
+    joined.reserve(runs.size());
+
+    for (const auto& run : runs)
+    {
+        if (!joined.empty() && joined.back().row == run.row &&
+            joined.back().columnEnd + 1 == run.columnStart)
+            joined.back().columnEnd = run.columnEnd;
+        else
+            joined.push_back(run);
+    }
+
+    joined.shrink_to_fit();
+
+    return Coverage{dataset, std::move(joined)};
+}
+
+//! Determine if the BAG holds a cached coverage.
+/*!
+\param dataset
+    The BAG Dataset.
+
+\return
+    \e true if the coverage is cached in the BAG.
+*/
+bool Coverage::exists(
+    const Dataset& dataset)
+{
+    return H5Lexists(dataset.getH5file().getId(), COVERAGE_PATH,
+        H5P_DEFAULT) > 0;
+}
+
+//! Read the coverage cached in the BAG.
+/*!
+\param dataset
+    The BAG Dataset.
+
+\return
+    The cached coverage.
+*/
+Coverage Coverage::read(
+    const Dataset& dataset)
+{
+    const auto h5dataSet = dataset.getH5file().openDataSet(COVERAGE_PATH);
+
+    hsize_t numRuns = 0;
+    h5dataSet.getSpace().getSimpleExtentDims(&numRuns);
+
+    std::vector<CoverageRun> runs(numRuns);
+    if (numRuns > 0)
+        h5dataSet.read(runs.data(), makeDataType());
+
+    return Coverage{dataset, std::move(runs)};
+}
+
+//! Remove the coverage cached in the BAG, as the elevations have changed.
+/*!
+\param dataset
+    The BAG Dataset.
+*/
+void Coverage::remove(
+    const Dataset& dataset)
+{
+    if (Coverage::exists(dataset))
+        H5Ldelete(dataset.getH5file().getId(), COVERAGE_PATH, H5P_DEFAULT);
+}
+
+//! Cache the coverage in the BAG.
+/*!
+\param dataset
+    The BAG Dataset.
+*/
+void Coverage::write(
+    const Dataset& dataset) const
+{
+    Coverage::remove(dataset);
+
+    const hsize_t numRuns = m_runs.size();
+    constexpr hsize_t kUnlimitedSize = H5F_UNLIMITED;
+    const ::H5::DataSpace h5dataSpace{1, &numRuns, &kUnlimitedSize};
+
+    const ::H5::DSetCreatPropList h5createPropList{};
+    h5createPropList.setChunk(1, &kChunkSize);
+
+    const auto compressionLevel =
+        dataset.getSimpleLayer(Elevation)->getDescriptor()->getCompressionLevel();
+    if (compressionLevel > 0 && compressionLevel <= kMaxCompressionLevel)
+        h5createPropList.setDeflate(compressionLevel);
+    if (dataset.getDescriptor().isChecksummed())
+        h5createPropList.setFletcher32();
+
+    const auto h5dataType = makeDataType();
+    const auto h5dataSet = dataset.getH5file().createDataSet(COVERAGE_PATH,
+        h5dataType, h5dataSpace, h5createPropList);
+
+    if (numRuns > 0)
+        h5dataSet.write(m_runs.data(), h5dataType);
+}
+
+//! Retrieve the number of rows in the grid.
+/*!
+\return
+    The number of rows in the grid.
+*/
+uint32_t Coverage::getRows() const noexcept
+{
+    return m_rows;
+}
+
+//! Retrieve the number of columns in the grid.
+/*!
+\return
+    The number of columns in the grid.
+*/
+uint32_t Coverage::getColumns() const noexcept
+{
+    return m_columns;
+}
+
+//! Retrieve the runs of cells holding data.
+/*!
+\return
+    The runs, ordered by row then column.
+*/
+const std::vector<CoverageRun>& Coverage::getRuns() const & noexcept
+{
+    return m_runs;
+}
+
+//! Determine if no cell holds data.
+/*!
+\return
+    \e true if no cell holds data.
+*/
+bool Coverage::empty() const noexcept
+{
+    return m_runs.empty();
+}
+
+//! Determine if a cell holds data.
+/*!
+\param row
+    The row of the cell.
+\param column
+    The column of the cell.
+
+\return
+    \e true if the cell holds data.
+*/
+bool Coverage::contains(
+    uint32_t row,
+    uint32_t column) const noexcept
+{
+    // The last run starting at or before the cell.
+    auto run = std::upper_bound(m_runs.begin(), m_runs.end(),
+        CoverageRun{row, column, column},
+        [](const CoverageRun& lhs, const CoverageRun& rhs) noexcept {
+            return lhs.row < rhs.row ||
+                (lhs.row == rhs.row && lhs.columnStart < rhs.columnStart);
+        });
+
+    if (run == m_runs.begin())
+        return false;
+
+    --run;
+
+    return run->row == row && column <= run->columnEnd;
+}
+
+//! Retrieve the number of cells holding data.
+/*!
+\return
+    The number of cells holding data.
+*/
+uint64_t Coverage::getNumCells() const noexcept
+{
+    uint64_t numCells = 0;
+
+    for (const auto& run : m_runs)
+        numCells += run.columnEnd - run.columnStart + 1;
+
+    return numCells;
+}
+
+//! Retrieve the area covered by cells holding data.
+/*!
+\return
+    The area, in projected units squared.
+*/
+double Coverage::getArea() const noexcept
+{
+    return static_cast<double>(this->getNumCells()) * m_rowResolution *
+        m_columnResolution;
+}
+
+//! Retrieve the grid bounding box of the cells holding data.
+/*!
+\return
+    The bounding box (rowStart, columnStart, rowEnd, columnEnd), inclusive.
+    All zeros if the coverage is empty.
+*/
+std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>
+Coverage::getGridBounds() const noexcept
+{
+    if (m_runs.empty())
+        return {0, 0, 0, 0};
+
+    uint32_t columnStart = std::numeric_limits<uint32_t>::max();
+    uint32_t columnEnd = 0;
+
+    for (const auto& run : m_runs)
+    {
+        columnStart = std::min(columnStart, run.columnStart);
+        columnEnd = std::max(columnEnd, run.columnEnd);
+    }
+
+    return {m_runs.front().row, columnStart, m_runs.back().row, columnEnd};
+}
+
+//! Retrieve the projected bounding box of the cells holding data.
+/*!
+    The box encloses whole cells, so it extends half a cell beyond the
+    centres of the outermost cells.
+
+\return
+    The bounding box (xMin, yMin, xMax, yMax).
+    All zeros if the coverage is empty.
+*/
+std::tuple<double, double, double, double>
+Coverage::getBounds() const noexcept
+{
+    if (m_runs.empty())
+        return {0., 0., 0., 0.};
+
+    uint32_t rowStart = 0, columnStart = 0, rowEnd = 0, columnEnd = 0;
+    std::tie(rowStart, columnStart, rowEnd, columnEnd) = this->getGridBounds();
+
+    return {m_llCornerX + (columnStart - 0.5) * m_columnResolution,
+        m_llCornerY + (rowStart - 0.5) * m_rowResolution,
+        m_llCornerX + (columnEnd + 0.5) * m_columnResolution,
+        m_llCornerY + (rowEnd + 0.5) * m_rowResolution};
+}
+
+//! Find the holidays; groups of empty cells enclosed by cells holding data.
+/*!
+    Empty cells touching (including diagonally) are one group.  A group
+    reaching the edge of the grid is open water, not a holiday.
+
+\param maxCells
+    Only report holidays with at most this many cells.
+
+\return
+    The holidays, ordered by their first cell.
+*/
+std::vector<CoverageHoliday> Coverage::getHolidays(
+    uint64_t maxCells) const
+{
+    // Runs of empty cells in each row.
+    std::vector<CoverageRun> gaps;
+    std::vector<size_t> rowBegin(m_rows + 1, 0);
+
+    auto run = m_runs.begin();
+    for (uint32_t row = 0; row < m_rows; ++row)
+    {
+        rowBegin[row] = gaps.size();
+
+        uint32_t column = 0;
+        for (; run != m_runs.end() && run->row == row; ++run)
+        {
+            if (run->columnStart > column)
+                gaps.push_back({row, column, run->columnStart - 1});
+
+            column = run->columnEnd + 1;
+        }
+
+        if (column < m_columns)
+            gaps.push_back({row, column, m_columns - 1});
+    }
+    rowBegin[m_rows] = gaps.size();
+
+    // Group gaps that touch gaps in the previous row.
+    DisjointSet groups{gaps.size()};
+
+    for (uint32_t row = 1; row < m_rows; ++row)
+    {
+        size_t below = rowBegin[row - 1];
+        size_t current = rowBegin[row];
+
+        while (below < rowBegin[row] && current < rowBegin[row + 1])
+        {
+            const auto& a = gaps[below];
+            const auto& b = gaps[current];
+
+            if (a.columnEnd + 1 < b.columnStart)
+                ++below;
+            else if (b.columnEnd + 1 < a.columnStart)
+                ++current;
+            else
+            {
+                groups.merge(below, current);
+
+                if (a.columnEnd < b.columnEnd)
+                    ++below;
+                else
+                    ++current;
+            }
+        }
+    }
+
+    // Summarize each group.
+    struct Summary final
+    {
+        CoverageHoliday holiday;
+        bool open = false;
+        bool used = false;
+    };
+
+    std::vector<Summary> summaries(gaps.size());
+
+    for (size_t i = 0; i < gaps.size(); ++i)
+    {
+        const auto& gap = gaps[i];
+        auto& summary = summaries[groups.find(i)];
+        auto& holiday = summary.holiday;
+
+        if (!summary.used)
+        {
+            holiday = {gap.row, gap.columnStart, gap.row, gap.columnEnd, 0};
+            summary.used = true;
+        }
+
+        holiday.rowStart = std::min(holiday.rowStart, gap.row);
+        holiday.rowEnd = std::max(holiday.rowEnd, gap.row);
+        holiday.columnStart = std::min(holiday.columnStart, gap.columnStart);
+        holiday.columnEnd = std::max(holiday.columnEnd, gap.columnEnd);
+        holiday.numCells += gap.columnEnd - gap.columnStart + 1;
+
+        if (gap.row == 0 || gap.row + 1 == m_rows || gap.columnStart == 0 ||
+            gap.columnEnd + 1 == m_columns)
+            summary.open = true;
+    }
+
+    std::vector<CoverageHoliday> holidays;
+
+    for (const auto& summary : summaries)
+        if (summary.used && !summary.open && summary.holiday.numCells <= maxCells)
+            holidays.push_back(summary.holiday);
+
+    return holidays;
+}
+
+//! Trace the outline of the cells holding data.
+/*!
+    Cells sharing an edge belong to the same polygon; cells touching only at
+    a corner do not.  Outer rings are counter-clockwise and holes are
+    clockwise, so the rings can be written directly as polygons.  Each ring is
+    closed; its last point repeats the first.
+
+\return
+    The rings of the footprint.
+*/
+std::vector<Coverage::Ring> Coverage::getFootprint() const
+{
+    std::vector<size_t> rowBegin(m_rows + 2, m_runs.size());
+    for (size_t i = m_runs.size(); i-- > 0; )
+        rowBegin[m_runs[i].row] = i;
+    for (size_t row = m_rows; row-- > 0; )
+        rowBegin[row] = std::min(rowBegin[row], rowBegin[row + 1]);
+
+    const auto rowRuns = [this, &rowBegin](int64_t row) {
+        if (row < 0 || row >= m_rows)
+            return std::make_pair(m_runs.cend(), m_runs.cend());
+
+        return std::make_pair(m_runs.cbegin() + rowBegin[row],
+            m_runs.cbegin() + rowBegin[row + 1]);
+    };
+
+    // Vertex (x, y) is the lower left corner of cell (row y, column x).
+    std::vector<Edge> edges;
+
+    for (const auto& run : m_runs)
+    {
+        const Span span{run.columnStart, run.columnEnd + 1};
+
+        const auto below = rowRuns(static_cast<int64_t>(run.row) - 1);
+        for (const auto& part : subtract(span, below.first, below.second))
+            edges.push_back({part.start, run.row, part.end, run.row});
+
+        const auto above = rowRuns(static_cast<int64_t>(run.row) + 1);
+        for (const auto& part : subtract(span, above.first, above.second))
+            edges.push_back({part.end, run.row + 1, part.start, run.row + 1});
+
+        edges.push_back({span.start, run.row + 1, span.start, run.row});
+        edges.push_back({span.end, run.row, span.end, run.row + 1});
+    }
+
+    // At most two edges leave a vertex.
+    std::unordered_map<uint64_t, std::array<uint32_t, 2>> outgoing;
+    outgoing.reserve(edges.size());
+
+    constexpr auto kNone = std::numeric_limits<uint32_t>::max();
+    for (uint32_t i = 0; i < edges.size(); ++i)
+    {
+        auto inserted = outgoing.emplace(vertexKey(edges[i].x0, edges[i].y0),
+            std::array<uint32_t, 2>{i, kNone});
+        if (!inserted.second)
+            inserted.first->second[1] = i;
+    }
+
+    std::vector<bool> used(edges.size(), false);
+    std::vector<Ring> rings;
+
+    for (uint32_t first = 0; first < edges.size(); ++first)
+    {
+        if (used[first])
+            continue;
+
+        // Follow the edges, turning left where two leave a vertex.
+        std::vector<uint32_t> path;
+        uint32_t current = first;
+
+        do
+        {
+            used[current] = true;
+            path.push_back(current);
+
+            const auto& edge = edges[current];
+            const auto& next = outgoing.at(vertexKey(edge.x1, edge.y1));
+
+            current = next[0];
+            if (next[1] != kNone)
+            {
+                const int dx = sign(edge.x0, edge.x1);
+                const int dy = sign(edge.y0, edge.y1);
+                const auto& candidate = edges[next[0]];
+                const int cx = sign(candidate.x0, candidate.x1);
+                const int cy = sign(candidate.y0, candidate.y1);
+
+                if (dx * cy - dy * cx <= 0)
+                    current = next[1];
+            }
+        } while (current != first);
+
+        // Keep only the corners.
+        Ring ring;
+
+        for (size_t i = 0; i < path.size(); ++i)
+        {
+            const auto& edge = edges[path[i]];
+            const auto& previous = edges[path[(i + path.size() - 1) % path.size()]];
+
+            if (sign(edge.x0, edge.x1) == sign(previous.x0, previous.x1) &&
+                sign(edge.y0, edge.y1) == sign(previous.y0, previous.y1))
+                continue;
+
+            ring.emplace_back(m_llCornerX + (edge.x0 - 0.5) * m_columnResolution,
+                m_llCornerY + (edge.y0 - 0.5) * m_rowResolution);
+        }
+
+        ring.push_back(ring.front());
+        rings.push_back(std::move(ring));
+    }
+
+    return rings;
+}
+
+}  // namespace BAG
+
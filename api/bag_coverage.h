@@ -0,0 +1,119 @@
+#ifndef BAG_COVERAGE_H
+#define BAG_COVERAGE_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+
+namespace BAG {
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)  // std classes do not have DLL-interface when exporting
+#endif
+
+//! A run of consecutive cells holding data in one row of the grid.
+struct CoverageRun final
+{
+    //! The row.
+    uint32_t row = 0;
+    //! The first column of the run.
+    uint32_t columnStart = 0;
+    //! The last column of the run.
+    uint32_t columnEnd = 0;
+};
+
+//! A hole in the coverage; empty cells entirely surrounded by data.
+struct CoverageHoliday final
+{
+    //! The first row of the hole's bounding box.
+    uint32_t rowStart = 0;
+    //! The first column of the hole's bounding box.
+    uint32_t columnStart = 0;
+    //! The last row of the hole's bounding box.
+    uint32_t rowEnd = 0;
+    //! The last column of the hole's bounding box.
+    uint32_t columnEnd = 0;
+    //! The number of empty cells in the hole.
+    uint64_t numCells = 0;
+};
+
+//! The cells of a BAG that hold data, as a run length encoded mask.
+/*!
+    A cell holds data when its elevation is not BAG_NULL_ELEVATION.  The mask
+    is computed from the elevation layer chunk by chunk across threads, and is
+    cached in the BAG by Dataset::getCoverage() so later calls only read the
+    runs.
+
+    Projected coordinates follow the metadata: columns run along X with the
+    column resolution, rows run along Y with the row resolution, and grid
+    positions are cell centres starting at the lower left corner.
+*/
+class BAG_API Coverage final
+{
+public:
+    //! A closed ring of (x, y) projected coordinates.
+    using Ring = std::vector<std::tuple<double, double>>;
+
+    static Coverage compute(const Dataset& dataset, unsigned int numThreads = 0);
+
+    uint32_t getRows() const noexcept;
+    uint32_t getColumns() const noexcept;
+
+    const std::vector<CoverageRun>& getRuns() const & noexcept;
+
+    bool empty() const noexcept;
+    bool contains(uint32_t row, uint32_t column) const noexcept;
+
+    uint64_t getNumCells() const noexcept;
+    double getArea() const noexcept;
+
+    std::tuple<uint32_t, uint32_t, uint32_t, uint32_t> getGridBounds() const noexcept;
+    std::tuple<double, double, double, double> getBounds() const noexcept;
+
+    std::vector<CoverageHoliday> getHolidays(
+        uint64_t maxCells = std::numeric_limits<uint64_t>::max()) const;
+    std::vector<Ring> getFootprint() const;
+
+private:
+    Coverage(const Dataset& dataset, std::vector<CoverageRun>&& runs);
+
+    static bool exists(const Dataset& dataset);
+    static Coverage read(const Dataset& dataset);
+    static void remove(const Dataset& dataset);
+    void write(const Dataset& dataset) const;
+
+    //! The number of rows in the grid.
+    uint32_t m_rows = 0;
+    //! The number of columns in the grid.
+    uint32_t m_columns = 0;
+    //! The X of the lower left cell centre.
+    double m_llCornerX = 0.;
+    //! The Y of the lower left cell centre.
+    double m_llCornerY = 0.;
+    //! The distance between rows.
+    double m_rowResolution = 0.;
+    //! The distance between columns.
+    double m_columnResolution = 0.;
+    //! The runs, ordered by row then column.
+    std::vector<CoverageRun> m_runs;
+
+    friend Dataset;
+    friend Reverter;
+    friend SimpleLayer;
+    friend SurfaceDiff;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+}  // namespace BAG
+
+#endif  // BAG_COVERAGE_H
+
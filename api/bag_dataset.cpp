@@ -4,6 +4,7 @@
 #include "bag_georefmetadatalayerdescriptor.h"
 #include "bag_dataset.h"
 #include "bag_exceptions.h"
+#include "bag_extract.h"
 #include "bag_interleavedlegacylayer.h"
 #include "bag_interleavedlegacylayerdescriptor.h"
 #include "bag_metadataprofiles.h"
@@ -13,7 +14,9 @@
 #include "bag_simplelayerdescriptor.h"
 #include "bag_surfacecorrections.h"
 #include "bag_surfacecorrectionsdescriptor.h"
+#include "bag_trackinglistreader.h"
 #include "bag_version.h"
+#include "bag_vrindex.h"
 #include "bag_vrmetadata.h"
 #include "bag_vrmetadatadescriptor.h"
 #include "bag_vrnode.h"
@@ -256,13 +259,17 @@ std::string readStringAttributeFromGroup(
     The name of the BAG.
 \param openMode
     The mode to open the BAG with.
+\param streamTrackingLists
+    Leave the tracking lists on disk; they are read through a
+    TrackingListReader or VRTrackingListReader, and cannot be written.
 
 \return
     The BAG Dataset.
 */
 std::shared_ptr<Dataset> Dataset::open(
     const std::string& fileName,
-    OpenMode openMode)
+    OpenMode openMode,
+    bool streamTrackingLists)
 {
 #ifdef NDEBUG
     ::H5::Exception::dontPrint();
@@ -271,7 +278,7 @@ std::shared_ptr<Dataset> Dataset::open(
     std::shared_ptr<Dataset> pDataset{new Dataset};
     try
     {
-        pDataset->readDataset(fileName, openMode);
+        pDataset->readDataset(fileName, openMode, streamTrackingLists);
     } catch (H5::FileIException &fileExcept)
     {
         std::cerr << "\nUnable to open BAG file: " << fileName << " due to error: " << fileExcept.getCDetailMsg();
@@ -292,6 +299,9 @@ std::shared_ptr<Dataset> Dataset::open(
     The chunk size the HDF5 DataSet will use.
 \param compressionLevel
     The compression level the HDF5 DataSet will use.
+\param checksum
+    Add a Fletcher32 checksum to each chunk of every HDF5 DataSet, so
+    verify() can find corrupt chunks.
 
 \return
     The BAG Dataset.
@@ -300,24 +310,66 @@ std::shared_ptr<Dataset> Dataset::create(
     const std::string& fileName,
     Metadata&& metadata,
     uint64_t chunkSize,
-    int compressionLevel)
+    int compressionLevel,
+    bool checksum)
 {
     std::shared_ptr<Dataset> pDataset{new Dataset};
     pDataset->createDataset(fileName, std::move(metadata), chunkSize,
-        compressionLevel);
+        compressionLevel, checksum);
 
     return pDataset;
 }
 
+//! Destructor.
+/*!
+    Trims the room grown ahead of writes, as close() does.
+*/
+Dataset::~Dataset()
+{
+    try
+    {
+        this->trimExtents();
+    }
+    catch (...)
+    {
+        // The file keeps the room; readers only see what was written.
+    }
+}
+
 //! Close a BAG dataset. Closes the underlying HDF5 file.
 void Dataset::close() {
     if (m_pH5file) {
+        this->trimExtents();
         m_pH5file->close();
         m_pH5file.reset(nullptr);
     }
 }
 
 
+//! Trim the extendible DataSets to what was written.
+/*!
+    The variable resolution refinements and nodes, and the tracking lists,
+    grow their HDF5 DataSets ahead of the writes.  Give the room back before
+    the file is closed.
+*/
+void Dataset::trimExtents() const
+{
+    if (!m_pH5file || m_openMode == BAG_OPEN_READONLY)
+        return;
+
+    if (const auto pRefinements = this->getVRRefinements())
+        pRefinements->trim();
+
+    if (const auto pNode = this->getVRNode())
+        pNode->trim();
+
+    if (m_pTrackingList)
+        m_pTrackingList->trim();
+
+    if (m_pVRTrackingList)
+        m_pVRTrackingList->trim();
+}
+
 //! Add a layer to this dataset.
 /*!
 \param newLayer
@@ -461,12 +513,15 @@ GeorefMetadataLayer& Dataset::createGeorefMetadataLayer(
     The chunk size the HDF5 DataSet will use.
 \param compressionLevel
     The compression level the HDF5 DataSet will use.
+\param checksum
+    Add a Fletcher32 checksum to each chunk of every HDF5 DataSet.
 */
 void Dataset::createDataset(
     const std::string& fileName,
     Metadata&& metadata,
     uint64_t chunkSize,
-    int compressionLevel)
+    int compressionLevel,
+    bool checksum)
 {
 #ifdef NDEBUG
     ::H5::Exception::dontPrint();
@@ -474,6 +529,8 @@ void Dataset::createDataset(
 
     m_pH5file = std::unique_ptr<::H5::H5File, DeleteH5File>(new ::H5::H5File{
         fileName.c_str(), H5F_ACC_EXCL}, DeleteH5File{});
+    m_fileName = fileName;
+    m_openMode = BAG_OPEN_READ_WRITE;
 
     // Group: BAG_root
     {
@@ -488,6 +545,8 @@ void Dataset::createDataset(
     }
 
     // Metadata
+    m_descriptor.setChecksummed(checksum);
+
     metadata.createH5dataSet(*this);
     metadata.write();
     m_pMetadata = std::make_unique<Metadata>(std::move(metadata));
@@ -495,6 +554,7 @@ void Dataset::createDataset(
     m_descriptor = Descriptor{*m_pMetadata};
     m_descriptor.setReadOnly(false);
     m_descriptor.setVersion(BAG_VERSION);
+    m_descriptor.setChecksummed(checksum);
 
     // TrackingList
     m_pTrackingList = std::unique_ptr<TrackingList>(new TrackingList{*this,
@@ -685,6 +745,103 @@ std::vector<std::shared_ptr<GeorefMetadataLayer>> Dataset::getGeorefMetadataLaye
     return layers;
 }
 
+//! Retrieve the coverage of the elevation layer.
+/*!
+    The coverage is cached in the BAG the first time it is computed (unless
+    the BAG is read only), and the cache is dropped whenever the elevation
+    layer is written.
+
+\param numThreads
+    The number of threads to compute the coverage with.
+    Zero selects the hardware concurrency.
+
+\return
+    The coverage of the elevation layer.
+*/
+Coverage Dataset::getCoverage(
+    unsigned int numThreads) const
+{
+    if (Coverage::exists(*this))
+        return Coverage::read(*this);
+
+    auto coverage = Coverage::compute(*this, numThreads);
+
+    if (!m_descriptor.isReadOnly())
+        coverage.write(*this);
+
+    return coverage;
+}
+
+//! Check that every chunk of the BAG can be read back intact.
+/*!
+    See Verifier::verify().
+
+\param numThreads
+    The number of threads to check chunks with.
+    Zero selects the hardware concurrency.
+
+\return
+    The chunks that are not intact; empty if the BAG is sound.
+*/
+std::vector<ChunkFault> Dataset::verify(
+    unsigned int numThreads) const
+{
+    return Verifier::verify(*this, numThreads);
+}
+
+//! Copy the part of the BAG inside a bounding box into a new BAG.
+/*!
+    See Extractor::extract().
+
+\param xMin
+    The west edge of the box.
+\param yMin
+    The south edge of the box.
+\param xMax
+    The east edge of the box.
+\param yMax
+    The north edge of the box.
+\param outFileName
+    The name of the new BAG; it must not exist.
+\param numThreads
+    The number of threads to copy chunks with.
+    Zero selects the hardware concurrency.
+
+\return
+    The new BAG, open for reading and writing.
+*/
+std::shared_ptr<Dataset> Dataset::extract(
+    double xMin,
+    double yMin,
+    double xMax,
+    double yMax,
+    const std::string& outFileName,
+    unsigned int numThreads) const
+{
+    return Extractor::extract(*this, xMin, yMin, xMax, yMax, outFileName,
+        numThreads);
+}
+
+//! Revert the edits recorded in the tracking lists.
+/*!
+    See Reverter::revert().
+
+\param filter
+    The tracking list items to revert.
+\param numThreads
+    The number of threads to restore chunks with.
+    Zero selects the hardware concurrency.
+
+\return
+    The number of tracking list items reverted.
+*/
+size_t Dataset::revertEdits(
+    const RevertFilter& filter,
+    unsigned int numThreads)
+{
+    return Reverter::revert(*this, filter, numThreads);
+}
+
 //! Retrieve the dataset's descriptor.
 /*!
 \return
@@ -705,6 +862,29 @@ const Descriptor& Dataset::getDescriptor() const & noexcept
     return m_descriptor;
 }
 
+//! Retrieve the name of the file this BAG was opened or created from.
+/*!
+    Together with getOpenMode(), this is enough to open the BAG again, for
+    example in another process.
+
+\return
+    The file name, as given to open() or create().
+*/
+const std::string& Dataset::getFileName() const & noexcept
+{
+    return m_fileName;
+}
+
+//! Retrieve the mode this BAG was opened with.
+/*!
+\return
+    The open mode; BAG_OPEN_READ_WRITE if the BAG was created.
+*/
+OpenMode Dataset::getOpenMode() const noexcept
+{
+    return m_openMode;
+}
+
 //! Retrieve the HDF5 file that contains this BAG.
 /*!
 \return
@@ -1033,6 +1213,57 @@ std::shared_ptr<const VRTrackingList> Dataset::getVRTrackingList() const & noexc
     return std::static_pointer_cast<const VRTrackingList>(m_pVRTrackingList);
 }
 
+//! Retrieve the index of the variable resolution supercells.
+/*!
+    The index is built the first time it is asked for, and rebuilt after the
+    variable resolution metadata is written.
+
+\return
+    The index; nullptr if the BAG has no variable resolution metadata.
+*/
+std::shared_ptr<const VRIndex> Dataset::getVRIndex() const
+{
+    if (!this->getVRMetadata())
+        return {};
+
+    std::lock_guard<std::mutex> lock{m_vrIndexMutex};
+
+    if (!m_pVRIndex)
+        m_pVRIndex.reset(new VRIndex{*this});
+
+    return m_pVRIndex;
+}
+
+//! Retrieve a streaming reader of the tracking list.
+/*!
+    The reader reads the items last written to the BAG, whether or not the
+    tracking list was loaded into memory.
+
+\return
+    The reader.
+*/
+std::shared_ptr<const TrackingListReader> Dataset::getTrackingListReader() const
+{
+    return std::make_shared<const TrackingListReader>(*this);
+}
+
+//! Retrieve a streaming reader of the variable resolution tracking list.
+/*!
+    The reader reads the items last written to the BAG, whether or not the
+    variable resolution tracking list was loaded into memory.
+
+\return
+    The reader; nullptr if the BAG has no variable resolution tracking list.
+*/
+std::shared_ptr<const VRTrackingListReader>
+Dataset::getVRTrackingListReader() const
+{
+    if (!m_pVRTrackingList)
+        return {};
+
+    return std::make_shared<const VRTrackingListReader>(*this);
+}
+
 //! Convert a grid position to a geographic location.
 /*!
 \param row
@@ -1090,10 +1321,13 @@ void handleAbrt(int signum) {
     The name of the BAG.
 \param openMode
     The mode to open the BAG with.
+\param streamTrackingLists
+    Leave the items of the tracking lists on disk.
 */
 void Dataset::readDataset(
     const std::string& fileName,
-    OpenMode openMode)
+    OpenMode openMode,
+    bool streamTrackingLists)
 {
     signal(SIGABRT, handleAbrt);
     try {
@@ -1108,6 +1342,9 @@ void Dataset::readDataset(
         e.printErrorStack();
     }
 
+    m_fileName = fileName;
+    m_openMode = openMode;
+
     m_pMetadata = std::make_unique<Metadata>(*this);
 
     m_descriptor = Descriptor{*m_pMetadata};
@@ -1117,6 +1354,32 @@ void Dataset::readDataset(
 
     const auto bagGroup = m_pH5file->openGroup(ROOT_PATH);
 
+    // Chunks carry checksums if the elevation layer's do.
+    {
+        const hid_t id = DopenProtector2(bagGroup.getLocId(),
+            Layer::getInternalPath(Elevation).c_str(), H5P_DEFAULT);
+        if (id >= 0)
+        {
+            const hid_t createPlist = H5Dget_create_plist(id);
+            const int numFilters = H5Pget_nfilters(createPlist);
+
+            for (int i = 0; i < numFilters; ++i)
+            {
+                unsigned int flags = 0;
+                size_t numValues = 0;
+                unsigned int filterConfig = 0;
+
+                if (H5Pget_filter2(createPlist, static_cast<unsigned int>(i),
+                    &flags, &numValues, nullptr, 0, nullptr,
+                    &filterConfig) == H5Z_FILTER_FLETCHER32)
+                    m_descriptor.setChecksummed(true);
+            }
+
+            H5Pclose(createPlist);
+            H5Dclose(id);
+        }
+    }
+
     // Look for the simple layers.
     for (auto layerType : {Elevation, Uncertainty, Hypothesis_Strength,
         Num_Hypotheses, Shoal_Elevation, Std_Dev, Num_Soundings,
@@ -1189,7 +1452,8 @@ void Dataset::readDataset(
     {
         H5Dclose(id);
 
-        m_pVRTrackingList = std::make_shared<VRTrackingList>(*this);
+        m_pVRTrackingList = std::make_shared<VRTrackingList>(*this,
+            !streamTrackingLists);
 
         {
             auto descriptor = VRMetadataDescriptor::open(*this);
@@ -1218,7 +1482,8 @@ void Dataset::readDataset(
         }
     }
 
-    m_pTrackingList = std::unique_ptr<TrackingList>(new TrackingList{*this});
+    m_pTrackingList = std::unique_ptr<TrackingList>(new TrackingList{*this,
+        !streamTrackingLists});
 
     // Read optional Surface Corrections
     id = DopenProtector2(bagGroup.getLocId(), VERT_DATUM_CORR_PATH, H5P_DEFAULT);
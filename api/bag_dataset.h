@@ -4,17 +4,21 @@
 #include "bag_compounddatatype.h"
 #include "bag_georefmetadatalayerdescriptor.h"
 #include "bag_config.h"
+#include "bag_coverage.h"
 #include "bag_descriptor.h"
 #include "bag_exceptions.h"
 #include "bag_fordec.h"
 #include "bag_layer.h"
 #include "bag_metadata.h"
+#include "bag_revert.h"
 #include "bag_trackinglist.h"
 #include "bag_types.h"
+#include "bag_verify.h"
 #include "bag_vrtrackinglist.h"
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <unordered_map>
@@ -50,11 +54,11 @@ class BAG_API Dataset final
 {
 public:
     static std::shared_ptr<Dataset> open(const std::string &fileName,
-        OpenMode openMode);
+        OpenMode openMode, bool streamTrackingLists = false);
 
     static std::shared_ptr<Dataset> create(const std::string &fileName,
         Metadata&& metadata, uint64_t chunkSize = 100,
-        int compressionLevel = 5);
+        int compressionLevel = 5, bool checksum = false);
 
     void close();
 
@@ -64,6 +68,8 @@ public:
     Dataset& operator=(const Dataset&) = delete;
     Dataset& operator=(Dataset&&) = delete;
 
+    ~Dataset();
+
     bool operator==(const Dataset &rhs) const noexcept {
         return m_pH5file == rhs.m_pH5file &&
                m_layers == rhs.m_layers &&
@@ -126,19 +132,37 @@ public:
     std::shared_ptr<VRTrackingList> getVRTrackingList() & noexcept;
     std::shared_ptr<const VRTrackingList> getVRTrackingList() const & noexcept;
 
+    std::shared_ptr<const VRIndex> getVRIndex() const;
+
+    std::shared_ptr<const TrackingListReader> getTrackingListReader() const;
+    std::shared_ptr<const VRTrackingListReader> getVRTrackingListReader() const;
+
     Descriptor& getDescriptor() & noexcept;
     const Descriptor& getDescriptor() const & noexcept;
 
+    const std::string& getFileName() const & noexcept;
+    OpenMode getOpenMode() const noexcept;
+
+    Coverage getCoverage(unsigned int numThreads = 0) const;
+    std::vector<ChunkFault> verify(unsigned int numThreads = 0) const;
+    std::shared_ptr<Dataset> extract(double xMin, double yMin, double xMax,
+        double yMax, const std::string& outFileName,
+        unsigned int numThreads = 0) const;
+    size_t revertEdits(const RevertFilter& filter,
+        unsigned int numThreads = 0);
+
     std::tuple<double, double> gridToGeo(uint32_t row, uint32_t column) const noexcept;
     std::tuple<uint32_t, uint32_t> geoToGrid(double x, double y) const noexcept;
 
 private:
     Dataset() = default;
     uint32_t getNextId() const noexcept;
+    void trimExtents() const;
 
-    void readDataset(const std::string& fileName, OpenMode openMode);
+    void readDataset(const std::string& fileName, OpenMode openMode,
+        bool streamTrackingLists);
     void createDataset(const std::string& fileName, Metadata&& metadata,
-        uint64_t chunkSize, int compressionLevel);
+        uint64_t chunkSize, int compressionLevel, bool checksum);
 
     std::tuple<bool, float, float> getMinMax(LayerType type,
         const std::string& path = {}) const;
@@ -154,6 +178,10 @@ private:
 
     //! The HDF5 file that the BAG is stored in.
     std::unique_ptr<::H5::H5File, DeleteH5File> m_pH5file;
+    //! The name of the file the BAG was opened or created from.
+    std::string m_fileName;
+    //! The mode the BAG was opened with; created BAGs are read/write.
+    OpenMode m_openMode = BAG_OPEN_READONLY;
     //! The mandatory and optional layers found in the BAG, including ones
     //! created after opening.
     std::vector<std::shared_ptr<Layer>> m_layers;
@@ -165,19 +193,35 @@ private:
     Descriptor m_descriptor;
     //! The optional VR tracking list.
     std::shared_ptr<VRTrackingList> m_pVRTrackingList;
+    //! The index of the VR supercells; built on first use.
+    mutable std::shared_ptr<const VRIndex> m_pVRIndex;
+    //! Guards m_pVRIndex.
+    mutable std::mutex m_vrIndexMutex;
 
+    friend Coverage;
+    friend Extractor;
     friend GeorefMetadataLayer;
     friend GeorefMetadataLayerDescriptor;
     friend InterleavedLegacyLayer;
     friend InterleavedLegacyLayerDescriptor;
     friend LayerDescriptor;
+    friend Merger;
     friend Metadata;
+    friend Repacker;
+    friend Resampler;
+    friend Reverter;
     friend SimpleLayer;
     friend TrackingList;
+    friend TrackingListReader;
     friend SimpleLayerDescriptor;
     friend SurfaceCorrections;
     friend SurfaceCorrectionsDescriptor;
+    friend SurfaceDiff;
+    friend Tiler;
+    friend Upgrader;
     friend ValueTable;
+    friend Verifier;
+    friend VRBuilder;
     friend VRMetadata;
     friend VRMetadataDescriptor;
     friend VRNode;
@@ -185,6 +229,7 @@ private:
     friend VRRefinements;
     friend VRRefinementsDescriptor;
     friend VRTrackingList;
+    friend VRTrackingListReader;
 };
 
 #ifdef _MSC_VER
@@ -296,6 +296,17 @@ bool Descriptor::isReadOnly() const noexcept
     return m_isReadOnly;
 }
 
+//! Retrieve the checksum flag value.
+/*!
+\return
+    \e true if each chunk of the BAG carries a Fletcher32 checksum.
+    \e false otherwise.
+*/
+bool Descriptor::isChecksummed() const noexcept
+{
+    return m_isChecksummed;
+}
+
 //! Set the BAG grid size.
 /*!
 \param rows
@@ -405,6 +416,24 @@ Descriptor& Descriptor::setReadOnly(bool inReadOnly) & noexcept
     return *this;
 }
 
+//! Set the BAG's checksum flag.
+/*!
+    Only DataSets created after the flag is set carry checksums.
+
+\param inChecksummed
+    The new checksum flag.
+    \e true adds a Fletcher32 checksum to each chunk.
+    \e false does not.
+
+\return
+    The modified descriptor.
+*/
+Descriptor& Descriptor::setChecksummed(bool inChecksummed) & noexcept
+{
+    m_isChecksummed = inChecksummed;
+    return *this;
+}
+
 //! Set the BAG's version as a string.
 /*!
 \param inVersion
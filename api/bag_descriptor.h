@@ -34,6 +34,7 @@ public:
     bool operator==(const Descriptor &rhs) const noexcept {
         return m_version == rhs.m_version &&
                m_isReadOnly == rhs.m_isReadOnly &&
+               m_isChecksummed == rhs.m_isChecksummed &&
                layerDescriptorsEqual(rhs.m_layerDescriptors) &&
                m_horizontalReferenceSystem == rhs.m_horizontalReferenceSystem &&
                m_verticalReferenceSystem == rhs.m_verticalReferenceSystem &&
@@ -49,6 +50,7 @@ public:
 
     std::vector<LayerType> getLayerTypes() const;
     bool isReadOnly() const noexcept;
+    bool isChecksummed() const noexcept;
     std::vector<uint32_t> getLayerIds() const noexcept;
     const std::vector<std::weak_ptr<const LayerDescriptor>>&
         getLayerDescriptors() const & noexcept;
@@ -74,6 +76,7 @@ public:
     Descriptor& setHorizontalReferenceSystem(
         const std::string& horizontalReferenceSystem) & noexcept;
     Descriptor& setReadOnly(bool readOnly) & noexcept;
+    Descriptor& setChecksummed(bool checksummed) & noexcept;
     Descriptor& setVersion(std::string inVersion) & noexcept;
 
 private:
@@ -83,6 +86,8 @@ private:
     std::string m_version;
     //! True if the BAG is read only.
     bool m_isReadOnly = true;
+    //! True if each chunk of the BAG carries a Fletcher32 checksum.
+    bool m_isChecksummed = false;
     //! The layer descriptors (owned by each Layer).
     std::vector<std::weak_ptr<const LayerDescriptor>> m_layerDescriptors;
     //! The name of the horizontal reference system.
@@ -0,0 +1,702 @@
+
+#include "bag_chunkio.h"
+#include "bag_dataset.h"
+#include "bag_diff.h"
+#include "bag_exceptions.h"
+#include "bag_layerdescriptor.h"
+#include "bag_metadata.h"
+#include "bag_metadata_export.h"
+#include "bag_parallel.h"
+#include "bag_private.h"
+#include "bag_simplelayer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <H5Cpp.h>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+
+namespace BAG {
+
+namespace {
+
+//! The HDF5 DataSet chunk size of the patch values.
+constexpr hsize_t kPatchChunkSize = 16384;
+
+//! The names of the patch grid attributes.
+constexpr const char* kRowsName = "rows";
+constexpr const char* kColumnsName = "columns";
+constexpr const char* kLlCornerXName = "ll_corner_x";
+constexpr const char* kLlCornerYName = "ll_corner_y";
+constexpr const char* kRowResolutionName = "row_resolution";
+constexpr const char* kColumnResolutionName = "column_resolution";
+
+//! The paths of the patch DataSets.
+constexpr const char* kIndexPath = "/index";
+constexpr const char* kElevationPath = "/elevation";
+constexpr const char* kUncertaintyPath = "/uncertainty";
+
+//! How far, in cells, the patch grid may be from the target grid.
+constexpr double kGridTolerance = 1e-6;
+
+//! One changed chunk stored in a patch file.
+struct PatchEntry final
+{
+    //! The change.
+    ChunkChange change;
+    //! The offset of the chunk values in the patch value DataSets.
+    uint64_t offset = 0;
+};
+
+//! Make the HDF5 type of a patch entry.
+/*!
+\return
+    The HDF5 compound type of a PatchEntry.
+*/
+::H5::CompType makeEntryType()
+{
+    const ::H5::CompType h5dataType{sizeof(PatchEntry)};
+
+    h5dataType.insertMember("row_start",
+        HOFFSET(PatchEntry, change.rowStart), ::H5::PredType::NATIVE_UINT32);
+    h5dataType.insertMember("column_start",
+        HOFFSET(PatchEntry, change.columnStart), ::H5::PredType::NATIVE_UINT32);
+    h5dataType.insertMember("row_end",
+        HOFFSET(PatchEntry, change.rowEnd), ::H5::PredType::NATIVE_UINT32);
+    h5dataType.insertMember("column_end",
+        HOFFSET(PatchEntry, change.columnEnd), ::H5::PredType::NATIVE_UINT32);
+    h5dataType.insertMember("num_compared",
+        HOFFSET(PatchEntry, change.numCompared), ::H5::PredType::NATIVE_UINT64);
+    h5dataType.insertMember("num_changed",
+        HOFFSET(PatchEntry, change.numChanged), ::H5::PredType::NATIVE_UINT64);
+    h5dataType.insertMember("min_difference",
+        HOFFSET(PatchEntry, change.minDifference), ::H5::PredType::NATIVE_FLOAT);
+    h5dataType.insertMember("max_difference",
+        HOFFSET(PatchEntry, change.maxDifference), ::H5::PredType::NATIVE_FLOAT);
+    h5dataType.insertMember("mean_difference",
+        HOFFSET(PatchEntry, change.meanDifference), ::H5::PredType::NATIVE_DOUBLE);
+    h5dataType.insertMember("rms_difference",
+        HOFFSET(PatchEntry, change.rmsDifference), ::H5::PredType::NATIVE_DOUBLE);
+    h5dataType.insertMember("offset",
+        HOFFSET(PatchEntry, offset), ::H5::PredType::NATIVE_UINT64);
+
+    return h5dataType;
+}
+
+//! Make a copy of the metadata of a BAG.
+Metadata copyMetadata(const Dataset& dataset)
+{
+    Metadata metadata;
+    metadata.loadFromBuffer(exportMetadataToXML(
+        dataset.getMetadata().getStruct()));
+
+    return metadata;
+}
+
+//! Determine if two grid positions are the same, to a fraction of a cell.
+bool sameGridValue(double lhs, double rhs, double resolution) noexcept
+{
+    return std::abs(lhs - rhs) <= kGridTolerance * std::abs(resolution);
+}
+
+//! Widen the min/max of a layer to include a range, and write it.
+void widenMinMax(
+    Dataset& dataset,
+    LayerType type,
+    const ValueRange& range)
+{
+    if (range.empty())
+        return;
+
+    auto pLayer = dataset.getSimpleLayer(type);
+    auto pDescriptor = pLayer->getDescriptor();
+
+    float min = 0.f, max = 0.f;
+    std::tie(min, max) = pDescriptor->getMinMax();
+
+    pDescriptor->setMinMax(std::min(min, range.min), std::max(max, range.max));
+    pLayer->writeAttributes();
+}
+
+//! A patch file being written.
+/*!
+    The values of each changed chunk are appended to two one dimensional
+    DataSets; the index of the chunks is written on close.
+*/
+class PatchWriter final
+{
+public:
+    PatchWriter(const std::string& fileName, const Metadata& metadata,
+        int compressionLevel);
+
+    void append(const ChunkChange& change, const float* elevations,
+        const float* uncertainties);
+    void close();
+
+private:
+    //! The patch file.
+    ::H5::H5File m_h5file;
+    //! The elevations of the changed chunks.
+    ::H5::DataSet m_elevations;
+    //! The uncertainties of the changed chunks.
+    ::H5::DataSet m_uncertainties;
+    //! The number of values written.
+    hsize_t m_numValues = 0;
+    //! The changed chunks.
+    std::vector<PatchEntry> m_entries;
+    //! The compression level of the DataSets.
+    int m_compressionLevel = 0;
+};
+
+//! Constructor.
+/*!
+\param fileName
+    The name of the patch file; an existing file is replaced.
+\param metadata
+    The metadata of the grid the patch applies to.
+\param compressionLevel
+    The compression level of the patch values.
+*/
+PatchWriter::PatchWriter(
+    const std::string& fileName,
+    const Metadata& metadata,
+    int compressionLevel)
+    : m_h5file(fileName, H5F_ACC_TRUNC)
+    , m_compressionLevel(compressionLevel)
+{
+    const ::H5::DataSpace h5scalarSpace{};
+
+    const uint32_t rows = metadata.rows();
+    m_h5file.createAttribute(kRowsName, ::H5::PredType::NATIVE_UINT32,
+        h5scalarSpace).write(::H5::PredType::NATIVE_UINT32, &rows);
+    const uint32_t columns = metadata.columns();
+    m_h5file.createAttribute(kColumnsName, ::H5::PredType::NATIVE_UINT32,
+        h5scalarSpace).write(::H5::PredType::NATIVE_UINT32, &columns);
+
+    for (const auto& attribute : {
+            std::make_pair(kLlCornerXName, metadata.llCornerX()),
+            std::make_pair(kLlCornerYName, metadata.llCornerY()),
+            std::make_pair(kRowResolutionName, metadata.rowResolution()),
+            std::make_pair(kColumnResolutionName, metadata.columnResolution())})
+        m_h5file.createAttribute(attribute.first,
+            ::H5::PredType::NATIVE_DOUBLE, h5scalarSpace).write(
+                ::H5::PredType::NATIVE_DOUBLE, &attribute.second);
+
+    const hsize_t initialSize = 0;
+    constexpr hsize_t kUnlimitedSize = H5F_UNLIMITED;
+    const ::H5::DataSpace h5dataSpace{1, &initialSize, &kUnlimitedSize};
+
+    const ::H5::DSetCreatPropList h5createPropList{};
+    h5createPropList.setChunk(1, &kPatchChunkSize);
+    if (compressionLevel > 0 && compressionLevel <= kMaxCompressionLevel)
+        h5createPropList.setDeflate(compressionLevel);
+
+    m_elevations = m_h5file.createDataSet(kElevationPath,
+        ::H5::PredType::NATIVE_FLOAT, h5dataSpace, h5createPropList);
+    m_uncertainties = m_h5file.createDataSet(kUncertaintyPath,
+        ::H5::PredType::NATIVE_FLOAT, h5dataSpace, h5createPropList);
+}
+
+//! Append the values of a changed chunk.  The HDF5 mutex must be held.
+/*!
+\param change
+    The change in the chunk.
+\param elevations
+    The updated elevations of the chunk, row major.
+\param uncertainties
+    The updated uncertainties of the chunk, row major.
+*/
+void PatchWriter::append(
+    const ChunkChange& change,
+    const float* elevations,
+    const float* uncertainties)
+{
+    const hsize_t count = static_cast<hsize_t>(change.rowEnd - change.rowStart + 1) *
+        (change.columnEnd - change.columnStart + 1);
+    const hsize_t newSize = m_numValues + count;
+    const ::H5::DataSpace h5memSpace{1, &count};
+
+    for (const auto& dataSetValues : {std::make_pair(&m_elevations, elevations),
+            std::make_pair(&m_uncertainties, uncertainties)})
+    {
+        auto& h5dataSet = *dataSetValues.first;
+        h5dataSet.extend(&newSize);
+
+        auto h5fileSpace = h5dataSet.getSpace();
+        h5fileSpace.selectHyperslab(H5S_SELECT_SET, &count, &m_numValues);
+
+        h5dataSet.write(dataSetValues.second, ::H5::PredType::NATIVE_FLOAT,
+            h5memSpace, h5fileSpace);
+    }
+
+    m_entries.push_back({change, m_numValues});
+    m_numValues = newSize;
+}
+
+//! Write the index of the changed chunks, and close the file.
+void PatchWriter::close()
+{
+    std::sort(m_entries.begin(), m_entries.end(),
+        [](const PatchEntry& lhs, const PatchEntry& rhs) noexcept {
+            return lhs.change.rowStart < rhs.change.rowStart ||
+                (lhs.change.rowStart == rhs.change.rowStart &&
+                lhs.change.columnStart < rhs.change.columnStart);
+        });
+
+    const hsize_t numEntries = m_entries.size();
+    const ::H5::DataSpace h5dataSpace{1, &numEntries};
+
+    const ::H5::DSetCreatPropList h5createPropList{};
+    if (numEntries > 0)
+    {
+        h5createPropList.setChunk(1, &numEntries);
+        if (m_compressionLevel > 0 && m_compressionLevel <= kMaxCompressionLevel)
+            h5createPropList.setDeflate(m_compressionLevel);
+    }
+
+    const auto entryType = makeEntryType();
+    const auto h5dataSet = m_h5file.createDataSet(kIndexPath, entryType,
+        h5dataSpace, h5createPropList);
+    if (numEntries > 0)
+        h5dataSet.write(m_entries.data(), entryType);
+
+    m_elevations.close();
+    m_uncertainties.close();
+    m_h5file.close();
+}
+
+//! Compare one chunk of two surfaces.
+/*!
+\param window
+    The chunk.
+\param baseElevations
+    The base elevations of the chunk.
+\param baseUncertainties
+    The base uncertainties of the chunk.
+\param elevations
+    The updated elevations of the chunk.
+\param uncertainties
+    The updated uncertainties of the chunk.
+\param tolerance
+    The largest change that is not counted as one.
+\param differences
+    Set to the elevation differences, if not null.
+\param combinedUncertainties
+    Set to the combined uncertainties of the differences, if not null.
+
+\return
+    The change in the chunk.
+*/
+ChunkChange compareChunk(
+    const GridWindow& window,
+    const float* baseElevations,
+    const float* baseUncertainties,
+    const float* elevations,
+    const float* uncertainties,
+    float tolerance,
+    float* differences,
+    float* combinedUncertainties) noexcept
+{
+    ChunkChange change;
+    change.rowStart = window.rowStart;
+    change.columnStart = window.columnStart;
+    change.rowEnd = window.rowEnd;
+    change.columnEnd = window.columnEnd;
+
+    ValueRange range;
+    double sum = 0.;
+    double sumSquares = 0.;
+
+    const size_t numCells = static_cast<size_t>(window.rows()) * window.columns();
+    for (size_t cell = 0; cell < numCells; ++cell)
+    {
+        const bool hadElevation = ValueRange::isValid(baseElevations[cell]);
+        const bool hasElevation = ValueRange::isValid(elevations[cell]);
+        const bool hadUncertainty = ValueRange::isValid(baseUncertainties[cell]);
+        const bool hasUncertainty = ValueRange::isValid(uncertainties[cell]);
+
+        float difference = BAG_NULL_ELEVATION;
+        float uncertainty = BAG_NULL_UNCERTAINTY;
+
+        if (hadElevation && hasElevation)
+        {
+            difference = elevations[cell] - baseElevations[cell];
+
+            ++change.numCompared;
+            range.add(difference);
+            sum += difference;
+            sumSquares += static_cast<double>(difference) * difference;
+
+            const bool uncertaintyChanged = hadUncertainty != hasUncertainty ||
+                (hasUncertainty && std::abs(uncertainties[cell] -
+                    baseUncertainties[cell]) > tolerance);
+
+            if (std::abs(difference) > tolerance || uncertaintyChanged)
+                ++change.numChanged;
+
+            if (hadUncertainty && hasUncertainty)
+                uncertainty = std::sqrt(
+                    baseUncertainties[cell] * baseUncertainties[cell] +
+                    uncertainties[cell] * uncertainties[cell]);
+        }
+        else if (hadElevation != hasElevation)
+            ++change.numChanged;
+
+        if (differences)
+            differences[cell] = difference;
+        if (combinedUncertainties)
+            combinedUncertainties[cell] = uncertainty;
+    }
+
+    if (change.numCompared > 0)
+    {
+        change.minDifference = range.min;
+        change.maxDifference = range.max;
+        change.meanDifference = sum / change.numCompared;
+        change.rmsDifference = std::sqrt(sumSquares / change.numCompared);
+    }
+
+    return change;
+}
+
+}  // namespace
+
+//! Compare two surfaces on the same grid.
+/*!
+    The surfaces are compared chunk by chunk, following the chunks of the
+    base elevation layer, so the patch file applies chunk by chunk to a BAG
+    laid out like the base.
+
+\param base
+    The earlier surface.
+\param updated
+    The later surface.
+\param differenceFileName
+    The name of the difference BAG to create, or empty for none.
+\param patchFileName
+    The name of the patch file to write, or empty for none.  An existing file
+    is replaced.
+\param tolerance
+    The largest change in elevation or uncertainty that is not counted as one.
+\param compressionLevel
+    The compression level of the difference BAG and the patch file.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The change in every chunk, row major.
+*/
+std::vector<ChunkChange> SurfaceDiff::diff(
+    const Dataset& base,
+    const Dataset& updated,
+    const std::string& differenceFileName,
+    const std::string& patchFileName,
+    float tolerance,
+    int compressionLevel,
+    unsigned int numThreads)
+{
+    const auto& baseMetadata = base.getMetadata();
+    const auto& updatedMetadata = updated.getMetadata();
+
+    if (baseMetadata.rows() != updatedMetadata.rows() ||
+        baseMetadata.columns() != updatedMetadata.columns() ||
+        !sameGridValue(baseMetadata.llCornerX(), updatedMetadata.llCornerX(),
+            baseMetadata.columnResolution()) ||
+        !sameGridValue(baseMetadata.llCornerY(), updatedMetadata.llCornerY(),
+            baseMetadata.rowResolution()) ||
+        !sameGridValue(baseMetadata.columnResolution(),
+            updatedMetadata.columnResolution(), baseMetadata.columnResolution()) ||
+        !sameGridValue(baseMetadata.rowResolution(),
+            updatedMetadata.rowResolution(), baseMetadata.rowResolution()))
+        throw IncompatibleGrids{};
+
+    for (const auto* pDataset : {&base, &updated})
+        if (!pDataset->getSimpleLayer(Elevation) ||
+            !pDataset->getSimpleLayer(Uncertainty))
+            throw LayerNotFound{};
+
+    const ChunkedDataSet baseElevation{base.getH5file(),
+        Layer::getInternalPath(Elevation)};
+    const ChunkedDataSet baseUncertainty{base.getH5file(),
+        Layer::getInternalPath(Uncertainty)};
+    const ChunkedDataSet updatedElevation{updated.getH5file(),
+        Layer::getInternalPath(Elevation)};
+    const ChunkedDataSet updatedUncertainty{updated.getH5file(),
+        Layer::getInternalPath(Uncertainty)};
+
+    for (const auto* pDataSet : {&baseElevation, &baseUncertainty,
+            &updatedElevation, &updatedUncertainty})
+        if (pDataSet->getElementSize() != sizeof(float))
+            throw UnsupportedElementSize{};
+
+    // The difference BAG, chunked like the base where possible.
+    std::shared_ptr<Dataset> pDifference;
+    std::unique_ptr<ChunkedDataSet> differenceElevation;
+    std::unique_ptr<ChunkedDataSet> differenceUncertainty;
+
+    if (!differenceFileName.empty())
+    {
+        const uint64_t chunkSize = baseElevation.isChunked() &&
+            baseElevation.getChunkRows() == baseElevation.getChunkColumns() ?
+            baseElevation.getChunkRows() : 100;
+
+        pDifference = Dataset::create(differenceFileName, copyMetadata(base),
+            chunkSize, compressionLevel);
+
+        differenceElevation.reset(new ChunkedDataSet{pDifference->getH5file(),
+            Layer::getInternalPath(Elevation)});
+        differenceUncertainty.reset(new ChunkedDataSet{pDifference->getH5file(),
+            Layer::getInternalPath(Uncertainty)});
+    }
+
+    std::unique_ptr<PatchWriter> patchWriter;
+    if (!patchFileName.empty())
+    {
+        std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+        patchWriter.reset(new PatchWriter{patchFileName, baseMetadata,
+            compressionLevel});
+    }
+
+    const auto numChunks = baseElevation.getNumChunks();
+    std::vector<ChunkChange> changes(numChunks);
+
+    ValueRange differenceRange;
+    ValueRange uncertaintyRange;
+    std::mutex rangeMutex;
+
+    parallelFor(numChunks, numThreads, [&](size_t chunkIndex) {
+        const auto window = baseElevation.getChunkWindow(chunkIndex);
+
+        const auto baseElevations = baseElevation.readChunk(chunkIndex);
+        const auto baseUncertainties = baseUncertainty.read(window);
+        const auto elevations = updatedElevation.read(window);
+        const auto uncertainties = updatedUncertainty.read(window);
+
+        const size_t numCells = static_cast<size_t>(window.rows()) *
+            window.columns();
+        std::vector<float> differences(pDifference ? numCells : 0);
+        std::vector<float> combinedUncertainties(pDifference ? numCells : 0);
+
+        const auto* updatedElevations =
+            reinterpret_cast<const float*>(elevations.data());
+        const auto* updatedUncertainties =
+            reinterpret_cast<const float*>(uncertainties.data());
+
+        auto& change = changes[chunkIndex];
+        change = compareChunk(window,
+            reinterpret_cast<const float*>(baseElevations.data()),
+            reinterpret_cast<const float*>(baseUncertainties.data()),
+            updatedElevations, updatedUncertainties, tolerance,
+            pDifference ? differences.data() : nullptr,
+            pDifference ? combinedUncertainties.data() : nullptr);
+
+        if (pDifference)
+        {
+            ValueRange chunkDifferenceRange;
+            for (const float value : differences)
+                chunkDifferenceRange.add(value);
+
+            ValueRange chunkUncertaintyRange;
+            for (const float value : combinedUncertainties)
+                chunkUncertaintyRange.add(value);
+
+            differenceElevation->write(window,
+                reinterpret_cast<const uint8_t*>(differences.data()));
+            differenceUncertainty->write(window,
+                reinterpret_cast<const uint8_t*>(combinedUncertainties.data()));
+
+            std::lock_guard<std::mutex> lock{rangeMutex};
+            differenceRange.merge(chunkDifferenceRange);
+            uncertaintyRange.merge(chunkUncertaintyRange);
+        }
+
+        if (patchWriter && change.numChanged > 0)
+        {
+            std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+            patchWriter->append(change, updatedElevations,
+                updatedUncertainties);
+        }
+    });
+
+    if (patchWriter)
+    {
+        std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+        patchWriter->close();
+    }
+
+    if (pDifference)
+    {
+        differenceElevation.reset();
+        differenceUncertainty.reset();
+
+        widenMinMax(*pDifference, Elevation, differenceRange);
+        widenMinMax(*pDifference, Uncertainty, uncertaintyRange);
+    }
+
+    return changes;
+}
+
+//! Write a patch file over a BAG.
+/*!
+    Only the chunks in the patch are rewritten.  The min/max of the layers
+    are widened to include the patched values, as with any other write.
+
+\param target
+    The BAG to update; a copy of the base the patch was made from.
+\param patchFileName
+    The name of the patch file.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The changes the patch made, row major.
+*/
+std::vector<ChunkChange> SurfaceDiff::applyPatch(
+    Dataset& target,
+    const std::string& patchFileName,
+    unsigned int numThreads)
+{
+    if (target.getDescriptor().isReadOnly())
+        throw ReadOnlyError{};
+
+    std::unique_ptr<::H5::H5File> h5patchFile;
+    std::unique_ptr<::H5::DataSet> h5elevations;
+    std::unique_ptr<::H5::DataSet> h5uncertainties;
+    std::vector<PatchEntry> entries;
+
+    {
+        std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+        h5patchFile.reset(new ::H5::H5File{patchFileName, H5F_ACC_RDONLY});
+
+        // Check the patch is for this grid.
+        const auto& metadata = target.getMetadata();
+
+        uint32_t rows = 0, columns = 0;
+        h5patchFile->openAttribute(kRowsName).read(
+            ::H5::PredType::NATIVE_UINT32, &rows);
+        h5patchFile->openAttribute(kColumnsName).read(
+            ::H5::PredType::NATIVE_UINT32, &columns);
+
+        double llCornerX = 0., llCornerY = 0.;
+        double rowResolution = 0., columnResolution = 0.;
+        h5patchFile->openAttribute(kLlCornerXName).read(
+            ::H5::PredType::NATIVE_DOUBLE, &llCornerX);
+        h5patchFile->openAttribute(kLlCornerYName).read(
+            ::H5::PredType::NATIVE_DOUBLE, &llCornerY);
+        h5patchFile->openAttribute(kRowResolutionName).read(
+            ::H5::PredType::NATIVE_DOUBLE, &rowResolution);
+        h5patchFile->openAttribute(kColumnResolutionName).read(
+            ::H5::PredType::NATIVE_DOUBLE, &columnResolution);
+
+        if (rows != metadata.rows() || columns != metadata.columns() ||
+            !sameGridValue(llCornerX, metadata.llCornerX(),
+                metadata.columnResolution()) ||
+            !sameGridValue(llCornerY, metadata.llCornerY(),
+                metadata.rowResolution()) ||
+            !sameGridValue(rowResolution, metadata.rowResolution(),
+                metadata.rowResolution()) ||
+            !sameGridValue(columnResolution, metadata.columnResolution(),
+                metadata.columnResolution()))
+            throw PatchMismatch{};
+
+        const auto h5index = h5patchFile->openDataSet(kIndexPath);
+        hsize_t numEntries = 0;
+        h5index.getSpace().getSimpleExtentDims(&numEntries);
+
+        entries.resize(numEntries);
+        if (numEntries > 0)
+            h5index.read(entries.data(), makeEntryType());
+
+        h5elevations.reset(new ::H5::DataSet{
+            h5patchFile->openDataSet(kElevationPath)});
+        h5uncertainties.reset(new ::H5::DataSet{
+            h5patchFile->openDataSet(kUncertaintyPath)});
+    }
+
+    ChunkedDataSet targetElevation{target.getH5file(),
+        Layer::getInternalPath(Elevation)};
+    ChunkedDataSet targetUncertainty{target.getH5file(),
+        Layer::getInternalPath(Uncertainty)};
+
+    ValueRange elevationRange;
+    ValueRange uncertaintyRange;
+    std::mutex rangeMutex;
+
+    parallelFor(entries.size(), numThreads, [&](size_t entryIndex) {
+        const auto& change = entries[entryIndex].change;
+        const GridWindow window{change.rowStart, change.columnStart,
+            change.rowEnd, change.columnEnd};
+
+        if (window.rowEnd >= targetElevation.getRows() ||
+            window.columnEnd >= targetElevation.getColumns())
+            throw PatchMismatch{};
+
+        const hsize_t count = static_cast<hsize_t>(window.rows()) *
+            window.columns();
+        const hsize_t offset = entries[entryIndex].offset;
+
+        std::vector<float> elevations(count);
+        std::vector<float> uncertainties(count);
+
+        {
+            std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+            const ::H5::DataSpace h5memSpace{1, &count};
+            for (const auto& dataSetValues : {
+                    std::make_pair(h5elevations.get(), elevations.data()),
+                    std::make_pair(h5uncertainties.get(), uncertainties.data())})
+            {
+                auto h5fileSpace = dataSetValues.first->getSpace();
+                h5fileSpace.selectHyperslab(H5S_SELECT_SET, &count, &offset);
+
+                dataSetValues.first->read(dataSetValues.second,
+                    ::H5::PredType::NATIVE_FLOAT, h5memSpace, h5fileSpace);
+            }
+        }
+
+        ValueRange chunkElevationRange;
+        for (const float value : elevations)
+            chunkElevationRange.add(value);
+
+        ValueRange chunkUncertaintyRange;
+        for (const float value : uncertainties)
+            chunkUncertaintyRange.add(value);
+
+        targetElevation.write(window,
+            reinterpret_cast<const uint8_t*>(elevations.data()));
+        targetUncertainty.write(window,
+            reinterpret_cast<const uint8_t*>(uncertainties.data()));
+
+        std::lock_guard<std::mutex> lock{rangeMutex};
+        elevationRange.merge(chunkElevationRange);
+        uncertaintyRange.merge(chunkUncertaintyRange);
+    });
+
+    {
+        std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+        h5elevations.reset();
+        h5uncertainties.reset();
+        h5patchFile.reset();
+    }
+
+    widenMinMax(target, Elevation, elevationRange);
+    widenMinMax(target, Uncertainty, uncertaintyRange);
+
+    // The elevations changed, so any cached coverage is stale.
+    if (!entries.empty())
+        Coverage::remove(target);
+
+    std::vector<ChunkChange> changes;
+    changes.reserve(entries.size());
+    for (const auto& entry : entries)
+        changes.push_back(entry.change);
+
+    return changes;
+}
+
+}  // namespace BAG
+
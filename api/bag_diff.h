@@ -0,0 +1,77 @@
+#ifndef BAG_DIFF_H
+#define BAG_DIFF_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace BAG {
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)  // std classes do not have DLL-interface when exporting
+#endif
+
+//! The change in one chunk of the grid between two surfaces.
+struct ChunkChange final
+{
+    //! The first row of the chunk.
+    uint32_t rowStart = 0;
+    //! The first column of the chunk.
+    uint32_t columnStart = 0;
+    //! The last row of the chunk.
+    uint32_t rowEnd = 0;
+    //! The last column of the chunk.
+    uint32_t columnEnd = 0;
+    //! The number of cells with an elevation in both surfaces.
+    uint64_t numCompared = 0;
+    //! The number of cells whose elevation or uncertainty changed by more
+    //! than the tolerance, or that gained or lost their elevation.
+    uint64_t numChanged = 0;
+    //! The smallest elevation difference (updated - base).
+    float minDifference = 0.f;
+    //! The largest elevation difference (updated - base).
+    float maxDifference = 0.f;
+    //! The mean elevation difference.
+    double meanDifference = 0.;
+    //! The root mean square elevation difference.
+    double rmsDifference = 0.;
+};
+
+//! Change detection between two surfaces on the same grid.
+/*!
+    Both BAGs are streamed one chunk at a time across threads, so neither is
+    ever read whole.  Each pass can write:
+
+    - a difference BAG, whose elevation is the updated elevation less the base
+      elevation, and whose uncertainty combines the two uncertainties;
+    - a patch file, holding the updated elevations and uncertainties of only
+      the chunks that changed, which applyPatch() writes over a copy of the
+      base BAG.
+
+    Only the mandatory elevation and uncertainty layers are compared.
+*/
+class BAG_API SurfaceDiff final
+{
+public:
+    static std::vector<ChunkChange> diff(const Dataset& base,
+        const Dataset& updated, const std::string& differenceFileName,
+        const std::string& patchFileName, float tolerance = 0.f,
+        int compressionLevel = 5, unsigned int numThreads = 0);
+
+    static std::vector<ChunkChange> applyPatch(Dataset& target,
+        const std::string& patchFileName, unsigned int numThreads = 0);
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+}  // namespace BAG
+
+#endif  // BAG_DIFF_H
+
@@ -38,6 +38,16 @@ struct BAG_API UnsupportedAttributeType final : virtual std::exception
 };
 
 
+// Chunk related.
+//! A chunk failed its checksum or could not be decoded.
+struct BAG_API CorruptChunk final : virtual std::exception
+{
+    const char* what() const noexcept override
+    {
+        return "A chunk of the HDF5 DataSet failed its checksum or could not be decoded.";
+    }
+};
+
 // CompoundDataType related.
 //! Layer not found.
 struct BAG_API InvalidType final : virtual std::exception
@@ -96,6 +106,28 @@ struct BAG_API InvalidLayerId final : virtual std::exception
 };
 
 
+// Diff related.
+//! The patch was made for a different grid.
+struct BAG_API PatchMismatch final : virtual std::exception
+{
+    const char* what() const noexcept override
+    {
+        return "The patch was made for a BAG on a different grid.";
+    }
+};
+
+
+// Extract related.
+//! The bounding box does not contain any node of the grid.
+struct BAG_API EmptyExtraction final : virtual std::exception
+{
+    const char* what() const noexcept override
+    {
+        return "The bounding box does not contain any node of the BAG.";
+    }
+};
+
+
 // Group related.
 //! Attempt to use an unknown layer type.
 struct BAG_API UnsupportedGroupType final : virtual std::exception
@@ -240,6 +272,17 @@ struct InvalidDatumError final : virtual CoordSysError {};
 struct InvalidEllipsoidError final : virtual CoordSysError {};
 
 
+// Merge related.
+//! The BAGs do not share a coordinate system, resolution or grid alignment.
+struct BAG_API IncompatibleGrids final : virtual std::exception
+{
+    const char* what() const noexcept override
+    {
+        return "The BAGs are not on the same coordinate system, resolution and grid alignment.";
+    }
+};
+
+
 // Metadata related.
 //! Attempt to make an unsupported interleaved layer.
 struct BAG_API MetadataNotFound final : virtual std::exception
@@ -304,6 +347,17 @@ struct BAG_API ErrorLoadingMetadata final : virtual std::exception
 };
 
 
+// Resample related.
+//! The resolution to resample to is not valid.
+struct BAG_API InvalidResolution final : virtual std::exception
+{
+    const char* what() const noexcept override
+    {
+        return "The resolution to resample to must be greater than zero.";
+    }
+};
+
+
 // SimpleLayer related.
 //! Cannot convert DataType to an HDF5 DataType.
 struct BAG_API UnsupportedDataType final : virtual std::exception
@@ -365,6 +419,48 @@ struct BAG_API UnsupportedSurfaceType final : virtual std::exception
 };
 
 
+// Tile related.
+//! The tile size is not valid.
+struct BAG_API InvalidTileSize final : virtual std::exception
+{
+    const char* what() const noexcept override
+    {
+        return "A tile must have at least one row and one column.";
+    }
+};
+
+
+// TrackingList related.
+//! The sort order is not valid for the tracking list.
+struct BAG_API InvalidSortOrder final : virtual std::exception
+{
+    const char* what() const noexcept override
+    {
+        return "The tracking list cannot be sorted in this order.";
+    }
+};
+
+//! The tracking list was opened without its items.
+struct BAG_API TrackingListNotLoaded final : virtual std::exception
+{
+    const char* what() const noexcept override
+    {
+        return "The tracking list was opened for streaming, and cannot be"
+            " written.";
+    }
+};
+
+//! The tracking list was reordered, so the order of its edits is lost.
+struct BAG_API TrackingListSorted final : virtual std::exception
+{
+    const char* what() const noexcept override
+    {
+        return "The tracking list was reordered, and no longer holds its edits"
+            " in the order they were made.";
+    }
+};
+
+
 // Value Table related.
 //! The specified field does not exist.
 struct BAG_API FieldNotFound final : virtual std::exception
@@ -435,6 +531,26 @@ struct BAG_API ValueNotFound final : virtual std::exception
 };
 
 
+// VRBuild related.
+//! The factor of the resolution rule is not valid.
+struct BAG_API InvalidRuleFactor final : virtual std::exception
+{
+    const char* what() const noexcept override
+    {
+        return "The factor of the resolution rule must be greater than zero.";
+    }
+};
+
+//! The size of the supercells is not valid.
+struct BAG_API InvalidSupercellSize final : virtual std::exception
+{
+    const char* what() const noexcept override
+    {
+        return "The supercell size must be greater than zero.";
+    }
+};
+
+
 // VRRefinement related.
 //! VR Refinements are the wrong dimensions.
 struct BAG_API InvalidVRRefinementDimensions final : virtual std::exception
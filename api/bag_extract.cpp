@@ -0,0 +1,707 @@
+#include "bag_chunkio.h"
+#include "bag_dataset.h"
+#include "bag_exceptions.h"
+#include "bag_extract.h"
+#include "bag_georefmetadatalayer.h"
+#include "bag_georefmetadatalayerdescriptor.h"
+#include "bag_metadata.h"
+#include "bag_metadata_export.h"
+#include "bag_parallel.h"
+#include "bag_private.h"
+#include "bag_simplelayer.h"
+#include "bag_simplelayerdescriptor.h"
+#include "bag_trackinglist.h"
+#include "bag_trackinglistreader.h"
+#include "bag_valuetable.h"
+#include "bag_vrmetadata.h"
+#include "bag_vrmetadatadescriptor.h"
+#include "bag_vrnode.h"
+#include "bag_vrrefinements.h"
+#include "bag_vrtrackinglist.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <H5Cpp.h>
+#include <mutex>
+
+
+namespace BAG {
+
+namespace {
+
+//! How far, in cells, a node may be outside the box and still be inside it.
+constexpr double kBoundaryTolerance = 1e-6;
+
+//! The chunk size used when the source layer is not chunked.
+constexpr uint64_t kDefaultChunkSize = 100;
+
+//! The refinements of one supercell in the source.
+struct RefinementRange final
+{
+    //! The index of the first refinement.
+    uint32_t index = 0;
+    //! The number of refinements.
+    uint32_t count = 0;
+};
+
+//! Find the nodes of one axis of the grid inside an interval.
+/*!
+\param origin
+    The position of the first node.
+\param resolution
+    The distance between nodes.
+\param numNodes
+    The number of nodes.
+\param min
+    The start of the interval.
+\param max
+    The end of the interval.
+\param first
+    Receives the first node inside the interval.
+\param last
+    Receives the last node inside the interval.
+
+\return
+    \e true if any node is inside the interval.
+*/
+bool findNodes(
+    double origin,
+    double resolution,
+    uint32_t numNodes,
+    double min,
+    double max,
+    uint32_t& first,
+    uint32_t& last)
+{
+    const double start = std::max(
+        std::ceil((min - origin) / resolution - kBoundaryTolerance), 0.);
+    const double end = std::min(
+        std::floor((max - origin) / resolution + kBoundaryTolerance),
+        numNodes - 1.);
+
+    if (numNodes == 0 || start > end)
+        return false;
+
+    first = static_cast<uint32_t>(start);
+    last = static_cast<uint32_t>(end);
+
+    return true;
+}
+
+//! Get the chunk size of a layer for a window of it.
+/*!
+\param descriptor
+    The descriptor of the layer.
+\param window
+    The window of the layer being extracted.
+
+\return
+    The chunk size of the layer, or the default if it is not chunked; never
+    more than the window, as layers have fixed dimensions.
+*/
+uint64_t getChunkSize(
+    const LayerDescriptor& descriptor,
+    const GridWindow& window) noexcept
+{
+    const auto chunkSize = descriptor.getChunkSize();
+
+    return std::min<uint64_t>({chunkSize > 0 ? chunkSize : kDefaultChunkSize,
+        window.rows(), window.columns()});
+}
+
+//! Copy a window of a grid DataSet into another, one output chunk at a time.
+/*!
+    Output chunks that match a whole chunk of the source are copied as
+    stored; any other chunk is read from the window and written again.
+
+\param source
+    The DataSet to copy from.
+\param destination
+    The DataSet to copy into; its extent is that of the window.
+\param window
+    The window of the source to copy.
+\param computeRange
+    Find the range of the values copied; only for float and uint32 DataSets.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The range of the values copied.
+*/
+ValueRange copyWindow(
+    const ChunkedDataSet& source,
+    ChunkedDataSet& destination,
+    const GridWindow& window,
+    bool computeRange,
+    unsigned int numThreads)
+{
+    const bool aligned = source.isRawDecodable() &&
+        source.hasSameChunking(destination) &&
+        window.rowStart % source.getChunkRows() == 0 &&
+        window.columnStart % source.getChunkColumns() == 0;
+
+    ValueRange range;
+    std::mutex rangeMutex;
+
+    parallelFor(destination.getNumChunks(), numThreads, [&](size_t chunkIndex) {
+        const auto chunkWindow = destination.getChunkWindow(chunkIndex);
+        const GridWindow sourceWindow{chunkWindow.rowStart + window.rowStart,
+            chunkWindow.columnStart + window.columnStart,
+            chunkWindow.rowEnd + window.rowStart,
+            chunkWindow.columnEnd + window.columnStart};
+
+        ValueRange chunkRange;
+
+        const uint64_t sourceIndex = aligned ?
+            sourceWindow.rowStart / source.getChunkRows() *
+                source.getNumChunkColumns() +
+                sourceWindow.columnStart / source.getChunkColumns() : 0;
+        const auto storedWindow = source.getChunkWindow(sourceIndex);
+
+        if (aligned && storedWindow.rowEnd == sourceWindow.rowEnd &&
+            storedWindow.columnEnd == sourceWindow.columnEnd)
+        {
+            RawChunk rawChunk;
+            if (source.readRawChunk(sourceIndex, rawChunk))
+            {
+                destination.writeRawChunk(chunkIndex, rawChunk);
+
+                if (computeRange)
+                    source.addToRange(source.decodeRawChunk(rawChunk).data(),
+                        chunkWindow.rows(), chunkWindow.columns(),
+                        source.getChunkColumns(), chunkRange);
+            }
+            else if (computeRange)
+            {
+                // Never written; the destination reads the same fill value.
+                source.addToRange(source.getFillValue().data(), 1, 1, 1,
+                    chunkRange);
+            }
+        }
+        else
+        {
+            const auto values = source.read(sourceWindow);
+            destination.writeChunk(chunkIndex, values.data());
+
+            if (computeRange)
+                source.addToRange(values.data(), chunkWindow.rows(),
+                    chunkWindow.columns(), chunkWindow.columns(), chunkRange);
+        }
+
+        std::lock_guard<std::mutex> lock{rangeMutex};
+        range.merge(chunkRange);
+    });
+
+    return range;
+}
+
+//! Create an empty grid DataSet like one in another file, for a window of it.
+/*!
+\param source
+    The file holding the DataSet to copy.
+\param destination
+    The file to create the DataSet in.
+\param path
+    The path of the DataSet in both files.
+\param window
+    The window of the source the new DataSet will hold.
+*/
+void createGridLike(
+    const ::H5::H5File& source,
+    const ::H5::H5File& destination,
+    const std::string& path,
+    const GridWindow& window)
+{
+    std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+    const auto h5dataSet = source.openDataSet(path);
+    const auto h5createPropList = h5dataSet.getCreatePlist();
+
+    std::array<hsize_t, 2> maxDims{};
+    h5dataSet.getSpace().getSimpleExtentDims(nullptr, maxDims.data());
+
+    const std::array<hsize_t, 2> dims{window.rows(), window.columns()};
+    for (size_t i = 0; i < dims.size(); ++i)
+        if (maxDims[i] != H5S_UNLIMITED)
+            maxDims[i] = dims[i];
+
+    if (h5createPropList.getLayout() == H5D_CHUNKED)
+    {
+        // Chunks may not be larger than fixed dimensions.
+        std::array<hsize_t, 2> chunkDims{};
+        h5createPropList.getChunk(2, chunkDims.data());
+        for (size_t i = 0; i < dims.size(); ++i)
+            if (maxDims[i] != H5S_UNLIMITED)
+                chunkDims[i] = std::min(chunkDims[i], maxDims[i]);
+
+        h5createPropList.setChunk(2, chunkDims.data());
+    }
+
+    const ::H5::DataSpace h5dataSpace{2, dims.data(), maxDims.data()};
+    const auto h5copy = destination.createDataSet(path, h5dataSet.getDataType(),
+        h5dataSpace, h5createPropList);
+
+    const auto numAttributes = h5dataSet.getNumAttrs();
+    for (int i = 0; i < numAttributes; ++i)
+    {
+        const auto h5attribute = h5dataSet.openAttribute(
+            static_cast<unsigned int>(i));
+        const auto h5type = h5attribute.getDataType();
+        const auto h5space = h5attribute.getSpace();
+
+        std::vector<uint8_t> buffer(h5attribute.getInMemDataSize());
+        h5attribute.read(h5type, buffer.data());
+        h5copy.createAttribute(h5attribute.getName(), h5type, h5space).write(
+            h5type, buffer.data());
+    }
+}
+
+//! Renumber georeferenced metadata keys, adding the records they use.
+/*!
+\param keys
+    The keys to renumber, in place.
+\param numKeys
+    The number of keys.
+\param source
+    The value table the keys refer to.
+\param newKeys
+    The new key of each source key; 0 if it has no record in the output yet.
+\param records
+    Receives the records new keys are given to.
+\param firstNewKey
+    The key of the first record in \e records.
+*/
+template <typename T>
+void renumberKeys(
+    uint8_t* keys,
+    size_t numKeys,
+    const ValueTable& source,
+    std::vector<uint64_t>& newKeys,
+    Records& records,
+    uint64_t firstNewKey)
+{
+    auto* typedKeys = reinterpret_cast<T*>(keys);
+    const auto& sourceRecords = source.getRecords();
+
+    for (size_t i = 0; i < numKeys; ++i)
+    {
+        const auto key = static_cast<uint64_t>(typedKeys[i]);
+        if (key == 0 || key >= sourceRecords.size())
+        {
+            typedKeys[i] = 0;
+            continue;
+        }
+
+        if (newKeys[key] == 0)
+        {
+            newKeys[key] = firstNewKey + records.size();
+            records.push_back(sourceRecords[key]);
+        }
+
+        typedKeys[i] = static_cast<T>(newKeys[key]);
+    }
+}
+
+//! Renumber georeferenced metadata keys of any key type.
+void renumberKeys(
+    DataType keyType,
+    uint8_t* keys,
+    size_t numKeys,
+    const ValueTable& source,
+    std::vector<uint64_t>& newKeys,
+    Records& records,
+    uint64_t firstNewKey)
+{
+    switch (keyType)
+    {
+    case DT_UINT8:
+        renumberKeys<uint8_t>(keys, numKeys, source, newKeys, records,
+            firstNewKey);
+        break;
+    case DT_UINT16:
+        renumberKeys<uint16_t>(keys, numKeys, source, newKeys, records,
+            firstNewKey);
+        break;
+    case DT_UINT32:
+        renumberKeys<uint32_t>(keys, numKeys, source, newKeys, records,
+            firstNewKey);
+        break;
+    case DT_UINT64:
+        renumberKeys<uint64_t>(keys, numKeys, source, newKeys, records,
+            firstNewKey);
+        break;
+    default:
+        throw InvalidKeyType{};
+    }
+}
+
+//! Add the tracking list items inside a window to another list.
+/*!
+\param items
+    The items to clip.
+\param window
+    The nodes to keep.
+\param outList
+    The list to add the kept items to, moved to the origin of the window.
+*/
+template <typename Items, typename OutList>
+void clipTrackingItems(
+    const Items& items,
+    const GridWindow& window,
+    OutList& outList)
+{
+    for (auto item : items)
+    {
+        if (item.row < window.rowStart || item.row > window.rowEnd ||
+            item.col < window.columnStart || item.col > window.columnEnd)
+            continue;
+
+        item.row -= window.rowStart;
+        item.col -= window.columnStart;
+        outList.push_back(item);
+    }
+}
+
+//! Clip the variable resolution layers.
+/*!
+\param dataset
+    The source BAG.
+\param output
+    The new BAG.
+\param window
+    The supercells to keep.
+
+\return
+    The refinements of each supercell kept, in the order they are written.
+*/
+std::vector<RefinementRange> extractVR(
+    const Dataset& dataset,
+    Dataset& output,
+    const GridWindow& window)
+{
+    const auto pMetadata = dataset.getVRMetadata();
+    const auto pRefinements = dataset.getVRRefinements();
+    const auto pNode = dataset.getVRNode();
+
+    const auto& descriptor = *pMetadata->getDescriptor();
+    output.createVR(getChunkSize(descriptor, window),
+        descriptor.getCompressionLevel(), static_cast<bool>(pNode));
+
+    auto supercells = pMetadata->read(window.rowStart, window.columnStart,
+        window.rowEnd, window.columnEnd);
+    auto* items = reinterpret_cast<VRMetadataItem*>(supercells.data());
+
+    std::vector<RefinementRange> ranges;
+    std::vector<VRRefinementsItem> refinements;
+    std::vector<VRNodeItem> nodes;
+
+    for (uint32_t row = 0; row < window.rows(); ++row)
+    {
+        auto* rowItems = items + static_cast<size_t>(row) * window.columns();
+
+        // Read the refinements of the row at once; they are usually together.
+        uint32_t first = std::numeric_limits<uint32_t>::max();
+        uint32_t end = 0;
+        for (uint32_t column = 0; column < window.columns(); ++column)
+        {
+            const auto& item = rowItems[column];
+            const uint32_t count = item.dimensions_x * item.dimensions_y;
+            if (count == 0)
+                continue;
+
+            first = std::min(first, item.index);
+            end = std::max(end, item.index + count);
+        }
+
+        if (first >= end)
+            continue;
+
+        const auto rowRefinements = pRefinements->read(0, first, 0, end - 1);
+        const auto* refinementItems =
+            reinterpret_cast<const VRRefinementsItem*>(rowRefinements.data());
+
+        UInt8Array rowNodes;
+        if (pNode)
+            rowNodes = pNode->read(0, first, 0, end - 1);
+        const auto* nodeItems =
+            reinterpret_cast<const VRNodeItem*>(rowNodes.data());
+
+        for (uint32_t column = 0; column < window.columns(); ++column)
+        {
+            auto& item = rowItems[column];
+            const uint32_t count = item.dimensions_x * item.dimensions_y;
+            if (count == 0)
+                continue;
+
+            const auto offset = item.index - first;
+            ranges.push_back({item.index, count});
+            item.index = static_cast<uint32_t>(refinements.size());
+
+            refinements.insert(refinements.end(), refinementItems + offset,
+                refinementItems + offset + count);
+            if (pNode)
+                nodes.insert(nodes.end(), nodeItems + offset,
+                    nodeItems + offset + count);
+        }
+    }
+
+    auto pOutMetadata = output.getVRMetadata();
+    pOutMetadata->write(0, 0, window.rows() - 1, window.columns() - 1,
+        supercells.data());
+    pOutMetadata->writeAttributes();
+
+    if (!refinements.empty())
+    {
+        auto pOutRefinements = output.getVRRefinements();
+        pOutRefinements->write(0, 0, 0,
+            static_cast<uint32_t>(refinements.size() - 1),
+            reinterpret_cast<const uint8_t*>(refinements.data()));
+        pOutRefinements->writeAttributes();
+
+        if (pNode)
+        {
+            auto pOutNode = output.getVRNode();
+            pOutNode->write(0, 0, 0, static_cast<uint32_t>(nodes.size() - 1),
+                reinterpret_cast<const uint8_t*>(nodes.data()));
+            pOutNode->writeAttributes();
+        }
+    }
+
+    // The tracking list of the refinements that were kept.
+    const auto pTrackingList = dataset.getVRTrackingList();
+    auto pOutTrackingList = output.getVRTrackingList();
+    if (pTrackingList && pOutTrackingList)
+    {
+        // A streamed list is scanned on disk for the window.
+        if (pTrackingList->isLoaded())
+            clipTrackingItems(*pTrackingList, window, *pOutTrackingList);
+        else
+            clipTrackingItems(dataset.getVRTrackingListReader()->findBox(
+                window.rowStart, window.columnStart, window.rowEnd,
+                window.columnEnd), window, *pOutTrackingList);
+
+        pOutTrackingList->write();
+    }
+
+    return ranges;
+}
+
+//! Clip a georeferenced metadata layer, keeping only the records it uses.
+/*!
+\param layer
+    The source layer.
+\param output
+    The new BAG; its variable resolution layers must already exist.
+\param window
+    The nodes to keep.
+\param ranges
+    The refinements kept, as returned by extractVR().
+*/
+void extractGeorefMetadata(
+    const GeorefMetadataLayer& layer,
+    Dataset& output,
+    const GridWindow& window,
+    const std::vector<RefinementRange>& ranges)
+{
+    const auto pDescriptor =
+        std::dynamic_pointer_cast<const GeorefMetadataLayerDescriptor>(
+            layer.getDescriptor());
+    if (!pDescriptor)
+        throw InvalidLayerDescriptor{};
+
+    const auto keyType = pDescriptor->getDataType();
+    const auto keySize = pDescriptor->getElementSize();
+    auto& outLayer = output.createGeorefMetadataLayer(keyType,
+        pDescriptor->getProfile(), pDescriptor->getName(),
+        pDescriptor->getDefinition(), getChunkSize(*pDescriptor, window),
+        pDescriptor->getCompressionLevel());
+
+    const auto& values = layer.getValueTable();
+    auto& outValues = outLayer.getValueTable();
+
+    std::vector<uint64_t> newKeys(values.getRecords().size(), 0);
+    Records records;
+    const uint64_t firstNewKey = outValues.getRecords().size();
+
+    auto keys = layer.read(window.rowStart, window.columnStart, window.rowEnd,
+        window.columnEnd);
+    renumberKeys(keyType, keys.data(),
+        static_cast<size_t>(window.rows()) * window.columns(), values, newKeys,
+        records, firstNewKey);
+
+    // The keys of the refinements, in the order extractVR() wrote them.
+    std::vector<uint8_t> vrKeys;
+    for (const auto& range : ranges)
+    {
+        UInt8Array rangeKeys;
+        try
+        {
+            rangeKeys = layer.readVR(range.index, range.index + range.count - 1);
+        }
+        catch (const DatasetRequiresVariableResolution&)
+        {
+            break;
+        }
+
+        renumberKeys(keyType, rangeKeys.data(), range.count, values, newKeys,
+            records, firstNewKey);
+        vrKeys.insert(vrKeys.end(), rangeKeys.data(),
+            rangeKeys.data() + rangeKeys.size());
+    }
+
+    if (!records.empty())
+        outValues.addRecords(records);
+
+    outLayer.write(0, 0, window.rows() - 1, window.columns() - 1, keys.data());
+
+    if (!vrKeys.empty())
+        outLayer.writeVR(0, static_cast<uint32_t>(vrKeys.size() / keySize - 1),
+            vrKeys.data());
+}
+
+}  // namespace
+
+//! Copy the part of a BAG inside a bounding box into a new BAG.
+/*!
+\param dataset
+    The BAG Dataset to extract from.
+\param xMin
+    The west edge of the box, in the coordinate reference system of the BAG.
+\param yMin
+    The south edge of the box.
+\param xMax
+    The east edge of the box.
+\param yMax
+    The north edge of the box.
+\param outFileName
+    The name of the new BAG; it must not exist.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The new BAG, open for reading and writing.
+
+\throws
+    EmptyExtraction if no node of the BAG is inside the box.
+*/
+std::shared_ptr<Dataset> Extractor::extract(
+    const Dataset& dataset,
+    double xMin,
+    double yMin,
+    double xMax,
+    double yMax,
+    const std::string& outFileName,
+    unsigned int numThreads)
+{
+    const auto& metadata = dataset.getMetadata();
+
+    GridWindow window;
+    if (!findNodes(metadata.llCornerX(), metadata.columnResolution(),
+            metadata.columns(), xMin, xMax, window.columnStart,
+            window.columnEnd) ||
+        !findNodes(metadata.llCornerY(), metadata.rowResolution(),
+            metadata.rows(), yMin, yMax, window.rowStart, window.rowEnd))
+        throw EmptyExtraction{};
+
+    const auto pElevation = dataset.getSimpleLayer(Elevation);
+    if (!pElevation || !dataset.getSimpleLayer(Uncertainty))
+        throw LayerNotFound{};
+
+    // Describe the new grid; the geographic extent is scaled to match.
+    Metadata outMetadata;
+    outMetadata.loadFromBuffer(exportMetadataToXML(metadata.getStruct()));
+    outMetadata.setGridExtent(window.rows(), window.columns(),
+        metadata.llCornerX() + window.columnStart * metadata.columnResolution(),
+        metadata.llCornerY() + window.rowStart * metadata.rowResolution());
+
+    const auto& elevationDescriptor = *pElevation->getDescriptor();
+    auto pOutput = Dataset::create(outFileName, std::move(outMetadata),
+        getChunkSize(elevationDescriptor, window),
+        elevationDescriptor.getCompressionLevel(),
+        dataset.getDescriptor().isChecksummed());
+
+    const auto& h5file = dataset.getH5file();
+    const auto& h5outFile = pOutput->getH5file();
+
+    // The simple layers.
+    for (const auto& pLayer : dataset.getLayers())
+    {
+        if (!std::dynamic_pointer_cast<const SimpleLayer>(pLayer))
+            continue;
+
+        const auto& descriptor = *pLayer->getDescriptor();
+        const auto type = descriptor.getLayerType();
+        if (type != Elevation && type != Uncertainty)
+            pOutput->createSimpleLayer(type, getChunkSize(descriptor, window),
+                descriptor.getCompressionLevel());
+
+        ValueRange range;
+        {
+            const ChunkedDataSet source{h5file, descriptor.getInternalPath()};
+            ChunkedDataSet destination{h5outFile, descriptor.getInternalPath()};
+
+            range = copyWindow(source, destination, window, true, numThreads);
+        }
+
+        auto pOutLayer = pOutput->getSimpleLayer(type);
+        if (!range.empty())
+            pOutLayer->getDescriptor()->setMinMax(range.min, range.max);
+        pOutLayer->writeAttributes();
+    }
+
+    // The variable resolution layers, before georeferenced metadata needs them.
+    std::vector<RefinementRange> ranges;
+    if (dataset.getVRMetadata())
+        ranges = extractVR(dataset, *pOutput, window);
+
+    for (const auto& pLayer : dataset.getLayers())
+    {
+        const auto pGeorefLayer =
+            std::dynamic_pointer_cast<const GeorefMetadataLayer>(pLayer);
+        if (pGeorefLayer)
+            extractGeorefMetadata(*pGeorefLayer, *pOutput, window, ranges);
+    }
+
+    // The tracking list; a streamed list is scanned on disk for the window.
+    const auto& trackingList = dataset.getTrackingList();
+    auto& outTrackingList = pOutput->getTrackingList();
+    if (trackingList.isLoaded())
+        clipTrackingItems(trackingList, window, outTrackingList);
+    else
+        clipTrackingItems(dataset.getTrackingListReader()->findBox(
+            window.rowStart, window.columnStart, window.rowEnd,
+            window.columnEnd), window, outTrackingList);
+    outTrackingList.write();
+
+    // Legacy interleaved layers, and surface corrections, are found on open.
+    for (const auto* path : {NODE_GROUP_PATH, ELEVATION_SOLUTION_GROUP_PATH})
+    {
+        if (!h5file.nameExists(path))
+            continue;
+
+        createGridLike(h5file, h5outFile, path, window);
+
+        const ChunkedDataSet source{h5file, path};
+        ChunkedDataSet destination{h5outFile, path};
+        copyWindow(source, destination, window, false, numThreads);
+    }
+
+    if (h5file.nameExists(VERT_DATUM_CORR_PATH))
+    {
+        std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+        if (H5Ocopy(h5file.getId(), VERT_DATUM_CORR_PATH, h5outFile.getId(),
+            VERT_DATUM_CORR_PATH, H5P_DEFAULT, H5P_DEFAULT) < 0)
+            throw ::H5::FileIException{"Extractor::extract",
+                "copying the surface corrections failed"};
+    }
+
+    pOutput->close();
+
+    return Dataset::open(outFileName, BAG_OPEN_READ_WRITE);
+}
+
+}  // namespace BAG
+
@@ -0,0 +1,42 @@
+#ifndef BAG_EXTRACT_H
+#define BAG_EXTRACT_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <memory>
+#include <string>
+
+
+namespace BAG {
+
+//! Extraction of the part of a BAG inside a bounding box.
+/*!
+    The new BAG holds the nodes whose positions are inside the bounding box,
+    and is a complete BAG in its own right:
+
+    - the metadata describes the new grid and extent;
+    - every simple and legacy interleaved layer is clipped;
+    - georeferenced metadata keys are clipped, and only the records they use
+      are kept (renumbered from 1);
+    - the supercells of a variable resolution BAG are clipped, and only their
+      refinements and nodes are kept;
+    - only tracking list items inside the box are kept;
+    - surface corrections, which have their own grid, are copied whole.
+
+    Where the box starts on a chunk boundary, chunks of the simple layers are
+    copied as stored, without recompressing them.  Every chunk is still
+    inflated, outside the HDF5 mutex, to find the range of the new layer.
+*/
+class BAG_API Extractor final
+{
+public:
+    static std::shared_ptr<Dataset> extract(const Dataset& dataset,
+        double xMin, double yMin, double xMax, double yMax,
+        const std::string& outFileName, unsigned int numThreads = 0);
+};
+
+}  // namespace BAG
+
+#endif  // BAG_EXTRACT_H
+
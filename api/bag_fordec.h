@@ -6,28 +6,43 @@
 namespace BAG
 {
 
+class Coverage;
 class GeorefMetadataLayer;
 class GeorefMetadataLayerDescriptor;
 class Dataset;
 class Descriptor;
+class Extractor;
 class InterleavedLegacyLayer;
 class InterleavedLegacyLayerDescriptor;
 class Layer;
 class LayerDescriptor;
+class Merger;
 class Metadata;
+class Repacker;
+class Resampler;
+class Reverter;
 class SimpleLayer;
 class SimpleLayerDescriptor;
+class SurfaceDiff;
 class SurfaceCorrections;
 class SurfaceCorrectionsDescriptor;
+class Tiler;
 class TrackingList;
+class TrackingListReader;
+class Upgrader;
 class ValueTable;
+class Verifier;
+class VRBuilder;
+class VRIndex;
 class VRMetadata;
 class VRMetadataDescriptor;
 class VRNode;
 class VRNodeDescriptor;
+class VRRecordReader;
 class VRRefinements;
 class VRRefinementsDescriptor;
 class VRTrackingList;
+class VRTrackingListReader;
 
 }  // namespace BAG
 
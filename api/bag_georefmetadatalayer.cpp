@@ -229,6 +229,8 @@ GeorefMetadataLayer::createH5keyDataSet(
 
             if (compressionLevel > 0 && compressionLevel <= kMaxCompressionLevel)
                 h5createPropList.setDeflate(compressionLevel);
+            if (dataset.getDescriptor().isChecksummed())
+                h5createPropList.setFletcher32();
         }
         else if (compressionLevel > 0)
             throw CompressionNeedsChunkingSet{};
@@ -320,6 +322,8 @@ GeorefMetadataLayer::createH5vrKeyDataSet(
 
             if (compressionLevel > 0 && compressionLevel <= kMaxCompressionLevel)
                 h5createPropList.setDeflate(compressionLevel);
+            if (dataset.getDescriptor().isChecksummed())
+                h5createPropList.setFletcher32();
         }
         else if (compressionLevel > 0)
             throw CompressionNeedsChunkingSet{};
@@ -370,6 +374,8 @@ GeorefMetadataLayer::createH5valueDataSet(
 
     constexpr hsize_t kChunkSize = 100;
     h5createPropList.setChunk(1, &kChunkSize);
+    if (dataset.getDescriptor().isChecksummed())
+        h5createPropList.setFletcher32();
 
     // Create the DataSet using the above.
     const auto& h5file = dataset.getH5file();
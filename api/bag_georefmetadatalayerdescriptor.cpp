@@ -217,7 +217,7 @@ GeorefMetadataLayerDescriptor::getDefinition() const & noexcept
 \return
     The metadata profile type.
  */
-GeorefMetadataProfile GeorefMetadataLayerDescriptor::getProfile() {
+GeorefMetadataProfile GeorefMetadataLayerDescriptor::getProfile() const noexcept {
     return m_profile;
 }
 
@@ -49,7 +49,7 @@ public:
 
     std::weak_ptr<Dataset> getDataset() const &;
     const RecordDefinition& getDefinition() const & noexcept;
-    GeorefMetadataProfile getProfile();
+    GeorefMetadataProfile getProfile() const noexcept;
 
 protected:
     GeorefMetadataLayerDescriptor(Dataset& dataset, const std::string& name, GeorefMetadataProfile profile,
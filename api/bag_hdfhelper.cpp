@@ -2,6 +2,7 @@
 #include "bag_exceptions.h"
 #include "bag_hdfhelper.h"
 
+#include <algorithm>
 #include <array>
 #include <H5Cpp.h>
 #include <numeric>
@@ -130,6 +131,66 @@ namespace BAG {
     return h5type;
 }
 
+//! Create an HDF5 CompType of a TrackingItem in memory.
+/*!
+\return
+    The HDF5 CompType to be used when reading and writing tracking list items
+    from memory.
+*/
+::H5::CompType createH5trackingItemCompType()
+{
+    using value_type = TrackingItem;
+
+    const ::H5::CompType h5type{sizeof(value_type)};
+
+    h5type.insertMember("row", HOFFSET(value_type, row),
+        ::H5::PredType::NATIVE_UINT32);
+    h5type.insertMember("col", HOFFSET(value_type, col),
+        ::H5::PredType::NATIVE_UINT32);
+    h5type.insertMember("depth", HOFFSET(value_type, depth),
+        ::H5::PredType::NATIVE_FLOAT);
+    h5type.insertMember("uncertainty", HOFFSET(value_type, uncertainty),
+        ::H5::PredType::NATIVE_FLOAT);
+    h5type.insertMember("track_code", HOFFSET(value_type, track_code),
+        ::H5::PredType::NATIVE_UINT8);
+    h5type.insertMember("list_series", HOFFSET(value_type, list_series),
+        ::H5::PredType::NATIVE_INT16);
+
+    return h5type;
+}
+
+//! Create an HDF5 CompType of a VRTrackingItem in memory.
+/*!
+\return
+    The HDF5 CompType to be used when reading and writing variable resolution
+    tracking list items from memory.
+*/
+::H5::CompType createH5vrTrackingItemCompType()
+{
+    using value_type = VRTrackingItem;
+
+    const ::H5::CompType h5type{sizeof(value_type)};
+
+    h5type.insertMember("row", HOFFSET(value_type, row),
+        ::H5::PredType::NATIVE_UINT32);
+    h5type.insertMember("col", HOFFSET(value_type, col),
+        ::H5::PredType::NATIVE_UINT32);
+    h5type.insertMember("sub_row", HOFFSET(value_type, sub_row),
+        ::H5::PredType::NATIVE_UINT32);
+    h5type.insertMember("sub_col", HOFFSET(value_type, sub_col),
+        ::H5::PredType::NATIVE_UINT32);
+    h5type.insertMember("depth", HOFFSET(value_type, depth),
+        ::H5::PredType::NATIVE_FLOAT);
+    h5type.insertMember("uncertainty", HOFFSET(value_type, uncertainty),
+        ::H5::PredType::NATIVE_FLOAT);
+    h5type.insertMember("track_code", HOFFSET(value_type, track_code),
+        ::H5::PredType::NATIVE_UINT8);
+    h5type.insertMember("list_series", HOFFSET(value_type, list_series),
+        ::H5::PredType::NATIVE_UINT16);
+
+    return h5type;
+}
+
 //! Get the chunk size from an HDF5 file.
 /*!
 \param h5file
@@ -163,6 +224,38 @@ uint64_t getChunkSize(
     return 0;
 }
 
+//! Get the chunk length of a single row HDF5 DataSet from an HDF5 file.
+/*!
+    The variable resolution refinements and nodes are a single row of
+    records, so only the extent of a chunk along the row matters.
+
+\param h5file
+    The HDF5 file.
+\param path
+    The path to the HDF5 DataSet.
+
+\return
+    The number of records in a chunk of the specified HDF5 DataSet.
+    0 if the HDF5 DataSet does not use chunking.
+*/
+uint64_t getChunkLength(
+    const ::H5::H5File& h5file,
+    const std::string& path)
+{
+    const auto h5dataset = h5file.openDataSet(path);
+    const auto h5pList = h5dataset.getCreatePlist();
+
+    if (h5pList.getLayout() == H5D_CHUNKED)
+    {
+        std::array<hsize_t, kRank> maxDims{};
+
+        if (h5pList.getChunk(kRank, maxDims.data()) == kRank)
+            return static_cast<uint64_t>(maxDims[1]);
+    }
+
+    return 0;
+}
+
 //! Get the compression level from an HDF5 file.
 /*!
 \param h5file
@@ -217,6 +310,83 @@ size_t getRecordSize(
         });
 }
 
+//! Grow the extent of an extendible HDF5 DataSet to hold a size.
+/*!
+    Each dimension shorter than the size grows; with geometric growth it at
+    least doubles, so appending one item at a time extends the DataSet a
+    logarithmic number of times.  Dimensions already long enough are kept;
+    trimExtent() gives back what is left over.
+
+\param h5dataSet
+    The HDF5 DataSet.
+\param dims
+    The size the DataSet must hold, one value per dimension.
+\param geometric
+    True to grow at least twofold; false to grow to exactly the size.
+
+\return
+    True if the DataSet was extended.
+*/
+bool growExtent(
+    const ::H5::DataSet& h5dataSet,
+    const std::vector<uint64_t>& dims,
+    bool geometric)
+{
+    std::array<hsize_t, H5S_MAX_RANK> fileDims{};
+    const auto rank = h5dataSet.getSpace().getSimpleExtentDims(fileDims.data());
+    if (rank != static_cast<int>(dims.size()))
+        throw InvalidWriteSize{};
+
+    bool grow = false;
+    for (int i = 0; i < rank; ++i)
+    {
+        if (dims[i] <= fileDims[i])
+            continue;
+
+        fileDims[i] = geometric ? std::max<hsize_t>(dims[i], 2 * fileDims[i]) :
+            dims[i];
+        grow = true;
+    }
+
+    if (grow)
+        h5dataSet.extend(fileDims.data());
+
+    return grow;
+}
+
+//! Shrink the extent of an extendible HDF5 DataSet back to a size.
+/*!
+    Gives back the room grown by growExtent() beyond what was written.
+    Dimensions already no longer than the size are kept.
+
+\param h5dataSet
+    The HDF5 DataSet.
+\param dims
+    The size to keep, one value per dimension.
+*/
+void trimExtent(
+    const ::H5::DataSet& h5dataSet,
+    const std::vector<uint64_t>& dims)
+{
+    std::array<hsize_t, H5S_MAX_RANK> fileDims{};
+    const auto rank = h5dataSet.getSpace().getSimpleExtentDims(fileDims.data());
+    if (rank != static_cast<int>(dims.size()))
+        throw InvalidWriteSize{};
+
+    bool trim = false;
+    for (int i = 0; i < rank; ++i)
+    {
+        if (dims[i] >= fileDims[i])
+            continue;
+
+        fileDims[i] = dims[i];
+        trim = true;
+    }
+
+    if (trim)
+        h5dataSet.extend(fileDims.data());
+}
+
 //! Determine the HDF5 file DataType from the specified data type.
 /*!
 \param type
@@ -7,7 +7,9 @@
 #include "bag_types.h"
 #include "bag_valuetable.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 
 //! Forward declarations of HDF5 classes used, to avoid exposing dependencies
@@ -33,12 +35,25 @@ namespace BAG {
 
 ::H5::CompType createH5memoryCompType(const RecordDefinition& definition);
 
+::H5::CompType createH5trackingItemCompType();
+
+::H5::CompType createH5vrTrackingItemCompType();
+
 uint64_t getChunkSize(const ::H5::H5File& h5file,
     const std::string& path);
 
+uint64_t getChunkLength(const ::H5::H5File& h5file,
+    const std::string& path);
+
 int getCompressionLevel(const ::H5::H5File& h5file,
     const std::string& path);
 
+bool growExtent(const ::H5::DataSet& h5dataSet,
+    const std::vector<uint64_t>& dims, bool geometric);
+
+void trimExtent(const ::H5::DataSet& h5dataSet,
+    const std::vector<uint64_t>& dims);
+
 size_t getRecordSize(const RecordDefinition& definition);
 
 const ::H5::AtomType& getH5fileType(DataType type);
@@ -1,15 +1,217 @@
 
+#include "bag_chunkio.h"
 #include "bag_hdfhelper.h"
 #include "bag_interleavedlegacylayer.h"
 #include "bag_interleavedlegacylayerdescriptor.h"
 #include "bag_private.h"
 
+#include <algorithm>
 #include <array>
+#include <cstring>
 #include <H5Cpp.h>
+#include <list>
+#include <mutex>
+#include <vector>
 
 
 namespace BAG {
 
+namespace {
+
+//! The most windows a group keeps.
+constexpr size_t kMaxCachedWindows = 8;
+//! The most bytes of records a group keeps.
+constexpr size_t kMaxCachedBytes = 64 * 1024 * 1024;
+
+//! The layers stored in an interleaved group.
+std::vector<LayerType> getGroupLayerTypes(
+    GroupType groupType)
+{
+    if (groupType == NODE)
+        return {Hypothesis_Strength, Num_Hypotheses};
+
+    return {Shoal_Elevation, Std_Dev, Num_Soundings};
+}
+
+}  // namespace
+
+//! The windows most recently read from an interleaved group, holding every
+//! member of it.
+struct InterleavedLegacyLayer::GroupCache final
+{
+    //! A window of the group and its records.
+    struct Entry final
+    {
+        //! The window.
+        GridWindow window;
+        //! The records of the window, row by row.
+        std::vector<uint8_t> records;
+    };
+
+    //! A member of the records.
+    struct Member final
+    {
+        //! The layer stored in the member.
+        LayerType type = UNKNOWN_LAYER_TYPE;
+        //! The offset of the member in a record.
+        size_t offset = 0;
+        //! The size of the member.
+        size_t size = 0;
+    };
+
+    GroupCache(GroupType group, const ::H5::DataSet& h5dataSet);
+
+    const Entry& read(const ::H5::DataSet& h5dataSet, const GridWindow& window,
+        Entry& transient);
+    const Member* getMember(LayerType type) const noexcept;
+
+    //! The group.
+    GroupType groupType = UNKNOWN_GROUP_TYPE;
+    //! The type the records are read with; the members of the group in the
+    //! file, packed.
+    ::H5::CompType h5type;
+    //! The members of the records.
+    std::vector<Member> members;
+    //! The size of a record.
+    size_t recordSize = 0;
+    //! Guards the windows.
+    std::mutex mutex;
+    //! The windows, most recently used first.
+    std::list<Entry> entries;
+    //! The bytes held by the windows.
+    size_t numBytes = 0;
+};
+
+//! Constructor.
+/*!
+\param group
+    The group; NODE or ELEVATION.
+\param h5dataSet
+    The HDF5 DataSet of the group.
+*/
+InterleavedLegacyLayer::GroupCache::GroupCache(
+    GroupType group,
+    const ::H5::DataSet& h5dataSet)
+    : groupType(group)
+{
+    const auto h5fileType = h5dataSet.getCompType();
+
+    for (const auto type : getGroupLayerTypes(groupType))
+    {
+        const auto h5memberType = createH5compType(type, groupType);
+        const auto name = h5memberType.getMemberName(0);
+
+        // Only the members in the file can be read.
+        if (H5Tget_member_index(h5fileType.getId(), name.c_str()) < 0)
+            continue;
+
+        Member member;
+        member.type = type;
+        member.offset = recordSize;
+        member.size = h5memberType.getSize();
+        members.push_back(member);
+
+        recordSize += member.size;
+    }
+
+    h5type = ::H5::CompType{recordSize};
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+        const auto h5memberType = createH5compType(members[i].type, groupType);
+        h5type.insertMember(h5memberType.getMemberName(0), members[i].offset,
+            h5memberType.getMemberDataType(0));
+    }
+}
+
+//! Retrieve the records of a window, reading them if no cached window holds
+//! them.
+/*!
+    The caller must hold the mutex.
+
+\param h5dataSet
+    The HDF5 DataSet of the group.
+\param window
+    The window to read.
+\param transient
+    Holds the window when it is too large to cache.
+
+\return
+    A cached window holding the requested one, or the transient window.
+*/
+const InterleavedLegacyLayer::GroupCache::Entry&
+InterleavedLegacyLayer::GroupCache::read(
+    const ::H5::DataSet& h5dataSet,
+    const GridWindow& window,
+    Entry& transient)
+{
+    const auto found = std::find_if(entries.begin(), entries.end(),
+        [&window](const Entry& entry) {
+            return entry.window.rowStart <= window.rowStart &&
+                entry.window.columnStart <= window.columnStart &&
+                entry.window.rowEnd >= window.rowEnd &&
+                entry.window.columnEnd >= window.columnEnd;
+        });
+    if (found != entries.end())
+    {
+        entries.splice(entries.begin(), entries, found);
+        return entries.front();
+    }
+
+    const std::array<hsize_t, kRank> count{window.rows(), window.columns()};
+    const std::array<hsize_t, kRank> offset{window.rowStart,
+        window.columnStart};
+
+    const auto h5fileSpace = h5dataSet.getSpace();
+    h5fileSpace.selectHyperslab(H5S_SELECT_SET, count.data(), offset.data());
+
+    const ::H5::DataSpace h5memSpace{kRank, count.data(), count.data()};
+
+    Entry entry;
+    entry.window = window;
+    entry.records.resize(static_cast<size_t>(window.rows()) *
+        window.columns() * recordSize);
+    h5dataSet.read(entry.records.data(), h5type, h5memSpace, h5fileSpace);
+
+    // A window too large to cache is only lent to the caller.
+    if (entry.records.size() > kMaxCachedBytes)
+    {
+        transient = std::move(entry);
+        return transient;
+    }
+
+    // Make room for the newest window.
+    numBytes += entry.records.size();
+    entries.push_front(std::move(entry));
+
+    while (entries.size() > kMaxCachedWindows || numBytes > kMaxCachedBytes)
+    {
+        numBytes -= entries.back().records.size();
+        entries.pop_back();
+    }
+
+    return entries.front();
+}
+
+//! Find the member storing a layer.
+/*!
+\param type
+    The layer type.
+
+\return
+    The member; nullptr if the group in the file does not store the layer.
+*/
+const InterleavedLegacyLayer::GroupCache::Member*
+InterleavedLegacyLayer::GroupCache::getMember(
+    LayerType type) const noexcept
+{
+    const auto found = std::find_if(members.begin(), members.end(),
+        [type](const Member& member) {
+            return member.type == type;
+        });
+
+    return found == members.end() ? nullptr : &*found;
+}
+
 //! Constructor
 /*
 \param dataset
@@ -25,6 +227,8 @@ InterleavedLegacyLayer::InterleavedLegacyLayer(
     std::unique_ptr<::H5::DataSet, DeleteH5dataSet> pH5dataSet)
     : Layer(dataset, descriptor)
     , m_pH5dataSet(std::move(pH5dataSet))
+    , m_pGroupCache(std::make_shared<GroupCache>(descriptor.getGroupType(),
+        *m_pH5dataSet))
 {
 }
 
@@ -55,8 +259,23 @@ std::shared_ptr<InterleavedLegacyLayer> InterleavedLegacyLayer::open(
     h5dataSet->getSpace().getSimpleExtentDims(dims.data(), nullptr);
     descriptor.setDims(dims[0], dims[1]);
 
-    return std::make_shared<InterleavedLegacyLayer>(dataset,
+    auto pLayer = std::make_shared<InterleavedLegacyLayer>(dataset,
         descriptor, std::move(h5dataSet));
+
+    // Share the windows read with the layers already open from the group.
+    for (const auto& pOther : dataset.getLayers())
+    {
+        const auto pSibling =
+            std::dynamic_pointer_cast<const InterleavedLegacyLayer>(pOther);
+        if (pSibling &&
+            pSibling->m_pGroupCache->groupType == descriptor.getGroupType())
+        {
+            pLayer->m_pGroupCache = pSibling->m_pGroupCache;
+            break;
+        }
+    }
+
+    return pLayer;
 }
 
 
@@ -73,27 +292,43 @@ UInt8Array InterleavedLegacyLayer::readProxy(
     if (!pDescriptor)
         throw InvalidDescriptor{};
 
+    const auto pMember = m_pGroupCache->getMember(pDescriptor->getLayerType());
+    if (!pMember)
+        throw UnsupportedLayerType{};
+
     const auto rows = (rowEnd - rowStart) + 1;
     const auto columns = (columnEnd - columnStart) + 1;
-    const std::array<hsize_t, kRank> count{rows, columns};
-    const std::array<hsize_t, kRank> offset{rowStart, columnStart};
-
-    // Query the file for the specified rows and columns.
-    const auto h5fileSpace = m_pH5dataSet->getSpace();
-    h5fileSpace.selectHyperslab(H5S_SELECT_SET, count.data(), offset.data());
 
     // Initialize the output buffer.
     const auto bufferSize = pDescriptor->getReadBufferSize(rows, columns);
     UInt8Array buffer{bufferSize};
 
-    // Prepare the memory space.
-    const ::H5::DataSpace h5memSpace{kRank, count.data(), count.data()};
+    // The records of every member of the group are read once, and kept for
+    // the other layers of it.
+    std::lock_guard<std::mutex> lock{m_pGroupCache->mutex};
+
+    GroupCache::Entry transient;
+    const auto& entry = m_pGroupCache->read(*m_pH5dataSet,
+        {rowStart, columnStart, rowEnd, columnEnd}, transient);
+
+    const auto recordSize = m_pGroupCache->recordSize;
+    const auto entryColumns = entry.window.columns();
+    auto* out = buffer.data();
 
-    // Set up the type.
-    const auto h5dataType = createH5compType(pDescriptor->getLayerType(),
-        pDescriptor->getGroupType());
+    for (uint32_t row = rowStart; row <= rowEnd; ++row)
+    {
+        const auto* record = entry.records.data() +
+            ((static_cast<size_t>(row - entry.window.rowStart) * entryColumns) +
+            (columnStart - entry.window.columnStart)) * recordSize +
+            pMember->offset;
 
-    m_pH5dataSet->read(buffer.data(), h5dataType, h5memSpace, h5fileSpace);
+        for (uint32_t column = 0; column < columns; ++column)
+        {
+            std::memcpy(out, record, pMember->size);
+            out += pMember->size;
+            record += recordSize;
+        }
+    }
 
     return buffer;
 }
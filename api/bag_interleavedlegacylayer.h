@@ -31,6 +31,11 @@ namespace BAG {
     the group.
     The NODE group is made of Hypothesis_Strength and Num_Hypotheses.
     The ELEVATION group is made of Shoal_Elevation, Std_Dev and Num_Soundings.
+
+    The layers of a group share a small cache of the windows most recently
+    read from it, holding every member of the group.  Reading a window of
+    each layer of a group, or a window inside one already read, reads the
+    group once.
 */
 class BAG_API InterleavedLegacyLayer final : public Layer
 {
@@ -66,8 +71,12 @@ private:
 
     void writeAttributesProxy() const override;
 
+    struct GroupCache;
+
     //! The HDF5 DataSet.
     std::unique_ptr<H5::DataSet, DeleteH5dataSet> m_pH5dataSet;
+    //! The windows read from the group, shared with the other layers of it.
+    std::shared_ptr<GroupCache> m_pGroupCache;
 
     friend Dataset;
 };
@@ -53,12 +53,12 @@ public:
 
     void writeAttributes() const;
 
-protected:
-    Layer(Dataset& dataset, LayerDescriptor& descriptor);
-
     std::weak_ptr<Dataset> getDataset() & noexcept;
     std::weak_ptr<const Dataset> getDataset() const & noexcept;
 
+protected:
+    Layer(Dataset& dataset, LayerDescriptor& descriptor);
+
 private:
     virtual UInt8Array readProxy(uint32_t rowStart,
         uint32_t columnStart, uint32_t rowEnd, uint32_t columnEnd) const = 0;
@@ -243,6 +243,20 @@ LayerDescriptor& LayerDescriptor::setInternalPath(std::string inPath) & noexcept
     return *this;
 }
 
+//! Set the chunk size of the layer.
+/*!
+\param chunkSize
+    The new chunk size of the layer.
+
+\return
+    The descriptor.  Useful for chaining set calls.
+*/
+LayerDescriptor& LayerDescriptor::setChunkSize(uint64_t chunkSize) & noexcept
+{
+    m_chunkSize = chunkSize;
+    return *this;
+}
+
 //! Set the name of the layer.
 /*!
 \param inName
@@ -70,6 +70,7 @@ protected:
     size_t getReadBufferSize(uint64_t rows, uint64_t columns) const noexcept;
 
     LayerDescriptor& setInternalPath(std::string inPath) & noexcept;
+    LayerDescriptor& setChunkSize(uint64_t chunkSize) & noexcept;
 
 private:
     virtual DataType getDataTypeProxy() const noexcept = 0;
@@ -0,0 +1,427 @@
+
+#include "bag_chunkio.h"
+#include "bag_dataset.h"
+#include "bag_exceptions.h"
+#include "bag_layerdescriptor.h"
+#include "bag_merge.h"
+#include "bag_metadata.h"
+#include "bag_metadata_export.h"
+#include "bag_parallel.h"
+#include "bag_simplelayer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+
+namespace BAG {
+
+namespace {
+
+//! How far, in cells, an origin may be from the output grid and still align.
+constexpr double kAlignmentTolerance = 1e-6;
+
+//! Where an input sits in the output grid.
+struct Placement final
+{
+    //! The input.
+    std::shared_ptr<const Dataset> pDataset;
+    //! The cells of the output grid the input covers.
+    GridWindow window;
+};
+
+//! Determine if two resolutions are the same.
+bool sameResolution(double lhs, double rhs) noexcept
+{
+    return std::abs(lhs - rhs) <= 1e-9 * std::max(std::abs(lhs), std::abs(rhs));
+}
+
+//! Find the whole number of cells between two origins.
+/*!
+\param from
+    The origin of the output grid.
+\param to
+    The origin of the input grid.
+\param resolution
+    The size of a cell.
+
+\return
+    The number of cells from \e from to \e to.
+*/
+uint32_t cellOffset(
+    double from,
+    double to,
+    double resolution)
+{
+    const double cells = (to - from) / resolution;
+    const double rounded = std::round(cells);
+
+    if (std::abs(cells - rounded) > kAlignmentTolerance)
+        throw IncompatibleGrids{};
+
+    return static_cast<uint32_t>(rounded);
+}
+
+//! The accumulated values of one output chunk.
+/*!
+    Inputs are combined into this one at a time, in priority order.
+*/
+class ChunkMerger final
+{
+public:
+    ChunkMerger(MergeRule rule, const GridWindow& window)
+        : m_rule(rule)
+        , m_window(window)
+        , m_elevations(static_cast<size_t>(window.rows()) * window.columns(),
+            BAG_NULL_ELEVATION)
+        , m_uncertainties(m_elevations.size(), BAG_NULL_UNCERTAINTY)
+        , m_numEmpty(m_elevations.size())
+    {
+        if (m_rule == MergeRule::UncertaintyWeighted)
+        {
+            m_sumWeights.resize(m_elevations.size(), 0.);
+            m_sumWeighted.resize(m_elevations.size(), 0.);
+            m_sumElevations.resize(m_elevations.size(), 0.);
+            m_counts.resize(m_elevations.size(), 0);
+            m_unweighted.resize(m_elevations.size(), false);
+        }
+    }
+
+    //! Is every cell filled, so lower priority inputs cannot change it?
+    bool isComplete() const noexcept
+    {
+        return m_rule == MergeRule::Priority && m_numEmpty == 0;
+    }
+
+    void add(const GridWindow& overlap, const float* elevations,
+        const float* uncertainties) noexcept;
+    void finish() noexcept;
+
+    //! The merged elevations of the chunk window.
+    const std::vector<float>& getElevations() const & noexcept
+    {
+        return m_elevations;
+    }
+    //! The merged uncertainties of the chunk window.
+    const std::vector<float>& getUncertainties() const & noexcept
+    {
+        return m_uncertainties;
+    }
+
+private:
+    //! The rule combining the inputs.
+    MergeRule m_rule = MergeRule::Priority;
+    //! The chunk window, in output cells.
+    GridWindow m_window;
+    //! The elevations.
+    std::vector<float> m_elevations;
+    //! The uncertainties.
+    std::vector<float> m_uncertainties;
+    //! The number of cells without an elevation yet.
+    size_t m_numEmpty = 0;
+    //! The sum of the weights (UncertaintyWeighted only).
+    std::vector<double> m_sumWeights;
+    //! The sum of the weighted elevations (UncertaintyWeighted only).
+    std::vector<double> m_sumWeighted;
+    //! The sum of the elevations (UncertaintyWeighted only).
+    std::vector<double> m_sumElevations;
+    //! The number of elevations (UncertaintyWeighted only).
+    std::vector<uint32_t> m_counts;
+    //! Did an elevation without an uncertainty contribute?
+    std::vector<bool> m_unweighted;
+};
+
+//! Combine the values of one input.
+/*!
+\param overlap
+    The cells, in output grid coordinates, the input provides.
+\param elevations
+    The input elevations of the overlap, row major.
+\param uncertainties
+    The input uncertainties of the overlap, row major.
+*/
+void ChunkMerger::add(
+    const GridWindow& overlap,
+    const float* elevations,
+    const float* uncertainties) noexcept
+{
+    for (uint32_t row = overlap.rowStart; row <= overlap.rowEnd; ++row)
+    {
+        const size_t source = static_cast<size_t>(row - overlap.rowStart) *
+            overlap.columns();
+        const size_t target = static_cast<size_t>(row - m_window.rowStart) *
+            m_window.columns() + (overlap.columnStart - m_window.columnStart);
+
+        for (uint32_t column = 0; column < overlap.columns(); ++column)
+        {
+            const float elevation = elevations[source + column];
+            if (!ValueRange::isValid(elevation))
+                continue;
+
+            const float uncertainty = uncertainties[source + column];
+            const size_t cell = target + column;
+            const bool empty = !ValueRange::isValid(m_elevations[cell]);
+
+            switch (m_rule)
+            {
+            case MergeRule::Priority:
+                if (!empty)
+                    continue;
+                break;
+            case MergeRule::Shoalest:
+                if (!empty && elevation <= m_elevations[cell])
+                    continue;
+                break;
+            case MergeRule::UncertaintyWeighted:
+                if (ValueRange::isValid(uncertainty) && uncertainty > 0.f)
+                {
+                    const double weight = 1. / (static_cast<double>(uncertainty) *
+                        uncertainty);
+                    m_sumWeights[cell] += weight;
+                    m_sumWeighted[cell] += weight * elevation;
+                }
+                else
+                    m_unweighted[cell] = true;
+
+                m_sumElevations[cell] += elevation;
+                ++m_counts[cell];
+                break;
+            }
+
+            if (empty)
+                --m_numEmpty;
+
+            m_elevations[cell] = elevation;
+            m_uncertainties[cell] = uncertainty;
+        }
+    }
+}
+
+//! Finish combining the inputs.
+/*!
+    Forms the weighted means; without an uncertainty for every contribution
+    to a cell, the plain mean is used and the cell has no uncertainty.
+*/
+void ChunkMerger::finish() noexcept
+{
+    if (m_rule != MergeRule::UncertaintyWeighted)
+        return;
+
+    for (size_t cell = 0; cell < m_elevations.size(); ++cell)
+    {
+        if (m_counts[cell] < 2 && !m_unweighted[cell])
+            continue;  // Nothing or a single value with its uncertainty.
+
+        if (m_unweighted[cell])
+        {
+            m_elevations[cell] = static_cast<float>(m_sumElevations[cell] /
+                m_counts[cell]);
+            m_uncertainties[cell] = m_counts[cell] == 1 ?
+                m_uncertainties[cell] : BAG_NULL_UNCERTAINTY;
+        }
+        else
+        {
+            m_elevations[cell] = static_cast<float>(m_sumWeighted[cell] /
+                m_sumWeights[cell]);
+            m_uncertainties[cell] = static_cast<float>(
+                std::sqrt(1. / m_sumWeights[cell]));
+        }
+    }
+}
+
+}  // namespace
+
+//! Merge several BAGs into a new one.
+/*!
+\param inputs
+    The BAGs to merge, highest priority first.
+\param outFileName
+    The name of the BAG to create.
+\param rule
+    How cells covered by more than one input are combined.
+\param chunkSize
+    The chunk size of the output layers.
+\param compressionLevel
+    The compression level of the output layers.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The merged BAG, open for writing.
+*/
+std::shared_ptr<Dataset> Merger::merge(
+    const std::vector<std::shared_ptr<const Dataset>>& inputs,
+    const std::string& outFileName,
+    MergeRule rule,
+    uint64_t chunkSize,
+    int compressionLevel,
+    unsigned int numThreads)
+{
+    if (inputs.empty() || std::any_of(inputs.begin(), inputs.end(),
+            [](const std::shared_ptr<const Dataset>& pDataset) {
+                return !pDataset;
+            }))
+        throw DatasetNotFound{};
+
+    // Check the inputs are on the same grid, and find the lower left corner
+    // and geographic extent of all.
+    const auto& first = inputs.front()->getMetadata();
+    const auto wkt = first.horizontalReferenceSystemAsWKT();
+
+    double llCornerX = first.llCornerX();
+    double llCornerY = first.llCornerY();
+
+    const auto& firstIdentification = *first.getStruct().identificationInfo;
+    double west = firstIdentification.westBoundingLongitude;
+    double east = firstIdentification.eastBoundingLongitude;
+    double south = firstIdentification.southBoundingLatitude;
+    double north = firstIdentification.northBoundingLatitude;
+
+    for (const auto& pDataset : inputs)
+    {
+        const auto& metadata = pDataset->getMetadata();
+
+        if (metadata.horizontalReferenceSystemAsWKT() != wkt ||
+            !sameResolution(metadata.rowResolution(), first.rowResolution()) ||
+            !sameResolution(metadata.columnResolution(),
+                first.columnResolution()))
+            throw IncompatibleGrids{};
+
+        if (!pDataset->getSimpleLayer(Elevation) ||
+            !pDataset->getSimpleLayer(Uncertainty))
+            throw LayerNotFound{};
+
+        llCornerX = std::min(llCornerX, metadata.llCornerX());
+        llCornerY = std::min(llCornerY, metadata.llCornerY());
+
+        const auto& identification = *metadata.getStruct().identificationInfo;
+        west = std::min(west, identification.westBoundingLongitude);
+        east = std::max(east, identification.eastBoundingLongitude);
+        south = std::min(south, identification.southBoundingLatitude);
+        north = std::max(north, identification.northBoundingLatitude);
+    }
+
+    // Place each input in the output grid.
+    std::vector<Placement> placements;
+    placements.reserve(inputs.size());
+
+    uint32_t rows = 0;
+    uint32_t columns = 0;
+
+    for (const auto& pDataset : inputs)
+    {
+        const auto& metadata = pDataset->getMetadata();
+
+        const auto rowStart = cellOffset(llCornerY, metadata.llCornerY(),
+            first.rowResolution());
+        const auto columnStart = cellOffset(llCornerX, metadata.llCornerX(),
+            first.columnResolution());
+
+        const GridWindow window{rowStart, columnStart,
+            rowStart + metadata.rows() - 1, columnStart + metadata.columns() - 1};
+
+        rows = std::max(rows, window.rowEnd + 1);
+        columns = std::max(columns, window.columnEnd + 1);
+
+        placements.push_back({pDataset, window});
+    }
+
+    // Create the output, described by the first input's metadata.
+    Metadata metadata;
+    metadata.loadFromBuffer(exportMetadataToXML(first.getStruct()));
+    metadata.setGridExtent(rows, columns, llCornerX, llCornerY);
+    metadata.setGeographicExtent(west, east, south, north);
+
+    auto pOutput = Dataset::create(outFileName, std::move(metadata), chunkSize,
+        compressionLevel);
+
+    ChunkedDataSet outElevation{pOutput->getH5file(),
+        Layer::getInternalPath(Elevation)};
+    ChunkedDataSet outUncertainty{pOutput->getH5file(),
+        Layer::getInternalPath(Uncertainty)};
+
+    std::vector<std::unique_ptr<const ChunkedDataSet>> inElevations;
+    std::vector<std::unique_ptr<const ChunkedDataSet>> inUncertainties;
+
+    for (const auto& placement : placements)
+    {
+        const auto& h5file = placement.pDataset->getH5file();
+
+        inElevations.emplace_back(new ChunkedDataSet{h5file,
+            Layer::getInternalPath(Elevation)});
+        inUncertainties.emplace_back(new ChunkedDataSet{h5file,
+            Layer::getInternalPath(Uncertainty)});
+
+        if (inElevations.back()->getElementSize() != sizeof(float) ||
+            inUncertainties.back()->getElementSize() != sizeof(float))
+            throw UnsupportedElementSize{};
+    }
+
+    // Merge one output chunk at a time.
+    ValueRange elevationRange;
+    ValueRange uncertaintyRange;
+    std::mutex rangeMutex;
+
+    parallelFor(outElevation.getNumChunks(), numThreads, [&](size_t chunkIndex) {
+        const auto window = outElevation.getChunkWindow(chunkIndex);
+        ChunkMerger merger{rule, window};
+
+        for (size_t i = 0; i < placements.size() && !merger.isComplete(); ++i)
+        {
+            const auto& placement = placements[i].window;
+            if (!window.intersects(placement))
+                continue;
+
+            const auto overlap = window.intersection(placement);
+            const GridWindow source{overlap.rowStart - placement.rowStart,
+                overlap.columnStart - placement.columnStart,
+                overlap.rowEnd - placement.rowStart,
+                overlap.columnEnd - placement.columnStart};
+
+            const auto elevations = inElevations[i]->read(source);
+            const auto uncertainties = inUncertainties[i]->read(source);
+
+            merger.add(overlap,
+                reinterpret_cast<const float*>(elevations.data()),
+                reinterpret_cast<const float*>(uncertainties.data()));
+        }
+
+        merger.finish();
+
+        ValueRange chunkElevationRange;
+        for (const float value : merger.getElevations())
+            chunkElevationRange.add(value);
+
+        ValueRange chunkUncertaintyRange;
+        for (const float value : merger.getUncertainties())
+            chunkUncertaintyRange.add(value);
+
+        outElevation.writeChunk(chunkIndex,
+            reinterpret_cast<const uint8_t*>(merger.getElevations().data()));
+        outUncertainty.writeChunk(chunkIndex,
+            reinterpret_cast<const uint8_t*>(merger.getUncertainties().data()));
+
+        std::lock_guard<std::mutex> lock{rangeMutex};
+        elevationRange.merge(chunkElevationRange);
+        uncertaintyRange.merge(chunkUncertaintyRange);
+    });
+
+    // Record the range of the merged values.
+    for (const auto& layerRange : {std::make_pair(Elevation, elevationRange),
+            std::make_pair(Uncertainty, uncertaintyRange)})
+    {
+        if (layerRange.second.empty())
+            continue;
+
+        auto pLayer = pOutput->getSimpleLayer(layerRange.first);
+        pLayer->getDescriptor()->setMinMax(layerRange.second.min,
+            layerRange.second.max);
+        pLayer->writeAttributes();
+    }
+
+    return pOutput;
+}
+
+}  // namespace BAG
+
@@ -0,0 +1,61 @@
+#ifndef BAG_MERGE_H
+#define BAG_MERGE_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace BAG {
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)  // std classes do not have DLL-interface when exporting
+#endif
+
+//! How overlapping cells are combined when merging BAGs.
+enum class MergeRule
+{
+    //! The first input (in the order given) holding data wins.
+    Priority,
+    //! The shoalest (highest) elevation wins.
+    Shoalest,
+    //! Elevations are averaged, weighted by the inverse of their variance.
+    UncertaintyWeighted,
+};
+
+//! Merge (mosaic) several BAGs into one.
+/*!
+    The inputs must share a coordinate reference system, resolution and grid
+    alignment.  The output grid covers all the inputs, and its metadata is
+    that of the first input, moved to the new extent.
+
+    The output is produced one chunk at a time across threads.  Each output
+    chunk reads only the windows of the inputs it overlaps, one input at a
+    time, so memory depends on the chunk size and thread count, not on the
+    number of inputs.
+
+    Only the mandatory elevation and uncertainty layers are merged.
+*/
+class BAG_API Merger final
+{
+public:
+    static std::shared_ptr<Dataset> merge(
+        const std::vector<std::shared_ptr<const Dataset>>& inputs,
+        const std::string& outFileName, MergeRule rule = MergeRule::Priority,
+        uint64_t chunkSize = 100, int compressionLevel = 5,
+        unsigned int numThreads = 0);
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+}  // namespace BAG
+
+#endif  // BAG_MERGE_H
+
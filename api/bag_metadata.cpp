@@ -121,6 +121,8 @@ void Metadata::createH5dataSet(
 
     const ::H5::DSetCreatPropList h5createPropList{};
     h5createPropList.setChunk(1, &kMetadataChunkSize);
+    if (dataset.getDescriptor().isChecksummed())
+        h5createPropList.setFletcher32();
 
     m_pH5dataSet = std::unique_ptr<::H5::DataSet, DeleteH5dataSet>(
         new ::H5::DataSet{h5file.createDataSet(METADATA_PATH,
@@ -240,6 +242,116 @@ void Metadata::loadFromBuffer(const std::string& xmlBuffer)
     m_xmlLength = xmlBuffer.size();
 }
 
+//! Move the grid the metadata describes, keeping its resolution.
+/*!
+    Used to describe a sub-grid or a mosaic of grids before creating a new
+    BAG.  The geographic extent is scaled linearly with the projected extent,
+    which is close for the small areas involved; use setGeographicExtent()
+    when the exact bounds are known.
+
+\param rows
+    The new number of rows.
+\param columns
+    The new number of columns.
+\param llCornerX
+    The X of the lower left cell.
+\param llCornerY
+    The Y of the lower left cell.
+*/
+void Metadata::setGridExtent(
+    uint32_t rows,
+    uint32_t columns,
+    double llCornerX,
+    double llCornerY) noexcept
+{
+    auto& spatial = *m_pMetaStruct->spatialRepresentationInfo;
+    auto& identification = *m_pMetaStruct->identificationInfo;
+
+    const double urCornerX = llCornerX + (columns - 1) * spatial.columnResolution;
+    const double urCornerY = llCornerY + (rows - 1) * spatial.rowResolution;
+
+    const double width = spatial.urCornerX - spatial.llCornerX;
+    if (width > 0.)
+    {
+        const double west = identification.westBoundingLongitude;
+        const double east = identification.eastBoundingLongitude;
+        const double perUnit = (east - west) / width;
+
+        identification.westBoundingLongitude = west +
+            (llCornerX - spatial.llCornerX) * perUnit;
+        identification.eastBoundingLongitude = west +
+            (urCornerX - spatial.llCornerX) * perUnit;
+    }
+
+    const double height = spatial.urCornerY - spatial.llCornerY;
+    if (height > 0.)
+    {
+        const double south = identification.southBoundingLatitude;
+        const double north = identification.northBoundingLatitude;
+        const double perUnit = (north - south) / height;
+
+        identification.southBoundingLatitude = south +
+            (llCornerY - spatial.llCornerY) * perUnit;
+        identification.northBoundingLatitude = south +
+            (urCornerY - spatial.llCornerY) * perUnit;
+    }
+
+    spatial.numberOfRows = rows;
+    spatial.numberOfColumns = columns;
+    spatial.llCornerX = llCornerX;
+    spatial.llCornerY = llCornerY;
+    spatial.urCornerX = urCornerX;
+    spatial.urCornerY = urCornerY;
+}
+
+//! Set the geographic bounding box.
+/*!
+\param westLongitude
+    The west bounding longitude.
+\param eastLongitude
+    The east bounding longitude.
+\param southLatitude
+    The south bounding latitude.
+\param northLatitude
+    The north bounding latitude.
+*/
+void Metadata::setGeographicExtent(
+    double westLongitude,
+    double eastLongitude,
+    double southLatitude,
+    double northLatitude) noexcept
+{
+    auto& identification = *m_pMetaStruct->identificationInfo;
+
+    identification.westBoundingLongitude = westLongitude;
+    identification.eastBoundingLongitude = eastLongitude;
+    identification.southBoundingLatitude = southLatitude;
+    identification.northBoundingLatitude = northLatitude;
+}
+
+//! Set the distance between the nodes of the grid.
+/*!
+    The lower left corner is kept; set the grid extent afterwards to move it.
+
+\param rowResolution
+    The distance between rows.
+\param columnResolution
+    The distance between columns.
+*/
+void Metadata::setResolution(
+    double rowResolution,
+    double columnResolution) noexcept
+{
+    auto& spatial = *m_pMetaStruct->spatialRepresentationInfo;
+
+    spatial.rowResolution = rowResolution;
+    spatial.columnResolution = columnResolution;
+    spatial.urCornerX = spatial.llCornerX +
+        (spatial.numberOfColumns - 1) * columnResolution;
+    spatial.urCornerY = spatial.llCornerY +
+        (spatial.numberOfRows - 1) * rowResolution;
+}
+
 //! Retrieve the row resolution.
 /*!
 \return
@@ -0,0 +1,16 @@
+
+#include "bag_parallel.h"
+
+
+namespace BAG {
+
+//! \copydoc getHdf5Mutex
+std::mutex& getHdf5Mutex() noexcept
+{
+    static std::mutex hdf5Mutex;
+
+    return hdf5Mutex;
+}
+
+}  // namespace BAG
+
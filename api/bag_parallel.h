@@ -0,0 +1,182 @@
+#ifndef BAG_PARALLEL_H
+#define BAG_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace BAG {
+
+//! Retrieve the mutex guarding HDF5 calls made from worker threads.
+/*!
+    HDF5 is not guaranteed to be built thread-safe, so every HDF5 call made
+    while worker threads are running must hold this mutex.  Work that does not
+    touch HDF5 (decompression, checksums, statistics) runs without it.
+
+\return
+    The process wide HDF5 mutex.
+*/
+std::mutex& getHdf5Mutex() noexcept;
+
+//! Determine how many worker threads to use.
+/*!
+\param numThreads
+    The number of threads requested.  Zero selects the hardware concurrency.
+\param numTasks
+    The number of tasks to be processed.
+
+\return
+    The number of threads to use; at least one, and never more than the
+    number of tasks.
+*/
+inline unsigned int getNumThreads(
+    unsigned int numThreads,
+    size_t numTasks) noexcept
+{
+    if (numThreads == 0)
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    if (numTasks < numThreads)
+        numThreads = static_cast<unsigned int>(std::max<size_t>(numTasks, 1));
+
+    return numThreads;
+}
+
+//! Run a function over a range of task indices using a pool of threads.
+/*!
+    Tasks are handed out one at a time from a shared counter, so uneven tasks
+    (sparse versus dense chunks) balance across the threads.  The calling
+    thread takes part in the work.  The first exception thrown by a task stops
+    the hand out of further tasks and is rethrown once all threads finish.
+
+\param numTasks
+    The number of tasks; \e func is called with every index in [0, numTasks).
+\param numThreads
+    The number of threads requested.  Zero selects the hardware concurrency.
+\param func
+    The function to call; it receives the task index.
+*/
+template <typename Func>
+void parallelFor(
+    size_t numTasks,
+    unsigned int numThreads,
+    Func&& func)
+{
+    numThreads = getNumThreads(numThreads, numTasks);
+
+    if (numThreads == 1)
+    {
+        for (size_t task = 0; task < numTasks; ++task)
+            func(task);
+
+        return;
+    }
+
+    std::atomic<size_t> nextTask{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr firstError;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        while (!failed)
+        {
+            const size_t task = nextTask++;
+            if (task >= numTasks)
+                break;
+
+            try
+            {
+                func(task);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock{errorMutex};
+
+                if (!firstError)
+                    firstError = std::current_exception();
+
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+
+    for (unsigned int i = 1; i < numThreads; ++i)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    if (firstError)
+        std::rethrow_exception(firstError);
+}
+
+//! Sort a range using a pool of threads.
+/*!
+    The range is cut into one piece per thread; the pieces are sorted in
+    parallel, then merged pairwise in rounds, the merges of a round also in
+    parallel.  Small ranges are sorted on the calling thread.  Like std::sort,
+    the sort is not stable.
+
+\param first
+    The start of the range.
+\param last
+    One past the end of the range.
+\param less
+    The strict weak ordering to sort by.
+\param numThreads
+    The number of threads requested.  Zero selects the hardware concurrency.
+*/
+template <typename RandomIt, typename Less>
+void parallelSort(
+    RandomIt first,
+    RandomIt last,
+    Less less,
+    unsigned int numThreads)
+{
+    // Pieces smaller than this are not worth a thread.
+    constexpr size_t kMinPieceSize = 16384;
+
+    const size_t size = static_cast<size_t>(last - first);
+    const size_t numPieces = getNumThreads(numThreads, size / kMinPieceSize);
+
+    if (numPieces <= 1)
+    {
+        std::sort(first, last, less);
+        return;
+    }
+
+    std::vector<size_t> bounds(numPieces + 1);
+    for (size_t piece = 0; piece <= numPieces; ++piece)
+        bounds[piece] = size * piece / numPieces;
+
+    parallelFor(numPieces, numThreads, [&](size_t piece) {
+        std::sort(first + bounds[piece], first + bounds[piece + 1], less);
+    });
+
+    for (size_t width = 1; width < numPieces; width *= 2)
+        parallelFor((numPieces + 2 * width - 1) / (2 * width), numThreads,
+            [&](size_t task) {
+                const size_t lower = task * 2 * width;
+                const size_t middle = std::min(lower + width, numPieces);
+                const size_t upper = std::min(lower + 2 * width, numPieces);
+
+                if (middle < upper)
+                    std::inplace_merge(first + bounds[lower],
+                        first + bounds[middle], first + bounds[upper], less);
+            });
+}
+
+}  // namespace BAG
+
+#endif  // BAG_PARALLEL_H
+
@@ -19,6 +19,33 @@ namespace BAG
 //! The maximum compression level supported by HDF5.
 constexpr int kMaxCompressionLevel = 9;
 
+//! The most records in a chunk of the variable resolution refinements or
+//! nodes; longer chunks make reading a few supercells decode more than it
+//! needs.
+constexpr uint64_t kMaxVRChunkLength = 1024;
+
+//! The number of records in a chunk of the variable resolution refinements
+//! or nodes.
+/*!
+    The refinements and nodes are a single row, so they are chunked along it
+    only.  A chunk holds as many records as a chunk of the grid holds cells,
+    up to kMaxVRChunkLength.
+
+\param chunkSize
+    The chunk size of the grid.
+
+\return
+    The number of records in a chunk; 0 if chunkSize is 0.
+*/
+inline uint64_t getVRChunkLength(
+    uint64_t chunkSize) noexcept
+{
+    if (chunkSize > 0 && chunkSize > kMaxVRChunkLength / chunkSize)
+        return kMaxVRChunkLength;
+
+    return chunkSize * chunkSize;
+}
+
 //! Path names for BAG entities
 #define ROOT_PATH                       "/BAG_root"
 #define METADATA_PATH                   ROOT_PATH "/metadata"
@@ -38,6 +65,7 @@ constexpr int kMaxCompressionLevel = 9;
 #define STANDARD_DEV_PATH	            ROOT_PATH "/standard_dev"
 #define NUM_SOUNDINGS_PATH              ROOT_PATH "/num_soundings"
 #define GEOREF_METADATA_PATH            ROOT_PATH "/georef_metadata/"
+#define COVERAGE_PATH                   ROOT_PATH "/coverage_mask"
 
 //! Path names for optional VR BAG entities
 #define VR_TRACKING_LIST_PATH           ROOT_PATH "/varres_tracking_list"
@@ -68,6 +96,8 @@ constexpr int kMaxCompressionLevel = 9;
 #define MAX_AVERAGE                     "max_value"                  /*!< Name for max average attribute value */
 
 #define TRACKING_LIST_LENGTH_NAME       "Tracking List Length"       /*!< Name for the tracking list length attribute */
+#define TRACKING_LIST_SORT_ORDER_NAME   "Tracking List Sort Order"   /*!< Name for the tracking list sort order attribute */
+#define TRACKING_LIST_REORDERED_NAME    "Tracking List Reordered"    /*!< Name for the tracking list reordered attribute */
 
 #define VERT_DATUM_CORR_NSX             "Node Spacing X"             /*!<Name for the node spacing X attribute for vert datum set */
 #define VERT_DATUM_CORR_NSY             "Node Spacing Y"             /*!<Name for the node spacing Y attribute for vert datum set */
@@ -106,6 +136,8 @@ constexpr int kMaxCompressionLevel = 9;
 #define VR_NODE_MAX_N_SAMPLES           "max_n_samples"
 
 #define VR_TRACKING_LIST_LENGTH_NAME    "VR Tracking List Length"
+#define VR_TRACKING_LIST_SORT_ORDER_NAME "VR Tracking List Sort Order"
+#define VR_TRACKING_LIST_REORDERED_NAME "VR Tracking List Reordered"
 
 }  // namespace BAG
 
@@ -0,0 +1,518 @@
+#include "bag_chunkio.h"
+#include "bag_dataset.h"
+#include "bag_exceptions.h"
+#include "bag_parallel.h"
+#include "bag_private.h"
+#include "bag_repack.h"
+
+#include <algorithm>
+#include <array>
+#include <H5Cpp.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace BAG {
+
+namespace {
+
+//! The settings and results of the structure pass of a repack.
+struct CopyContext final
+{
+    //! The source file.
+    hid_t source = -1;
+    //! The destination file.
+    hid_t destination = -1;
+    //! The new chunk size of two dimensional DataSets; 0 to keep it.
+    uint64_t chunkSize = 0;
+    //! The new compression level; negative to keep the filters.
+    int compressionLevel = -1;
+    //! The DataSets created empty, whose chunks are still to be copied.
+    std::vector<std::string> dataSetPaths;
+    //! The paths, relative to the root, of objects not to copy.
+    std::vector<std::string> excludedPaths;
+};
+
+//! Determine if a path is excluded from the copy, or lies in a group that is.
+bool isExcluded(
+    const std::string& name,
+    const CopyContext& context)
+{
+    return std::any_of(context.excludedPaths.begin(),
+        context.excludedPaths.end(), [&name](const std::string& path) {
+            return name.compare(0, path.size(), path) == 0 &&
+                (name.size() == path.size() || name[path.size()] == '/');
+        });
+}
+
+//! Determine if values of an HDF5 type are stored outside the DataSet.
+/*!
+\param type
+    The HDF5 type.
+
+\return
+    \e true if the type holds variable length data or references.
+    \e false otherwise.
+*/
+bool hasIndirectData(
+    hid_t type)
+{
+    switch (H5Tget_class(type))
+    {
+    case H5T_VLEN:  //[[fallthrough]]
+    case H5T_REFERENCE:
+        return true;
+    case H5T_STRING:
+        return H5Tis_variable_str(type) > 0;
+    case H5T_COMPOUND:
+    {
+        const int numMembers = H5Tget_nmembers(type);
+        for (int i = 0; i < numMembers; ++i)
+        {
+            const auto memberType = H5Tget_member_type(type,
+                static_cast<unsigned int>(i));
+            const bool indirect = hasIndirectData(memberType);
+            H5Tclose(memberType);
+
+            if (indirect)
+                return true;
+        }
+
+        return false;
+    }
+    case H5T_ARRAY:
+    {
+        const auto baseType = H5Tget_super(type);
+        const bool indirect = hasIndirectData(baseType);
+        H5Tclose(baseType);
+
+        return indirect;
+    }
+    default:
+        return false;
+    }
+}
+
+//! Determine if a filter is in a DataSet creation property list.
+bool hasFilter(
+    hid_t createPlist,
+    H5Z_filter_t id)
+{
+    const int numFilters = H5Pget_nfilters(createPlist);
+    for (int i = 0; i < numFilters; ++i)
+    {
+        unsigned int flags = 0;
+        size_t numValues = 0;
+        unsigned int filterConfig = 0;
+
+        if (H5Pget_filter2(createPlist, static_cast<unsigned int>(i), &flags,
+            &numValues, nullptr, 0, nullptr, &filterConfig) == id)
+            return true;
+    }
+
+    return false;
+}
+
+//! Determine if a DataSet is the variable resolution refinements or nodes.
+/*!
+\param name
+    The path of the DataSet, relative to the root.
+
+\return
+    \e true if the DataSet holds a single row of refinements or nodes.
+    \e false otherwise.
+*/
+bool isVRRecordList(
+    const char* name)
+{
+    const auto path = std::string{"/"} + name;
+
+    return path == VR_REFINEMENT_PATH || path == VR_NODE_PATH;
+}
+
+//! Apply the new chunk size and compression level to a creation property list.
+/*!
+    The variable resolution refinements and nodes are chunked one row of
+    records at a time, also when the source chunked them as squares.
+
+\param createPlist
+    A copy of the creation property list of the source DataSet.
+\param space
+    The data space of the source DataSet; of rank one or two.
+\param name
+    The path of the DataSet, relative to the root.
+\param context
+    The repack settings.
+*/
+void updateCreatePlist(
+    hid_t createPlist,
+    hid_t space,
+    const char* name,
+    const CopyContext& context)
+{
+    const int rank = H5Sget_simple_extent_ndims(space);
+    std::array<hsize_t, 2> maxDims{};
+    H5Sget_simple_extent_dims(space, nullptr, maxDims.data());
+
+    std::array<hsize_t, 2> chunkDims{};
+    bool chunked = H5Pget_layout(createPlist) == H5D_CHUNKED;
+    if (chunked)
+        H5Pget_chunk(createPlist, rank, chunkDims.data());
+
+    if (rank == 2 && chunked && isVRRecordList(name))
+    {
+        // Square chunks of a single row are almost all padding.
+        if (context.chunkSize > 0)
+            chunkDims = {1, getVRChunkLength(context.chunkSize)};
+        else if (chunkDims[0] > 1)
+            chunkDims = {1, getVRChunkLength(chunkDims[0])};
+    }
+    else if (rank == 2 && context.chunkSize > 0)
+    {
+        chunkDims = {context.chunkSize, context.chunkSize};
+        chunked = true;
+
+        // Fixed dimensions limit the chunk; empty ones cannot be chunked.
+        for (int i = 0; i < rank; ++i)
+            if (maxDims[i] != H5S_UNLIMITED)
+            {
+                chunkDims[i] = std::min(chunkDims[i], maxDims[i]);
+                chunked = chunked && maxDims[i] > 0;
+            }
+    }
+
+    if (!chunked)
+        return;
+
+    H5Pset_chunk(createPlist, rank, chunkDims.data());
+
+    if (context.compressionLevel < 0)
+        return;
+
+    const bool checksum = hasFilter(createPlist, H5Z_FILTER_FLETCHER32);
+
+    H5Premove_filter(createPlist, H5Z_FILTER_ALL);
+    if (context.compressionLevel > 0)
+        H5Pset_deflate(createPlist, static_cast<unsigned int>(
+            std::min(context.compressionLevel, kMaxCompressionLevel)));
+    if (checksum)
+        H5Pset_fletcher32(createPlist);
+}
+
+//! Copy one attribute; an H5Aiterate2() callback.
+herr_t copyAttribute(
+    hid_t location,
+    const char* name,
+    const H5A_info_t* /*info*/,
+    void* destination)
+{
+    const auto attribute = H5Aopen(location, name, H5P_DEFAULT);
+    if (attribute < 0)
+        return -1;
+
+    const auto fileType = H5Aget_type(attribute);
+    const auto memType = H5Tget_native_type(fileType, H5T_DIR_ASCEND);
+    const auto space = H5Aget_space(attribute);
+    const auto numElements = std::max<hssize_t>(
+        H5Sget_simple_extent_npoints(space), 1);
+
+    std::vector<uint8_t> buffer(H5Tget_size(memType) *
+        static_cast<size_t>(numElements));
+
+    herr_t status = H5Aread(attribute, memType, buffer.data());
+    if (status >= 0)
+    {
+        const auto copy = H5Acreate2(*static_cast<const hid_t*>(destination),
+            name, fileType, space, H5P_DEFAULT, H5P_DEFAULT);
+        status = copy < 0 ? -1 : H5Awrite(copy, memType, buffer.data());
+        if (copy >= 0)
+            H5Aclose(copy);
+
+        if (hasIndirectData(memType))
+            H5Dvlen_reclaim(memType, space, H5P_DEFAULT, buffer.data());
+    }
+
+    H5Sclose(space);
+    H5Tclose(memType);
+    H5Tclose(fileType);
+    H5Aclose(attribute);
+
+    return status < 0 ? -1 : 0;
+}
+
+//! Copy the attributes of one object to another.
+herr_t copyAttributes(
+    hid_t source,
+    hid_t destination)
+{
+    return H5Aiterate2(source, H5_INDEX_NAME, H5_ITER_INC, nullptr,
+        copyAttribute, &destination);
+}
+
+//! Create a DataSet like the source, with the new layout and its attributes.
+/*!
+\param source
+    The source DataSet.
+\param name
+    The path of the DataSet.
+\param context
+    The repack settings; receives the path if chunks must be copied.
+
+\return
+    A negative value on failure.
+*/
+herr_t createDataSet(
+    hid_t source,
+    const char* name,
+    CopyContext& context)
+{
+    const auto fileType = H5Dget_type(source);
+    const auto space = H5Dget_space(source);
+    const int rank = H5Sget_simple_extent_ndims(space);
+
+    herr_t status = 0;
+
+    if ((rank != 1 && rank != 2) || hasIndirectData(fileType))
+    {
+        // Variable length data lives in the global heap of the source.
+        status = H5Ocopy(context.source, name, context.destination, name,
+            H5P_DEFAULT, H5P_DEFAULT);
+    }
+    else
+    {
+        const auto createPlist = H5Dget_create_plist(source);
+        updateCreatePlist(createPlist, space, name, context);
+
+        const auto copy = H5Dcreate2(context.destination, name, fileType,
+            space, H5P_DEFAULT, createPlist, H5P_DEFAULT);
+        H5Pclose(createPlist);
+
+        status = copy < 0 ? -1 : copyAttributes(source, copy);
+        if (copy >= 0)
+        {
+            H5Dclose(copy);
+            context.dataSetPaths.emplace_back(name);
+        }
+    }
+
+    H5Sclose(space);
+    H5Tclose(fileType);
+
+    return status;
+}
+
+//! Copy one link and what it leads to; an H5Lvisit() callback.
+/*!
+    Links are visited before the members of the groups they lead to, so a
+    group always exists before anything is created in it.
+*/
+herr_t copyLink(
+    hid_t group,
+    const char* name,
+    const H5L_info_t* info,
+    void* pContext)
+{
+    auto& context = *static_cast<CopyContext*>(pContext);
+
+    if (isExcluded(name, context))
+        return 0;
+
+    if (info->type == H5L_TYPE_SOFT)
+    {
+        std::vector<char> target(info->u.val_size + 1, '\0');
+        if (H5Lget_val(group, name, target.data(), target.size(),
+            H5P_DEFAULT) < 0)
+            return -1;
+
+        return H5Lcreate_soft(target.data(), context.destination, name,
+            H5P_DEFAULT, H5P_DEFAULT) < 0 ? -1 : 0;
+    }
+
+    if (info->type != H5L_TYPE_HARD)
+        return 0;
+
+    const auto object = H5Oopen(group, name, H5P_DEFAULT);
+    if (object < 0)
+        return -1;
+
+    herr_t status = 0;
+
+    switch (H5Iget_type(object))
+    {
+    case H5I_GROUP:
+    {
+        const auto createPlist = H5Gget_create_plist(object);
+        const auto copy = H5Gcreate2(context.destination, name, H5P_DEFAULT,
+            createPlist, H5P_DEFAULT);
+        H5Pclose(createPlist);
+
+        status = copy < 0 ? -1 : copyAttributes(object, copy);
+        if (copy >= 0)
+            H5Gclose(copy);
+        break;
+    }
+    case H5I_DATASET:
+        status = createDataSet(object, name, context);
+        break;
+    default:
+        status = H5Ocopy(context.source, name, context.destination, name,
+            H5P_DEFAULT, H5P_DEFAULT);
+        break;
+    }
+
+    H5Oclose(object);
+
+    return status < 0 ? -1 : 0;
+}
+
+//! A DataSet whose chunks are copied across threads.
+struct ChunkCopy final
+{
+    //! The source DataSet.
+    std::unique_ptr<const ChunkedDataSet> pSource;
+    //! The new DataSet.
+    std::unique_ptr<ChunkedDataSet> pDestination;
+    //! Can chunks be copied as stored?
+    bool raw = false;
+};
+
+}  // namespace
+
+//! Copy a BAG into a new file, optionally re-chunked and recompressed.
+/*!
+\param dataset
+    The BAG Dataset to copy.
+\param outFileName
+    The name of the new BAG; it must not exist.
+\param chunkSize
+    The chunk size of two dimensional DataSets.  Zero keeps the chunk size of
+    each DataSet.
+\param compressionLevel
+    The compression level of chunked DataSets; zero for none.  Negative keeps
+    the filters of each DataSet.  Fletcher32 checksums are always kept.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The new BAG, open for reading and writing.
+*/
+std::shared_ptr<Dataset> Repacker::repack(
+    const Dataset& dataset,
+    const std::string& outFileName,
+    uint64_t chunkSize,
+    int compressionLevel,
+    unsigned int numThreads)
+{
+    return Repacker::repackExcept(dataset, outFileName, chunkSize,
+        compressionLevel, numThreads, {});
+}
+
+//! Copy a BAG into a new file, leaving some objects out.
+/*!
+\param dataset
+    The BAG Dataset to copy.
+\param outFileName
+    The name of the new BAG; it must not exist.
+\param chunkSize
+    The chunk size of two dimensional DataSets; zero to keep it.
+\param compressionLevel
+    The compression level of chunked DataSets; negative to keep the filters.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+\param excludedPaths
+    The absolute paths of the groups and DataSets not to copy.
+
+\return
+    The new BAG, open for reading and writing.
+*/
+std::shared_ptr<Dataset> Repacker::repackExcept(
+    const Dataset& dataset,
+    const std::string& outFileName,
+    uint64_t chunkSize,
+    int compressionLevel,
+    unsigned int numThreads,
+    const std::vector<std::string>& excludedPaths)
+{
+    const auto& h5file = dataset.getH5file();
+
+    std::vector<ChunkCopy> copies;
+    {
+        std::unique_ptr<::H5::H5File> pOutFile;
+        CopyContext context;
+        context.chunkSize = chunkSize;
+        context.compressionLevel = compressionLevel;
+
+        // Links are visited by their path relative to the root group.
+        for (const auto& path : excludedPaths)
+            context.excludedPaths.push_back(path.substr(
+                path.find_first_not_of('/')));
+
+        {
+            std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+            // Anything cached must reach the source before it is copied.
+            h5file.flush(H5F_SCOPE_GLOBAL);
+
+            pOutFile.reset(new ::H5::H5File{outFileName, H5F_ACC_EXCL,
+                h5file.getCreatePlist()});
+
+            context.source = h5file.getId();
+            context.destination = pOutFile->getId();
+
+            if (copyAttributes(context.source, context.destination) < 0 ||
+                H5Lvisit(context.source, H5_INDEX_NAME, H5_ITER_INC, copyLink,
+                    &context) < 0)
+                throw ::H5::FileIException{"Repacker::repack",
+                    "copying the file structure failed"};
+        }
+
+        for (const auto& path : context.dataSetPaths)
+        {
+            ChunkCopy copy;
+            copy.pSource.reset(new ChunkedDataSet{h5file, path});
+            copy.pDestination.reset(new ChunkedDataSet{*pOutFile, path});
+            copy.raw = copy.pSource->hasSameStorage(*copy.pDestination);
+
+            copies.push_back(std::move(copy));
+        }
+
+        // The first task of each DataSet.
+        std::vector<uint64_t> firstTask{0};
+        for (const auto& copy : copies)
+            firstTask.push_back(firstTask.back() +
+                copy.pDestination->getNumChunks());
+
+        parallelFor(firstTask.back(), numThreads, [&](size_t task) {
+            const size_t copyIndex = static_cast<size_t>(std::distance(
+                firstTask.begin(), std::upper_bound(firstTask.begin(),
+                    firstTask.end(), task)) - 1);
+            const uint64_t chunkIndex = task - firstTask[copyIndex];
+            auto& copy = copies[copyIndex];
+
+            if (copy.raw)
+            {
+                // Chunks never written in the source stay unallocated.
+                RawChunk rawChunk;
+                if (copy.pSource->readRawChunk(chunkIndex, rawChunk))
+                    copy.pDestination->writeRawChunk(chunkIndex, rawChunk);
+
+                return;
+            }
+
+            const auto buffer = copy.pSource->read(
+                copy.pDestination->getChunkWindow(chunkIndex));
+            copy.pDestination->writeChunk(chunkIndex, buffer.data());
+        });
+
+        copies.clear();
+
+        std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+        pOutFile->close();
+    }
+
+    return Dataset::open(outFileName, BAG_OPEN_READ_WRITE);
+}
+
+}  // namespace BAG
+
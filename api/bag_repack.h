@@ -0,0 +1,50 @@
+#ifndef BAG_REPACK_H
+#define BAG_REPACK_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace BAG {
+
+//! Copying of a whole BAG into a new, compact file.
+/*!
+    Every group, DataSet and attribute is copied: all layers, georeferenced
+    metadata, variable resolution structure, tracking lists and metadata.
+    Space freed in the source by removed layers is not carried over, and
+    the new file is written once, so it holds no free space.
+
+    Two dimensional DataSets can be given a new chunk size, and any chunked
+    DataSet a new compression level.  One dimensional DataSets keep their
+    chunk length.  The variable resolution refinements and nodes, a single
+    row each, are chunked a row of records at a time; files that chunked
+    them as squares are converted.  Chunks are copied across threads: as
+    stored, when the layout and filters are unchanged, otherwise decoded and
+    encoded again outside the HDF5 mutex where possible.  DataSets holding
+    variable length data or references are copied whole with H5Ocopy().
+*/
+class BAG_API Repacker final
+{
+public:
+    static std::shared_ptr<Dataset> repack(const Dataset& dataset,
+        const std::string& outFileName, uint64_t chunkSize = 0,
+        int compressionLevel = -1, unsigned int numThreads = 0);
+
+private:
+    static std::shared_ptr<Dataset> repackExcept(const Dataset& dataset,
+        const std::string& outFileName, uint64_t chunkSize,
+        int compressionLevel, unsigned int numThreads,
+        const std::vector<std::string>& excludedPaths);
+
+    friend Upgrader;
+};
+
+}  // namespace BAG
+
+#endif  // BAG_REPACK_H
+
@@ -0,0 +1,502 @@
+#include "bag_chunkio.h"
+#include "bag_dataset.h"
+#include "bag_exceptions.h"
+#include "bag_layerdescriptor.h"
+#include "bag_metadata.h"
+#include "bag_metadata_export.h"
+#include "bag_parallel.h"
+#include "bag_resample.h"
+#include "bag_simplelayer.h"
+#include "bag_vrindex.h"
+#include "bag_vrrefinements.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+
+namespace BAG {
+
+namespace {
+
+//! How far, in cells, the extent may exceed whole cells and not add one.
+constexpr double kExtentTolerance = 1e-6;
+
+//! The refinements of one row of supercells.
+struct RowRefinements final
+{
+    //! The index of the first refinement.
+    uint32_t first = 0;
+    //! The refinements, from the first one of the row to the last one.
+    std::vector<VRRefinementsItem> items;
+};
+
+//! The refinements of the rows of supercells, each read once and kept until
+//! every band using it is done.
+class RowCache final
+{
+public:
+    //! Constructor.
+    /*!
+    \param index
+        The index of the supercells.
+    \param refinements
+        The refinements layer.
+    \param numUsers
+        The number of bands using each row of supercells.
+    */
+    RowCache(
+        const VRIndex& index,
+        const VRRefinements& refinements,
+        const std::vector<uint32_t>& numUsers)
+        : m_index(index)
+        , m_refinements(refinements)
+        , m_slots(numUsers.size())
+    {
+        for (size_t row = 0; row < numUsers.size(); ++row)
+            m_slots[row].numUsers = numUsers[row];
+    }
+
+    //! Retrieve the refinements of a row of supercells, reading them if no
+    //! other band has.
+    /*!
+    \param row
+        The row of supercells.
+
+    \return
+        The refinements of the row.
+    */
+    std::shared_ptr<const RowRefinements> acquire(
+        uint32_t row)
+    {
+        auto& slot = m_slots[row];
+
+        // Other bands wanting the row wait for it rather than read it again.
+        std::lock_guard<std::mutex> lock{slot.mutex};
+        if (!slot.pRefinements)
+            slot.pRefinements = this->read(row);
+
+        return slot.pRefinements;
+    }
+
+    //! Signal a band is done with a row of supercells.
+    /*!
+    \param row
+        The row of supercells.
+    */
+    void release(
+        uint32_t row)
+    {
+        auto& slot = m_slots[row];
+
+        std::lock_guard<std::mutex> lock{slot.mutex};
+        if (--slot.numUsers == 0)
+            slot.pRefinements.reset();
+    }
+
+private:
+    //! The state of one row of supercells.
+    struct Slot final
+    {
+        //! Guards the slot.
+        std::mutex mutex;
+        //! The number of bands yet to release the row.
+        uint32_t numUsers = 0;
+        //! The refinements; nullptr until read, and once released.
+        std::shared_ptr<const RowRefinements> pRefinements;
+    };
+
+    //! Read the refinements of a row of supercells, as one range.
+    std::shared_ptr<const RowRefinements> read(
+        uint32_t row) const
+    {
+        auto pRow = std::make_shared<RowRefinements>();
+
+        uint32_t first = std::numeric_limits<uint32_t>::max();
+        uint32_t end = 0;
+        for (uint32_t column = 0; column < m_index.getColumns(); ++column)
+        {
+            const auto* pItem = m_index.getSupercell(row, column);
+            if (!pItem)
+                continue;
+
+            first = std::min(first, pItem->index);
+            end = std::max(end, pItem->index +
+                pItem->dimensions_x * pItem->dimensions_y);
+        }
+
+        if (first >= end)
+            return pRow;
+
+        UInt8Array buffer;
+        {
+            std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+            buffer = m_refinements.read(0, first, 0, end - 1);
+        }
+
+        const auto* items =
+            reinterpret_cast<const VRRefinementsItem*>(buffer.data());
+
+        pRow->first = first;
+        pRow->items.assign(items, items + (end - first));
+
+        return pRow;
+    }
+
+    //! The index of the supercells.
+    const VRIndex& m_index;
+    //! The refinements layer.
+    const VRRefinements& m_refinements;
+    //! The rows of supercells.
+    std::vector<Slot> m_slots;
+};
+
+//! The refinements binned into one cell of the resampled grid.
+struct Bin final
+{
+    //! The sum of the depths, or the depth kept.
+    double depth = 0.;
+    //! The sum of the uncertainties, or the uncertainty kept.
+    double uncertainty = 0.;
+    //! What the kept refinement is chosen by; the distance to the centre of
+    //! the cell (squared), or the depth.
+    double key = std::numeric_limits<double>::max();
+    //! The number of refinements.
+    uint32_t count = 0;
+
+    //! Add a refinement to the bin.
+    void add(
+        ResampleRule rule,
+        const VRRefinementsItem& refinement,
+        double distance) noexcept
+    {
+        ++count;
+
+        switch (rule)
+        {
+        case ResampleRule::Nearest:
+            if (distance >= key)
+                return;
+
+            key = distance;
+            break;
+        case ResampleRule::Minimum:
+            if (refinement.depth >= key)
+                return;
+
+            key = refinement.depth;
+            break;
+        case ResampleRule::Mean:
+            depth += refinement.depth;
+            uncertainty += refinement.depth_uncrt;
+            return;
+        }
+
+        depth = refinement.depth;
+        uncertainty = refinement.depth_uncrt;
+    }
+
+    //! The depth of the cell.
+    float getDepth(
+        ResampleRule rule) const noexcept
+    {
+        if (count == 0)
+            return BAG_NULL_ELEVATION;
+
+        return static_cast<float>(rule == ResampleRule::Mean ?
+            depth / count : depth);
+    }
+
+    //! The uncertainty of the cell.
+    float getUncertainty(
+        ResampleRule rule) const noexcept
+    {
+        if (count == 0)
+            return BAG_NULL_UNCERTAINTY;
+
+        return static_cast<float>(rule == ResampleRule::Mean ?
+            uncertainty / count : uncertainty);
+    }
+};
+
+//! The number of cells of the resampled grid along one axis.
+uint32_t getNumCells(
+    double extent,
+    double resolution) noexcept
+{
+    const auto cells = extent / resolution;
+
+    return static_cast<uint32_t>(std::max(1., std::ceil(cells -
+        kExtentTolerance)));
+}
+
+//! The rows of supercells whose refinements may fall in a band of rows of
+//! the resampled grid.
+/*!
+\param bandStart
+    The Y of the south edge of the band.
+\param bandEnd
+    The Y of the north edge of the band.
+\param southEdge
+    The Y of the south edge of the supercells.
+\param rowResolution
+    The distance between rows of supercells.
+\param numRows
+    The number of rows of supercells.
+\param first
+    Set to the first row of supercells.
+\param last
+    Set to the last row of supercells.
+*/
+void getSupercellRows(
+    double bandStart,
+    double bandEnd,
+    double southEdge,
+    double rowResolution,
+    uint32_t numRows,
+    uint32_t& first,
+    uint32_t& last) noexcept
+{
+    // Refinements lie within their supercell; allow one more either side for
+    // those on its edge.
+    const auto start = std::floor((bandStart - southEdge) / rowResolution) - 1.;
+    const auto end = std::floor((bandEnd - southEdge) / rowResolution) + 1.;
+
+    first = static_cast<uint32_t>(std::min<double>(std::max(start, 0.),
+        numRows - 1.));
+    last = static_cast<uint32_t>(std::min<double>(std::max(end, 0.),
+        numRows - 1.));
+}
+
+}  // namespace
+
+//! Resample a variable resolution BAG onto a single resolution grid.
+/*!
+\param dataset
+    The variable resolution BAG Dataset.
+\param outFileName
+    The name of the new BAG; it must not exist.
+\param resolution
+    The distance between the rows, and between the columns, of the new grid.
+\param rule
+    How the refinements falling in one cell combine.
+\param chunkSize
+    The chunk size of the new BAG.
+\param compressionLevel
+    The compression level of the new BAG.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The new BAG, open for reading and writing.
+*/
+std::shared_ptr<Dataset> Resampler::resample(
+    const Dataset& dataset,
+    const std::string& outFileName,
+    double resolution,
+    ResampleRule rule,
+    uint64_t chunkSize,
+    int compressionLevel,
+    unsigned int numThreads)
+{
+    if (!(resolution > 0.))
+        throw InvalidResolution{};
+
+    const auto pIndex = dataset.getVRIndex();
+    const auto pRefinements = dataset.getVRRefinements();
+    if (!pIndex || !pRefinements)
+        throw LayerNotFound{};
+
+    const auto& index = *pIndex;
+    const auto& metadata = dataset.getMetadata();
+
+    // The new grid covers the supercells, starting at their south west edge.
+    const double westEdge = metadata.llCornerX() -
+        metadata.columnResolution() / 2.;
+    const double southEdge = metadata.llCornerY() -
+        metadata.rowResolution() / 2.;
+
+    const auto rows = getNumCells(index.getRows() * metadata.rowResolution(),
+        resolution);
+    const auto columns = getNumCells(
+        index.getColumns() * metadata.columnResolution(), resolution);
+
+    Metadata outMetadata;
+    outMetadata.loadFromBuffer(exportMetadataToXML(metadata.getStruct()));
+    outMetadata.setResolution(resolution, resolution);
+    outMetadata.setGridExtent(rows, columns, westEdge + resolution / 2.,
+        southEdge + resolution / 2.);
+
+    chunkSize = std::max<uint64_t>(1, std::min<uint64_t>({chunkSize, rows,
+        columns}));
+
+    auto pOutput = Dataset::create(outFileName, std::move(outMetadata),
+        chunkSize, compressionLevel);
+
+    ChunkedDataSet outElevation{pOutput->getH5file(),
+        Layer::getInternalPath(Elevation)};
+    ChunkedDataSet outUncertainty{pOutput->getH5file(),
+        Layer::getInternalPath(Uncertainty)};
+
+    // Each band of chunks reads the rows of supercells it overlaps.
+    const auto numBands = outElevation.getNumChunkRows();
+    const auto bandRows = outElevation.getChunkRows();
+
+    std::vector<std::pair<uint32_t, uint32_t>> bandSupercellRows(numBands);
+    std::vector<uint32_t> numUsers(index.getRows(), 0);
+
+    for (uint64_t band = 0; band < numBands; ++band)
+    {
+        const auto rowStart = band * bandRows;
+        const auto rowEnd = std::min<uint64_t>(rowStart + bandRows, rows);
+
+        auto& supercellRows = bandSupercellRows[band];
+        getSupercellRows(southEdge + rowStart * resolution,
+            southEdge + rowEnd * resolution, southEdge,
+            metadata.rowResolution(), index.getRows(), supercellRows.first,
+            supercellRows.second);
+
+        for (auto row = supercellRows.first; row <= supercellRows.second; ++row)
+            ++numUsers[row];
+    }
+
+    RowCache cache{index, *pRefinements, numUsers};
+
+    ValueRange elevationRange;
+    ValueRange uncertaintyRange;
+    std::mutex rangeMutex;
+
+    parallelFor(numBands, numThreads, [&](size_t band) {
+        const auto rowStart = static_cast<uint32_t>(band * bandRows);
+        const auto rowEnd = static_cast<uint32_t>(std::min<uint64_t>(
+            rowStart + bandRows, rows)) - 1;
+        const auto numBandRows = rowEnd - rowStart + 1;
+
+        std::vector<Bin> bins(static_cast<size_t>(numBandRows) * columns);
+
+        // Bin the refinements of every row of supercells the band overlaps.
+        const auto& supercellRows = bandSupercellRows[band];
+        for (auto row = supercellRows.first; row <= supercellRows.second; ++row)
+        {
+            const auto pRow = cache.acquire(row);
+
+            for (uint32_t column = 0; column < index.getColumns(); ++column)
+            {
+                const auto* pItem = index.getSupercell(row, column);
+                if (!pItem)
+                    continue;
+
+                const auto& item = *pItem;
+
+                double x0 = 0., y0 = 0.;
+                std::tie(x0, y0) = index.getNodePosition(row, column, 0, 0);
+
+                for (uint32_t subRow = 0; subRow < item.dimensions_y; ++subRow)
+                {
+                    const auto y = y0 + subRow * static_cast<double>(
+                        item.resolution_y);
+                    const auto cellRow = std::floor((y - southEdge) /
+                        resolution);
+                    if (cellRow < rowStart || cellRow > rowEnd)
+                        continue;
+
+                    const auto binRow = static_cast<uint32_t>(cellRow) -
+                        rowStart;
+                    const auto dy = y - (southEdge + (cellRow + 0.5) *
+                        resolution);
+                    const auto* refinements = pRow->items.data() +
+                        (item.index - pRow->first) +
+                        subRow * item.dimensions_x;
+
+                    for (uint32_t subColumn = 0; subColumn < item.dimensions_x;
+                        ++subColumn)
+                    {
+                        const auto& refinement = refinements[subColumn];
+                        if (refinement.depth == BAG_NULL_ELEVATION)
+                            continue;
+
+                        const auto x = x0 + subColumn * static_cast<double>(
+                            item.resolution_x);
+                        const auto cellColumn = std::floor((x - westEdge) /
+                            resolution);
+                        if (cellColumn < 0. || cellColumn >= columns)
+                            continue;
+
+                        const auto dx = x - (westEdge + (cellColumn + 0.5) *
+                            resolution);
+
+                        bins[static_cast<size_t>(binRow) * columns +
+                            static_cast<uint32_t>(cellColumn)].add(rule,
+                            refinement, dx * dx + dy * dy);
+                    }
+                }
+            }
+
+            cache.release(row);
+        }
+
+        // Write the chunks of the band.
+        ValueRange bandElevationRange;
+        ValueRange bandUncertaintyRange;
+
+        const auto numChunkColumns = outElevation.getNumChunkColumns();
+        for (uint64_t chunkColumn = 0; chunkColumn < numChunkColumns;
+            ++chunkColumn)
+        {
+            const auto chunkIndex = band * numChunkColumns + chunkColumn;
+            const auto window = outElevation.getChunkWindow(chunkIndex);
+
+            std::vector<float> elevations;
+            std::vector<float> uncertainties;
+            elevations.reserve(static_cast<size_t>(window.rows()) *
+                window.columns());
+            uncertainties.reserve(elevations.capacity());
+
+            for (auto row = window.rowStart; row <= window.rowEnd; ++row)
+            {
+                const auto* binRow = bins.data() +
+                    static_cast<size_t>(row - rowStart) * columns;
+
+                for (auto column = window.columnStart;
+                    column <= window.columnEnd; ++column)
+                {
+                    const auto& bin = binRow[column];
+
+                    elevations.push_back(bin.getDepth(rule));
+                    uncertainties.push_back(bin.getUncertainty(rule));
+
+                    bandElevationRange.add(elevations.back());
+                    bandUncertaintyRange.add(uncertainties.back());
+                }
+            }
+
+            outElevation.writeChunk(chunkIndex,
+                reinterpret_cast<const uint8_t*>(elevations.data()));
+            outUncertainty.writeChunk(chunkIndex,
+                reinterpret_cast<const uint8_t*>(uncertainties.data()));
+        }
+
+        std::lock_guard<std::mutex> lock{rangeMutex};
+        elevationRange.merge(bandElevationRange);
+        uncertaintyRange.merge(bandUncertaintyRange);
+    });
+
+    // Record the range of the resampled values.
+    for (const auto& layerRange : {std::make_pair(Elevation, elevationRange),
+            std::make_pair(Uncertainty, uncertaintyRange)})
+    {
+        if (layerRange.second.empty())
+            continue;
+
+        auto pLayer = pOutput->getSimpleLayer(layerRange.first);
+        pLayer->getDescriptor()->setMinMax(layerRange.second.min,
+            layerRange.second.max);
+        pLayer->writeAttributes();
+    }
+
+    return pOutput;
+}
+
+}  // namespace BAG
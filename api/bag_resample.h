@@ -0,0 +1,49 @@
+#ifndef BAG_RESAMPLE_H
+#define BAG_RESAMPLE_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+namespace BAG {
+
+//! How the refinements falling in one cell of the resampled grid combine.
+enum class ResampleRule
+{
+    //! The refinement nearest the centre of the cell.
+    Nearest,
+    //! The refinement with the smallest depth, with its uncertainty.
+    Minimum,
+    //! The mean depth and the mean uncertainty of the refinements.
+    Mean,
+};
+
+//! Flattening of a variable resolution BAG onto a single resolution grid.
+/*!
+    The refinements of the supercells are binned into the cells of a regular
+    grid at a chosen resolution, covering the supercells, and combined by a
+    ResampleRule.  Cells without refinements hold the null values.  The
+    result is a new BAG whose elevation and uncertainty layers hold the
+    resampled grid; its metadata is that of the source, with the new
+    resolution and extent.
+
+    The output is produced a band of chunks at a time across threads.  The
+    refinements of each row of supercells are read once, as one contiguous
+    range, and dropped once every band covering the row is done with them.
+*/
+class BAG_API Resampler final
+{
+public:
+    static std::shared_ptr<Dataset> resample(const Dataset& dataset,
+        const std::string& outFileName, double resolution,
+        ResampleRule rule = ResampleRule::Mean, uint64_t chunkSize = 100,
+        int compressionLevel = 5, unsigned int numThreads = 0);
+};
+
+}  // namespace BAG
+
+#endif  // BAG_RESAMPLE_H
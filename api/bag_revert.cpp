@@ -0,0 +1,454 @@
+#include "bag_chunkio.h"
+#include "bag_coverage.h"
+#include "bag_dataset.h"
+#include "bag_exceptions.h"
+#include "bag_parallel.h"
+#include "bag_private.h"
+#include "bag_revert.h"
+#include "bag_simplelayer.h"
+#include "bag_trackinglist.h"
+#include "bag_vrindex.h"
+#include "bag_vrrefinements.h"
+#include "bag_vrrefinementsdescriptor.h"
+#include "bag_vrtrackinglist.h"
+
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+
+namespace BAG {
+
+namespace {
+
+//! A node to restore.
+struct Restore final
+{
+    //! The chunk holding the node.
+    uint64_t chunk = 0;
+    //! The node; its row major position in the grid, or its refinement index.
+    uint64_t position = 0;
+    //! The depth to restore.
+    float depth = 0.f;
+    //! The uncertainty to restore.
+    float uncertainty = 0.f;
+};
+
+//! Determine if a tracking list item matches a filter.
+/*!
+\param filter
+    The filter.
+\param item
+    The tracking list item.
+
+\return
+    \e true if the item passes every criterion set in the filter.
+*/
+template <typename T>
+bool matches(
+    const RevertFilter& filter,
+    const T& item) noexcept
+{
+    if (filter.filterCode && item.track_code != filter.code)
+        return false;
+
+    if (filter.filterSeries && item.list_series != filter.series)
+        return false;
+
+    if (filter.filterBox && (item.row < filter.rowStart ||
+        item.row > filter.rowEnd || item.col < filter.columnStart ||
+        item.col > filter.columnEnd))
+        return false;
+
+    return true;
+}
+
+//! Group the nodes to restore by chunk, keeping the first restore of each.
+/*!
+\param restores
+    The nodes to restore, in tracking list order.
+*/
+void groupByChunk(
+    std::vector<Restore>& restores)
+{
+    std::stable_sort(restores.begin(), restores.end(),
+        [](const Restore& lhs, const Restore& rhs) {
+            return std::tie(lhs.chunk, lhs.position) <
+                std::tie(rhs.chunk, rhs.position);
+        });
+
+    restores.erase(std::unique(restores.begin(), restores.end(),
+        [](const Restore& lhs, const Restore& rhs) {
+            return lhs.position == rhs.position;
+        }), restores.end());
+}
+
+//! Retrieve the first restore of each chunk.
+/*!
+\param restores
+    The nodes to restore, grouped by chunk.
+
+\return
+    The position of the first restore of each chunk, then the number of
+    restores.
+*/
+std::vector<size_t> getChunkStarts(
+    const std::vector<Restore>& restores)
+{
+    std::vector<size_t> starts;
+    for (size_t i = 0; i < restores.size(); ++i)
+        if (i == 0 || restores[i].chunk != restores[i - 1].chunk)
+            starts.push_back(i);
+
+    starts.push_back(restores.size());
+
+    return starts;
+}
+
+//! Widen the range of a layer to the values restored to it, and write it.
+/*!
+\param layer
+    The layer.
+\param range
+    The range of the values restored.
+*/
+void widenRange(
+    Layer& layer,
+    const ValueRange& range)
+{
+    if (range.empty())
+        return;
+
+    auto& descriptor = *layer.getDescriptor();
+
+    ValueRange layerRange;
+    std::tie(layerRange.min, layerRange.max) = descriptor.getMinMax();
+    layerRange.merge(range);
+
+    descriptor.setMinMax(layerRange.min, layerRange.max);
+    layer.writeAttributes();
+}
+
+//! Restore nodes of the Elevation and Uncertainty layers.
+/*!
+    Each chunk holding nodes to restore is read, patched and written once.
+
+\param elevationLayer
+    The Elevation layer.
+\param uncertaintyLayer
+    The Uncertainty layer.
+\param elevation
+    The Elevation DataSet.
+\param uncertainty
+    The Uncertainty DataSet.
+\param restores
+    The nodes to restore, grouped by chunk of the Elevation DataSet.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+*/
+void restoreGrid(
+    SimpleLayer& elevationLayer,
+    SimpleLayer& uncertaintyLayer,
+    ChunkedDataSet& elevation,
+    ChunkedDataSet& uncertainty,
+    const std::vector<Restore>& restores,
+    unsigned int numThreads)
+{
+    const auto starts = getChunkStarts(restores);
+    const size_t numChunks = starts.size() - 1;
+
+    // Chunks of a differently chunked Uncertainty are read as windows.
+    const bool sameLayout =
+        uncertainty.getChunkRows() == elevation.getChunkRows() &&
+        uncertainty.getChunkColumns() == elevation.getChunkColumns();
+
+    std::vector<ValueRange> elevationRanges(numChunks);
+    std::vector<ValueRange> uncertaintyRanges(numChunks);
+
+    parallelFor(numChunks, numThreads, [&](size_t i) {
+        const auto chunk = restores[starts[i]].chunk;
+        const auto window = elevation.getChunkWindow(chunk);
+        const uint64_t columns = elevation.getColumns();
+
+        auto elevations = elevation.readChunk(chunk);
+        auto uncertainties = sameLayout ? uncertainty.readChunk(chunk) :
+            uncertainty.read(window);
+
+        auto* elevationValues = reinterpret_cast<float*>(elevations.data());
+        auto* uncertaintyValues = reinterpret_cast<float*>(uncertainties.data());
+
+        for (size_t j = starts[i]; j < starts[i + 1]; ++j)
+        {
+            const auto& restore = restores[j];
+            const auto row = restore.position / columns;
+            const auto column = restore.position % columns;
+            const auto offset = (row - window.rowStart) * window.columns() +
+                (column - window.columnStart);
+
+            elevationValues[offset] = restore.depth;
+            uncertaintyValues[offset] = restore.uncertainty;
+
+            elevationRanges[i].add(restore.depth);
+            uncertaintyRanges[i].add(restore.uncertainty);
+        }
+
+        elevation.writeChunk(chunk, elevations.data());
+        if (sameLayout)
+            uncertainty.writeChunk(chunk, uncertainties.data());
+        else
+            uncertainty.write(window, uncertainties.data());
+    });
+
+    ValueRange elevationRange, uncertaintyRange;
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        elevationRange.merge(elevationRanges[i]);
+        uncertaintyRange.merge(uncertaintyRanges[i]);
+    }
+
+    widenRange(elevationLayer, elevationRange);
+    widenRange(uncertaintyLayer, uncertaintyRange);
+}
+
+//! Restore refinements of a variable resolution BAG.
+/*!
+    Each refinements chunk holding refinements to restore is read, patched
+    and written once; the refinements layer widens its range as it is
+    written.
+
+\param refinements
+    The refinements layer.
+\param chunkLength
+    The number of refinements in a chunk.
+\param restores
+    The refinements to restore, grouped by chunk.
+*/
+void restoreRefinements(
+    VRRefinements& refinements,
+    uint64_t chunkLength,
+    const std::vector<Restore>& restores)
+{
+    uint32_t numRows = 0, numRefinements = 0;
+    std::tie(numRows, numRefinements) =
+        refinements.getDescriptor()->getDims();
+
+    const auto starts = getChunkStarts(restores);
+
+    for (size_t i = 0; i + 1 < starts.size(); ++i)
+    {
+        const uint64_t first = restores[starts[i]].chunk * chunkLength;
+        const auto last = static_cast<uint32_t>(std::min<uint64_t>(
+            first + chunkLength, numRefinements) - 1);
+
+        auto buffer = refinements.read(0, static_cast<uint32_t>(first), 0,
+            last);
+        auto* items = reinterpret_cast<VRRefinementsItem*>(buffer.data());
+
+        for (size_t j = starts[i]; j < starts[i + 1]; ++j)
+        {
+            auto& item = items[restores[j].position - first];
+            item.depth = restores[j].depth;
+            item.depth_uncrt = restores[j].uncertainty;
+        }
+
+        refinements.write(0, static_cast<uint32_t>(first), 0, last,
+            buffer.data());
+    }
+
+    refinements.writeAttributes();
+}
+
+//! Remove the items matching a filter from a tracking list, and write it.
+/*!
+\param list
+    The tracking list.
+\param filter
+    The filter.
+
+\return
+    The number of items removed.
+*/
+template <typename List>
+size_t removeMatching(
+    List& list,
+    const RevertFilter& filter)
+{
+    const auto size = list.size();
+    const auto isMatch = [&filter](const typename List::value_type& item) {
+        return matches(filter, item);
+    };
+
+    // The items from the first removed one on move down.
+    const auto first = std::find_if(list.begin(), list.end(), isMatch);
+    const auto end = std::remove_if(first, list.end(), isMatch);
+
+    list.markChanged(static_cast<size_t>(first - list.begin()),
+        static_cast<size_t>(end - list.begin()));
+    list.resize(static_cast<size_t>(end - list.begin()));
+    list.write();
+
+    return size - list.size();
+}
+
+}  // namespace
+
+//! Revert the edits recorded in the tracking lists of a BAG.
+/*!
+\param dataset
+    The BAG, open for reading and writing.
+\param filter
+    The tracking list items to revert.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The number of tracking list items reverted.
+
+\throws
+    ReadOnlyError if the BAG is open read only.
+    TrackingListNotLoaded if the BAG was opened to stream its tracking lists.
+    TrackingListSorted if a list with matching items was sorted or otherwise
+    reordered; nothing is changed then.
+    InvalidReadSize if a matching item names a node not in the BAG; nothing
+    is changed then.
+*/
+size_t Reverter::revert(
+    Dataset& dataset,
+    const RevertFilter& filter,
+    unsigned int numThreads)
+{
+    if (dataset.getDescriptor().isReadOnly())
+        throw ReadOnlyError{};
+
+    auto& trackingList = dataset.getTrackingList();
+    const auto pVRTrackingList = dataset.getVRTrackingList();
+    if (!trackingList.isLoaded() ||
+        (pVRTrackingList && !pVRTrackingList->isLoaded()))
+        throw TrackingListNotLoaded{};
+
+    // Find the nodes to restore before changing anything.
+    const auto& constList = static_cast<const TrackingList&>(trackingList);
+
+    std::vector<Restore> gridRestores;
+    std::unique_ptr<ChunkedDataSet> pElevation, pUncertainty;
+
+    const auto pElevationLayer = dataset.getSimpleLayer(Elevation);
+    const auto pUncertaintyLayer = dataset.getSimpleLayer(Uncertainty);
+
+    for (const auto& item : constList)
+    {
+        if (!matches(filter, item))
+            continue;
+
+        if (!pElevation)
+        {
+            // A reordered list no longer tells which item came first.
+            if (trackingList.isReordered())
+                throw TrackingListSorted{};
+
+            if (!pElevationLayer || !pUncertaintyLayer)
+                throw LayerNotFound{};
+
+            pElevation.reset(new ChunkedDataSet{dataset.getH5file(),
+                pElevationLayer->getDescriptor()->getInternalPath()});
+            pUncertainty.reset(new ChunkedDataSet{dataset.getH5file(),
+                pUncertaintyLayer->getDescriptor()->getInternalPath()});
+        }
+
+        if (item.row >= pElevation->getRows() ||
+            item.col >= pElevation->getColumns())
+            throw InvalidReadSize{};
+
+        Restore restore;
+        restore.chunk = (item.row / pElevation->getChunkRows()) *
+            pElevation->getNumChunkColumns() +
+            item.col / pElevation->getChunkColumns();
+        restore.position = static_cast<uint64_t>(item.row) *
+            pElevation->getColumns() + item.col;
+        restore.depth = item.depth;
+        restore.uncertainty = item.uncertainty;
+        gridRestores.push_back(restore);
+    }
+
+    std::vector<Restore> vrRestores;
+    std::shared_ptr<VRRefinements> pRefinements;
+    uint64_t chunkLength = 0;
+    uint32_t numRefinements = 0;
+
+    if (pVRTrackingList)
+    {
+        const auto& constVRList =
+            static_cast<const VRTrackingList&>(*pVRTrackingList);
+
+        std::shared_ptr<const VRIndex> pIndex;
+
+        for (const auto& item : constVRList)
+        {
+            if (!matches(filter, item))
+                continue;
+
+            if (!pIndex)
+            {
+                if (pVRTrackingList->isReordered())
+                    throw TrackingListSorted{};
+
+                pIndex = dataset.getVRIndex();
+                pRefinements = dataset.getVRRefinements();
+                if (!pIndex || !pRefinements)
+                    throw LayerNotFound{};
+
+                chunkLength = pRefinements->getDescriptor()->getChunkSize();
+                if (chunkLength == 0)
+                    chunkLength = kMaxVRChunkLength;
+
+                uint32_t numRows = 0;
+                std::tie(numRows, numRefinements) =
+                    pRefinements->getDescriptor()->getDims();
+            }
+
+            const auto* supercell = pIndex->getSupercell(item.row, item.col);
+            if (!supercell || item.sub_row >= supercell->dimensions_y ||
+                item.sub_col >= supercell->dimensions_x)
+                throw InvalidReadSize{};
+
+            Restore restore;
+            restore.position = supercell->index +
+                static_cast<uint64_t>(item.sub_row) * supercell->dimensions_x +
+                item.sub_col;
+            if (restore.position >= numRefinements)
+                throw InvalidReadSize{};
+
+            restore.chunk = restore.position / chunkLength;
+            restore.depth = item.depth;
+            restore.uncertainty = item.uncertainty;
+            vrRestores.push_back(restore);
+        }
+    }
+
+    size_t numReverted = 0;
+
+    if (!gridRestores.empty())
+    {
+        groupByChunk(gridRestores);
+        restoreGrid(*pElevationLayer, *pUncertaintyLayer, *pElevation,
+            *pUncertainty, gridRestores, numThreads);
+
+        // The elevations changed, so any cached coverage is stale.
+        Coverage::remove(dataset);
+
+        numReverted += removeMatching(trackingList, filter);
+    }
+
+    if (!vrRestores.empty())
+    {
+        groupByChunk(vrRestores);
+        restoreRefinements(*pRefinements, chunkLength, vrRestores);
+
+        numReverted += removeMatching(*pVRTrackingList, filter);
+    }
+
+    return numReverted;
+}
+
+}  // namespace BAG
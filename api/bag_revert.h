@@ -0,0 +1,67 @@
+#ifndef BAG_REVERT_H
+#define BAG_REVERT_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <cstdint>
+#include <cstddef>
+
+
+namespace BAG {
+
+//! The tracking list items an edit reversion applies to.
+/*!
+    An item matches when it passes every criterion that is set; with none
+    set, every item matches.  The rectangle of a variable resolution tracking
+    list item is one of supercells.
+*/
+struct BAG_API RevertFilter final
+{
+    //! Match the items with the track code only.
+    bool filterCode = false;
+    //! The track code.
+    uint8_t code = 0;
+    //! Match the items of the list series only.
+    bool filterSeries = false;
+    //! The list series.
+    uint16_t series = 0;
+    //! Match the items of the nodes in the rectangle only.
+    bool filterBox = false;
+    //! The starting row of the rectangle.
+    uint32_t rowStart = 0;
+    //! The starting column of the rectangle.
+    uint32_t columnStart = 0;
+    //! The ending row of the rectangle (inclusive).
+    uint32_t rowEnd = 0;
+    //! The ending column of the rectangle (inclusive).
+    uint32_t columnEnd = 0;
+};
+
+//! Reversion of the edits recorded in the tracking lists of a BAG.
+/*!
+    Each tracking list item holds the depth and uncertainty a node had before
+    it was edited.  The matching items are taken in list order, and the first
+    one of each node holds its value before the edits being reverted; that
+    value is restored, and every matching item is removed from its list.
+
+    The nodes to restore are grouped by chunk, so each chunk of the Elevation
+    and Uncertainty layers is read and written once, with the chunks spread
+    over threads.  The items of the variable resolution tracking list restore
+    refinements, a refinements chunk at a time.  The range of each layer is
+    widened to the restored values, and any cached coverage is removed.
+
+    The tracking lists must be loaded; a BAG opened to stream them cannot be
+    reverted.  A list with matching items must not have been sorted or
+    otherwise reordered, as that loses the order the edits were made in.
+*/
+class BAG_API Reverter final
+{
+public:
+    static size_t revert(Dataset& dataset, const RevertFilter& filter,
+        unsigned int numThreads = 0);
+};
+
+}  // namespace BAG
+
+#endif  // BAG_REVERT_H
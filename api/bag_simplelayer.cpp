@@ -1,5 +1,8 @@
 
 #include "bag_attributeinfo.h"
+#include "bag_chunkio.h"
+#include "bag_coverage.h"
+#include "bag_exceptions.h"
 #include "bag_private.h"
 #include "bag_simplelayer.h"
 #include "bag_simplelayerdescriptor.h"
@@ -7,6 +10,7 @@
 #include <algorithm>
 #include <array>
 #include <H5Cpp.h>
+#include <tuple>
 
 
 namespace BAG {
@@ -112,16 +116,23 @@ SimpleLayer::createH5dataSet(
 
     ::H5::DataSpace h5dataSpace{kRank, fileDims.data(), fileDims.data()};
 
-    ::H5::FloatType h5dataType;
-    h5dataType.copy(::H5::PredType::NATIVE_FLOAT);
-    h5dataType.setOrder(H5T_ORDER_LE);
+    // Counts are stored as unsigned integers, everything else as floats.
+    const bool isCount = descriptor.getDataType() == DT_UINT32;
+    const ::H5::DataType h5dataType{isCount ?
+        ::H5::PredType::STD_U32LE : ::H5::PredType::IEEE_F32LE};
 
     // Create the creation property list.
     const ::H5::DSetCreatPropList h5createPropList{};
     h5createPropList.setFillTime(H5D_FILL_TIME_ALLOC);
 
     constexpr float kFillValue = BAG_NULL_ELEVATION;
-    h5createPropList.setFillValue(h5dataType, &kFillValue);
+    constexpr uint32_t kCountFillValue = 0;
+    if (isCount)
+        h5createPropList.setFillValue(::H5::PredType::NATIVE_UINT32,
+            &kCountFillValue);
+    else
+        h5createPropList.setFillValue(::H5::PredType::NATIVE_FLOAT,
+            &kFillValue);
 
     // Use chunk size and compression level from the descriptor.
     const auto compressionLevel = descriptor.getCompressionLevel();
@@ -133,6 +144,8 @@ SimpleLayer::createH5dataSet(
 
         if (compressionLevel > 0 && compressionLevel <= kMaxCompressionLevel)
             h5createPropList.setDeflate(compressionLevel);
+        if (dataset.getDescriptor().isChecksummed())
+            h5createPropList.setFletcher32();
     }
     else if (compressionLevel > 0)
         throw CompressionNeedsChunkingSet{};
@@ -157,11 +170,22 @@ SimpleLayer::createH5dataSet(
         attInfo.h5type, maxElevDataSpace);
 
     // Set initial min/max values.
-    constexpr float minElev = std::numeric_limits<float>::max();
-    minElevAtt.write(attInfo.h5type, &minElev);
+    if (attInfo.h5type == ::H5::PredType::NATIVE_UINT32)
+    {
+        constexpr uint32_t minCount = std::numeric_limits<uint32_t>::max();
+        minElevAtt.write(attInfo.h5type, &minCount);
 
-    constexpr float maxElev = std::numeric_limits<float>::lowest();
-    maxElevAtt.write(attInfo.h5type, &maxElev);
+        constexpr uint32_t maxCount = std::numeric_limits<uint32_t>::lowest();
+        maxElevAtt.write(attInfo.h5type, &maxCount);
+    }
+    else
+    {
+        constexpr float minElev = std::numeric_limits<float>::max();
+        minElevAtt.write(attInfo.h5type, &minElev);
+
+        constexpr float maxElev = std::numeric_limits<float>::lowest();
+        maxElevAtt.write(attInfo.h5type, &maxElev);
+    }
 
     return pH5dataSet;
 }
@@ -197,6 +221,53 @@ UInt8Array SimpleLayer::readProxy(
     return buffer;
 }
 
+//! Read a section of data from this layer, one chunk at a time.
+/*!
+    Read the same section Layer::read() does, but move the compressed chunks
+    out of the file and decompress them without holding the HDF5 lock.
+    Threads reading through separate Datasets then only serialize on the
+    file access, so this scales where Layer::read() does not.
+
+\param rowStart
+    The starting row.
+\param columnStart
+    The starting column.
+\param rowEnd
+    The ending row (inclusive).
+\param columnEnd
+    The ending column (inclusive).
+
+\return
+    The section of data specified by the rows and columns.
+*/
+UInt8Array SimpleLayer::readChunked(
+    uint32_t rowStart,
+    uint32_t columnStart,
+    uint32_t rowEnd,
+    uint32_t columnEnd) const
+{
+    if (rowStart > rowEnd || columnStart > columnEnd)
+        throw InvalidReadSize{};
+
+    if (this->getDataset().expired())
+        throw DatasetNotFound{};
+
+    uint32_t numRows = 0, numColumns = 0;
+    std::tie(numRows, numColumns) = this->getDescriptor()->getDims();
+
+    if (columnEnd >= numColumns || rowEnd >= numRows)
+        throw InvalidReadSize{};
+
+    const ChunkedDataSet chunkedDataSet{*m_pH5dataSet};
+    const auto values = chunkedDataSet.read({rowStart, columnStart, rowEnd,
+        columnEnd});
+
+    UInt8Array buffer{values.size()};
+    std::copy(cbegin(values), cend(values), buffer.data());
+
+    return buffer;
+}
+
 //! \copydoc Layer::writeAttributes
 void SimpleLayer::writeAttributesProxy() const
 {
@@ -279,6 +350,14 @@ void SimpleLayer::writeProxy(
     const float currentMax = std::get<1>(pDescriptor->getMinMax());
 
     pDescriptor->setMinMax(std::min(currentMin, min), std::max(currentMax, max));
+
+    // The elevations changed, so any cached coverage is stale.
+    if (pDescriptor->getLayerType() == Elevation)
+    {
+        auto pDataset = this->getDataset().lock();
+        if (pDataset)
+            Coverage::remove(*pDataset);
+    }
 }
 
 }   //namespace BAG
@@ -44,6 +44,9 @@ public:
         return !(rhs == *this);
     }
 
+    UInt8Array readChunked(uint32_t rowStart, uint32_t columnStart,
+        uint32_t rowEnd, uint32_t columnEnd) const;
+
 protected:
     static std::shared_ptr<SimpleLayer> create(Dataset& dataset,
         LayerType type, uint32_t rows, uint32_t cols, uint64_t chunkSize, int compressionLevel);
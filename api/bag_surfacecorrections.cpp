@@ -164,6 +164,8 @@ SurfaceCorrections::createH5dataSet(
 
         if (compressionLevel > 0 && compressionLevel <= kMaxCompressionLevel)
             h5createPropList.setDeflate(compressionLevel);
+        if (dataset.getDescriptor().isChecksummed())
+            h5createPropList.setFletcher32();
     }
     else if (compressionLevel > 0)
         throw CompressionNeedsChunkingSet{};
@@ -0,0 +1,377 @@
+#include "bag_chunkio.h"
+#include "bag_dataset.h"
+#include "bag_exceptions.h"
+#include "bag_metadata.h"
+#include "bag_metadata_export.h"
+#include "bag_parallel.h"
+#include "bag_simplelayer.h"
+#include "bag_simplelayerdescriptor.h"
+#include "bag_tile.h"
+#include "bag_trackinglist.h"
+#include "bag_trackinglistreader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+
+namespace BAG {
+
+namespace {
+
+//! The chunk size used when the master layer is not chunked.
+constexpr uint64_t kDefaultChunkSize = 100;
+
+//! A tile being written.
+struct Tile final
+{
+    //! The tile.
+    std::shared_ptr<Dataset> pDataset;
+    //! The cells of the master the tile holds.
+    GridWindow window;
+    //! The layer of the tile being written.
+    std::unique_ptr<ChunkedDataSet> pDataSet;
+    //! The range of the values written to the layer.
+    ValueRange range;
+};
+
+//! A chunk of a tile inside a band of the master.
+struct Piece final
+{
+    //! The tile.
+    size_t tile = 0;
+    //! The cells of the tile to write.
+    GridWindow window;
+};
+
+//! Create the tiles of one row of tiles.
+/*!
+\param master
+    The BAG being tiled.
+\param rowStart
+    The first row of the master in the tiles.
+\param rowEnd
+    The last row of the master in the tiles.
+\param tileRow
+    The row of tiles, counted from the south.
+\param tileColumns
+    The number of columns in a tile.
+\param outPrefix
+    The start of the name of each tile.
+
+\return
+    The tiles, west to east, with every simple layer of the master.
+*/
+std::vector<Tile> createTiles(
+    const Dataset& master,
+    uint32_t rowStart,
+    uint32_t rowEnd,
+    uint32_t tileRow,
+    uint32_t tileColumns,
+    const std::string& outPrefix)
+{
+    const auto& metadata = master.getMetadata();
+    const auto layers = master.getLayers();
+    const auto& elevationDescriptor =
+        *master.getSimpleLayer(Elevation)->getDescriptor();
+
+    std::vector<Tile> tiles;
+
+    for (uint32_t columnStart = 0; columnStart < metadata.columns();
+        columnStart += tileColumns)
+    {
+        Tile tile;
+        tile.window = {rowStart, columnStart, rowEnd,
+            std::min(columnStart + tileColumns, metadata.columns()) - 1};
+
+        // Layers have fixed dimensions, so chunks may not be larger.
+        const auto chunkSize = [&tile](const LayerDescriptor& descriptor) {
+            const auto size = descriptor.getChunkSize();
+            return std::min<uint64_t>({size > 0 ? size : kDefaultChunkSize,
+                tile.window.rows(), tile.window.columns()});
+        };
+
+        Metadata tileMetadata;
+        tileMetadata.loadFromBuffer(exportMetadataToXML(metadata.getStruct()));
+        tileMetadata.setGridExtent(tile.window.rows(), tile.window.columns(),
+            metadata.llCornerX() + columnStart * metadata.columnResolution(),
+            metadata.llCornerY() + rowStart * metadata.rowResolution());
+
+        tile.pDataset = Dataset::create(
+            Tiler::getTileFileName(outPrefix, tileRow,
+                static_cast<uint32_t>(tiles.size())),
+            std::move(tileMetadata), chunkSize(elevationDescriptor),
+            elevationDescriptor.getCompressionLevel(),
+            master.getDescriptor().isChecksummed());
+
+        for (const auto& pLayer : layers)
+        {
+            if (!std::dynamic_pointer_cast<const SimpleLayer>(pLayer))
+                continue;
+
+            const auto& descriptor = *pLayer->getDescriptor();
+            const auto type = descriptor.getLayerType();
+            if (type != Elevation && type != Uncertainty)
+                tile.pDataset->createSimpleLayer(type, chunkSize(descriptor),
+                    descriptor.getCompressionLevel());
+        }
+
+        tiles.push_back(std::move(tile));
+    }
+
+    return tiles;
+}
+
+//! Copy a layer of the master into the tiles of one row of tiles.
+/*!
+\param source
+    The layer of the master.
+\param tiles
+    The tiles; each has the layer open for writing, and gets its range.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+*/
+void copyLayer(
+    const ChunkedDataSet& source,
+    std::vector<Tile>& tiles,
+    unsigned int numThreads)
+{
+    const auto& front = tiles.front();
+    const uint32_t rowStart = front.window.rowStart;
+    const uint32_t rowEnd = front.window.rowEnd;
+    const auto columns = static_cast<uint32_t>(source.getColumns());
+    const size_t elementSize = source.getElementSize();
+
+    // Whole chunk rows of the tiles, and of the master where they are larger.
+    const auto tileChunkRows = static_cast<uint32_t>(
+        front.pDataSet->getChunkRows());
+    const auto bandRows = tileChunkRows * std::max<uint32_t>(1u,
+        static_cast<uint32_t>(source.getChunkRows() / tileChunkRows));
+
+    std::mutex rangeMutex;
+
+    for (uint32_t bandStart = rowStart; bandStart <= rowEnd;
+        bandStart += bandRows)
+    {
+        const GridWindow band{bandStart, 0,
+            std::min(bandStart + bandRows - 1, rowEnd), columns - 1};
+        const size_t rowSize = columns * elementSize;
+
+        // Decode the band of the master.
+        std::vector<uint8_t> strip;
+        if (source.isRawDecodable())
+        {
+            strip.resize(band.rows() * rowSize);
+
+            const auto chunks = source.getChunksIntersecting(band);
+            parallelFor(chunks.size(), numThreads, [&](size_t i) {
+                const auto chunkWindow = source.getChunkWindow(chunks[i]);
+                const auto chunk = source.readChunk(chunks[i]);
+                const auto overlap = chunkWindow.intersection(band);
+
+                const size_t chunkRowSize = chunkWindow.columns() * elementSize;
+                for (uint32_t row = overlap.rowStart; row <= overlap.rowEnd;
+                    ++row)
+                    std::memcpy(strip.data() + (row - band.rowStart) * rowSize +
+                            overlap.columnStart * elementSize,
+                        chunk.data() + (row - chunkWindow.rowStart) *
+                            chunkRowSize + (overlap.columnStart -
+                            chunkWindow.columnStart) * elementSize,
+                        overlap.columns() * elementSize);
+            });
+        }
+        else
+        {
+            strip = source.read(band);
+        }
+
+        // The chunks of the tiles inside the band.
+        std::vector<Piece> pieces;
+        for (size_t i = 0; i < tiles.size(); ++i)
+        {
+            const auto& tile = tiles[i];
+            const GridWindow tileBand{band.rowStart - rowStart, 0,
+                band.rowEnd - rowStart, tile.window.columns() - 1};
+
+            for (const auto chunkIndex :
+                tile.pDataSet->getChunksIntersecting(tileBand))
+                pieces.push_back({i, tile.pDataSet->getChunkWindow(
+                    chunkIndex).intersection(tileBand)});
+        }
+
+        parallelFor(pieces.size(), numThreads, [&](size_t i) {
+            const auto& piece = pieces[i];
+            auto& tile = tiles[piece.tile];
+            const auto& window = piece.window;
+
+            const size_t pieceRowSize = window.columns() * elementSize;
+            std::vector<uint8_t> buffer(window.rows() * pieceRowSize);
+            for (uint32_t row = 0; row < window.rows(); ++row)
+                std::memcpy(buffer.data() + row * pieceRowSize,
+                    strip.data() + (window.rowStart + rowStart -
+                        band.rowStart + row) * rowSize +
+                        (window.columnStart + tile.window.columnStart) *
+                        elementSize,
+                    pieceRowSize);
+
+            tile.pDataSet->write(window, buffer.data());
+
+            ValueRange range;
+            source.addToRange(buffer.data(), window.rows(), window.columns(),
+                window.columns(), range);
+
+            std::lock_guard<std::mutex> lock{rangeMutex};
+            tile.range.merge(range);
+        });
+    }
+}
+
+}  // namespace
+
+//! Cut a BAG into a grid of tiles.
+/*!
+    Tiles are numbered from the south west; those on the north and east
+    edges hold what is left of the master, so may be smaller.
+
+\param master
+    The BAG to cut.
+\param tileRows
+    The number of rows in a tile.
+\param tileColumns
+    The number of columns in a tile.
+\param outPrefix
+    The start of the name of each tile; see getTileFileName().  No tile may
+    exist.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The names of the tiles, row by row from the south west.
+
+\throws
+    InvalidTileSize if a tile would have no rows or columns.
+*/
+std::vector<std::string> Tiler::tile(
+    const Dataset& master,
+    uint32_t tileRows,
+    uint32_t tileColumns,
+    const std::string& outPrefix,
+    unsigned int numThreads)
+{
+    if (tileRows == 0 || tileColumns == 0)
+        throw InvalidTileSize{};
+
+    if (!master.getSimpleLayer(Elevation) || !master.getSimpleLayer(Uncertainty))
+        throw LayerNotFound{};
+
+    const auto& metadata = master.getMetadata();
+    const auto& trackingList = master.getTrackingList();
+
+    std::vector<std::string> fileNames;
+
+    for (uint32_t rowStart = 0, tileRow = 0; rowStart < metadata.rows();
+        rowStart += tileRows, ++tileRow)
+    {
+        const uint32_t rowEnd =
+            std::min(rowStart + tileRows, metadata.rows()) - 1;
+
+        auto tiles = createTiles(master, rowStart, rowEnd, tileRow,
+            tileColumns, outPrefix);
+
+        for (const auto& pLayer : master.getLayers())
+        {
+            if (!std::dynamic_pointer_cast<const SimpleLayer>(pLayer))
+                continue;
+
+            const auto& descriptor = *pLayer->getDescriptor();
+            const auto& path = descriptor.getInternalPath();
+
+            for (auto& tile : tiles)
+            {
+                tile.pDataSet.reset(new ChunkedDataSet{
+                    tile.pDataset->getH5file(), path});
+                tile.range = {};
+            }
+
+            {
+                const ChunkedDataSet source{master.getH5file(), path};
+                copyLayer(source, tiles, numThreads);
+            }
+
+            for (auto& tile : tiles)
+            {
+                tile.pDataSet.reset();
+
+                auto pTileLayer = tile.pDataset->getSimpleLayer(
+                    descriptor.getLayerType());
+                if (!tile.range.empty())
+                    pTileLayer->getDescriptor()->setMinMax(tile.range.min,
+                        tile.range.max);
+                pTileLayer->writeAttributes();
+            }
+        }
+
+        // A streamed tracking list is scanned on disk once per row of tiles.
+        std::vector<TrackingItem> bandItems;
+        if (!trackingList.isLoaded())
+            bandItems = master.getTrackingListReader()->findBox(rowStart, 0,
+                rowEnd, metadata.columns() - 1);
+
+        const auto itemsBegin = trackingList.isLoaded() ?
+            trackingList.cbegin() : bandItems.cbegin();
+        const auto itemsEnd = trackingList.isLoaded() ?
+            trackingList.cend() : bandItems.cend();
+
+        for (size_t column = 0; column < tiles.size(); ++column)
+        {
+            const auto& tile = tiles[column];
+            const auto& window = tile.window;
+
+            auto& tileTrackingList = tile.pDataset->getTrackingList();
+            for (auto it = itemsBegin; it != itemsEnd; ++it)
+            {
+                auto item = *it;
+                if (item.row < window.rowStart || item.row > window.rowEnd ||
+                    item.col < window.columnStart || item.col > window.columnEnd)
+                    continue;
+
+                item.row -= window.rowStart;
+                item.col -= window.columnStart;
+                tileTrackingList.push_back(item);
+            }
+            tileTrackingList.write();
+
+            tile.pDataset->close();
+
+            fileNames.push_back(getTileFileName(outPrefix, tileRow,
+                static_cast<uint32_t>(column)));
+        }
+    }
+
+    return fileNames;
+}
+
+//! Retrieve the name of a tile.
+/*!
+\param outPrefix
+    The start of the name of each tile.
+\param tileRow
+    The row of the tile, counted from the south.
+\param tileColumn
+    The column of the tile, counted from the west.
+
+\return
+    The name of the tile; \e outPrefix followed by "_<row>_<column>.bag".
+*/
+std::string Tiler::getTileFileName(
+    const std::string& outPrefix,
+    uint32_t tileRow,
+    uint32_t tileColumn)
+{
+    return outPrefix + "_" + std::to_string(tileRow) + "_" +
+        std::to_string(tileColumn) + ".bag";
+}
+
+}  // namespace BAG
+
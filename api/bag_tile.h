@@ -0,0 +1,36 @@
+#ifndef BAG_TILE_H
+#define BAG_TILE_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <string>
+#include <vector>
+
+
+namespace BAG {
+
+//! Cutting of a BAG into a grid of tiles, each its own BAG.
+/*!
+    The master is read once, in bands of chunk rows across its whole width.
+    Each band is decoded by a pool of threads and handed to the tiles it
+    covers, whose chunks are compressed in parallel; a tile writes each of
+    its chunks once.  Only the tiles of one row of tiles are open at a time.
+
+    Every simple layer and the tracking list are tiled, and the metadata of
+    each tile is that of the master, moved to the tile's grid.
+*/
+class BAG_API Tiler final
+{
+public:
+    static std::vector<std::string> tile(const Dataset& master,
+        uint32_t tileRows, uint32_t tileColumns, const std::string& outPrefix,
+        unsigned int numThreads = 0);
+
+    static std::string getTileFileName(const std::string& outPrefix,
+        uint32_t tileRow, uint32_t tileColumn);
+};
+
+}  // namespace BAG
+
+#endif  // BAG_TILE_H
@@ -1,8 +1,13 @@
 
+#include "bag_exceptions.h"
+#include "bag_hdfhelper.h"
+#include "bag_parallel.h"
 #include "bag_private.h"
 #include "bag_trackinglist.h"
 
+#include <algorithm>
 #include <array>
+#include <functional>
 #include <H5Cpp.h>
 
 
@@ -11,13 +16,250 @@ namespace BAG {
 //! The HDF5 DataSet chunk size.
 constexpr hsize_t kChunkSize = 10;
 
+namespace {
+
+//! The orderings of the tracking list index.
+enum Ordering : size_t
+{
+    kByNode,
+    kByCode,
+    kBySeries,
+};
+
+//! Order items by row, then column.
+bool nodeLess(
+    const TrackingItem& lhs,
+    const TrackingItem& rhs) noexcept
+{
+    return lhs.row < rhs.row || (lhs.row == rhs.row && lhs.col < rhs.col);
+}
+
+//! Order items by track code.
+bool codeLess(
+    const TrackingItem& lhs,
+    const TrackingItem& rhs) noexcept
+{
+    return lhs.track_code < rhs.track_code;
+}
+
+//! Order items by list series.
+bool seriesLess(
+    const TrackingItem& lhs,
+    const TrackingItem& rhs) noexcept
+{
+    return lhs.list_series < rhs.list_series;
+}
+
+//! The key orderings of the tracking list index, by Ordering.
+constexpr std::array<bool (*)(const TrackingItem&, const TrackingItem&), 3>
+    kKeyLess{nodeLess, codeLess, seriesLess};
+
+//! The packed sort key of an item, and its position in the list.
+struct SortKey final
+{
+    //! The key.
+    uint64_t key;
+    //! The position of the item.
+    uint32_t position;
+
+    bool operator<(const SortKey& rhs) const noexcept
+    {
+        return key < rhs.key || (key == rhs.key && position < rhs.position);
+    }
+};
+
+//! Pack the key of an item in an order into an integer.
+/*!
+\param item
+    The item.
+\param order
+    The sort order.
+
+\return
+    The key of the item; keys compare as the items do in the order.
+*/
+uint64_t packSortKey(
+    const TrackingItem& item,
+    TrackingListOrder order) noexcept
+{
+    switch (order)
+    {
+    case TrackingListOrder::Node:
+        return (static_cast<uint64_t>(item.row) << 32) | item.col;
+    case TrackingListOrder::Code:
+        return item.track_code;
+    case TrackingListOrder::Series:
+        return item.list_series;
+    default:
+        return 0;
+    }
+}
+
+//! Determine if items are sorted in an order.
+/*!
+\param items
+    The items.
+\param order
+    The sort order.
+
+\return
+    \e true if the order is not Unsorted and the items follow it.
+    \e false otherwise.
+*/
+bool isSortedBy(
+    const std::vector<TrackingItem>& items,
+    TrackingListOrder order)
+{
+    return order != TrackingListOrder::Unsorted &&
+        std::is_sorted(items.begin(), items.end(),
+            [order](const TrackingItem& lhs, const TrackingItem& rhs) {
+                return packSortKey(lhs, order) < packSortKey(rhs, order);
+            });
+}
+
+//! Read the sort order attribute of the tracking list DataSet.
+/*!
+\param h5dataSet
+    The HDF5 DataSet of the tracking list.
+
+\return
+    The recorded sort order; Unsorted if none is recorded.
+*/
+TrackingListOrder readSortOrder(
+    const ::H5::DataSet& h5dataSet)
+{
+    if (!h5dataSet.attrExists(TRACKING_LIST_SORT_ORDER_NAME))
+        return TrackingListOrder::Unsorted;
+
+    uint8_t value = 0;
+    h5dataSet.openAttribute(TRACKING_LIST_SORT_ORDER_NAME).read(
+        ::H5::PredType::NATIVE_UINT8, &value);
+
+    return value <= static_cast<uint8_t>(TrackingListOrder::Series) ?
+        static_cast<TrackingListOrder>(value) : TrackingListOrder::Unsorted;
+}
+
+//! Write the sort order attribute of the tracking list DataSet.
+/*!
+    The attribute is only created once the list is sorted.
+
+\param h5dataSet
+    The HDF5 DataSet of the tracking list.
+\param order
+    The sort order.
+*/
+void writeSortOrder(
+    const ::H5::DataSet& h5dataSet,
+    TrackingListOrder order)
+{
+    const bool exists = h5dataSet.attrExists(TRACKING_LIST_SORT_ORDER_NAME);
+    if (!exists && order == TrackingListOrder::Unsorted)
+        return;
+
+    const auto attribute = exists ?
+        h5dataSet.openAttribute(TRACKING_LIST_SORT_ORDER_NAME) :
+        h5dataSet.createAttribute(TRACKING_LIST_SORT_ORDER_NAME,
+            ::H5::PredType::NATIVE_UINT8, ::H5::DataSpace{});
+
+    const auto value = static_cast<uint8_t>(order);
+    attribute.write(::H5::PredType::NATIVE_UINT8, &value);
+}
+
+//! Read the reordered attribute of the tracking list DataSet.
+/*!
+\param h5dataSet
+    The HDF5 DataSet of the tracking list.
+
+\return
+    \e true if the items were recorded as reordered.
+    \e false otherwise.
+*/
+bool readReordered(
+    const ::H5::DataSet& h5dataSet)
+{
+    if (!h5dataSet.attrExists(TRACKING_LIST_REORDERED_NAME))
+        return false;
+
+    uint8_t value = 0;
+    h5dataSet.openAttribute(TRACKING_LIST_REORDERED_NAME).read(
+        ::H5::PredType::NATIVE_UINT8, &value);
+
+    return value != 0;
+}
+
+//! Write the reordered attribute of the tracking list DataSet.
+/*!
+    The attribute is only created once the list is reordered.
+
+\param h5dataSet
+    The HDF5 DataSet of the tracking list.
+\param reordered
+    Whether the items were reordered.
+*/
+void writeReordered(
+    const ::H5::DataSet& h5dataSet,
+    bool reordered)
+{
+    const bool exists = h5dataSet.attrExists(TRACKING_LIST_REORDERED_NAME);
+    if (!exists && !reordered)
+        return;
+
+    const auto attribute = exists ?
+        h5dataSet.openAttribute(TRACKING_LIST_REORDERED_NAME) :
+        h5dataSet.createAttribute(TRACKING_LIST_REORDERED_NAME,
+            ::H5::PredType::NATIVE_UINT8, ::H5::DataSpace{});
+
+    const uint8_t value = reordered ? 1 : 0;
+    attribute.write(::H5::PredType::NATIVE_UINT8, &value);
+}
+
+//! Write a range of the items to the HDF5 DataSet.
+/*!
+\param h5dataSet
+    The HDF5 DataSet of the tracking list.
+\param h5type
+    The HDF5 CompType of the items in memory.
+\param items
+    The items of the tracking list.
+\param first
+    The first item to write.
+\param last
+    One past the last item to write.
+*/
+void writeItems(
+    const ::H5::DataSet& h5dataSet,
+    const ::H5::CompType& h5type,
+    const std::vector<TrackingItem>& items,
+    size_t first,
+    size_t last)
+{
+    const hsize_t start = first;
+    const hsize_t count = last - first;
+
+    const auto h5fileSpace = h5dataSet.getSpace();
+    h5fileSpace.selectHyperslab(H5S_SELECT_SET, &count, &start);
+
+    const ::H5::DataSpace h5memSpace{1, &count};
+
+    h5dataSet.write(items.data() + first, h5type, h5memSpace, h5fileSpace);
+}
+
+}  // namespace
+
 //! Constructor
 /*!
 \param dataset
     The BAG Dataset the tracking list belongs to.
+\param loadItems
+    Read the items into memory.  Without them, the list is empty and cannot
+    be written; a TrackingListReader streams the items instead.
 */
-TrackingList::TrackingList(const Dataset& dataset)
+TrackingList::TrackingList(
+    const Dataset& dataset,
+    bool loadItems)
     : m_pBagDataset(dataset.shared_from_this())
+    , m_loaded(loadItems)
+    , m_index(kKeyLess)
 {
     m_pH5dataSet = openH5dataSet();
 }
@@ -33,6 +275,7 @@ TrackingList::TrackingList(
     const Dataset& dataset,
     int compressionLevel)
     : m_pBagDataset(dataset.shared_from_this())
+    , m_index(kKeyLess)
 {
     m_pH5dataSet = createH5dataSet(compressionLevel);
 }
@@ -130,6 +373,21 @@ TrackingList::const_reference TrackingList::operator[](
     return m_items[index];
 }
 
+//! Replace an item of the tracking list.
+/*!
+\param index
+    The position of the item.
+\param value
+    The new item.
+*/
+void TrackingList::set(
+    size_t index,
+    const value_type& value) noexcept
+{
+    m_items[index] = value;
+    markChanged(index, index + 1);
+}
+
 //! Retrieve the number of items in the tracking list.
 /*!
 \return
@@ -143,6 +401,12 @@ size_t TrackingList::size() const noexcept
 //! Empty the tracking list.
 void TrackingList::clear() noexcept
 {
+    m_index.invalidate();
+    m_numWritten = 0;
+    m_changedBegin = 0;
+    m_changedEnd = 0;
+    m_sortOrder = TrackingListOrder::Unsorted;
+    m_reordered = false;
     m_items.clear();
 }
 
@@ -154,6 +418,7 @@ void TrackingList::clear() noexcept
 void TrackingList::push_back(const value_type& value)
 {
     m_items.push_back(value);
+    m_sortOrder = TrackingListOrder::Unsorted;
 }
 
 //! Add an item to the end of the tracking list.
@@ -164,6 +429,188 @@ void TrackingList::push_back(const value_type& value)
 void TrackingList::push_back(value_type&& value)
 {
     m_items.push_back(value);
+    m_sortOrder = TrackingListOrder::Unsorted;
+}
+
+//! Find the items of a node.
+/*!
+    The lookup is a binary search of the list when it is sorted by node, and
+    of an index over the list otherwise.  Items appended since the last lookup
+    are merged into the index first; any other change through a non-const
+    accessor has it rebuilt.
+
+\param row
+    The row of the node.
+\param col
+    The column of the node.
+
+\return
+    The items of the node, in list order.
+*/
+std::vector<TrackingList::value_type> TrackingList::findNode(
+    uint32_t row,
+    uint32_t col) const
+{
+    value_type key{};
+    key.row = row;
+    key.col = col;
+
+    if (m_sortOrder == TrackingListOrder::Node)
+        return TrackingListIndex<value_type, 3>::findSorted(key, m_items,
+            nodeLess);
+
+    return m_index.find(kByNode, key, m_items);
+}
+
+//! Find the items with a track code.
+/*!
+\param code
+    The track code.
+
+\return
+    The items with the track code, in list order.
+*/
+std::vector<TrackingList::value_type> TrackingList::findCode(
+    uint8_t code) const
+{
+    value_type key{};
+    key.track_code = code;
+
+    if (m_sortOrder == TrackingListOrder::Code)
+        return TrackingListIndex<value_type, 3>::findSorted(key, m_items,
+            codeLess);
+
+    return m_index.find(kByCode, key, m_items);
+}
+
+//! Find the items of a list series.
+/*!
+\param series
+    The list series.
+
+\return
+    The items of the list series, in list order.
+*/
+std::vector<TrackingList::value_type> TrackingList::findSeries(
+    uint16_t series) const
+{
+    value_type key{};
+    key.list_series = series;
+
+    if (m_sortOrder == TrackingListOrder::Series)
+        return TrackingListIndex<value_type, 3>::findSorted(key, m_items,
+            seriesLess);
+
+    return m_index.find(kBySeries, key, m_items);
+}
+
+//! Determine if the items of the tracking list were read into memory.
+/*!
+\return
+    \e true if the items were read from the BAG.
+    \e false if the BAG was opened to stream its tracking lists.
+*/
+bool TrackingList::isLoaded() const noexcept
+{
+    return m_loaded;
+}
+
+//! Retrieve the order the tracking list is sorted in.
+/*!
+    The order is recorded in the tracking list DataSet by write(), and is
+    lost by any change to the items.
+
+\return
+    The order the tracking list is sorted in.
+*/
+TrackingListOrder TrackingList::getSortOrder() const noexcept
+{
+    return m_sortOrder;
+}
+
+//! Determine if the items may no longer be in the order they were added.
+/*!
+    The list is reordered by sortBy() moving an item, or noted as reordered
+    with markReordered().  This is recorded in the tracking list DataSet by
+    write(), and only clear() forgets it.
+
+\return
+    \e true if the items may no longer be in the order they were added.
+    \e false otherwise.
+*/
+bool TrackingList::isReordered() const noexcept
+{
+    return m_reordered;
+}
+
+//! Note the items were reordered in place.
+/*!
+    Call this after moving items through the non-const iterators, along with
+    markChanged() for the items moved.
+*/
+void TrackingList::markReordered() noexcept
+{
+    m_reordered = true;
+}
+
+//! Sort the tracking list.
+/*!
+    The items are sorted ascending by a key packed into an integer, in
+    parallel; items with equal keys keep their relative order.  Only the
+    items that moved are rewritten at the next write(), which also records
+    the sort order.  Lookups by the sort key then search the list itself.
+
+\param order
+    The order to sort in; Node, Code or Series.
+\param numThreads
+    The number of threads to sort with.  Zero selects the hardware
+    concurrency.
+*/
+void TrackingList::sortBy(
+    TrackingListOrder order,
+    unsigned int numThreads)
+{
+    if (order != TrackingListOrder::Node && order != TrackingListOrder::Code &&
+        order != TrackingListOrder::Series)
+        throw InvalidSortOrder{};
+
+    if (order == m_sortOrder)
+        return;
+
+    const size_t numItems = m_items.size();
+
+    std::vector<SortKey> keys(numItems);
+    for (size_t i = 0; i < numItems; ++i)
+        keys[i] = {packSortKey(m_items[i], order), static_cast<uint32_t>(i)};
+
+    parallelSort(keys.begin(), keys.end(), std::less<SortKey>{}, numThreads);
+
+    // Reorder the items, noting the range that moved.
+    std::vector<value_type> sorted;
+    sorted.reserve(numItems);
+
+    size_t firstMoved = numItems;
+    size_t lastMoved = 0;
+
+    for (size_t i = 0; i < numItems; ++i)
+    {
+        sorted.push_back(m_items[keys[i].position]);
+
+        if (keys[i].position != i)
+        {
+            firstMoved = std::min(firstMoved, i);
+            lastMoved = i + 1;
+        }
+    }
+
+    if (firstMoved < lastMoved)
+    {
+        markChanged(firstMoved, lastMoved);
+        m_items.swap(sorted);
+        m_reordered = true;
+    }
+
+    m_sortOrder = order;
 }
 
 //! Retrieve the first item in the tracking list.
@@ -211,12 +658,16 @@ TrackingList::const_reference TrackingList::back() const &
     Reserve more space in the tracking list.  If the amount to be reserved is
     less than the current capacity, do nothing.
 
+    The HDF5 DataSet is also given room for that many items at the next
+    write(), so a list written as it grows is extended once.
+
 \param newCapacity
     The new capacity of the tracking list.
 */
 void TrackingList::reserve(size_t newCapacity)
 {
     m_items.reserve(newCapacity);
+    m_capacity = std::max(m_capacity, newCapacity);
 }
 
 //! Resize the tracking list to the new value.
@@ -226,6 +677,11 @@ void TrackingList::reserve(size_t newCapacity)
 */
 void TrackingList::resize(size_t count)
 {
+    m_index.invalidate();
+    m_numWritten = std::min(m_numWritten, count);
+    m_changedEnd = std::min(m_changedEnd, count);
+    if (count > m_items.size())
+        m_sortOrder = TrackingListOrder::Unsorted;
     m_items.resize(count);
 }
 
@@ -292,6 +748,8 @@ TrackingList::createH5dataSet(
 
     if (compressionLevel > 0 && compressionLevel <= kMaxCompressionLevel)
         h5createPropList.setDeflate(compressionLevel);
+    if (pDataset->getDescriptor().isChecksummed())
+        h5createPropList.setFletcher32();
 
     const auto h5dataSet = h5file.createDataSet(TRACKING_LIST_PATH,
         h5dataType, h5dataSpace, h5createPropList);
@@ -320,6 +778,7 @@ TrackingList::openH5dataSet()
         throw DatasetNotFound{};
 
     m_items.clear();
+    m_numWritten = 0;
 
     auto pDataset = m_pBagDataset.lock();
 
@@ -331,7 +790,7 @@ TrackingList::openH5dataSet()
     uint32_t length = 0;
     attribute.read(attribute.getDataType(), &length);
 
-    if (length == 0)
+    if (length == 0 || !m_loaded)
         return std::unique_ptr<::H5::DataSet, DeleteH5dataSet>(
             new ::H5::DataSet{h5dataSet}, DeleteH5dataSet{});
 
@@ -344,35 +803,45 @@ TrackingList::openH5dataSet()
     for (int i=0; i<ndims; ++i)
         numItems *= dims[i];
 
-    m_items.resize(numItems);
+    // The DataSet may have room beyond the list; read the list only.
+    const hsize_t numListItems = std::min<size_t>(numItems, length);
+    m_items.resize(numListItems);
 
-    // Set up the structure for reading.
-    ::H5::CompType h5type(sizeof(value_type));
-    h5type.insertMember("row", HOFFSET(value_type, row),
-        ::H5::PredType::NATIVE_UINT32);
-    h5type.insertMember("col", HOFFSET(value_type, col),
-        ::H5::PredType::NATIVE_UINT32);
-    h5type.insertMember("depth", HOFFSET(value_type, depth),
-        ::H5::PredType::NATIVE_FLOAT);
-    h5type.insertMember("uncertainty", HOFFSET(value_type, uncertainty),
-        ::H5::PredType::NATIVE_FLOAT);
-    h5type.insertMember("track_code", HOFFSET(value_type, track_code),
-        ::H5::PredType::NATIVE_UINT8);
-    h5type.insertMember("list_series", HOFFSET(value_type, list_series),
-        ::H5::PredType::NATIVE_INT16);
+    constexpr hsize_t kStart = 0;
+    const auto h5fileSpace = h5dataSet.getSpace();
+    h5fileSpace.selectHyperslab(H5S_SELECT_SET, &numListItems, &kStart);
+
+    const ::H5::DataSpace h5memSpace{1, &numListItems};
+
+    h5dataSet.read(m_items.data(), createH5trackingItemCompType(), h5memSpace,
+        h5fileSpace);
+    m_numWritten = m_items.size();
 
-    h5dataSet.read(m_items.data(), h5type);
+    // Trust the recorded sort order only if the items follow it; a library
+    // unaware of the attribute may have changed the list since.
+    const auto order = readSortOrder(h5dataSet);
+    if (isSortedBy(m_items, order))
+        m_sortOrder = order;
+    m_reordered = readReordered(h5dataSet);
 
     return std::unique_ptr<::H5::DataSet, DeleteH5dataSet>(
         new ::H5::DataSet{h5dataSet}, DeleteH5dataSet{});
 }
 
 //! Write the tracking list to the HDF5 DataSet.
+/*!
+    Only the items appended since the last write, and those noted as changed
+    by set(), markChanged() or sortBy(), are written; saving after each edit
+    costs the size of the edit rather than of the list.
+*/
 void TrackingList::write() const
 {
     if (m_pBagDataset.expired() || !m_pH5dataSet)
         throw DatasetNotFound{};
 
+    if (!m_loaded)
+        throw TrackingListNotLoaded{};
+
     // Write the Attribute.
     const ::H5::DataSpace listLengthDataSpace{};
     const ::H5::Attribute listLengthAtt = m_pH5dataSet->openAttribute(
@@ -381,33 +850,76 @@ void TrackingList::write() const
     const uint32_t length = static_cast<uint32_t>(m_items.size());
     listLengthAtt.write(::H5::PredType::NATIVE_UINT32, &length);
 
-    // Resize the DataSet to reflect the new data size.
-    const hsize_t numItems = length;
-    m_pH5dataSet->extend(&numItems);
+    // Grow the DataSet to hold the list, geometrically so writing a growing
+    // list extends it rarely.  The room beyond the list is trimmed when the
+    // Dataset is closed.
+    const size_t numItems = m_items.size();
+    growExtent(*m_pH5dataSet, {std::max<uint64_t>(numItems, m_capacity)},
+        true);
 
-    // Write the data.
-    const ::H5::CompType h5type{sizeof(value_type)};
+    // Write the items changed and appended since the last write only.
+    const auto h5type = createH5trackingItemCompType();
 
-    h5type.insertMember("row", HOFFSET(value_type, row),
-        ::H5::PredType::NATIVE_UINT32);
-    h5type.insertMember("col", HOFFSET(value_type, col),
-        ::H5::PredType::NATIVE_UINT32);
-    h5type.insertMember("depth", HOFFSET(value_type, depth),
-        ::H5::PredType::NATIVE_FLOAT);
-    h5type.insertMember("uncertainty", HOFFSET(value_type, uncertainty),
-        ::H5::PredType::NATIVE_FLOAT);
-    h5type.insertMember("track_code", HOFFSET(value_type, track_code),
-        ::H5::PredType::NATIVE_UINT8);
-    h5type.insertMember("list_series", HOFFSET(value_type, list_series),
-        ::H5::PredType::NATIVE_INT16);
+    if (m_changedBegin < m_changedEnd)
+        writeItems(*m_pH5dataSet, h5type, m_items, m_changedBegin,
+            m_changedEnd);
+    if (m_numWritten < numItems)
+        writeItems(*m_pH5dataSet, h5type, m_items, m_numWritten, numItems);
 
-    constexpr hsize_t kMaxSize = H5F_UNLIMITED;
+    m_numWritten = numItems;
+    m_changedBegin = 0;
+    m_changedEnd = 0;
 
-    ::H5::DataSpace h5memSpace{1, &numItems, &kMaxSize};
+    writeSortOrder(*m_pH5dataSet, m_sortOrder);
+    writeReordered(*m_pH5dataSet, m_reordered);
+}
 
-    ::H5::DataSpace h5fileSpace{1, &numItems, &kMaxSize};
+//! Note items changed in place.
+/*!
+    The items are rewritten at the next write(); items past those written
+    are written then anyway.  The lookups are rebuilt, and the list is no
+    longer known to be sorted.
+
+\param first
+    The first item.
+\param last
+    One past the last item.
+*/
+void TrackingList::markChanged(
+    size_t first,
+    size_t last) noexcept
+{
+    m_index.invalidate();
+    m_sortOrder = TrackingListOrder::Unsorted;
+
+    last = std::min(last, m_numWritten);
+    if (first >= last)
+        return;
+
+    if (m_changedBegin < m_changedEnd)
+    {
+        m_changedBegin = std::min(m_changedBegin, first);
+        m_changedEnd = std::max(m_changedEnd, last);
+    }
+    else
+    {
+        m_changedBegin = first;
+        m_changedEnd = last;
+    }
+}
+
+//! Trim the HDF5 DataSet to the items last written.
+void TrackingList::trim() const
+{
+    if (!m_pH5dataSet)
+        return;
+
+    const auto attribute = m_pH5dataSet->openAttribute(TRACKING_LIST_LENGTH_NAME);
+
+    uint32_t length = 0;
+    attribute.read(attribute.getDataType(), &length);
 
-    m_pH5dataSet->write(m_items.data(), h5type, h5memSpace, h5fileSpace);
+    trimExtent(*m_pH5dataSet, {length});
 }
 
 }   //namespace BAG
@@ -4,8 +4,10 @@
 #include "bag_config.h"
 #include "bag_deleteh5dataset.h"
 #include "bag_fordec.h"
+#include "bag_trackinglistindex.h"
 #include "bag_types.h"
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -24,6 +26,13 @@ namespace BAG {
 #endif
 
 //! The interface for a tracking list.
+/*!
+    Items changed in place, through the non-const iterators, references or
+    data(), must be noted with markChanged() before the next write() or
+    lookup.  set() replaces an item and notes it.  Items moved in place must
+    also be noted with markReordered().  Reading through them leaves the list
+    as written.
+*/
 class BAG_API TrackingList final
 {
 public:
@@ -74,11 +83,23 @@ public:
     size_t size() const noexcept;
     reference operator[](size_t index) & noexcept;
     const_reference operator[](size_t index) const & noexcept;
+    void set(size_t index, const value_type& value) noexcept;
+    void markChanged(size_t first, size_t last) noexcept;
+
+    std::vector<value_type> findNode(uint32_t row, uint32_t col) const;
+    std::vector<value_type> findCode(uint8_t code) const;
+    std::vector<value_type> findSeries(uint16_t series) const;
 
+    TrackingListOrder getSortOrder() const noexcept;
+    void sortBy(TrackingListOrder order, unsigned int numThreads = 0);
+    bool isReordered() const noexcept;
+    void markReordered() noexcept;
+
+    bool isLoaded() const noexcept;
     void write() const;
 
 protected:
-    explicit TrackingList(const Dataset& dataset);
+    explicit TrackingList(const Dataset& dataset, bool loadItems = true);
     TrackingList(const Dataset& dataset, int compressionLevel);
 
 private:
@@ -87,12 +108,30 @@ private:
         int compressionLevel);
     std::unique_ptr<::H5::DataSet, DeleteH5dataSet> openH5dataSet();
 
+    void trim() const;
+
     //! The associated BAG Dataset.
     std::weak_ptr<const Dataset> m_pBagDataset;
     //! The items in the tracking list.
     std::vector<value_type> m_items;
     //! The HDF5 DataSet this class wraps.
     std::unique_ptr<::H5::DataSet, DeleteH5dataSet> m_pH5dataSet;
+    //! The number of items to make room for in the HDF5 DataSet.
+    size_t m_capacity = 0;
+    //! The number of items, from the front, last written to the HDF5 DataSet.
+    mutable size_t m_numWritten = 0;
+    //! The first written item that may have changed since.
+    mutable size_t m_changedBegin = 0;
+    //! One past the last written item that may have changed since.
+    mutable size_t m_changedEnd = 0;
+    //! Whether the items were read from the HDF5 DataSet.
+    bool m_loaded = true;
+    //! The order the items are sorted in.
+    TrackingListOrder m_sortOrder = TrackingListOrder::Unsorted;
+    //! Whether the items may no longer be in the order they were added.
+    bool m_reordered = false;
+    //! The lookups by node, track code and list series.
+    TrackingListIndex<value_type, 3> m_index;
 
     bool itemsEqual(std::vector<value_type> other) const {
         auto size = m_items.size();
@@ -127,6 +166,7 @@ template <typename... Args>
 void TrackingList::emplace_back(Args&&... args) &
 {
     m_items.emplace_back(std::forward<Args>(args)...);
+    m_sortOrder = TrackingListOrder::Unsorted;
 }
 
 #ifdef _MSC_VER
@@ -0,0 +1,206 @@
+/*!
+\file bag_trackinglistindex.h
+\brief Sorted lookups into the items of a tracking list.
+*/
+#ifndef BAG_TRACKINGLISTINDEX_H
+#define BAG_TRACKINGLISTINDEX_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <numeric>
+#include <vector>
+
+
+namespace BAG {
+
+//! The order a tracking list is sorted in, ascending.
+/*!
+    The value is kept in an attribute of the tracking list DataSet.
+*/
+enum class TrackingListOrder : uint8_t
+{
+    //! Not sorted; the order items were added in.
+    Unsorted = 0,
+    //! By row and column (then sub row and sub column in a VR list).
+    Node = 1,
+    //! By sub row and sub column; VR tracking lists only.
+    SubPosition = 2,
+    //! By track code.
+    Code = 3,
+    //! By list series.
+    Series = 4,
+};
+
+//! Sorted orderings of the items of a tracking list.
+/*!
+    Each ordering holds the positions of the items, sorted by a key and then by
+    position, so the items sharing a key are found with a binary search and
+    come out in list order.
+
+    Items appended to the list are left pending and merged into the orderings
+    at the next lookup; any other change to the items must invalidate() the
+    index, which is then rebuilt at the next lookup.  Lookups are thread safe
+    with one another.
+
+\tparam T
+    The type of the tracking list items.
+\tparam N
+    The number of orderings.
+*/
+template <typename T, size_t N>
+class TrackingListIndex final
+{
+public:
+    //! Whether the key of one item sorts before the key of another.
+    using KeyLess = bool (*)(const T&, const T&);
+
+    explicit TrackingListIndex(const std::array<KeyLess, N>& keyLess) noexcept
+        : m_keyLess(keyLess)
+    {}
+
+    TrackingListIndex(const TrackingListIndex&) = delete;
+    TrackingListIndex(TrackingListIndex&&) = delete;
+
+    TrackingListIndex& operator=(const TrackingListIndex&) = delete;
+    TrackingListIndex& operator=(TrackingListIndex&&) = delete;
+
+    //! Drop the orderings; the items changed other than by being appended.
+    void invalidate() noexcept
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        m_numIndexed = 0;
+        for (auto& positions : m_positions)
+            positions.clear();
+    }
+
+    //! Find the items whose key matches that of an item.
+    /*!
+    \param ordering
+        The ordering to search.
+    \param key
+        An item holding the key to match.
+    \param items
+        The items of the tracking list.
+    \param prefixLess
+        Match on a leading part of the key of the ordering only, by this
+        coarser key ordering; the whole key if nullptr.
+
+    \return
+        The matching items, in list order.
+    */
+    std::vector<T> find(
+        size_t ordering,
+        const T& key,
+        const std::vector<T>& items,
+        KeyLess prefixLess = nullptr) const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        update(items);
+
+        const auto keyLess = prefixLess ? prefixLess : m_keyLess[ordering];
+        const auto& positions = m_positions[ordering];
+
+        const auto first = std::lower_bound(positions.begin(), positions.end(),
+            key, [&items, keyLess](uint32_t position, const T& value) {
+                return keyLess(items[position], value);
+            });
+        const auto last = std::upper_bound(first, positions.end(), key,
+            [&items, keyLess](const T& value, uint32_t position) {
+                return keyLess(value, items[position]);
+            });
+
+        // Matching a prefix, the positions are in order of the rest of the key.
+        std::vector<uint32_t> matches{first, last};
+        if (prefixLess)
+            std::sort(matches.begin(), matches.end());
+
+        std::vector<T> result;
+        result.reserve(matches.size());
+
+        for (const auto position : matches)
+            result.push_back(items[position]);
+
+        return result;
+    }
+
+    //! Find the items whose key matches that of an item, in sorted items.
+    /*!
+    \param key
+        An item holding the key to match.
+    \param items
+        The items of the tracking list, sorted by the key.
+    \param keyLess
+        The key ordering the items are sorted by.
+
+    \return
+        The matching items, in list order.
+    */
+    static std::vector<T> findSorted(
+        const T& key,
+        const std::vector<T>& items,
+        KeyLess keyLess)
+    {
+        const auto range = std::equal_range(items.begin(), items.end(), key,
+            keyLess);
+
+        return {range.first, range.second};
+    }
+
+private:
+    //! Bring the orderings up to date with the items.
+    /*!
+        The positions of the pending items are sorted among themselves and
+        merged after those already ordered.  They all follow the ordered
+        positions, so the stable merge keeps equal keys in list order.
+
+    \param items
+        The items of the tracking list.
+    */
+    void update(const std::vector<T>& items) const
+    {
+        const size_t numItems = items.size();
+        if (m_numIndexed > numItems)
+            m_numIndexed = 0;  // Shrunk without invalidating; start over.
+
+        if (m_numIndexed == numItems)
+            return;
+
+        for (size_t ordering = 0; ordering < N; ++ordering)
+        {
+            auto& positions = m_positions[ordering];
+            positions.resize(numItems);
+
+            const auto middle = positions.begin() + m_numIndexed;
+            std::iota(middle, positions.end(),
+                static_cast<uint32_t>(m_numIndexed));
+
+            const auto keyLess = m_keyLess[ordering];
+            const auto less = [&items, keyLess](uint32_t lhs, uint32_t rhs) {
+                return keyLess(items[lhs], items[rhs]);
+            };
+
+            std::stable_sort(middle, positions.end(), less);
+            std::inplace_merge(positions.begin(), middle, positions.end(),
+                less);
+        }
+
+        m_numIndexed = numItems;
+    }
+
+    //! The key ordering of each ordering.
+    std::array<KeyLess, N> m_keyLess;
+    //! The item positions of each ordering.
+    mutable std::array<std::vector<uint32_t>, N> m_positions;
+    //! The number of items in the orderings.
+    mutable size_t m_numIndexed = 0;
+    //! Guards the orderings against concurrent lookups.
+    mutable std::mutex m_mutex;
+};
+
+}  // namespace BAG
+
+#endif  // BAG_TRACKINGLISTINDEX_H
@@ -0,0 +1,482 @@
+#include "bag_dataset.h"
+#include "bag_exceptions.h"
+#include "bag_hdfhelper.h"
+#include "bag_private.h"
+#include "bag_trackinglistreader.h"
+
+#include <algorithm>
+#include <array>
+#include <H5Cpp.h>
+#include <iterator>
+
+
+namespace BAG {
+
+namespace {
+
+//! The number of items read at a time when streaming a list.
+constexpr size_t kBlockSize = 65536;
+
+//! Open the HDF5 DataSet of a tracking list, and read its length.
+/*!
+\param h5file
+    The HDF5 file of the BAG.
+\param path
+    The path of the tracking list DataSet.
+\param lengthName
+    The name of the list length attribute.
+\param size
+    Set to the number of items in the list.
+
+\return
+    The HDF5 DataSet of the tracking list.
+*/
+std::unique_ptr<::H5::DataSet, DeleteH5dataSet> openList(
+    const ::H5::H5File& h5file,
+    const char* path,
+    const char* lengthName,
+    size_t& size)
+{
+    const auto h5dataSet = h5file.openDataSet(path);
+    const auto attribute = h5dataSet.openAttribute(lengthName);
+
+    uint32_t length = 0;
+    attribute.read(attribute.getDataType(), &length);
+
+    // The DataSet may have room beyond the list; stream the list only.
+    std::array<hsize_t, H5S_MAX_RANK> dims{};
+    const int ndims = h5dataSet.getSpace().getSimpleExtentDims(dims.data(),
+        nullptr);
+
+    size_t numItems = 1;
+    for (int i=0; i<ndims; ++i)
+        numItems *= dims[i];
+
+    size = std::min<size_t>(numItems, length);
+
+    return std::unique_ptr<::H5::DataSet, DeleteH5dataSet>(
+        new ::H5::DataSet{h5dataSet}, DeleteH5dataSet{});
+}
+
+//! Read a range of items from the HDF5 DataSet of a tracking list.
+/*!
+\param h5dataSet
+    The HDF5 DataSet of the tracking list.
+\param h5type
+    The HDF5 CompType of an item in memory.
+\param first
+    The position of the first item.
+\param numItems
+    The number of items to read.
+\param items
+    Filled with the items.
+*/
+template <typename T>
+void readItems(
+    const ::H5::DataSet& h5dataSet,
+    const ::H5::CompType& h5type,
+    size_t first,
+    size_t numItems,
+    std::vector<T>& items)
+{
+    items.resize(numItems);
+    if (numItems == 0)
+        return;
+
+    const hsize_t count = numItems;
+    const hsize_t offset = first;
+    const auto h5fileSpace = h5dataSet.getSpace();
+    h5fileSpace.selectHyperslab(H5S_SELECT_SET, &count, &offset);
+
+    const ::H5::DataSpace h5memSpace{1, &count};
+
+    h5dataSet.read(items.data(), h5type, h5memSpace, h5fileSpace);
+}
+
+//! Read the items of a tracking list matching a predicate.
+/*!
+    The list is read a block at a time into one buffer, so only the buffer
+    and the matches are held in memory.
+
+\param h5dataSet
+    The HDF5 DataSet of the tracking list.
+\param h5type
+    The HDF5 CompType of an item in memory.
+\param size
+    The number of items in the list.
+\param predicate
+    Whether an item matches.
+
+\return
+    The matching items, in list order.
+*/
+template <typename T, typename Predicate>
+std::vector<T> scanItems(
+    const ::H5::DataSet& h5dataSet,
+    const ::H5::CompType& h5type,
+    size_t size,
+    Predicate predicate)
+{
+    std::vector<T> result;
+    std::vector<T> block;
+
+    for (size_t first = 0; first < size; first += kBlockSize)
+    {
+        readItems(h5dataSet, h5type, first, std::min(kBlockSize,
+            size - first), block);
+
+        std::copy_if(block.begin(), block.end(), std::back_inserter(result),
+            predicate);
+    }
+
+    return result;
+}
+
+}  // namespace
+
+//! Constructor.
+/*!
+\param dataset
+    The BAG Dataset the tracking list belongs to.
+*/
+TrackingListReader::TrackingListReader(const Dataset& dataset)
+    : m_pBagDataset(dataset.shared_from_this())
+{
+    m_pH5dataSet = openList(dataset.getH5file(), TRACKING_LIST_PATH,
+        TRACKING_LIST_LENGTH_NAME, m_size);
+}
+
+//! Retrieve the number of items in the tracking list.
+/*!
+\return
+    The number of items in the tracking list.
+*/
+size_t TrackingListReader::size() const noexcept
+{
+    return m_size;
+}
+
+//! Read an item of the tracking list.
+/*!
+\param index
+    The position of the item.
+
+\return
+    The item.
+*/
+TrackingListReader::value_type TrackingListReader::read(size_t index) const
+{
+    return this->read(index, index).front();
+}
+
+//! Read a range of items of the tracking list.
+/*!
+\param indexStart
+    The position of the first item.
+\param indexEnd
+    The position of the last item (inclusive).
+
+\return
+    The items from indexStart to indexEnd.
+*/
+std::vector<TrackingListReader::value_type> TrackingListReader::read(
+    size_t indexStart,
+    size_t indexEnd) const
+{
+    if (m_pBagDataset.expired())
+        throw DatasetNotFound{};
+
+    if (indexStart > indexEnd || indexEnd >= m_size)
+        throw InvalidReadSize{};
+
+    std::vector<value_type> items;
+    readItems(*m_pH5dataSet, createH5trackingItemCompType(), indexStart,
+        indexEnd - indexStart + 1, items);
+
+    return items;
+}
+
+//! Retrieve the number of items in a block.
+/*!
+\return
+    The number of items in each block but the last.
+*/
+size_t TrackingListReader::getBlockSize() noexcept
+{
+    return kBlockSize;
+}
+
+//! Retrieve the number of blocks in the tracking list.
+/*!
+\return
+    The number of blocks readBlock() reads the list in.
+*/
+size_t TrackingListReader::getNumBlocks() const noexcept
+{
+    return (m_size + kBlockSize - 1) / kBlockSize;
+}
+
+//! Read a block of items of the tracking list.
+/*!
+\param block
+    The block; from 0 to getNumBlocks() - 1.
+
+\return
+    The items of the block.
+*/
+std::vector<TrackingListReader::value_type> TrackingListReader::readBlock(
+    size_t block) const
+{
+    if (block >= this->getNumBlocks())
+        throw InvalidReadSize{};
+
+    const size_t first = block * kBlockSize;
+
+    return this->read(first, std::min(first + kBlockSize, m_size) - 1);
+}
+
+//! Find the items with a track code.
+/*!
+\param code
+    The track code.
+
+\return
+    The items with the track code, in list order.
+*/
+std::vector<TrackingListReader::value_type> TrackingListReader::findCode(
+    uint8_t code) const
+{
+    if (m_pBagDataset.expired())
+        throw DatasetNotFound{};
+
+    return scanItems<value_type>(*m_pH5dataSet, createH5trackingItemCompType(),
+        m_size, [code](const value_type& item) {
+            return item.track_code == code;
+        });
+}
+
+//! Find the items of a list series.
+/*!
+\param series
+    The list series.
+
+\return
+    The items of the list series, in list order.
+*/
+std::vector<TrackingListReader::value_type> TrackingListReader::findSeries(
+    uint16_t series) const
+{
+    if (m_pBagDataset.expired())
+        throw DatasetNotFound{};
+
+    return scanItems<value_type>(*m_pH5dataSet, createH5trackingItemCompType(),
+        m_size, [series](const value_type& item) {
+            return item.list_series == series;
+        });
+}
+
+//! Find the items of the nodes in a rectangle.
+/*!
+\param rowStart
+    The starting row.
+\param columnStart
+    The starting column.
+\param rowEnd
+    The ending row (inclusive).
+\param columnEnd
+    The ending column (inclusive).
+
+\return
+    The items of the nodes in the rectangle, in list order.
+*/
+std::vector<TrackingListReader::value_type> TrackingListReader::findBox(
+    uint32_t rowStart,
+    uint32_t columnStart,
+    uint32_t rowEnd,
+    uint32_t columnEnd) const
+{
+    if (m_pBagDataset.expired())
+        throw DatasetNotFound{};
+
+    return scanItems<value_type>(*m_pH5dataSet, createH5trackingItemCompType(),
+        m_size, [=](const value_type& item) {
+            return item.row >= rowStart && item.row <= rowEnd &&
+                item.col >= columnStart && item.col <= columnEnd;
+        });
+}
+
+//! Constructor.
+/*!
+\param dataset
+    The BAG Dataset the variable resolution tracking list belongs to.
+*/
+VRTrackingListReader::VRTrackingListReader(const Dataset& dataset)
+    : m_pBagDataset(dataset.shared_from_this())
+{
+    m_pH5dataSet = openList(dataset.getH5file(), VR_TRACKING_LIST_PATH,
+        VR_TRACKING_LIST_LENGTH_NAME, m_size);
+}
+
+//! Retrieve the number of items in the variable resolution tracking list.
+/*!
+\return
+    The number of items in the variable resolution tracking list.
+*/
+size_t VRTrackingListReader::size() const noexcept
+{
+    return m_size;
+}
+
+//! Read an item of the variable resolution tracking list.
+/*!
+\param index
+    The position of the item.
+
+\return
+    The item.
+*/
+VRTrackingListReader::value_type VRTrackingListReader::read(size_t index) const
+{
+    return this->read(index, index).front();
+}
+
+//! Read a range of items of the variable resolution tracking list.
+/*!
+\param indexStart
+    The position of the first item.
+\param indexEnd
+    The position of the last item (inclusive).
+
+\return
+    The items from indexStart to indexEnd.
+*/
+std::vector<VRTrackingListReader::value_type> VRTrackingListReader::read(
+    size_t indexStart,
+    size_t indexEnd) const
+{
+    if (m_pBagDataset.expired())
+        throw DatasetNotFound{};
+
+    if (indexStart > indexEnd || indexEnd >= m_size)
+        throw InvalidReadSize{};
+
+    std::vector<value_type> items;
+    readItems(*m_pH5dataSet, createH5vrTrackingItemCompType(), indexStart,
+        indexEnd - indexStart + 1, items);
+
+    return items;
+}
+
+//! Retrieve the number of items in a block.
+/*!
+\return
+    The number of items in each block but the last.
+*/
+size_t VRTrackingListReader::getBlockSize() noexcept
+{
+    return kBlockSize;
+}
+
+//! Retrieve the number of blocks in the variable resolution tracking list.
+/*!
+\return
+    The number of blocks readBlock() reads the list in.
+*/
+size_t VRTrackingListReader::getNumBlocks() const noexcept
+{
+    return (m_size + kBlockSize - 1) / kBlockSize;
+}
+
+//! Read a block of items of the variable resolution tracking list.
+/*!
+\param block
+    The block; from 0 to getNumBlocks() - 1.
+
+\return
+    The items of the block.
+*/
+std::vector<VRTrackingListReader::value_type> VRTrackingListReader::readBlock(
+    size_t block) const
+{
+    if (block >= this->getNumBlocks())
+        throw InvalidReadSize{};
+
+    const size_t first = block * kBlockSize;
+
+    return this->read(first, std::min(first + kBlockSize, m_size) - 1);
+}
+
+//! Find the items with a track code.
+/*!
+\param code
+    The track code.
+
+\return
+    The items with the track code, in list order.
+*/
+std::vector<VRTrackingListReader::value_type> VRTrackingListReader::findCode(
+    uint8_t code) const
+{
+    if (m_pBagDataset.expired())
+        throw DatasetNotFound{};
+
+    return scanItems<value_type>(*m_pH5dataSet,
+        createH5vrTrackingItemCompType(), m_size,
+        [code](const value_type& item) {
+            return item.track_code == code;
+        });
+}
+
+//! Find the items of a list series.
+/*!
+\param series
+    The list series.
+
+\return
+    The items of the list series, in list order.
+*/
+std::vector<VRTrackingListReader::value_type> VRTrackingListReader::findSeries(
+    uint16_t series) const
+{
+    if (m_pBagDataset.expired())
+        throw DatasetNotFound{};
+
+    return scanItems<value_type>(*m_pH5dataSet,
+        createH5vrTrackingItemCompType(), m_size,
+        [series](const value_type& item) {
+            return item.list_series == series;
+        });
+}
+
+//! Find the items of the supercells in a rectangle.
+/*!
+\param rowStart
+    The starting row of supercells.
+\param columnStart
+    The starting column of supercells.
+\param rowEnd
+    The ending row of supercells (inclusive).
+\param columnEnd
+    The ending column of supercells (inclusive).
+
+\return
+    The items of the supercells in the rectangle, in list order.
+*/
+std::vector<VRTrackingListReader::value_type> VRTrackingListReader::findBox(
+    uint32_t rowStart,
+    uint32_t columnStart,
+    uint32_t rowEnd,
+    uint32_t columnEnd) const
+{
+    if (m_pBagDataset.expired())
+        throw DatasetNotFound{};
+
+    return scanItems<value_type>(*m_pH5dataSet,
+        createH5vrTrackingItemCompType(), m_size,
+        [=](const value_type& item) {
+            return item.row >= rowStart && item.row <= rowEnd &&
+                item.col >= columnStart && item.col <= columnEnd;
+        });
+}
+
+}  // namespace BAG
@@ -0,0 +1,123 @@
+#ifndef BAG_TRACKINGLISTREADER_H
+#define BAG_TRACKINGLISTREADER_H
+
+#include "bag_config.h"
+#include "bag_deleteh5dataset.h"
+#include "bag_fordec.h"
+#include "bag_types.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+namespace H5 {
+
+class DataSet;
+
+}  // namespace H5
+
+namespace BAG {
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)  // std classes do not have DLL-interface when exporting
+#endif
+
+//! Streaming, read only access to the tracking list in a BAG.
+/*!
+    Unlike TrackingList, which holds every item in memory, the reader reads
+    the items from the HDF5 DataSet as they are asked for: single items and
+    ranges by index, and whole lists a block of items at a time.  The scans
+    by track code, list series or node rectangle hold one block at a time,
+    so their memory use depends on the number of matches only.
+
+    The reader sees the items last written to the BAG.
+*/
+class BAG_API TrackingListReader final
+{
+public:
+    using value_type = TrackingItem;
+
+    // Allow std::make_shared() to call our constructor
+    explicit TrackingListReader(const Dataset& dataset);
+
+    TrackingListReader(const TrackingListReader&) = delete;
+    TrackingListReader(TrackingListReader&&) = delete;
+
+    TrackingListReader& operator=(const TrackingListReader&) = delete;
+    TrackingListReader& operator=(TrackingListReader&&) = delete;
+
+    size_t size() const noexcept;
+
+    value_type read(size_t index) const;
+    std::vector<value_type> read(size_t indexStart, size_t indexEnd) const;
+
+    static size_t getBlockSize() noexcept;
+    size_t getNumBlocks() const noexcept;
+    std::vector<value_type> readBlock(size_t block) const;
+
+    std::vector<value_type> findCode(uint8_t code) const;
+    std::vector<value_type> findSeries(uint16_t series) const;
+    std::vector<value_type> findBox(uint32_t rowStart, uint32_t columnStart,
+        uint32_t rowEnd, uint32_t columnEnd) const;
+
+private:
+    //! The associated BAG Dataset.
+    std::weak_ptr<const Dataset> m_pBagDataset;
+    //! The HDF5 DataSet of the tracking list.
+    std::unique_ptr<::H5::DataSet, DeleteH5dataSet> m_pH5dataSet;
+    //! The number of items in the tracking list.
+    size_t m_size = 0;
+};
+
+//! Streaming, read only access to the variable resolution tracking list in a
+//! BAG.
+/*!
+    The variable resolution counterpart of TrackingListReader; the rectangle
+    of a scan is one of supercells.
+*/
+class BAG_API VRTrackingListReader final
+{
+public:
+    using value_type = VRTrackingItem;
+
+    // Allow std::make_shared() to call our constructor
+    explicit VRTrackingListReader(const Dataset& dataset);
+
+    VRTrackingListReader(const VRTrackingListReader&) = delete;
+    VRTrackingListReader(VRTrackingListReader&&) = delete;
+
+    VRTrackingListReader& operator=(const VRTrackingListReader&) = delete;
+    VRTrackingListReader& operator=(VRTrackingListReader&&) = delete;
+
+    size_t size() const noexcept;
+
+    value_type read(size_t index) const;
+    std::vector<value_type> read(size_t indexStart, size_t indexEnd) const;
+
+    static size_t getBlockSize() noexcept;
+    size_t getNumBlocks() const noexcept;
+    std::vector<value_type> readBlock(size_t block) const;
+
+    std::vector<value_type> findCode(uint8_t code) const;
+    std::vector<value_type> findSeries(uint16_t series) const;
+    std::vector<value_type> findBox(uint32_t rowStart, uint32_t columnStart,
+        uint32_t rowEnd, uint32_t columnEnd) const;
+
+private:
+    //! The associated BAG Dataset.
+    std::weak_ptr<const Dataset> m_pBagDataset;
+    //! The HDF5 DataSet of the variable resolution tracking list.
+    std::unique_ptr<::H5::DataSet, DeleteH5dataSet> m_pH5dataSet;
+    //! The number of items in the variable resolution tracking list.
+    size_t m_size = 0;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+}  // namespace BAG
+
+#endif  // BAG_TRACKINGLISTREADER_H
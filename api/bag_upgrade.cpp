@@ -0,0 +1,249 @@
+#include "bag_chunkio.h"
+#include "bag_dataset.h"
+#include "bag_hdfhelper.h"
+#include "bag_interleavedlegacylayer.h"
+#include "bag_interleavedlegacylayerdescriptor.h"
+#include "bag_parallel.h"
+#include "bag_private.h"
+#include "bag_repack.h"
+#include "bag_simplelayer.h"
+#include "bag_simplelayerdescriptor.h"
+#include "bag_upgrade.h"
+#include "bag_version.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <H5Cpp.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace BAG {
+
+namespace {
+
+//! The chunk size used when the elevation layer is not chunked.
+constexpr uint64_t kDefaultChunkSize = 100;
+
+//! An interleaved layer becoming a simple layer.
+struct Member final
+{
+    //! The type of the layer.
+    LayerType type = UNKNOWN_LAYER_TYPE;
+    //! The offset of the member in a record of the interleaved DataSet.
+    size_t offset = 0;
+    //! The new simple layer.
+    std::unique_ptr<ChunkedDataSet> pDestination;
+    //! The range of the values written to the new layer.
+    ValueRange range;
+};
+
+//! The path of the DataSet holding an interleaved group.
+const char* getGroupPath(
+    GroupType groupType)
+{
+    return groupType == NODE ? NODE_GROUP_PATH : ELEVATION_SOLUTION_GROUP_PATH;
+}
+
+//! Split one interleaved DataSet into simple layers of the upgraded BAG.
+/*!
+\param source
+    The file of the legacy BAG.
+\param upgraded
+    The upgraded BAG.
+\param destination
+    The file of the upgraded BAG.
+\param groupType
+    The interleaved group; NODE or ELEVATION.
+\param types
+    The layers of the group to split out.
+\param chunkSize
+    The chunk size of the new layers.
+\param compressionLevel
+    The compression level of the new layers.
+\param numThreads
+    The number of threads to use.
+*/
+void splitGroup(
+    const ::H5::H5File& source,
+    Dataset& upgraded,
+    const ::H5::H5File& destination,
+    GroupType groupType,
+    const std::vector<LayerType>& types,
+    uint64_t chunkSize,
+    int compressionLevel,
+    unsigned int numThreads)
+{
+    if (types.empty())
+        return;
+
+    const ChunkedDataSet group{source, getGroupPath(groupType)};
+
+    std::vector<Member> members;
+    for (const auto type : types)
+    {
+        // The member names come from the type legacy layers are read with.
+        const auto memberName = createH5compType(type, groupType)
+            .getMemberName(0);
+        const int index = H5Tget_member_index(group.getMemType(),
+            memberName.c_str());
+        if (index < 0)
+            continue;
+
+        upgraded.createSimpleLayer(type, chunkSize, compressionLevel);
+
+        Member member;
+        member.type = type;
+        member.offset = H5Tget_member_offset(group.getMemType(),
+            static_cast<unsigned int>(index));
+        member.pDestination.reset(new ChunkedDataSet{destination,
+            Layer::getInternalPath(type)});
+
+        members.push_back(std::move(member));
+    }
+
+    if (members.empty())
+        return;
+
+    const auto& grid = *members.front().pDestination;
+    const size_t recordSize = group.getElementSize();
+    std::mutex rangeMutex;
+
+    parallelFor(grid.getNumChunks(), numThreads, [&](size_t chunkIndex) {
+        const auto window = grid.getChunkWindow(chunkIndex);
+        const size_t numValues = static_cast<size_t>(window.rows()) *
+            window.columns();
+
+        // Each chunk of the group is decoded once for all of its members.
+        const auto records = group.read(window);
+
+        for (auto& member : members)
+        {
+            const size_t valueSize = member.pDestination->getElementSize();
+            std::vector<uint8_t> values(numValues * valueSize);
+
+            for (size_t i = 0; i < numValues; ++i)
+                std::memcpy(values.data() + i * valueSize,
+                    records.data() + i * recordSize + member.offset,
+                    valueSize);
+
+            member.pDestination->writeChunk(chunkIndex, values.data());
+
+            ValueRange range;
+            member.pDestination->addToRange(values.data(), window.rows(),
+                window.columns(), window.columns(), range);
+
+            std::lock_guard<std::mutex> lock{rangeMutex};
+            member.range.merge(range);
+        }
+    });
+
+    for (auto& member : members)
+    {
+        member.pDestination.reset();
+
+        if (member.range.empty())
+            continue;
+
+        auto pLayer = upgraded.getSimpleLayer(member.type);
+        pLayer->getDescriptor()->setMinMax(member.range.min, member.range.max);
+        pLayer->writeAttributes();
+    }
+}
+
+}  // namespace
+
+//! Migrate a legacy BAG, with interleaved layers, into a BAG 2.0 file.
+/*!
+\param dataset
+    The BAG Dataset to upgrade.
+\param outFileName
+    The name of the new BAG; it must not exist.
+\param chunkSize
+    The chunk size of two dimensional DataSets.  Zero keeps the chunk size of
+    each DataSet; the new layers then use the chunk size of the elevation
+    layer.
+\param compressionLevel
+    The compression level of chunked DataSets; zero for none.  Negative keeps
+    the filters of each DataSet; the new layers then use the compression
+    level of the elevation layer.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The new BAG, open for reading and writing.
+*/
+std::shared_ptr<Dataset> Upgrader::upgrade(
+    const Dataset& dataset,
+    const std::string& outFileName,
+    uint64_t chunkSize,
+    int compressionLevel,
+    unsigned int numThreads)
+{
+    // The interleaved layers, by group, that have no simple layer yet.
+    std::array<std::vector<LayerType>, 2> groupLayers;
+    std::vector<std::string> excludedPaths;
+
+    for (const auto& pLayer : dataset.getLayers())
+    {
+        const auto pDescriptor =
+            std::dynamic_pointer_cast<const InterleavedLegacyLayerDescriptor>(
+                pLayer->getDescriptor());
+        if (!pDescriptor)
+            continue;
+
+        const auto groupType = pDescriptor->getGroupType();
+        const auto path = getGroupPath(groupType);
+        if (std::find(excludedPaths.begin(), excludedPaths.end(), path) ==
+            excludedPaths.end())
+            excludedPaths.emplace_back(path);
+
+        const auto type = pDescriptor->getLayerType();
+        if (!dataset.getSimpleLayer(type))
+            groupLayers[groupType == NODE ? 0 : 1].push_back(type);
+    }
+
+    auto pUpgraded = Repacker::repackExcept(dataset, outFileName, chunkSize,
+        compressionLevel, numThreads, excludedPaths);
+
+    {
+        // Mark the new file with the current version.
+        std::array<char, BAG_VERSION_LENGTH> version{};
+        std::strncpy(version.data(), BAG_VERSION, version.size() - 1);
+
+        std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+        const auto h5bagGroup = pUpgraded->getH5file().openGroup(ROOT_PATH);
+        const auto versionAtt = h5bagGroup.attrExists(BAG_VERSION_NAME) ?
+            h5bagGroup.openAttribute(BAG_VERSION_NAME) :
+            h5bagGroup.createAttribute(BAG_VERSION_NAME,
+                ::H5::StrType{0, BAG_VERSION_LENGTH}, ::H5::DataSpace{});
+        versionAtt.write(::H5::StrType{0, BAG_VERSION_LENGTH}, version.data());
+
+        pUpgraded->m_descriptor.setVersion(BAG_VERSION);
+    }
+
+    // The new layers are chunked like the elevation layer.
+    const auto& elevationDescriptor =
+        *dataset.getLayer(Elevation, {})->getDescriptor();
+    const auto& metadata = dataset.getMetadata();
+
+    const auto elevationChunkSize = elevationDescriptor.getChunkSize();
+    const auto layerChunkSize = std::min<uint64_t>({chunkSize > 0 ? chunkSize :
+        (elevationChunkSize > 0 ? elevationChunkSize : kDefaultChunkSize),
+        metadata.rows(), metadata.columns()});
+    const auto layerCompressionLevel = compressionLevel >= 0 ?
+        compressionLevel : elevationDescriptor.getCompressionLevel();
+
+    splitGroup(dataset.getH5file(), *pUpgraded, pUpgraded->getH5file(), NODE,
+        groupLayers[0], layerChunkSize, layerCompressionLevel, numThreads);
+    splitGroup(dataset.getH5file(), *pUpgraded, pUpgraded->getH5file(),
+        ELEVATION, groupLayers[1], layerChunkSize, layerCompressionLevel,
+        numThreads);
+
+    return pUpgraded;
+}
+
+}  // namespace BAG
@@ -0,0 +1,38 @@
+#ifndef BAG_UPGRADE_H
+#define BAG_UPGRADE_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+namespace BAG {
+
+//! Migration of a legacy (BAG 1.5 and 1.6) file into a BAG 2.0 file.
+/*!
+    Legacy BAGs keep their optional layers interleaved, as members of the
+    compound NODE (/BAG_root/node) and ELEVATION (/BAG_root/elevation_solution)
+    DataSets.  Each is streamed once, decoding every chunk a single time
+    across a pool of threads, and split into one simple layer per member:
+    Hypothesis_Strength and Num_Hypotheses, and Shoal_Elevation, Std_Dev and
+    Num_Soundings.  The minimum and maximum of each new layer are computed
+    along the way.
+
+    Everything else is copied as the Repacker copies it, and the new file is
+    marked with the current BAG version.  A BAG without interleaved layers is
+    simply copied.
+*/
+class BAG_API Upgrader final
+{
+public:
+    static std::shared_ptr<Dataset> upgrade(const Dataset& dataset,
+        const std::string& outFileName, uint64_t chunkSize = 0,
+        int compressionLevel = -1, unsigned int numThreads = 0);
+};
+
+}  // namespace BAG
+
+#endif  // BAG_UPGRADE_H
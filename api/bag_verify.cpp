@@ -0,0 +1,125 @@
+
+#include "bag_chunkio.h"
+#include "bag_dataset.h"
+#include "bag_parallel.h"
+#include "bag_verify.h"
+
+#include <algorithm>
+#include <H5Cpp.h>
+#include <memory>
+#include <mutex>
+
+
+namespace BAG {
+
+namespace {
+
+//! Collect the path of each HDF5 DataSet found by H5Lvisit().
+herr_t collectDataSet(
+    hid_t group,
+    const char* name,
+    const H5L_info_t* info,
+    void* paths)
+{
+    if (info->type != H5L_TYPE_HARD)
+        return 0;
+
+    const hid_t id = H5Oopen(group, name, H5P_DEFAULT);
+    if (id < 0)
+        return 0;
+
+    if (H5Iget_type(id) == H5I_DATASET)
+        static_cast<std::vector<std::string>*>(paths)->push_back(
+            std::string{"/"} + name);
+
+    H5Oclose(id);
+
+    return 0;
+}
+
+}  // namespace
+
+//! Check every chunk of a BAG.
+/*!
+\param dataset
+    The BAG Dataset.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The chunks that are not intact, ordered by DataSet path then chunk.
+*/
+std::vector<ChunkFault> Verifier::verify(
+    const Dataset& dataset,
+    unsigned int numThreads)
+{
+    const auto& h5file = dataset.getH5file();
+
+    std::vector<std::string> paths;
+    {
+        std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+        H5Lvisit(h5file.getId(), H5_INDEX_NAME, H5_ITER_INC, collectDataSet,
+            &paths);
+    }
+
+    // Scalar and higher rank DataSets have no chunks to check here.
+    std::vector<std::unique_ptr<const ChunkedDataSet>> dataSets;
+    std::vector<std::string> dataSetPaths;
+
+    for (const auto& path : paths)
+    {
+        try
+        {
+            dataSets.emplace_back(new ChunkedDataSet{h5file, path});
+            dataSetPaths.push_back(path);
+        }
+        catch (const UnsupportedElementSize&)
+        {
+        }
+    }
+
+    // The first task of each DataSet.
+    std::vector<uint64_t> firstTask{0};
+    for (const auto& pDataSet : dataSets)
+        firstTask.push_back(firstTask.back() + pDataSet->getNumChunks());
+
+    std::vector<ChunkFault> faults;
+    std::mutex faultMutex;
+
+    parallelFor(firstTask.back(), numThreads, [&](size_t task) {
+        const size_t dataSetIndex = static_cast<size_t>(std::distance(
+            firstTask.begin(), std::upper_bound(firstTask.begin(),
+                firstTask.end(), task)) - 1);
+        const uint64_t chunkIndex = task - firstTask[dataSetIndex];
+        const auto& dataSet = *dataSets[dataSetIndex];
+
+        auto message = dataSet.verifyChunk(chunkIndex);
+        if (message.empty())
+            return;
+
+        const auto window = dataSet.getChunkWindow(chunkIndex);
+
+        ChunkFault fault;
+        fault.path = dataSetPaths[dataSetIndex];
+        fault.chunkIndex = chunkIndex;
+        fault.rowStart = window.rowStart;
+        fault.columnStart = window.columnStart;
+        fault.rowEnd = window.rowEnd;
+        fault.columnEnd = window.columnEnd;
+        fault.message = std::move(message);
+
+        std::lock_guard<std::mutex> lock{faultMutex};
+        faults.push_back(std::move(fault));
+    });
+
+    std::sort(faults.begin(), faults.end(),
+        [](const ChunkFault& lhs, const ChunkFault& rhs) {
+            return lhs.path < rhs.path ||
+                (lhs.path == rhs.path && lhs.chunkIndex < rhs.chunkIndex);
+        });
+
+    return faults;
+}
+
+}  // namespace BAG
+
@@ -0,0 +1,61 @@
+#ifndef BAG_VERIFY_H
+#define BAG_VERIFY_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace BAG {
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)  // std classes do not have DLL-interface when exporting
+#endif
+
+//! A chunk of a BAG that cannot be read back intact.
+struct ChunkFault final
+{
+    //! The path of the HDF5 DataSet holding the chunk.
+    std::string path;
+    //! The chunk, numbered row major.
+    uint64_t chunkIndex = 0;
+    //! The first row of the chunk (always 0 in one dimensional DataSets).
+    uint32_t rowStart = 0;
+    //! The first column (or element) of the chunk.
+    uint32_t columnStart = 0;
+    //! The last row of the chunk.
+    uint32_t rowEnd = 0;
+    //! The last column (or element) of the chunk.
+    uint32_t columnEnd = 0;
+    //! Why the chunk is not intact.
+    std::string message;
+};
+
+//! Integrity checking of every chunk of a BAG.
+/*!
+    Every chunk of every one and two dimensional HDF5 DataSet in the file is
+    checked across threads.  Raw chunks are read under the HDF5 mutex, and
+    their Fletcher32 checksum (see Dataset::create()) is checked and they are
+    inflated without it, so the check is limited by the disk rather than by
+    HDF5.  Chunks without a checksum can only be found corrupt if they do not
+    inflate.
+*/
+class BAG_API Verifier final
+{
+public:
+    static std::vector<ChunkFault> verify(const Dataset& dataset,
+        unsigned int numThreads = 0);
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+}  // namespace BAG
+
+#endif  // BAG_VERIFY_H
+
@@ -0,0 +1,11 @@
+#ifndef BAG_VERSION_H
+#define BAG_VERSION_H
+
+#define BAG_VERSION         "2.0.5"
+#define BAG_VERSION_LENGTH  32      // Reserve 32 bytes of space in the attribute.
+#define BAG_VER_MAJOR       2
+#define BAG_VER_MINOR       0
+#define BAG_VER_REVISION    5
+
+#endif  // BAG_VERSION_H
+
@@ -0,0 +1,465 @@
+#include "bag_chunkio.h"
+#include "bag_dataset.h"
+#include "bag_exceptions.h"
+#include "bag_layerdescriptor.h"
+#include "bag_metadata.h"
+#include "bag_metadata_export.h"
+#include "bag_parallel.h"
+#include "bag_simplelayer.h"
+#include "bag_types.h"
+#include "bag_vrbuild.h"
+#include "bag_vrmetadata.h"
+#include "bag_vrnode.h"
+#include "bag_vrrefinements.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <vector>
+
+
+namespace BAG {
+
+namespace {
+
+//! The sums of the source cells standing for one refined node.
+struct NodeBin final
+{
+    //! Include a source cell.
+    void add(
+        float elevation,
+        float uncertainty,
+        uint32_t soundings,
+        uint32_t hypotheses,
+        float hypStrength) noexcept
+    {
+        if (!ValueRange::isValid(elevation))
+            return;
+
+        elevationSum += elevation;
+        ++numElevations;
+
+        if (ValueRange::isValid(uncertainty))
+        {
+            uncertaintySum += uncertainty;
+            ++numUncertainties;
+        }
+
+        if (ValueRange::isValid(hypStrength))
+        {
+            hypStrengthSum += hypStrength;
+            ++numHypStrengths;
+        }
+
+        numSoundings += soundings;
+        maxHypotheses = std::max(maxHypotheses, hypotheses);
+    }
+
+    //! The refinement of the node.
+    VRRefinementsItem getRefinement() const noexcept
+    {
+        return {numElevations > 0 ?
+                static_cast<float>(elevationSum / numElevations) :
+                BAG_NULL_ELEVATION,
+            numUncertainties > 0 ?
+                static_cast<float>(uncertaintySum / numUncertainties) :
+                BAG_NULL_UNCERTAINTY};
+    }
+
+    //! The node values of the node.
+    VRNodeItem getNode() const noexcept
+    {
+        return {numHypStrengths > 0 ?
+                static_cast<float>(hypStrengthSum / numHypStrengths) : 0.f,
+            maxHypotheses, numSoundings};
+    }
+
+    //! The sum of the elevations.
+    double elevationSum = 0.;
+    //! The number of elevations.
+    uint32_t numElevations = 0;
+    //! The sum of the uncertainties.
+    double uncertaintySum = 0.;
+    //! The number of uncertainties.
+    uint32_t numUncertainties = 0;
+    //! The sum of the hypotheses strengths.
+    double hypStrengthSum = 0.;
+    //! The number of hypotheses strengths.
+    uint32_t numHypStrengths = 0;
+    //! The number of soundings.
+    uint32_t numSoundings = 0;
+    //! The most hypotheses.
+    uint32_t maxHypotheses = 0;
+};
+
+//! A row of supercells, ready to be written.
+struct SupercellRow final
+{
+    //! The variable resolution metadata; the indices are relative to the
+    //! first refinement of the row.
+    std::vector<VRMetadataItem> supercells;
+    //! The refinements of the refined supercells, one after the other.
+    std::vector<VRRefinementsItem> refinements;
+    //! The nodes matching the refinements.
+    std::vector<VRNodeItem> nodes;
+    //! The low resolution elevation of each supercell.
+    std::vector<float> elevations;
+    //! The low resolution uncertainty of each supercell.
+    std::vector<float> uncertainties;
+};
+
+//! The optional layers of the source, read as dense grids.
+const std::array<LayerType, 3> kNodeLayers{Num_Soundings, Num_Hypotheses,
+    Hypothesis_Strength};
+
+//! Pick the number of refined nodes along the sides of a supercell.
+/*!
+\param rule
+    The resolution rule.
+\param ruleFactor
+    The factor of the rule.
+\param shoalest
+    The shoalest (highest) elevation in the supercell.
+\param numSoundings
+    The number of soundings in the supercell.
+\param width
+    The number of source cells across the supercell.
+\param height
+    The number of source cells up the supercell.
+\param columnResolution
+    The column resolution of the source.
+\param rowResolution
+    The row resolution of the source.
+\param numColumns
+    Set to the number of nodes across.
+\param numRows
+    Set to the number of nodes up.
+*/
+void pickDimensions(
+    VRResolutionRule rule,
+    double ruleFactor,
+    float shoalest,
+    uint64_t numSoundings,
+    uint32_t width,
+    uint32_t height,
+    double columnResolution,
+    double rowResolution,
+    uint32_t& numColumns,
+    uint32_t& numRows)
+{
+    // Clamp a number of nodes between one and the number of cells.
+    const auto clamp = [](double nodes, uint32_t cells) {
+        return static_cast<uint32_t>(std::max(1., std::min<double>(
+            std::floor(nodes), cells)));
+    };
+
+    if (rule == VRResolutionRule::Density)
+    {
+        const double nodes = std::sqrt(numSoundings / ruleFactor);
+
+        numColumns = clamp(nodes, width);
+        numRows = clamp(nodes, height);
+        return;
+    }
+
+    // Land and drying areas get the finest grid.
+    const double spacing = ruleFactor * -shoalest;
+    if (!(spacing > 0.))
+    {
+        numColumns = width;
+        numRows = height;
+        return;
+    }
+
+    numColumns = clamp(width * columnResolution / spacing, width);
+    numRows = clamp(height * rowResolution / spacing, height);
+}
+
+}  // namespace
+
+//! Build a variable resolution BAG from a single resolution one.
+/*!
+\param source
+    The dense, single resolution BAG.
+\param outFileName
+    The name of the variable resolution BAG to create; it must not exist.
+\param supercellSize
+    The number of source cells along each side of a supercell.
+\param rule
+    How the refinement grid of each supercell is chosen.
+\param ruleFactor
+    The factor of the rule: the node spacing as a fraction of the depth, or
+    the number of soundings per node.
+\param chunkSize
+    The chunk size of the output layers.
+\param compressionLevel
+    The compression level of the output layers.
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The new variable resolution BAG.
+*/
+std::shared_ptr<Dataset> VRBuilder::build(
+    const Dataset& source,
+    const std::string& outFileName,
+    uint32_t supercellSize,
+    VRResolutionRule rule,
+    double ruleFactor,
+    uint64_t chunkSize,
+    int compressionLevel,
+    unsigned int numThreads)
+{
+    if (supercellSize == 0)
+        throw InvalidSupercellSize{};
+    if (!(ruleFactor > 0.))
+        throw InvalidRuleFactor{};
+
+    const auto& metadata = source.getMetadata();
+    const uint32_t sourceRows = metadata.rows();
+    const uint32_t sourceColumns = metadata.columns();
+    const double rowResolution = metadata.rowResolution();
+    const double columnResolution = metadata.columnResolution();
+
+    const uint32_t rows = (sourceRows + supercellSize - 1) / supercellSize;
+    const uint32_t columns = (sourceColumns + supercellSize - 1) /
+        supercellSize;
+
+    // The first supercell starts at the south west edge of the source.
+    Metadata outMetadata;
+    outMetadata.loadFromBuffer(exportMetadataToXML(metadata.getStruct()));
+    outMetadata.setResolution(supercellSize * rowResolution,
+        supercellSize * columnResolution);
+    outMetadata.setGridExtent(rows, columns,
+        metadata.llCornerX() + (supercellSize - 1) * columnResolution / 2.,
+        metadata.llCornerY() + (supercellSize - 1) * rowResolution / 2.);
+
+    chunkSize = std::max<uint64_t>(1, std::min<uint64_t>({chunkSize, rows,
+        columns}));
+
+    const ChunkedDataSet sourceElevation{source.getH5file(),
+        Layer::getInternalPath(Elevation)};
+    const ChunkedDataSet sourceUncertainty{source.getH5file(),
+        Layer::getInternalPath(Uncertainty)};
+
+    std::array<std::unique_ptr<ChunkedDataSet>, kNodeLayers.size()> nodeLayers;
+    for (size_t i = 0; i < kNodeLayers.size(); ++i)
+        if (source.getSimpleLayer(kNodeLayers[i]))
+            nodeLayers[i].reset(new ChunkedDataSet{source.getH5file(),
+                Layer::getInternalPath(kNodeLayers[i])});
+
+    auto pOutput = Dataset::create(outFileName, std::move(outMetadata),
+        chunkSize, compressionLevel);
+    pOutput->createVR(chunkSize, compressionLevel, true);
+
+    auto pElevation = pOutput->getSimpleLayer(Elevation);
+    auto pUncertainty = pOutput->getSimpleLayer(Uncertainty);
+    auto pVrMetadata = pOutput->getVRMetadata();
+    auto pVrRefinements = pOutput->getVRRefinements();
+    auto pVrNode = pOutput->getVRNode();
+
+    // The writer takes the rows in order.
+    std::mutex writerMutex;
+    std::map<uint32_t, SupercellRow> finished;
+    uint32_t nextRow = 0;
+    uint64_t nextIndex = 0;
+
+    ValueRange elevationRange;
+    ValueRange uncertaintyRange;
+
+    parallelFor(rows, numThreads, [&](size_t task) {
+        const auto row = static_cast<uint32_t>(task);
+
+        // The source rows of the supercells.
+        GridWindow window;
+        window.rowStart = row * supercellSize;
+        window.rowEnd = std::min(window.rowStart + supercellSize,
+            sourceRows) - 1;
+        window.columnStart = 0;
+        window.columnEnd = sourceColumns - 1;
+
+        const auto elevationBuffer = sourceElevation.read(window);
+        const auto uncertaintyBuffer = sourceUncertainty.read(window);
+        const auto* elevations =
+            reinterpret_cast<const float*>(elevationBuffer.data());
+        const auto* uncertainties =
+            reinterpret_cast<const float*>(uncertaintyBuffer.data());
+
+        std::array<std::vector<uint8_t>, kNodeLayers.size()> nodeBuffers;
+        for (size_t i = 0; i < kNodeLayers.size(); ++i)
+            if (nodeLayers[i])
+                nodeBuffers[i] = nodeLayers[i]->read(window);
+
+        const auto* soundings = nodeLayers[0] ?
+            reinterpret_cast<const uint32_t*>(nodeBuffers[0].data()) : nullptr;
+        const auto* hypotheses = nodeLayers[1] ?
+            reinterpret_cast<const uint32_t*>(nodeBuffers[1].data()) : nullptr;
+        const auto* hypStrengths = nodeLayers[2] ?
+            reinterpret_cast<const float*>(nodeBuffers[2].data()) : nullptr;
+
+        const uint32_t height = window.rows();
+
+        SupercellRow result;
+        result.supercells.reserve(columns);
+        result.elevations.reserve(columns);
+        result.uncertainties.reserve(columns);
+
+        std::vector<NodeBin> bins;
+        for (uint32_t column = 0; column < columns; ++column)
+        {
+            const uint32_t columnStart = column * supercellSize;
+            const uint32_t width = std::min(columnStart + supercellSize,
+                sourceColumns) - columnStart;
+
+            // The shoalest elevation, the soundings and the means.
+            NodeBin supercellBin;
+            float shoalest = std::numeric_limits<float>::lowest();
+            uint64_t numSoundings = 0;
+
+            for (uint32_t cellRow = 0; cellRow < height; ++cellRow)
+                for (uint32_t cellColumn = 0; cellColumn < width; ++cellColumn)
+                {
+                    const size_t cell = static_cast<size_t>(cellRow) *
+                        sourceColumns + columnStart + cellColumn;
+                    if (!ValueRange::isValid(elevations[cell]))
+                        continue;
+
+                    supercellBin.add(elevations[cell], uncertainties[cell], 0,
+                        0, 0.f);
+                    shoalest = std::max(shoalest, elevations[cell]);
+                    numSoundings += soundings ? soundings[cell] : 1;
+                }
+
+            const auto lowResolution = supercellBin.getRefinement();
+            result.elevations.push_back(lowResolution.depth);
+            result.uncertainties.push_back(lowResolution.depth_uncrt);
+
+            if (supercellBin.numElevations == 0)
+            {
+                result.supercells.push_back({std::numeric_limits<uint32_t>::max(),
+                    0, 0, 0.f, 0.f, 0.f, 0.f});
+                continue;
+            }
+
+            uint32_t numNodeColumns = 0, numNodeRows = 0;
+            pickDimensions(rule, ruleFactor, shoalest, numSoundings, width,
+                height, columnResolution, rowResolution, numNodeColumns,
+                numNodeRows);
+
+            // Each cell goes to the node whose cell holds its centre.
+            bins.assign(static_cast<size_t>(numNodeRows) * numNodeColumns,
+                NodeBin{});
+
+            for (uint32_t cellRow = 0; cellRow < height; ++cellRow)
+            {
+                const auto nodeRow = static_cast<uint32_t>(
+                    (cellRow + 0.5) * numNodeRows / height);
+
+                for (uint32_t cellColumn = 0; cellColumn < width; ++cellColumn)
+                {
+                    const auto nodeColumn = static_cast<uint32_t>(
+                        (cellColumn + 0.5) * numNodeColumns / width);
+                    const size_t cell = static_cast<size_t>(cellRow) *
+                        sourceColumns + columnStart + cellColumn;
+
+                    bins[static_cast<size_t>(nodeRow) * numNodeColumns +
+                        nodeColumn].add(elevations[cell], uncertainties[cell],
+                        soundings ? soundings[cell] : 1,
+                        hypotheses ? hypotheses[cell] : 1,
+                        hypStrengths ? hypStrengths[cell] : BAG_NULL_GENERIC);
+                }
+            }
+
+            VRMetadataItem supercell{};
+            supercell.index = static_cast<uint32_t>(result.refinements.size());
+            supercell.dimensions_x = numNodeColumns;
+            supercell.dimensions_y = numNodeRows;
+            supercell.resolution_x = static_cast<float>(width *
+                columnResolution / numNodeColumns);
+            supercell.resolution_y = static_cast<float>(height *
+                rowResolution / numNodeRows);
+            supercell.sw_corner_x = supercell.resolution_x / 2.f;
+            supercell.sw_corner_y = supercell.resolution_y / 2.f;
+            result.supercells.push_back(supercell);
+
+            for (const auto& bin : bins)
+            {
+                result.refinements.push_back(bin.getRefinement());
+                result.nodes.push_back(bin.getNode());
+            }
+        }
+
+        // Write this row, and any finished after it, in order.
+        std::lock_guard<std::mutex> writerLock{writerMutex};
+        finished.emplace(row, std::move(result));
+
+        for (auto next = finished.find(nextRow); next != finished.end();
+            next = finished.find(nextRow))
+        {
+            auto& ready = next->second;
+
+            for (auto& supercell : ready.supercells)
+                if (supercell.dimensions_x > 0)
+                    supercell.index += static_cast<uint32_t>(nextIndex);
+
+            for (size_t i = 0; i < ready.elevations.size(); ++i)
+            {
+                elevationRange.add(ready.elevations[i]);
+                uncertaintyRange.add(ready.uncertainties[i]);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock{getHdf5Mutex()};
+
+                pElevation->write(nextRow, 0, nextRow, columns - 1,
+                    reinterpret_cast<const uint8_t*>(ready.elevations.data()));
+                pUncertainty->write(nextRow, 0, nextRow, columns - 1,
+                    reinterpret_cast<const uint8_t*>(
+                        ready.uncertainties.data()));
+                pVrMetadata->write(nextRow, 0, nextRow, columns - 1,
+                    reinterpret_cast<const uint8_t*>(ready.supercells.data()));
+
+                if (!ready.refinements.empty())
+                {
+                    const auto last = static_cast<uint32_t>(nextIndex +
+                        ready.refinements.size() - 1);
+
+                    pVrRefinements->write(0, static_cast<uint32_t>(nextIndex),
+                        0, last, reinterpret_cast<const uint8_t*>(
+                            ready.refinements.data()));
+                    pVrNode->write(0, static_cast<uint32_t>(nextIndex), 0,
+                        last, reinterpret_cast<const uint8_t*>(
+                            ready.nodes.data()));
+                }
+            }
+
+            nextIndex += ready.refinements.size();
+            finished.erase(next);
+            ++nextRow;
+        }
+    });
+
+    // Record the ranges, skipping nulls and supercells not refined.
+    for (const auto& layerRange : {std::make_pair(Elevation, elevationRange),
+            std::make_pair(Uncertainty, uncertaintyRange)})
+    {
+        if (layerRange.second.empty())
+            continue;
+
+        auto pLayer = pOutput->getSimpleLayer(layerRange.first);
+        pLayer->getDescriptor()->setMinMax(layerRange.second.min,
+            layerRange.second.max);
+        pLayer->writeAttributes();
+    }
+
+    pVrMetadata->recomputeStatistics(numThreads);
+    pVrRefinements->recomputeStatistics(numThreads);
+    pVrNode->recomputeStatistics(numThreads);
+
+    return pOutput;
+}
+
+}  // namespace BAG
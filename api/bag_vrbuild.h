@@ -0,0 +1,60 @@
+#ifndef BAG_VRBUILD_H
+#define BAG_VRBUILD_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+namespace BAG {
+
+//! How the refinement grid of a supercell is chosen.
+enum class VRResolutionRule
+{
+    //! Shallower supercells are refined more finely; the node spacing aims
+    //! at the rule factor times the shoalest depth of the supercell.
+    Depth,
+    //! Supercells with more soundings are refined more finely; each node aims
+    //! at the rule factor soundings.  The soundings are those of the
+    //! Num_Soundings layer, or one per cell with data without it.
+    Density,
+};
+
+//! Building of a variable resolution BAG from a dense, single resolution one.
+/*!
+    Each supercell of the output covers a square of supercellSize cells of
+    the source, starting at its south west corner; supercells along the north
+    and east edges may cover fewer.  A VRResolutionRule picks the number of
+    refined nodes along each side of a supercell, from one up to the number of
+    cells it covers.  Each node is placed at the centre of the block of source
+    cells it stands for, and holds their mean elevation and uncertainty;
+    blocks without data hold the null values.  Supercells without data are
+    not refined.
+
+    The nodes carry the number of soundings of their block (from the
+    Num_Soundings layer, or the number of cells with data), the most
+    hypotheses (from Num_Hypotheses, or one) and the mean hypotheses strength
+    (from Hypothesis_Strength, or zero).  The low resolution elevation and
+    uncertainty of each supercell are the mean of its cells with data.
+
+    Rows of supercells are processed in parallel.  A single writer takes the
+    finished rows in order, gives their refinements contiguous indices, and
+    writes the variable resolution metadata, refinements and nodes, so the
+    output is the same whatever the number of threads.
+*/
+class BAG_API VRBuilder final
+{
+public:
+    static std::shared_ptr<Dataset> build(const Dataset& source,
+        const std::string& outFileName, uint32_t supercellSize,
+        VRResolutionRule rule = VRResolutionRule::Depth,
+        double ruleFactor = 0.1, uint64_t chunkSize = 100,
+        int compressionLevel = 5, unsigned int numThreads = 0);
+};
+
+}  // namespace BAG
+
+#endif  // BAG_VRBUILD_H
@@ -0,0 +1,643 @@
+
+#include "bag_dataset.h"
+#include "bag_exceptions.h"
+#include "bag_metadata.h"
+#include "bag_vrindex.h"
+#include "bag_vrmetadata.h"
+#include "bag_vrmetadatadescriptor.h"
+#include "bag_vrrefinements.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+
+namespace BAG {
+
+namespace {
+
+//! The slot of a supercell that is not refined.
+constexpr uint32_t kNoSupercell = std::numeric_limits<uint32_t>::max();
+//! The most supercells read from the metadata layer at once.
+constexpr uint64_t kMaxBandCells = 1 << 20;
+//! The most unwanted refinements read to join two ranges.
+constexpr uint32_t kMaxGap = 1024;
+//! The most refinements read at once.
+constexpr uint32_t kMaxRangeLength = 1 << 20;
+
+//! Determine if a supercell has a refined grid.
+bool isRefined(
+    const VRMetadataItem& item) noexcept
+{
+    return item.index != kNoSupercell && item.dimensions_x > 0 &&
+        item.dimensions_y > 0;
+}
+
+//! The position of a coordinate along one axis of a refined grid.
+/*!
+\param offset
+    The distance from the south west corner of the supercell.
+\param swCorner
+    The distance from the south west corner of the supercell to the first node.
+\param resolution
+    The distance between nodes.
+
+\return
+    The position, in nodes from the first one.
+*/
+double toNodes(
+    double offset,
+    float swCorner,
+    float resolution) noexcept
+{
+    return resolution > 0.f ? (offset - swCorner) / resolution : 0.;
+}
+
+//! The nearest node along one axis of a refined grid.
+uint32_t nearestNode(
+    double position,
+    uint32_t numNodes) noexcept
+{
+    const auto node = std::round(position);
+
+    return static_cast<uint32_t>(std::min<double>(std::max(node, 0.),
+        numNodes - 1));
+}
+
+//! The first of the two nodes to interpolate between along one axis of a
+//! refined grid, and the weight of the second one.
+uint32_t lowerNode(
+    double position,
+    uint32_t numNodes,
+    double& weight) noexcept
+{
+    weight = 0.;
+    if (numNodes < 2)
+        return 0;
+
+    const auto node = static_cast<uint32_t>(std::min<double>(std::max(
+        std::floor(position), 0.), numNodes - 2));
+    weight = std::min(std::max(position - node, 0.), 1.);
+
+    return node;
+}
+
+//! The supercells whose refined grid may hold a coordinate range along one
+//! axis.
+/*!
+\param low
+    The smallest coordinate.
+\param high
+    The largest coordinate.
+\param origin
+    The coordinate of the centre of the first supercell.
+\param resolution
+    The distance between supercells.
+\param count
+    The number of supercells.
+\param first
+    Set to the first supercell.
+\param last
+    Set to the last supercell.
+
+\return
+    True if any supercell may hold the range.
+*/
+bool getSupercellRange(
+    double low,
+    double high,
+    double origin,
+    double resolution,
+    uint32_t count,
+    uint32_t& first,
+    uint32_t& last) noexcept
+{
+    if (count == 0 || !(low <= high) || resolution <= 0.)
+        return false;
+
+    // A refined grid lies within its supercell; allow one more either side.
+    const auto lowCell = std::floor((low - origin) / resolution + 0.5) - 1.;
+    const auto highCell = std::floor((high - origin) / resolution + 0.5) + 1.;
+    if (highCell < 0. || lowCell > count - 1.)
+        return false;
+
+    first = static_cast<uint32_t>(std::max(lowCell, 0.));
+    last = static_cast<uint32_t>(std::min<double>(highCell, count - 1.));
+
+    return true;
+}
+
+//! The nodes of a refined grid within a coordinate range along one axis.
+/*!
+\param low
+    The smallest coordinate, from the first node.
+\param high
+    The largest coordinate, from the first node.
+\param resolution
+    The distance between nodes.
+\param numNodes
+    The number of nodes.
+\param first
+    Set to the first node in the range.
+\param last
+    Set to the last node in the range.
+
+\return
+    True if any node is in the range.
+*/
+bool getNodeRange(
+    double low,
+    double high,
+    float resolution,
+    uint32_t numNodes,
+    uint32_t& first,
+    uint32_t& last) noexcept
+{
+    if (numNodes == 0)
+        return false;
+
+    // A single node, or nodes without spacing, sit on the first one.
+    const auto lowNode = resolution > 0.f ? std::ceil(low / resolution) :
+        (low <= 0. ? 0. : 1.);
+    const auto highNode = resolution > 0.f ? std::floor(high / resolution) :
+        (high >= 0. ? numNodes - 1. : -1.);
+
+    const auto start = std::max(lowNode, 0.);
+    const auto end = std::min<double>(highNode, numNodes - 1.);
+    if (start > end)
+        return false;
+
+    first = static_cast<uint32_t>(start);
+    last = static_cast<uint32_t>(end);
+
+    return true;
+}
+
+//! A point query resolved to nodes.
+struct PointPlan final
+{
+    //! The first refinement of the point in the values read.
+    size_t slot = 0;
+    //! The weights of the second column and the second row interpolated;
+    //! only used with four corners.
+    double columnWeight = 0.;
+    double rowWeight = 0.;
+    //! True if the four corners to interpolate follow the nearest node.
+    bool bilinear = false;
+};
+
+}  // namespace
+
+//! Constructor.
+/*!
+    Read the variable resolution metadata layer, a band of rows at a time.
+
+\param dataset
+    The variable resolution BAG Dataset.
+*/
+VRIndex::VRIndex(
+    const Dataset& dataset)
+    : m_pDataset(dataset.shared_from_this())
+{
+    const auto& metadata = dataset.getMetadata();
+
+    m_llCornerX = metadata.llCornerX();
+    m_llCornerY = metadata.llCornerY();
+    m_rowResolution = metadata.rowResolution();
+    m_columnResolution = metadata.columnResolution();
+
+    const auto pMetadata = dataset.getVRMetadata();
+    if (!pMetadata)
+        throw LayerNotFound{};
+
+    std::tie(m_rows, m_columns) = pMetadata->getDescriptor()->getDims();
+    if (m_rows == 0 || m_columns == 0)
+        return;
+
+    m_slots.assign(static_cast<size_t>(m_rows) * m_columns, kNoSupercell);
+
+    const auto bandRows = static_cast<uint32_t>(std::max<uint64_t>(1,
+        kMaxBandCells / m_columns));
+
+    for (uint32_t rowStart = 0; rowStart < m_rows; rowStart += bandRows)
+    {
+        const auto rowEnd = std::min(rowStart + bandRows, m_rows) - 1;
+
+        const auto buffer = pMetadata->read(rowStart, 0, rowEnd,
+            m_columns - 1);
+        const auto* items =
+            reinterpret_cast<const VRMetadataItem*>(buffer.data());
+        const size_t numItems = static_cast<size_t>(rowEnd - rowStart + 1) *
+            m_columns;
+        const size_t firstSlot = static_cast<size_t>(rowStart) * m_columns;
+
+        for (size_t i = 0; i < numItems; ++i)
+        {
+            if (!isRefined(items[i]))
+                continue;
+
+            m_slots[firstSlot + i] =
+                static_cast<uint32_t>(m_supercells.size());
+            m_supercells.push_back(items[i]);
+        }
+    }
+
+    m_supercells.shrink_to_fit();
+}
+
+//! Retrieve the number of rows of supercells.
+/*!
+\return
+    The number of rows of supercells.
+*/
+uint32_t VRIndex::getRows() const noexcept
+{
+    return m_rows;
+}
+
+//! Retrieve the number of columns of supercells.
+/*!
+\return
+    The number of columns of supercells.
+*/
+uint32_t VRIndex::getColumns() const noexcept
+{
+    return m_columns;
+}
+
+//! Retrieve the number of supercells with a refined grid.
+/*!
+\return
+    The number of refined supercells.
+*/
+uint64_t VRIndex::getNumRefinedSupercells() const noexcept
+{
+    return m_supercells.size();
+}
+
+//! Retrieve the variable resolution metadata of a supercell.
+/*!
+\param row
+    The row of the supercell.
+\param column
+    The column of the supercell.
+
+\return
+    The metadata of the supercell; nullptr if it is outside the grid or not
+    refined.
+*/
+const VRMetadataItem* VRIndex::getSupercell(
+    uint32_t row,
+    uint32_t column) const noexcept
+{
+    if (row >= m_rows || column >= m_columns)
+        return nullptr;
+
+    const auto slot = m_slots[static_cast<size_t>(row) * m_columns + column];
+
+    return slot == kNoSupercell ? nullptr : &m_supercells[slot];
+}
+
+//! Find the supercell holding a position.
+/*!
+\param x
+    The X of the position.
+\param y
+    The Y of the position.
+\param row
+    Set to the row of the supercell.
+\param column
+    Set to the column of the supercell.
+
+\return
+    True if the position is inside the grid.
+*/
+bool VRIndex::findSupercell(
+    double x,
+    double y,
+    uint32_t& row,
+    uint32_t& column) const noexcept
+{
+    if (m_rowResolution <= 0. || m_columnResolution <= 0.)
+        return false;
+
+    const auto cellRow = std::floor((y - m_llCornerY) / m_rowResolution + 0.5);
+    const auto cellColumn = std::floor((x - m_llCornerX) / m_columnResolution +
+        0.5);
+
+    if (!(cellRow >= 0. && cellRow < m_rows &&
+        cellColumn >= 0. && cellColumn < m_columns))
+        return false;
+
+    row = static_cast<uint32_t>(cellRow);
+    column = static_cast<uint32_t>(cellColumn);
+
+    return true;
+}
+
+//! Retrieve the position of a node of a refined grid.
+/*!
+\param row
+    The row of the supercell.
+\param column
+    The column of the supercell.
+\param subRow
+    The row of the node in the refined grid.
+\param subColumn
+    The column of the node in the refined grid.
+
+\return
+    The (x, y) of the node; the centre of the supercell if it is not refined.
+*/
+VRIndex::Point VRIndex::getNodePosition(
+    uint32_t row,
+    uint32_t column,
+    uint32_t subRow,
+    uint32_t subColumn) const noexcept
+{
+    const auto x = m_llCornerX + column * m_columnResolution;
+    const auto y = m_llCornerY + row * m_rowResolution;
+
+    const auto* pItem = this->getSupercell(row, column);
+    if (!pItem)
+        return Point{x, y};
+
+    return Point{x - m_columnResolution / 2. + pItem->sw_corner_x +
+        subColumn * static_cast<double>(pItem->resolution_x),
+        y - m_rowResolution / 2. + pItem->sw_corner_y +
+        subRow * static_cast<double>(pItem->resolution_y)};
+}
+
+//! Find the refinements at points.
+/*!
+    Each point takes the node of its supercell nearest to it.  With bilinear
+    interpolation, the depth and uncertainty are interpolated between the four
+    nodes around the point instead; the nearest node is kept where one of them
+    has no depth.  Points outside refined supercells are not found.
+
+\param points
+    The (x, y) of the points.
+\param bilinear
+    True to interpolate between the nodes of the refined grid.
+
+\return
+    One sample per point, in the same order.
+*/
+std::vector<VRSample> VRIndex::query(
+    const std::vector<Point>& points,
+    bool bilinear) const
+{
+    std::vector<VRSample> samples(points.size());
+    std::vector<PointPlan> plans(points.size());
+    std::vector<Request> requests;
+    requests.reserve(points.size() * (bilinear ? 5 : 1));
+
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        auto& sample = samples[i];
+        std::tie(sample.x, sample.y) = points[i];
+
+        uint32_t row = 0, column = 0;
+        if (!this->findSupercell(sample.x, sample.y, row, column))
+            continue;
+
+        const auto* pItem = this->getSupercell(row, column);
+        if (!pItem)
+            continue;
+
+        const auto& item = *pItem;
+
+        // The position of the point in nodes of the refined grid.
+        const auto columnPosition = toNodes(sample.x - (m_llCornerX +
+            (column - 0.5) * m_columnResolution), item.sw_corner_x,
+            item.resolution_x);
+        const auto rowPosition = toNodes(sample.y - (m_llCornerY +
+            (row - 0.5) * m_rowResolution), item.sw_corner_y,
+            item.resolution_y);
+
+        sample.row = row;
+        sample.column = column;
+        sample.subRow = nearestNode(rowPosition, item.dimensions_y);
+        sample.subColumn = nearestNode(columnPosition, item.dimensions_x);
+        sample.index = item.index + sample.subRow * item.dimensions_x +
+            sample.subColumn;
+        sample.found = true;
+
+        auto& plan = plans[i];
+        plan.slot = requests.size();
+        requests.push_back({sample.index, requests.size()});
+
+        if (!bilinear)
+            continue;
+
+        const auto subRow = lowerNode(rowPosition, item.dimensions_y,
+            plan.rowWeight);
+        const auto subColumn = lowerNode(columnPosition, item.dimensions_x,
+            plan.columnWeight);
+        const auto nextRow = std::min(subRow + 1, item.dimensions_y - 1);
+        const auto nextColumn = std::min(subColumn + 1,
+            item.dimensions_x - 1);
+
+        for (const auto& corner : {
+            std::make_pair(subRow, subColumn),
+            std::make_pair(subRow, nextColumn),
+            std::make_pair(nextRow, subColumn),
+            std::make_pair(nextRow, nextColumn)})
+            requests.push_back({item.index + corner.first * item.dimensions_x +
+                corner.second, requests.size()});
+
+        plan.bilinear = true;
+    }
+
+    const auto values = this->readRefinements(std::move(requests));
+
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        auto& sample = samples[i];
+        if (!sample.found)
+            continue;
+
+        const auto& plan = plans[i];
+        const auto& nearest = values[plan.slot];
+        sample.depth = nearest.depth;
+        sample.uncertainty = nearest.depth_uncrt;
+
+        if (!plan.bilinear)
+            continue;
+
+        const auto* corners = &values[plan.slot + 1];
+        if (std::any_of(corners, corners + 4,
+            [](const VRRefinementsItem& corner) {
+                return corner.depth == BAG_NULL_ELEVATION;
+            }))
+            continue;
+
+        const std::array<double, 4> weights{
+            (1. - plan.rowWeight) * (1. - plan.columnWeight),
+            (1. - plan.rowWeight) * plan.columnWeight,
+            plan.rowWeight * (1. - plan.columnWeight),
+            plan.rowWeight * plan.columnWeight};
+
+        double depth = 0., uncertainty = 0.;
+        for (size_t corner = 0; corner < weights.size(); ++corner)
+        {
+            depth += weights[corner] * corners[corner].depth;
+            uncertainty += weights[corner] * corners[corner].depth_uncrt;
+        }
+
+        sample.depth = static_cast<float>(depth);
+        sample.uncertainty = static_cast<float>(uncertainty);
+    }
+
+    return samples;
+}
+
+//! Find the refined nodes in a box.
+/*!
+\param xMin
+    The smallest X of the box.
+\param yMin
+    The smallest Y of the box.
+\param xMax
+    The largest X of the box.
+\param yMax
+    The largest Y of the box.
+
+\return
+    Every node of a refined grid inside the box, with those without a depth,
+    supercell by supercell, row by row.
+*/
+std::vector<VRSample> VRIndex::queryBox(
+    double xMin,
+    double yMin,
+    double xMax,
+    double yMax) const
+{
+    uint32_t rowStart = 0, rowEnd = 0, columnStart = 0, columnEnd = 0;
+    if (!getSupercellRange(yMin, yMax, m_llCornerY, m_rowResolution, m_rows,
+        rowStart, rowEnd) ||
+        !getSupercellRange(xMin, xMax, m_llCornerX, m_columnResolution,
+        m_columns, columnStart, columnEnd))
+        return {};
+
+    std::vector<VRSample> samples;
+    std::vector<Request> requests;
+
+    for (auto row = rowStart; row <= rowEnd; ++row)
+    {
+        for (auto column = columnStart; column <= columnEnd; ++column)
+        {
+            const auto* pItem = this->getSupercell(row, column);
+            if (!pItem)
+                continue;
+
+            const auto& item = *pItem;
+
+            // The nodes of the refined grid inside the box.
+            double x0 = 0., y0 = 0.;
+            std::tie(x0, y0) = this->getNodePosition(row, column, 0, 0);
+
+            uint32_t subColumnStart = 0, subColumnEnd = 0;
+            uint32_t subRowStart = 0, subRowEnd = 0;
+            if (!getNodeRange(xMin - x0, xMax - x0, item.resolution_x,
+                item.dimensions_x, subColumnStart, subColumnEnd) ||
+                !getNodeRange(yMin - y0, yMax - y0, item.resolution_y,
+                item.dimensions_y, subRowStart, subRowEnd))
+                continue;
+
+            for (auto subRow = subRowStart; subRow <= subRowEnd; ++subRow)
+            {
+                for (auto subColumn = subColumnStart; subColumn <= subColumnEnd;
+                    ++subColumn)
+                {
+                    VRSample sample;
+                    std::tie(sample.x, sample.y) = this->getNodePosition(row,
+                        column, subRow, subColumn);
+                    sample.row = row;
+                    sample.column = column;
+                    sample.subRow = subRow;
+                    sample.subColumn = subColumn;
+                    sample.index = item.index + subRow * item.dimensions_x +
+                        subColumn;
+                    sample.found = true;
+
+                    requests.push_back({sample.index, samples.size()});
+                    samples.push_back(sample);
+                }
+            }
+        }
+    }
+
+    const auto values = this->readRefinements(std::move(requests));
+
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        samples[i].depth = values[i].depth;
+        samples[i].uncertainty = values[i].depth_uncrt;
+    }
+
+    return samples;
+}
+
+//! Read the refinements wanted by a query.
+/*!
+    The requests are sorted by index and joined into contiguous ranges,
+    reading a few unwanted refinements rather than making another read.
+
+\param requests
+    The refinements wanted, and where each goes.
+
+\return
+    The refinements, by slot.
+*/
+std::vector<VRRefinementsItem> VRIndex::readRefinements(
+    std::vector<Request> requests) const
+{
+    std::vector<VRRefinementsItem> values(requests.size());
+    if (requests.empty())
+        return values;
+
+    const auto pDataset = m_pDataset.lock();
+    if (!pDataset)
+        throw DatasetNotFound{};
+
+    const auto pRefinements = pDataset->getVRRefinements();
+    if (!pRefinements)
+        throw LayerNotFound{};
+
+    std::sort(requests.begin(), requests.end(),
+        [](const Request& lhs, const Request& rhs) noexcept {
+            return lhs.index < rhs.index;
+        });
+
+    for (size_t first = 0; first < requests.size();)
+    {
+        const auto indexStart = requests[first].index;
+        auto indexEnd = indexStart;
+
+        auto last = first + 1;
+        for (; last < requests.size(); ++last)
+        {
+            const auto index = requests[last].index;
+            if (index - indexEnd > kMaxGap ||
+                index - indexStart >= kMaxRangeLength)
+                break;
+
+            indexEnd = index;
+        }
+
+        const auto buffer = pRefinements->read(0, indexStart, 0, indexEnd);
+        const auto* items =
+            reinterpret_cast<const VRRefinementsItem*>(buffer.data());
+
+        for (auto i = first; i < last; ++i)
+            values[requests[i].slot] = items[requests[i].index - indexStart];
+
+        first = last;
+    }
+
+    return values;
+}
+
+}  // namespace BAG
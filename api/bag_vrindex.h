@@ -0,0 +1,136 @@
+#ifndef BAG_VRINDEX_H
+#define BAG_VRINDEX_H
+
+#include "bag_c_types.h"
+#include "bag_config.h"
+#include "bag_fordec.h"
+#include "bag_types.h"
+
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+
+namespace BAG {
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)  // std classes do not have DLL-interface when exporting
+#endif
+
+//! A refined node found by a VRIndex query.
+struct VRSample final
+{
+    //! The X of the node; for a point query, the X of the point.
+    double x = 0.;
+    //! The Y of the node; for a point query, the Y of the point.
+    double y = 0.;
+    //! The row of the supercell.
+    uint32_t row = 0;
+    //! The column of the supercell.
+    uint32_t column = 0;
+    //! The row of the node in the refined grid.
+    uint32_t subRow = 0;
+    //! The column of the node in the refined grid.
+    uint32_t subColumn = 0;
+    //! The index of the node in the refinements layer.
+    uint32_t index = 0;
+    //! The depth; BAG_NULL_ELEVATION if there is no refinement.
+    float depth = BAG_NULL_ELEVATION;
+    //! The uncertainty; BAG_NULL_UNCERTAINTY if there is no refinement.
+    float uncertainty = BAG_NULL_UNCERTAINTY;
+    //! True if the node was found in a refined supercell.
+    bool found = false;
+};
+
+//! A spatial index of the supercells of a variable resolution BAG.
+/*!
+    The index keeps the variable resolution metadata of the refined
+    supercells in memory; the others cost a single slot.  It answers point
+    and box queries in projected coordinates with the refinements of the
+    nodes found.  The refinements a query needs are sorted by index and read
+    in a few contiguous ranges, rather than once per node.
+
+    Supercell positions follow the metadata: columns run along X with the
+    column resolution, rows run along Y with the row resolution, and a
+    supercell is centred on its grid position starting at the lower left
+    corner.  The nodes of a refined grid are placed from the south west corner
+    of their supercell by sw_corner_x and sw_corner_y, resolution_x and
+    resolution_y apart.
+
+    Dataset::getVRIndex() builds the index once and keeps it until the
+    variable resolution metadata is written.
+*/
+class BAG_API VRIndex final
+{
+public:
+    //! A (x, y) position in projected coordinates.
+    using Point = std::tuple<double, double>;
+
+    VRIndex(const VRIndex&) = delete;
+    VRIndex(VRIndex&&) = delete;
+
+    VRIndex& operator=(const VRIndex&) = delete;
+    VRIndex& operator=(VRIndex&&) = delete;
+
+    uint32_t getRows() const noexcept;
+    uint32_t getColumns() const noexcept;
+    uint64_t getNumRefinedSupercells() const noexcept;
+
+    const VRMetadataItem* getSupercell(uint32_t row, uint32_t column) const noexcept;
+    bool findSupercell(double x, double y, uint32_t& row,
+        uint32_t& column) const noexcept;
+    Point getNodePosition(uint32_t row, uint32_t column, uint32_t subRow,
+        uint32_t subColumn) const noexcept;
+
+    std::vector<VRSample> query(const std::vector<Point>& points,
+        bool bilinear = false) const;
+    std::vector<VRSample> queryBox(double xMin, double yMin, double xMax,
+        double yMax) const;
+
+private:
+    explicit VRIndex(const Dataset& dataset);
+
+    //! A refinement wanted by a query.
+    struct Request final
+    {
+        //! The index of the refinement.
+        uint32_t index = 0;
+        //! Where the refinement goes in the values read.
+        size_t slot = 0;
+    };
+
+    std::vector<VRRefinementsItem> readRefinements(
+        std::vector<Request> requests) const;
+
+    //! The Dataset the refinements are read from.
+    std::weak_ptr<const Dataset> m_pDataset;
+    //! The number of rows of supercells.
+    uint32_t m_rows = 0;
+    //! The number of columns of supercells.
+    uint32_t m_columns = 0;
+    //! The X of the lower left supercell centre.
+    double m_llCornerX = 0.;
+    //! The Y of the lower left supercell centre.
+    double m_llCornerY = 0.;
+    //! The distance between rows.
+    double m_rowResolution = 0.;
+    //! The distance between columns.
+    double m_columnResolution = 0.;
+    //! The position of each supercell in m_supercells, row by row; the
+    //! largest uint32_t if it is not refined.
+    std::vector<uint32_t> m_slots;
+    //! The refined supercells.
+    std::vector<VRMetadataItem> m_supercells;
+
+    friend Dataset;
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+}  // namespace BAG
+
+#endif  // BAG_VRINDEX_H
@@ -1,12 +1,18 @@
 
+#include "bag_chunkio.h"
 #include "bag_hdfhelper.h"
+#include "bag_parallel.h"
 #include "bag_private.h"
 #include "bag_vrmetadata.h"
 #include "bag_vrmetadatadescriptor.h"
 
+#include <algorithm>
 #include <array>
 #include <cstring>  //member
 #include <H5Cpp.h>
+#include <limits>
+#include <map>
+#include <mutex>
 
 
 namespace BAG {
@@ -64,6 +70,81 @@ T readAttribute(
     return value;
 }
 
+//! The ranges and statistics of some refined supercells.
+struct SupercellRanges final
+{
+    //! Include a refined supercell.
+    void add(const VRMetadataItem& item)
+    {
+        minDimX = std::min(minDimX, item.dimensions_x);
+        minDimY = std::min(minDimY, item.dimensions_y);
+        maxDimX = std::max(maxDimX, item.dimensions_x);
+        maxDimY = std::max(maxDimY, item.dimensions_y);
+
+        minResX = std::min(minResX, item.resolution_x);
+        minResY = std::min(minResY, item.resolution_y);
+        maxResX = std::max(maxResX, item.resolution_x);
+        maxResY = std::max(maxResY, item.resolution_y);
+
+        const uint32_t numRefinements = item.dimensions_x *
+            item.dimensions_y;
+        ++statistics.numRefinedSupercells;
+        statistics.numRefinements += numRefinements;
+        minRefinements = std::min(minRefinements, numRefinements);
+        statistics.maxRefinements = std::max(statistics.maxRefinements,
+            numRefinements);
+        statistics.refinedArea +=
+            static_cast<double>(item.dimensions_x) * item.resolution_x *
+            static_cast<double>(item.dimensions_y) * item.resolution_y;
+
+        ++resolutions[std::max(item.resolution_x, item.resolution_y)];
+    }
+
+    //! Include the supercells of other ranges.
+    void merge(const SupercellRanges& other)
+    {
+        minDimX = std::min(minDimX, other.minDimX);
+        minDimY = std::min(minDimY, other.minDimY);
+        maxDimX = std::max(maxDimX, other.maxDimX);
+        maxDimY = std::max(maxDimY, other.maxDimY);
+
+        minResX = std::min(minResX, other.minResX);
+        minResY = std::min(minResY, other.minResY);
+        maxResX = std::max(maxResX, other.maxResX);
+        maxResY = std::max(maxResY, other.maxResY);
+
+        statistics.numRefinedSupercells +=
+            other.statistics.numRefinedSupercells;
+        statistics.numRefinements += other.statistics.numRefinements;
+        minRefinements = std::min(minRefinements, other.minRefinements);
+        statistics.maxRefinements = std::max(statistics.maxRefinements,
+            other.statistics.maxRefinements);
+        statistics.refinedArea += other.statistics.refinedArea;
+
+        for (const auto& resolution : other.resolutions)
+            resolutions[resolution.first] += resolution.second;
+    }
+
+    //! The smallest dimensions.
+    uint32_t minDimX = std::numeric_limits<uint32_t>::max();
+    uint32_t minDimY = std::numeric_limits<uint32_t>::max();
+    //! The largest dimensions.
+    uint32_t maxDimX = std::numeric_limits<uint32_t>::lowest();
+    uint32_t maxDimY = std::numeric_limits<uint32_t>::lowest();
+    //! The finest resolutions.
+    float minResX = std::numeric_limits<float>::max();
+    float minResY = std::numeric_limits<float>::max();
+    //! The coarsest resolutions.
+    float maxResX = std::numeric_limits<float>::lowest();
+    float maxResY = std::numeric_limits<float>::lowest();
+    //! The fewest refinements of a supercell.
+    uint32_t minRefinements = std::numeric_limits<uint32_t>::max();
+    //! The statistics, but for minRefinements and resolutions.
+    VRStatistics statistics;
+    //! The number of supercells at each resolution.
+    std::map<float, uint64_t> resolutions;
+};
+
 }  // namespace
 
 //! Constructor
@@ -209,6 +290,8 @@ VRMetadata::createH5dataSet(
 
         if (compressionLevel > 0 && compressionLevel <= kMaxCompressionLevel)
             h5createPropList.setDeflate(compressionLevel);
+        if (dataset.getDescriptor().isChecksummed())
+            h5createPropList.setFletcher32();
     }
     else if (compressionLevel > 0)
         throw CompressionNeedsChunkingSet{};
@@ -287,6 +370,87 @@ UInt8Array VRMetadata::readProxy(
     return buffer;
 }
 
+//! Recompute the dimension and resolution ranges, and the supercell statistics.
+/*!
+    The ranges kept as the metadata is written only ever widen, and count the
+    supercells that are not refined; files from other producers may carry
+    stale or placeholder ranges.  The supercells are scanned a chunk at a time
+    across threads, and only the refined ones are counted.  The descriptor
+    takes the new ranges, and so do the attributes unless the Dataset is read
+    only.
+
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+
+\return
+    The statistics of the refined supercells.
+*/
+VRStatistics VRMetadata::recomputeStatistics(
+    unsigned int numThreads)
+{
+    const auto pDataset = this->getDataset().lock();
+    if (!pDataset)
+        throw DatasetNotFound{};
+
+    auto pDescriptor = this->getDescriptor();
+
+    uint32_t numRows = 0, numColumns = 0;
+    std::tie(numRows, numColumns) = pDescriptor->getDims();
+
+    const ChunkedDataSet chunked{*m_pH5dataSet};
+    const auto memDataType = makeDataType();
+
+    SupercellRanges ranges;
+    std::mutex rangesMutex;
+
+    parallelFor(chunked.getNumChunks(), numThreads, [&](size_t chunkIndex) {
+        const auto window = chunked.getChunkWindow(chunkIndex);
+        if (window.rowStart >= numRows || window.columnStart >= numColumns)
+            return;
+
+        const auto buffer = chunked.readChunk(chunkIndex, memDataType.getId());
+        const auto* items =
+            reinterpret_cast<const VRMetadataItem*>(buffer.data());
+        const auto rowEnd = std::min(window.rowEnd + 1, numRows);
+        const auto columnEnd = std::min(window.columnEnd + 1, numColumns);
+
+        SupercellRanges chunkRanges;
+        for (uint32_t row = window.rowStart; row < rowEnd; ++row)
+            for (uint32_t column = window.columnStart; column < columnEnd;
+                ++column)
+            {
+                const auto& item = items[(row - window.rowStart) *
+                    window.columns() + (column - window.columnStart)];
+
+                if (item.dimensions_x > 0 && item.dimensions_y > 0 &&
+                    item.index != std::numeric_limits<uint32_t>::max())
+                    chunkRanges.add(item);
+            }
+
+        std::lock_guard<std::mutex> lock{rangesMutex};
+        ranges.merge(chunkRanges);
+    });
+
+    pDescriptor->setMinDimensions(ranges.minDimX, ranges.minDimY);
+    pDescriptor->setMaxDimensions(ranges.maxDimX, ranges.maxDimY);
+    pDescriptor->setMinResolution(ranges.minResX, ranges.minResY);
+    pDescriptor->setMaxResolution(ranges.maxResX, ranges.maxResY);
+
+    if (!pDataset->getDescriptor().isReadOnly())
+        this->writeAttributesProxy();
+
+    auto& statistics = ranges.statistics;
+    if (statistics.numRefinedSupercells > 0)
+        statistics.minRefinements = ranges.minRefinements;
+
+    statistics.resolutions.reserve(ranges.resolutions.size());
+    for (const auto& resolution : ranges.resolutions)
+        statistics.resolutions.push_back({resolution.first,
+            resolution.second});
+
+    return statistics;
+}
+
 //! \copydoc Layer::writeAttributes
 void VRMetadata::writeAttributesProxy() const
 {
@@ -358,19 +522,25 @@ void VRMetadata::writeProxy(
     if ((fileDims[0] < (rowEnd + 1)) ||
         (fileDims[1] < (columnEnd + 1)))
     {
+        // Update the dataset's dimensions.
+        if (this->getDataset().expired())
+            throw DatasetNotFound{};
+
+        auto pDataset = this->getDataset().lock();
+
+        // Every supercell has metadata, so make room for the whole grid at
+        // once rather than a few rows at a time.
+        uint32_t gridRows = 0, gridColumns = 0;
+        std::tie(gridRows, gridColumns) = pDataset->getDescriptor().getDims();
+
         const std::array<hsize_t, kRank> newDims{
-            std::max<hsize_t>(fileDims[0], rowEnd + 1),
-            std::max<hsize_t>(fileDims[1], columnEnd + 1)};
+            std::max<hsize_t>({fileDims[0], rowEnd + 1, gridRows}),
+            std::max<hsize_t>({fileDims[1], columnEnd + 1, gridColumns})};
 
         m_pH5dataSet->extend(newDims.data());
 
         fileDataSpace = m_pH5dataSet->getSpace();
 
-        // Update the dataset's dimensions.
-        if (this->getDataset().expired())
-            throw DatasetNotFound{};
-
-        auto pDataset = this->getDataset().lock();
         pDataset->getDescriptor().setDims(static_cast<uint32_t>(newDims[0]),
             static_cast<uint32_t>(newDims[1]));
         // The file descriptor is global (and the size of the mandatory layers) and specified
@@ -378,7 +548,8 @@ void VRMetadata::writeProxy(
         // this case, the VRMetadataDescriptor has the same dimensions as the mandatory layer
         // (since there should be a refinement for each fixed-resolution cell), so it's formally
         // redundant.  But we want to make sure that it's consistent, so ...
-        pDescriptor->setDims(fileDims[0], fileDims[1]);
+        pDescriptor->setDims(static_cast<uint32_t>(newDims[0]),
+            static_cast<uint32_t>(newDims[1]));
     }
 
     fileDataSpace.selectHyperslab(H5S_SELECT_SET, count.data(), offset.data());
@@ -426,6 +597,14 @@ void VRMetadata::writeProxy(
     pDescriptor->setMaxDimensions(maxDimX, maxDimY);
     pDescriptor->setMinResolution(minResX, minResY);
     pDescriptor->setMaxResolution(maxResX, maxResY);
+
+    // The index of the supercells is stale.
+    const auto pDataset = this->getDataset().lock();
+    if (pDataset)
+    {
+        std::lock_guard<std::mutex> lock{pDataset->m_vrIndexMutex};
+        pDataset->m_pVRIndex.reset();
+    }
 }
 
 }   //namespace BAG
@@ -6,7 +6,9 @@
 #include "bag_fordec.h"
 #include "bag_layer.h"
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 
 namespace BAG {
@@ -16,6 +18,33 @@ namespace BAG {
 #pragma warning(disable: 4251)  // std classes do not have DLL-interface when exporting
 #endif
 
+//! The number of refined supercells at one resolution.
+struct VRResolutionCount final
+{
+    //! The resolution; the coarser of resolution_x and resolution_y.
+    float resolution = 0.f;
+    //! The number of refined supercells.
+    uint64_t count = 0;
+};
+
+//! Statistics of the refined supercells of a variable resolution BAG.
+struct VRStatistics final
+{
+    //! The number of refined supercells.
+    uint64_t numRefinedSupercells = 0;
+    //! The number of refinements of the refined supercells.
+    uint64_t numRefinements = 0;
+    //! The fewest refinements of a refined supercell.
+    uint32_t minRefinements = 0;
+    //! The most refinements of a refined supercell.
+    uint32_t maxRefinements = 0;
+    //! The area covered by the refined grids, in square projected units.
+    double refinedArea = 0.;
+    //! The number of refined supercells at each resolution, by increasing
+    //! resolution.
+    std::vector<VRResolutionCount> resolutions;
+};
+
 //! The interface for variable resolution metadata.
 class BAG_API VRMetadata final : public Layer
 {
@@ -41,6 +70,8 @@ public:
     std::shared_ptr<VRMetadataDescriptor> getDescriptor() & noexcept;
     std::shared_ptr<const VRMetadataDescriptor> getDescriptor() const & noexcept;
 
+    VRStatistics recomputeStatistics(unsigned int numThreads = 0);
+
 protected:
     static std::shared_ptr<VRMetadata> create(Dataset& dataset,
         uint64_t chunkSize, int compressionLevel);
@@ -1,12 +1,18 @@
 
+#include "bag_chunkio.h"
+#include "bag_dataset.h"
 #include "bag_hdfhelper.h"
+#include "bag_parallel.h"
 #include "bag_private.h"
 #include "bag_vrnode.h"
 #include "bag_vrnodedescriptor.h"
 
+#include <algorithm>
 #include <array>
 #include <cstring>  //memset
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <H5Cpp.h>
 
 
@@ -103,7 +109,8 @@ std::shared_ptr<const VRNodeDescriptor> VRNode::getDescriptor() const & noexcept
 \param dataset
     The BAG Dataset that this layer belongs to.
 \param chunkSize
-    The chunk size in the HDF5 DataSet.
+    The chunk size of the grid; the HDF5 DataSet is chunked in rows of
+    getVRChunkLength() records.
 \param compressionLevel
     The compression level in the HDF5 DataSet.
 
@@ -115,8 +122,9 @@ std::shared_ptr<VRNode> VRNode::create(
     uint64_t chunkSize,
     int compressionLevel)
 {
-    auto descriptor = VRNodeDescriptor::create(dataset, chunkSize,
-        compressionLevel);
+    // The descriptor keeps the chunk length, in records.
+    auto descriptor = VRNodeDescriptor::create(dataset,
+        getVRChunkLength(chunkSize), compressionLevel);
 
     auto h5dataSet = VRNode::createH5dataSet(dataset, *descriptor);
 
@@ -210,11 +218,14 @@ VRNode::createH5dataSet(
     const auto compressionLevel = descriptor.getCompressionLevel();
     if (chunkSize > 0)
     {
-        const std::array<hsize_t, kRank> chunkDims{chunkSize, chunkSize};
+        // One row of records; see getVRChunkLength().
+        const std::array<hsize_t, kRank> chunkDims{1, chunkSize};
         h5createPropList.setChunk(kRank, chunkDims.data());
 
         if (compressionLevel > 0 && compressionLevel <= kMaxCompressionLevel)
             h5createPropList.setDeflate(compressionLevel);
+        if (dataset.getDescriptor().isChecksummed())
+            h5createPropList.setFletcher32();
     }
     else if (compressionLevel > 0)
         throw CompressionNeedsChunkingSet{};
@@ -325,6 +336,105 @@ void VRNode::writeAttributesProxy() const
         std::get<1>(minMaxNSamples), VR_NODE_MAX_N_SAMPLES);
 }
 
+//! Recompute the hypotheses strength, hypotheses and samples ranges.
+/*!
+    The ranges kept as nodes are written only ever widen, and files from
+    other producers may carry stale or placeholder ranges.  The nodes are
+    scanned a chunk at a time across threads; null hypotheses strengths are
+    skipped.  The descriptor takes the new ranges, and so do the attributes
+    unless the Dataset is read only.
+
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+*/
+void VRNode::recomputeStatistics(
+    unsigned int numThreads)
+{
+    const auto pDataset = this->getDataset().lock();
+    if (!pDataset)
+        throw DatasetNotFound{};
+
+    auto pDescriptor = this->getDescriptor();
+
+    uint32_t numRows = 0, numColumns = 0;
+    std::tie(numRows, numColumns) = pDescriptor->getDims();
+
+    const ChunkedDataSet chunked{*m_pH5dataSet};
+    const auto memDataType = makeDataType();
+
+    ValueRange hypStrengthRange;
+    uint32_t minNumHyp = std::numeric_limits<uint32_t>::max(), maxNumHyp = 0;
+    uint32_t minNSamples = std::numeric_limits<uint32_t>::max(),
+        maxNSamples = 0;
+    std::mutex rangeMutex;
+
+    parallelFor(chunked.getNumChunks(), numThreads, [&](size_t chunkIndex) {
+        // The DataSet may be longer than the nodes written.
+        const auto window = chunked.getChunkWindow(chunkIndex);
+        if (window.rowStart >= numRows || window.columnStart >= numColumns)
+            return;
+
+        const auto buffer = chunked.readChunk(chunkIndex, memDataType.getId());
+        const auto* items = reinterpret_cast<const BagVRNodeItem*>(buffer.data());
+        const auto count = std::min(window.columnEnd + 1, numColumns) -
+            window.columnStart;
+
+        ValueRange hypStrength;
+        uint32_t chunkMinNumHyp = std::numeric_limits<uint32_t>::max();
+        uint32_t chunkMaxNumHyp = 0;
+        uint32_t chunkMinNSamples = std::numeric_limits<uint32_t>::max();
+        uint32_t chunkMaxNSamples = 0;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            hypStrength.add(items[i].hyp_strength);
+
+            chunkMinNumHyp = std::min(chunkMinNumHyp, items[i].num_hypotheses);
+            chunkMaxNumHyp = std::max(chunkMaxNumHyp, items[i].num_hypotheses);
+            chunkMinNSamples = std::min(chunkMinNSamples, items[i].n_samples);
+            chunkMaxNSamples = std::max(chunkMaxNSamples, items[i].n_samples);
+        }
+
+        std::lock_guard<std::mutex> lock{rangeMutex};
+        hypStrengthRange.merge(hypStrength);
+        minNumHyp = std::min(minNumHyp, chunkMinNumHyp);
+        maxNumHyp = std::max(maxNumHyp, chunkMaxNumHyp);
+        minNSamples = std::min(minNSamples, chunkMinNSamples);
+        maxNSamples = std::max(maxNSamples, chunkMaxNSamples);
+    });
+
+    pDescriptor->setMinMaxHypStrength(hypStrengthRange.min,
+        hypStrengthRange.max);
+    pDescriptor->setMinMaxNumHypotheses(minNumHyp, maxNumHyp);
+    pDescriptor->setMinMaxNSamples(minNSamples, maxNSamples);
+
+    if (!pDataset->getDescriptor().isReadOnly())
+        this->writeAttributesProxy();
+}
+
+//! Make room in the file for a number of nodes.
+/*!
+    Writing up to that many nodes then extends the HDF5 DataSet no further.
+    The room not written is trimmed when the Dataset is closed.
+
+\param numItems
+    The number of nodes to make room for.
+*/
+void VRNode::reserve(
+    uint32_t numItems)
+{
+    growExtent(*m_pH5dataSet, {1, numItems}, false);
+}
+
+//! Trim the HDF5 DataSet to the nodes written.
+void VRNode::trim() const
+{
+    uint32_t numRows = 0, numColumns = 0;
+    std::tie(numRows, numColumns) = this->getDescriptor()->getDims();
+
+    trimExtent(*m_pH5dataSet, {numRows, numColumns});
+}
+
 //! \copydoc Layer::write
 void VRNode::writeProxy(
     uint32_t rowStart,
@@ -344,38 +454,30 @@ void VRNode::writeProxy(
     const std::array<hsize_t, kRank> offset{rowStart, columnStart};
     const ::H5::DataSpace memDataSpace{kRank, count.data(), count.data()};
 
-    ::H5::DataSpace fileDataSpace = m_pH5dataSet->getSpace();
-
-    // Expand the file data space if needed.
-    std::array<hsize_t, kRank> fileDims{};
-    std::array<hsize_t, kRank> maxFileDims{};
-
-    const int numDims = fileDataSpace.getSimpleExtentDims(fileDims.data(),
-                                                          maxFileDims.data());
-    if (numDims != kRank) {
+    // Grow the file data space if needed; geometrically, so appending costs
+    // few extends.  The descriptor keeps the size written, and the room left
+    // over is trimmed when the Dataset is closed.
+    if (m_pH5dataSet->getSpace().getSimpleExtentNdims() != kRank)
         throw InvalidVRRefinementDimensions{};
-    }
 
-    if ((fileDims[0] < (rowEnd + 1)) ||
-        (fileDims[1] < (columnEnd + 1)))
-    {
-        const std::array<hsize_t, kRank> newDims{
-                std::max<hsize_t>(fileDims[0], rowEnd + 1),
-                std::max<hsize_t>(fileDims[1], columnEnd + 1)};
-        m_pH5dataSet->extend(newDims.data());
+    growExtent(*m_pH5dataSet, {rowEnd + 1ull, columnEnd + 1ull}, true);
 
-        fileDataSpace = m_pH5dataSet->getSpace();
+    uint32_t numRows = 0, numColumns = 0;
+    std::tie(numRows, numColumns) = pDescriptor->getDims();
 
-        // Update the dataset's dimensions.
+    if (numRows < rowEnd + 1 || numColumns < columnEnd + 1)
+    {
         if (this->getDataset().expired())
             throw DatasetNotFound{};
 
         // So that the read() call checks correctly against the size of the array, rather
         // than the dimensions of the mandatory layer, we need to keep track of the size
         // of the layer in the layer-specific descriptor.
-        pDescriptor->setDims(newDims[0], newDims[1]);
+        pDescriptor->setDims(std::max(numRows, rowEnd + 1),
+            std::max(numColumns, columnEnd + 1));
     }
 
+    auto fileDataSpace = m_pH5dataSet->getSpace();
     fileDataSpace.selectHyperslab(H5S_SELECT_SET, count.data(), offset.data());
 
     const auto memDataType = makeDataType();
@@ -41,6 +41,9 @@ public:
     std::shared_ptr<VRNodeDescriptor> getDescriptor() & noexcept;
     std::shared_ptr<const VRNodeDescriptor> getDescriptor() const & noexcept;
 
+    void recomputeStatistics(unsigned int numThreads = 0);
+    void reserve(uint32_t numItems);
+
 protected:
     static std::shared_ptr<VRNode> create(Dataset& dataset,
         uint64_t chunkSize, int compressionLevel);
@@ -61,10 +64,13 @@ private:
 
     void writeAttributesProxy() const override;
 
+    void trim() const;
+
     //! The HDF5 DataSet this layer wraps.
     std::unique_ptr<H5::DataSet, DeleteH5dataSet> m_pH5dataSet;
 
     friend Dataset;
+    friend VRRecordReader;
 };
 
 #ifdef _MSC_VER
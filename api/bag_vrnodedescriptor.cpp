@@ -1,5 +1,7 @@
 
+#include "bag_dataset.h"
 #include "bag_exceptions.h"
+#include "bag_hdfhelper.h"
 #include "bag_private.h"
 #include "bag_vrnodedescriptor.h"
 
@@ -37,6 +39,9 @@ VRNodeDescriptor::VRNodeDescriptor(
     uint32_t rows, uint32_t cols)
     : LayerDescriptor(dataset, VarRes_Node, rows, cols, VR_NODE_PATH)
 {
+    // The nodes are chunked along their single row; keep the number of
+    // records in a chunk.
+    this->setChunkSize(getChunkLength(dataset.getH5file(), VR_NODE_PATH));
 }
 
 //! Create a mew variable resolution node.
@@ -0,0 +1,294 @@
+#include "bag_dataset.h"
+#include "bag_exceptions.h"
+#include "bag_private.h"
+#include "bag_types.h"
+#include "bag_vrmetadata.h"
+#include "bag_vrnode.h"
+#include "bag_vrnodedescriptor.h"
+#include "bag_vrrecords.h"
+#include "bag_vrrefinements.h"
+#include "bag_vrrefinementsdescriptor.h"
+
+#include <algorithm>
+#include <array>
+#include <H5Cpp.h>
+#include <limits>
+#include <tuple>
+
+
+namespace BAG {
+
+namespace {
+
+//! Create an HDF5 CompType filling the refinement fields of a VRRecord.
+/*!
+    HDF5 converts the members by name and leaves the other fields of the
+    records as they were.
+
+\return
+    The HDF5 CompType of the refinement fields of a VRRecord.
+*/
+::H5::CompType makeRefinementsDataType()
+{
+    const ::H5::CompType memDataType{sizeof(VRRecord)};
+
+    memDataType.insertMember("depth", HOFFSET(VRRecord, depth),
+        ::H5::PredType::NATIVE_FLOAT);
+    memDataType.insertMember("depth_uncrt", HOFFSET(VRRecord, depth_uncrt),
+        ::H5::PredType::NATIVE_FLOAT);
+
+    return memDataType;
+}
+
+//! Create an HDF5 CompType filling the node fields of a VRRecord.
+/*!
+\return
+    The HDF5 CompType of the node fields of a VRRecord.
+*/
+::H5::CompType makeNodeDataType()
+{
+    const ::H5::CompType memDataType{sizeof(VRRecord)};
+
+    memDataType.insertMember("hyp_strength", HOFFSET(VRRecord, hyp_strength),
+        ::H5::PredType::NATIVE_FLOAT);
+    memDataType.insertMember("num_hypotheses",
+        HOFFSET(VRRecord, num_hypotheses), ::H5::PredType::NATIVE_UINT32);
+    memDataType.insertMember("n_samples", HOFFSET(VRRecord, n_samples),
+        ::H5::PredType::NATIVE_UINT32);
+
+    return memDataType;
+}
+
+//! Whether a supercell is refined.
+bool isRefined(const VRMetadataItem& supercell) noexcept
+{
+    return supercell.dimensions_x > 0 && supercell.dimensions_y > 0 &&
+        supercell.index != std::numeric_limits<uint32_t>::max();
+}
+
+}  // namespace
+
+//! Read the records of a range of indices.
+/*!
+\param dataset
+    The variable resolution BAG.
+\param indexStart
+    The first index.
+\param indexEnd
+    The last index (inclusive).
+
+\return
+    The records from indexStart to indexEnd.
+*/
+std::vector<VRRecord> VRRecordReader::read(
+    const Dataset& dataset,
+    uint32_t indexStart,
+    uint32_t indexEnd)
+{
+    if (indexStart > indexEnd)
+        throw InvalidReadSize{};
+
+    return readSpans(dataset,
+        {{indexStart, static_cast<uint64_t>(indexEnd) + 1}});
+}
+
+//! Read the records of a rectangle of supercells.
+/*!
+    The variable resolution metadata of the rectangle is read once; the
+    records of its refined supercells are read as the union of their index
+    ranges, and packed supercell by supercell.
+
+\param dataset
+    The variable resolution BAG.
+\param rowStart
+    The starting row of supercells.
+\param columnStart
+    The starting column of supercells.
+\param rowEnd
+    The ending row of supercells (inclusive).
+\param columnEnd
+    The ending column of supercells (inclusive).
+
+\return
+    The records of the supercells, and where those of each supercell start.
+*/
+VRSupercellRecords VRRecordReader::readSupercells(
+    const Dataset& dataset,
+    uint32_t rowStart,
+    uint32_t columnStart,
+    uint32_t rowEnd,
+    uint32_t columnEnd)
+{
+    if (rowStart > rowEnd || columnStart > columnEnd)
+        throw InvalidReadSize{};
+
+    const auto pMetadata = dataset.getVRMetadata();
+    if (!pMetadata)
+        throw LayerNotFound{};
+
+    const auto metadataBuffer = pMetadata->read(rowStart, columnStart, rowEnd,
+        columnEnd);
+    const auto* supercells =
+        reinterpret_cast<const VRMetadataItem*>(metadataBuffer.data());
+
+    VRSupercellRecords result;
+    result.rows = rowEnd - rowStart + 1;
+    result.columns = columnEnd - columnStart + 1;
+
+    const size_t numSupercells = static_cast<size_t>(result.rows) *
+        result.columns;
+
+    // The index ranges of the refined supercells, merged where they touch.
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    for (size_t i = 0; i < numSupercells; ++i)
+        if (isRefined(supercells[i]))
+            ranges.emplace_back(supercells[i].index, supercells[i].index +
+                static_cast<uint64_t>(supercells[i].dimensions_x) *
+                supercells[i].dimensions_y);
+
+    std::sort(ranges.begin(), ranges.end());
+
+    std::vector<std::pair<uint64_t, uint64_t>> spans;
+    std::vector<uint64_t> spanStarts;
+    uint64_t numRecords = 0;
+    for (const auto& range : ranges)
+    {
+        if (!spans.empty() && range.first <= spans.back().second)
+        {
+            numRecords += std::max(spans.back().second, range.second) -
+                spans.back().second;
+            spans.back().second = std::max(spans.back().second, range.second);
+            continue;
+        }
+
+        spans.push_back(range);
+        spanStarts.push_back(numRecords);
+        numRecords += range.second - range.first;
+    }
+
+    const auto records = readSpans(dataset, spans);
+
+    // Pack the records supercell by supercell.
+    result.offsets.reserve(numSupercells + 1);
+    result.items.reserve(records.size());
+
+    for (size_t i = 0; i < numSupercells; ++i)
+    {
+        result.offsets.push_back(result.items.size());
+
+        const auto& supercell = supercells[i];
+        if (!isRefined(supercell))
+            continue;
+
+        // The span holding the supercell is the last starting at or before it.
+        const auto span = std::upper_bound(spans.begin(), spans.end(),
+            std::make_pair(static_cast<uint64_t>(supercell.index),
+                std::numeric_limits<uint64_t>::max())) - 1;
+        const auto* first = records.data() + spanStarts[span - spans.begin()] +
+            (supercell.index - span->first);
+
+        result.items.insert(result.items.end(), first, first +
+            static_cast<uint64_t>(supercell.dimensions_x) *
+            supercell.dimensions_y);
+    }
+
+    result.offsets.push_back(result.items.size());
+
+    return result;
+}
+
+//! Read the records of sorted, disjoint ranges of indices.
+/*!
+    The ranges are cut at the chunk boundaries of the refinements.  The pieces
+    in each chunk are read from the refinements, as one selection, and then
+    from the nodes into the same records.
+
+\param dataset
+    The variable resolution BAG.
+\param spans
+    The index ranges [first, end), sorted and disjoint.
+
+\return
+    The records of the ranges, one after the other.
+*/
+std::vector<VRRecord> VRRecordReader::readSpans(
+    const Dataset& dataset,
+    const std::vector<std::pair<uint64_t, uint64_t>>& spans)
+{
+    const auto pRefinements = dataset.getVRRefinements();
+    const auto pNode = dataset.getVRNode();
+    if (!pRefinements || !pNode)
+        throw LayerNotFound{};
+
+    uint32_t numRows = 0, numRefinements = 0, numNodes = 0;
+    std::tie(numRows, numRefinements) = pRefinements->getDescriptor()->getDims();
+    std::tie(numRows, numNodes) = pNode->getDescriptor()->getDims();
+
+    if (!spans.empty() && spans.back().second > std::min(numRefinements,
+        numNodes))
+        throw InvalidReadSize{};
+
+    uint64_t numRecords = 0;
+    for (const auto& span : spans)
+        numRecords += span.second - span.first;
+
+    std::vector<VRRecord> records(numRecords);
+    if (records.empty())
+        return records;
+
+    uint64_t chunkLength = pRefinements->getDescriptor()->getChunkSize();
+    if (chunkLength == 0)
+        chunkLength = kMaxVRChunkLength;
+
+    const auto& h5refinements = *pRefinements->m_pH5dataSet;
+    const auto& h5node = *pNode->m_pH5dataSet;
+    const auto refinementsDataType = makeRefinementsDataType();
+    const auto nodeDataType = makeNodeDataType();
+
+    const auto h5refinementsSpace = h5refinements.getSpace();
+    const auto h5nodeSpace = h5node.getSpace();
+
+    auto span = spans.begin();
+    uint64_t position = span->first;
+    uint64_t slot = 0;
+
+    while (span != spans.end())
+    {
+        const uint64_t chunkEnd = (position / chunkLength + 1) * chunkLength;
+        const uint64_t chunkSlot = slot;
+
+        h5refinementsSpace.selectNone();
+        h5nodeSpace.selectNone();
+
+        // Select the pieces of the spans in this chunk.
+        while (span != spans.end() && position < chunkEnd)
+        {
+            const auto end = std::min(span->second, chunkEnd);
+
+            const std::array<hsize_t, kRank> sizes{1, end - position};
+            const std::array<hsize_t, kRank> offsets{0, position};
+            h5refinementsSpace.selectHyperslab(H5S_SELECT_OR, sizes.data(),
+                offsets.data());
+            h5nodeSpace.selectHyperslab(H5S_SELECT_OR, sizes.data(),
+                offsets.data());
+
+            slot += end - position;
+            position = end;
+
+            if (position == span->second && ++span != spans.end())
+                position = span->first;
+        }
+
+        const std::array<hsize_t, kRank> sizes{1, slot - chunkSlot};
+        const ::H5::DataSpace memDataSpace{kRank, sizes.data(), sizes.data()};
+
+        h5refinements.read(records.data() + chunkSlot, refinementsDataType,
+            memDataSpace, h5refinementsSpace);
+        h5node.read(records.data() + chunkSlot, nodeDataType, memDataSpace,
+            h5nodeSpace);
+    }
+
+    return records;
+}
+
+}  // namespace BAG
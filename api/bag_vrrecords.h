@@ -0,0 +1,84 @@
+#ifndef BAG_VRRECORDS_H
+#define BAG_VRRECORDS_H
+
+#include "bag_config.h"
+#include "bag_fordec.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+namespace BAG {
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)  // std classes do not have DLL-interface when exporting
+#endif
+
+//! A refined node: its refinement and its node values together.
+struct VRRecord final
+{
+    //! The depth.
+    float depth = 0.f;
+    //! The uncertainty.
+    float depth_uncrt = 0.f;
+    //! Hypotheses strength.
+    float hyp_strength = 0.f;
+    //! Number of hypotheses.
+    uint32_t num_hypotheses = 0;
+    //! Number of samples.
+    uint32_t n_samples = 0;
+};
+
+//! The records of a rectangle of supercells.
+/*!
+    Laid out as VRSupercellRefinements: the records of supercell (row, column)
+    of the rectangle run from offsets[row * columns + column] up to the next
+    offset.
+*/
+struct VRSupercellRecords final
+{
+    //! The number of rows of supercells.
+    uint32_t rows = 0;
+    //! The number of columns of supercells.
+    uint32_t columns = 0;
+    //! The records of the supercells.
+    std::vector<VRRecord> items;
+    //! Where the records of each supercell start in items, followed by the
+    //! number of records.
+    std::vector<uint64_t> offsets;
+};
+
+//! Joint reads of the variable resolution refinements and nodes.
+/*!
+    The refinement and the node at an index describe the same refined node.
+    Rather than reading both layers over the same range and matching them up,
+    the reader fills one VRRecord per index from both.
+
+    The two HDF5 DataSets are walked in lockstep, a chunk of the refinements
+    at a time: the part of the requested indices in a chunk is read from the
+    refinements and then from the nodes, each into its own fields of the
+    records, before moving on to the next chunk.
+*/
+class BAG_API VRRecordReader final
+{
+public:
+    static std::vector<VRRecord> read(const Dataset& dataset,
+        uint32_t indexStart, uint32_t indexEnd);
+    static VRSupercellRecords readSupercells(const Dataset& dataset,
+        uint32_t rowStart, uint32_t columnStart, uint32_t rowEnd,
+        uint32_t columnEnd);
+
+private:
+    static std::vector<VRRecord> readSpans(const Dataset& dataset,
+        const std::vector<std::pair<uint64_t, uint64_t>>& spans);
+};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+}  // namespace BAG
+
+#endif  // BAG_VRRECORDS_H
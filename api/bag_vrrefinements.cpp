@@ -1,13 +1,21 @@
 
+#include "bag_chunkio.h"
+#include "bag_dataset.h"
 #include "bag_hdfhelper.h"
+#include "bag_parallel.h"
 #include "bag_private.h"
+#include "bag_vrmetadata.h"
 #include "bag_vrrefinements.h"
 #include "bag_vrrefinementsdescriptor.h"
 
+#include <algorithm>
 #include <iostream>
 #include <array>
 #include <cstring>  //memset
 #include <H5Cpp.h>
+#include <limits>
+#include <mutex>
+#include <utility>
 
 namespace BAG {
 
@@ -75,6 +83,148 @@ std::shared_ptr<const VRRefinementsDescriptor> VRRefinements::getDescriptor() co
     return std::dynamic_pointer_cast<const VRRefinementsDescriptor>(Layer::getDescriptor());
 }
 
+//! Read the refinements of a rectangle of supercells.
+/*!
+    The variable resolution metadata of the rectangle is read once.  The
+    refinements of its refined supercells are then read together, as one
+    selection of the union of their index ranges, and packed supercell by
+    supercell.
+
+\param rowStart
+    The starting row of supercells.
+\param columnStart
+    The starting column of supercells.
+\param rowEnd
+    The ending row of supercells (inclusive).
+\param columnEnd
+    The ending column of supercells (inclusive).
+
+\return
+    The refinements of the supercells, and where those of each supercell
+    start.
+*/
+VRSupercellRefinements VRRefinements::readSupercells(
+    uint32_t rowStart,
+    uint32_t columnStart,
+    uint32_t rowEnd,
+    uint32_t columnEnd) const
+{
+    if (rowStart > rowEnd || columnStart > columnEnd)
+        throw InvalidReadSize{};
+
+    const auto pDataset = this->getDataset().lock();
+    if (!pDataset)
+        throw DatasetNotFound{};
+
+    const auto pMetadata = pDataset->getVRMetadata();
+    if (!pMetadata)
+        throw LayerNotFound{};
+
+    const auto metadataBuffer = pMetadata->read(rowStart, columnStart, rowEnd,
+        columnEnd);
+    const auto* supercells =
+        reinterpret_cast<const VRMetadataItem*>(metadataBuffer.data());
+
+    VRSupercellRefinements result;
+    result.rows = rowEnd - rowStart + 1;
+    result.columns = columnEnd - columnStart + 1;
+
+    const size_t numSupercells = static_cast<size_t>(result.rows) *
+        result.columns;
+
+    // The index range [first, end) of each refined supercell.
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    for (size_t i = 0; i < numSupercells; ++i)
+    {
+        const auto& supercell = supercells[i];
+        const uint64_t count =
+            static_cast<uint64_t>(supercell.dimensions_x) *
+            supercell.dimensions_y;
+
+        if (count > 0 && supercell.index != std::numeric_limits<uint32_t>::max())
+            ranges.emplace_back(supercell.index, supercell.index + count);
+    }
+
+    // Merge the ranges that touch or overlap.
+    std::sort(ranges.begin(), ranges.end());
+
+    std::vector<std::pair<uint64_t, uint64_t>> spans;
+    for (const auto& range : ranges)
+    {
+        if (!spans.empty() && range.first <= spans.back().second)
+            spans.back().second = std::max(spans.back().second, range.second);
+        else
+            spans.push_back(range);
+    }
+
+    uint32_t numRows = 0, numColumns = 0;
+    std::tie(numRows, numColumns) = this->getDescriptor()->getDims();
+
+    if (!spans.empty() && spans.back().second > numColumns)
+        throw InvalidReadSize{};
+
+    // Read the union of the ranges at once.
+    std::vector<uint64_t> spanStarts;
+    spanStarts.reserve(spans.size());
+
+    std::vector<VRRefinementsItem> values;
+    if (!spans.empty())
+    {
+        const auto h5fileDataSpace = m_pH5dataSet->getSpace();
+        h5fileDataSpace.selectNone();
+
+        hsize_t numValues = 0;
+        for (const auto& span : spans)
+        {
+            const std::array<hsize_t, kRank> sizes{1, span.second - span.first};
+            const std::array<hsize_t, kRank> offsets{0, span.first};
+            h5fileDataSpace.selectHyperslab(H5S_SELECT_OR, sizes.data(),
+                offsets.data());
+
+            spanStarts.push_back(numValues);
+            numValues += sizes[1];
+        }
+
+        values.resize(numValues);
+
+        const std::array<hsize_t, kRank> sizes{1, numValues};
+        const ::H5::DataSpace memDataSpace{kRank, sizes.data(), sizes.data()};
+
+        m_pH5dataSet->read(values.data(), makeDataType(), memDataSpace,
+            h5fileDataSpace);
+    }
+
+    // Pack the refinements supercell by supercell.
+    result.offsets.reserve(numSupercells + 1);
+    result.items.reserve(values.size());
+
+    for (size_t i = 0; i < numSupercells; ++i)
+    {
+        result.offsets.push_back(result.items.size());
+
+        const auto& supercell = supercells[i];
+        const uint64_t count =
+            static_cast<uint64_t>(supercell.dimensions_x) *
+            supercell.dimensions_y;
+
+        if (count == 0 || supercell.index == std::numeric_limits<uint32_t>::max())
+            continue;
+
+        // The span holding the supercell is the last starting at or before it.
+        const auto span = std::upper_bound(spans.begin(), spans.end(),
+            std::make_pair(static_cast<uint64_t>(supercell.index),
+                std::numeric_limits<uint64_t>::max())) - 1;
+        const auto* first = values.data() + spanStarts[span - spans.begin()] +
+            (supercell.index - span->first);
+
+        result.items.insert(result.items.end(), first, first + count);
+    }
+
+    result.offsets.push_back(result.items.size());
+
+    return result;
+}
+
 //! Constructor.
 /*!
 \param dataset
@@ -98,7 +248,8 @@ VRRefinements::VRRefinements(
 \param dataset
     The BAG Dataset this layer belongs to.
 \param chunkSize
-    The chunk size the HDF5 DataSet will use.
+    The chunk size of the grid; the HDF5 DataSet is chunked in rows of
+    getVRChunkLength() records.
 \param compressionLevel
     The compression level the HDF5 DataSet will use.
 
@@ -110,8 +261,9 @@ std::unique_ptr<VRRefinements> VRRefinements::create(
     uint64_t chunkSize,
     int compressionLevel)
 {
-    auto descriptor = VRRefinementsDescriptor::create(dataset, chunkSize,
-        compressionLevel);
+    // The descriptor keeps the chunk length, in records.
+    auto descriptor = VRRefinementsDescriptor::create(dataset,
+        getVRChunkLength(chunkSize), compressionLevel);
 
     auto h5dataSet = VRRefinements::createH5dataSet(dataset, *descriptor);
 
@@ -194,11 +346,14 @@ VRRefinements::createH5dataSet(
     const auto compressionLevel = descriptor.getCompressionLevel();
     if (chunkSize > 0)
     {
-        const std::array<hsize_t, kRank> chunkDims{chunkSize, chunkSize};
+        // One row of records; see getVRChunkLength().
+        const std::array<hsize_t, kRank> chunkDims{1, chunkSize};
         h5createPropList.setChunk(kRank, chunkDims.data());
 
         if (compressionLevel > 0 && compressionLevel <= kMaxCompressionLevel)
             h5createPropList.setDeflate(compressionLevel);
+        if (dataset.getDescriptor().isChecksummed())
+            h5createPropList.setFletcher32();
     }
     else if (compressionLevel > 0)
         throw CompressionNeedsChunkingSet{};
@@ -294,6 +449,90 @@ void VRRefinements::writeAttributesProxy() const
         std::get<1>(minMaxUncertainty), VR_REFINEMENT_MAX_UNCERTAINTY);
 }
 
+//! Recompute the depth and uncertainty ranges from the refinements.
+/*!
+    The ranges kept as refinements are written only ever widen, and files
+    from other producers may carry stale or placeholder ranges.  The
+    refinements are scanned a chunk at a time across threads, skipping null
+    values.  The descriptor takes the new ranges, and so do the attributes
+    unless the Dataset is read only.
+
+\param numThreads
+    The number of threads to use.  Zero selects the hardware concurrency.
+*/
+void VRRefinements::recomputeStatistics(
+    unsigned int numThreads)
+{
+    const auto pDataset = this->getDataset().lock();
+    if (!pDataset)
+        throw DatasetNotFound{};
+
+    auto pDescriptor = this->getDescriptor();
+
+    uint32_t numRows = 0, numColumns = 0;
+    std::tie(numRows, numColumns) = pDescriptor->getDims();
+
+    const ChunkedDataSet chunked{*m_pH5dataSet};
+    const auto memDataType = makeDataType();
+
+    ValueRange depthRange, uncertaintyRange;
+    std::mutex rangeMutex;
+
+    parallelFor(chunked.getNumChunks(), numThreads, [&](size_t chunkIndex) {
+        // The DataSet may be longer than the refinements written.
+        const auto window = chunked.getChunkWindow(chunkIndex);
+        if (window.rowStart >= numRows || window.columnStart >= numColumns)
+            return;
+
+        const auto buffer = chunked.readChunk(chunkIndex, memDataType.getId());
+        const auto* items =
+            reinterpret_cast<const VRRefinementsItem*>(buffer.data());
+        const auto count = std::min(window.columnEnd + 1, numColumns) -
+            window.columnStart;
+
+        ValueRange depth, uncertainty;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            depth.add(items[i].depth);
+            uncertainty.add(items[i].depth_uncrt);
+        }
+
+        std::lock_guard<std::mutex> lock{rangeMutex};
+        depthRange.merge(depth);
+        uncertaintyRange.merge(uncertainty);
+    });
+
+    pDescriptor->setMinMaxDepth(depthRange.min, depthRange.max);
+    pDescriptor->setMinMaxUncertainty(uncertaintyRange.min,
+        uncertaintyRange.max);
+
+    if (!pDataset->getDescriptor().isReadOnly())
+        this->writeAttributesProxy();
+}
+
+//! Make room in the file for a number of refinements.
+/*!
+    Writing up to that many refinements then extends the HDF5 DataSet no further.
+    The room not written is trimmed when the Dataset is closed.
+
+\param numItems
+    The number of refinements to make room for.
+*/
+void VRRefinements::reserve(
+    uint32_t numItems)
+{
+    growExtent(*m_pH5dataSet, {1, numItems}, false);
+}
+
+//! Trim the HDF5 DataSet to the refinements written.
+void VRRefinements::trim() const
+{
+    uint32_t numRows = 0, numColumns = 0;
+    std::tie(numRows, numColumns) = this->getDescriptor()->getDims();
+
+    trimExtent(*m_pH5dataSet, {numRows, numColumns});
+}
+
 //! \copydoc Layer::write
 void VRRefinements::writeProxy(
     uint32_t rowStart,
@@ -313,38 +552,30 @@ void VRRefinements::writeProxy(
     const std::array<hsize_t, kRank> offset{rowStart, columnStart};
     const ::H5::DataSpace memDataSpace{kRank, count.data(), count.data()};
 
-    ::H5::DataSpace fileDataSpace = m_pH5dataSet->getSpace();
-
-    // Expand the file data space if needed.
-    std::array<hsize_t, kRank> fileDims{};
-    std::array<hsize_t, kRank> maxFileDims{};
-
-    const int numDims = fileDataSpace.getSimpleExtentDims(fileDims.data(),
-                                                          maxFileDims.data());
-    if (numDims != kRank) {
+    // Grow the file data space if needed; geometrically, so appending costs
+    // few extends.  The descriptor keeps the size written, and the room left
+    // over is trimmed when the Dataset is closed.
+    if (m_pH5dataSet->getSpace().getSimpleExtentNdims() != kRank)
         throw InvalidVRRefinementDimensions{};
-    }
 
-    if ((fileDims[0] < (rowEnd + 1)) ||
-        (fileDims[1] < (columnEnd + 1)))
-    {
-        const std::array<hsize_t, kRank> newDims{
-                std::max<hsize_t>(fileDims[0], rowEnd + 1),
-                std::max<hsize_t>(fileDims[1], columnEnd + 1)};
-        m_pH5dataSet->extend(newDims.data());
+    growExtent(*m_pH5dataSet, {rowEnd + 1ull, columnEnd + 1ull}, true);
 
-        fileDataSpace = m_pH5dataSet->getSpace();
+    uint32_t numRows = 0, numColumns = 0;
+    std::tie(numRows, numColumns) = pDescriptor->getDims();
 
-        // Update the dataset's dimensions.
+    if (numRows < rowEnd + 1 || numColumns < columnEnd + 1)
+    {
         if (this->getDataset().expired())
             throw DatasetNotFound{};
 
         // So that the read() call checks correctly against the size of the array, rather
         // than the dimensions of the mandatory layer, we need to keep track of the size
         // of the layer in the layer-specific descriptor.
-        pDescriptor->setDims(newDims[0], newDims[1]);
+        pDescriptor->setDims(std::max(numRows, rowEnd + 1),
+            std::max(numColumns, columnEnd + 1));
     }
 
+    auto fileDataSpace = m_pH5dataSet->getSpace();
     fileDataSpace.selectHyperslab(H5S_SELECT_SET, count.data(), offset.data());
 
     const auto memDataType = makeDataType();
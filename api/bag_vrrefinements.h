@@ -5,8 +5,11 @@
 #include "bag_deleteh5dataset.h"
 #include "bag_fordec.h"
 #include "bag_layer.h"
+#include "bag_types.h"
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 
 namespace BAG {
@@ -16,6 +19,27 @@ namespace BAG {
 #pragma warning(disable: 4251)  // std classes do not have DLL-interface when exporting
 #endif
 
+//! The refinements of a rectangle of supercells.
+/*!
+    The refinements of each refined supercell are packed one after the
+    other, supercell by supercell and row by row of the rectangle.  The
+    refinements of supercell (row, column) of the rectangle run from
+    offsets[row * columns + column] up to the next offset; supercells that
+    are not refined have none.
+*/
+struct VRSupercellRefinements final
+{
+    //! The number of rows of supercells.
+    uint32_t rows = 0;
+    //! The number of columns of supercells.
+    uint32_t columns = 0;
+    //! The refinements of the supercells.
+    std::vector<VRRefinementsItem> items;
+    //! Where the refinements of each supercell start in items, followed by
+    //! the number of refinements.
+    std::vector<uint64_t> offsets;
+};
+
 //! The interface for the variable resolution refinements layer.
 class BAG_API VRRefinements final : public Layer
 {
@@ -37,6 +61,12 @@ public:
     std::shared_ptr<VRRefinementsDescriptor> getDescriptor() & noexcept;
     std::shared_ptr<const VRRefinementsDescriptor> getDescriptor() const & noexcept;
 
+    VRSupercellRefinements readSupercells(uint32_t rowStart,
+        uint32_t columnStart, uint32_t rowEnd, uint32_t columnEnd) const;
+
+    void recomputeStatistics(unsigned int numThreads = 0);
+    void reserve(uint32_t numItems);
+
 protected:
     VRRefinements(Dataset& dataset,
         VRRefinementsDescriptor& descriptor,
@@ -61,10 +91,13 @@ private:
 
     void writeAttributesProxy() const override;
 
+    void trim() const;
+
     //! The HDF5 DataSet this layer wraps.
     std::unique_ptr<H5::DataSet, DeleteH5dataSet> m_pH5dataSet;
 
     friend Dataset;
+    friend VRRecordReader;
 };
 
 #ifdef _MSC_VER
@@ -1,5 +1,7 @@
 
+#include "bag_dataset.h"
 #include "bag_exceptions.h"
+#include "bag_hdfhelper.h"
 #include "bag_private.h"
 #include "bag_vrrefinementsdescriptor.h"
 
@@ -36,6 +38,9 @@ VRRefinementsDescriptor::VRRefinementsDescriptor(
     const Dataset& dataset, uint32_t rows, uint32_t cols)
     : LayerDescriptor(dataset, VarRes_Refinement, rows, cols, VR_REFINEMENT_PATH)
 {
+    // The refinements are chunked along their single row; keep the number of
+    // records in a chunk.
+    this->setChunkSize(getChunkLength(dataset.getH5file(), VR_REFINEMENT_PATH));
 }
 
 //! Create a new variable resolution refinements descriptor.
@@ -38,6 +38,20 @@
         return new BagTrackingItem{inRow, inCol, inDepth,
             inUncertainty, inTrack_code, inList_series};
     }
+
+    #ifdef SWIGPYTHON
+    %pythoncode %{
+        @staticmethod
+        def numpy_dtype():
+            """
+              The NumPy structured dtype matching the layout of a BagTrackingItem.
+            """
+            import numpy
+            return numpy.dtype([('row', numpy.uint32), ('col', numpy.uint32),
+                ('depth', numpy.float32), ('uncertainty', numpy.float32),
+                ('track_code', numpy.uint8), ('list_series', numpy.uint16)], align=True)
+    %}
+    #endif
 }
 
 // Add a constructor for BagVRMetadataItem.
@@ -49,6 +63,21 @@
         return new BagVRMetadataItem{inIndex, inDimX, inDimY, inResX, inResY,
             inSWx, inSWy};
     }
+
+    #ifdef SWIGPYTHON
+    %pythoncode %{
+        @staticmethod
+        def numpy_dtype():
+            """
+              The NumPy structured dtype matching the layout of a BagVRMetadataItem.
+            """
+            import numpy
+            return numpy.dtype([('index', numpy.uint32),
+                ('dimensions_x', numpy.uint32), ('dimensions_y', numpy.uint32),
+                ('resolution_x', numpy.float32), ('resolution_y', numpy.float32),
+                ('sw_corner_x', numpy.float32), ('sw_corner_y', numpy.float32)], align=True)
+    %}
+    #endif
 };
 
 // Add a constructor for BagVRNodeItem.
@@ -58,6 +87,19 @@
     {
         return new BagVRNodeItem{inHypStr, inNumHyp, inNSam};
     }
+
+    #ifdef SWIGPYTHON
+    %pythoncode %{
+        @staticmethod
+        def numpy_dtype():
+            """
+              The NumPy structured dtype matching the layout of a BagVRNodeItem.
+            """
+            import numpy
+            return numpy.dtype([('hyp_strength', numpy.float32),
+                ('num_hypotheses', numpy.uint32), ('n_samples', numpy.uint32)], align=True)
+    %}
+    #endif
 };
 
 // Add a constructor for BagVRRefinementsItem.
@@ -67,6 +109,19 @@
     {
         return new BagVRRefinementsItem{inDepth, inUncertaintyDepth};
     }
+
+    #ifdef SWIGPYTHON
+    %pythoncode %{
+        @staticmethod
+        def numpy_dtype():
+            """
+              The NumPy structured dtype matching the layout of a BagVRRefinementsItem.
+            """
+            import numpy
+            return numpy.dtype([('depth', numpy.float32),
+                ('depth_uncrt', numpy.float32)], align=True)
+    %}
+    #endif
 };
 
 // Add a constructor for BagVRTrackingItem.
@@ -78,6 +133,21 @@
         return new BagVRTrackingItem{inRow, inCol, inSubRow, inSubCol, inDepth,
             inUncertainty, inTrackCode, inListSeries};
     }
+
+    #ifdef SWIGPYTHON
+    %pythoncode %{
+        @staticmethod
+        def numpy_dtype():
+            """
+              The NumPy structured dtype matching the layout of a BagVRTrackingItem.
+            """
+            import numpy
+            return numpy.dtype([('row', numpy.uint32), ('col', numpy.uint32),
+                ('sub_row', numpy.uint32), ('sub_col', numpy.uint32),
+                ('depth', numpy.float32), ('uncertainty', numpy.float32),
+                ('track_code', numpy.uint8), ('list_series', numpy.uint16)], align=True)
+    %}
+    #endif
 };
 
 
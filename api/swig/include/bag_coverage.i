@@ -0,0 +1,111 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_coverage
+
+%{
+#include "bag_coverage.h"
+%}
+
+%import "bag_types.i"
+
+%include <stdint.i>
+%include <std_pair.i>
+%include <std_vector.i>
+
+%template(CoverageRuns) std::vector<BAG::CoverageRun>;
+%template(CoverageHolidays) std::vector<BAG::CoverageHoliday>;
+%template(DoublePairVector) std::vector<std::pair<double, double>>;
+%template(CoverageRings) std::vector<std::vector<std::pair<double, double>>>;
+%template(GridCover) std::pair<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, uint32_t>>;
+
+
+#define final
+
+namespace BAG
+{
+    class Dataset;
+
+    struct CoverageRun final
+    {
+        uint32_t row = 0;
+        uint32_t columnStart = 0;
+        uint32_t columnEnd = 0;
+    };
+
+    struct CoverageHoliday final
+    {
+        uint32_t rowStart = 0;
+        uint32_t columnStart = 0;
+        uint32_t rowEnd = 0;
+        uint32_t columnEnd = 0;
+        uint64_t numCells = 0;
+    };
+
+    class Coverage final
+    {
+    public:
+        static Coverage compute(const Dataset& dataset, unsigned int numThreads = 0);
+
+        uint32_t getRows() const noexcept;
+        uint32_t getColumns() const noexcept;
+
+        const std::vector<CoverageRun>& getRuns() const & noexcept;
+
+        bool empty() const noexcept;
+        bool contains(uint32_t row, uint32_t column) const noexcept;
+
+        uint64_t getNumCells() const noexcept;
+        double getArea() const noexcept;
+
+        std::vector<CoverageHoliday> getHolidays(
+            uint64_t maxCells = std::numeric_limits<uint64_t>::max()) const;
+
+        // Converted to std::pair<T, T> below.
+        //std::tuple<uint32_t, uint32_t, uint32_t, uint32_t> getGridBounds() const noexcept;
+        //std::tuple<double, double, double, double> getBounds() const noexcept;
+        //std::vector<Ring> getFootprint() const;
+    };
+
+    %extend Coverage
+    {
+        std::pair<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, uint32_t>>
+        getGridBounds() const noexcept
+        {
+            uint32_t rowStart = 0, columnStart = 0, rowEnd = 0, columnEnd = 0;
+            std::tie(rowStart, columnStart, rowEnd, columnEnd) = $self->getGridBounds();
+            return {{rowStart, columnStart}, {rowEnd, columnEnd}};
+        }
+
+        std::pair<std::pair<double, double>, std::pair<double, double>>
+        getBounds() const noexcept
+        {
+            double xMin = 0., yMin = 0., xMax = 0., yMax = 0.;
+            std::tie(xMin, yMin, xMax, yMax) = $self->getBounds();
+            return {{xMin, yMin}, {xMax, yMax}};
+        }
+
+        std::vector<std::vector<std::pair<double, double>>> getFootprint() const
+        {
+            std::vector<std::vector<std::pair<double, double>>> rings;
+
+            for (const auto& ring : $self->getFootprint())
+            {
+                std::vector<std::pair<double, double>> points;
+                points.reserve(ring.size());
+
+                for (const auto& point : ring)
+                    points.emplace_back(std::get<0>(point), std::get<1>(point));
+
+                rings.push_back(std::move(points));
+            }
+
+            return rings;
+        }
+    }
+}
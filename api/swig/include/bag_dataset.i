@@ -12,16 +12,21 @@
 #include "bag_dataset.h"
 %}
 
+%import "bag_coverage.i"
 %import "bag_layer.i"
+%import "bag_revert.i"
 %import "bag_georefmetadatalayer.i"
 %import "bag_descriptor.i"
 %import "bag_simplelayer.i"
 %import "bag_surfacecorrections.i"
 %import "bag_trackinglist.i"
+%import "bag_trackinglistreader.i"
 %import "bag_types.i"
 %import "bag_vrmetadata.i"
 %import "bag_vrnode.i"
 %import "bag_vrrefinements.i"
+%import "bag_verify.i"
+%import "bag_vrindex.i"
 %import "bag_vrtrackinglist.i"
 
 %include <std_string.i>
@@ -44,12 +49,13 @@ namespace BAG {
 class Dataset final
 {
 public:
-    %rename(openDataset) open(const std::string &, OpenMode);
+    %rename(openDataset) open(const std::string &, OpenMode, bool);
     static std::shared_ptr<Dataset> open(const std::string & fileName,
-        OpenMode openMode);
+        OpenMode openMode, bool streamTrackingLists = false);
 
     static std::shared_ptr<Dataset> create(const std::string& fileName,
-        Metadata&& metadata, uint64_t chunkSize, int compressionLevel);
+        Metadata&& metadata, uint64_t chunkSize, int compressionLevel,
+        bool checksum = false);
 
     void close();
 
@@ -109,8 +115,26 @@ public:
 
     std::shared_ptr<VRTrackingList> getVRTrackingList() & noexcept;
 
+    // Converted to a non-const std::shared_ptr below.
+    //std::shared_ptr<const VRIndex> getVRIndex() const;
+
+    // Converted to non-const std::shared_ptrs below.
+    //std::shared_ptr<const TrackingListReader> getTrackingListReader() const;
+    //std::shared_ptr<const VRTrackingListReader> getVRTrackingListReader() const;
+
     Descriptor& getDescriptor() & noexcept;
 
+    const std::string& getFileName() const & noexcept;
+    OpenMode getOpenMode() const noexcept;
+
+    Coverage getCoverage(unsigned int numThreads = 0) const;
+    std::vector<ChunkFault> verify(unsigned int numThreads = 0) const;
+    std::shared_ptr<Dataset> extract(double xMin, double yMin, double xMax,
+        double yMax, const std::string& outFileName,
+        unsigned int numThreads = 0) const;
+    size_t revertEdits(const RevertFilter& filter,
+        unsigned int numThreads = 0);
+
     // Converted to std::pair<T, T> below.
     //! Intentionally omit exposing of std::tuple methods (unsupported by SWIG), 
     //! so they can be exposed with std::pair below.
@@ -135,6 +159,23 @@ public:
         return rawPtrlayers;
     }
 
+    std::shared_ptr<BAG::VRIndex> getVRIndex() const
+    {
+        return std::const_pointer_cast<BAG::VRIndex>($self->getVRIndex());
+    }
+
+    std::shared_ptr<BAG::TrackingListReader> getTrackingListReader() const
+    {
+        return std::const_pointer_cast<BAG::TrackingListReader>(
+            $self->getTrackingListReader());
+    }
+
+    std::shared_ptr<BAG::VRTrackingListReader> getVRTrackingListReader() const
+    {
+        return std::const_pointer_cast<BAG::VRTrackingListReader>(
+            $self->getVRTrackingListReader());
+    }
+
     std::pair<double, double> gridToGeo(uint32_t row, uint32_t column) const noexcept
     {
         double x=0.0, y=0.0;
@@ -153,6 +194,29 @@ public:
     %pythoncode %{
         def __del__(self):
             self.close()
+
+        def __reduce__(self):
+            # HDF5 handles cannot cross processes; open the BAG again there.
+            return (_openDataset, (self.getFileName(), self.getOpenMode()))
+
+        def reference(self):
+            """
+              A picklable DatasetRef to this BAG, which opens it lazily.
+            """
+            return DatasetRef(self.getFileName(), self.getOpenMode())
+
+        @staticmethod
+        def open_async(fileName, openMode, executor=None):
+            """
+              Open a BAG on a worker thread.
+
+              Call it from a coroutine; it returns an awaitable for the
+              Dataset.  The open runs in executor, or the event loop's
+              default thread pool if it is None.
+            """
+            import asyncio
+            return asyncio.get_running_loop().run_in_executor(executor,
+                Dataset.openDataset, fileName, openMode)
     %}
     // TODO: Add context manager for Dataset to allow use with ``with``.
     #endif
@@ -160,3 +224,131 @@ public:
 
 }  // namespace BAG
 
+#ifdef SWIGPYTHON
+%pythoncode %{
+def _openDataset(fileName, openMode):
+    return Dataset.openDataset(fileName, openMode)
+
+
+class DatasetRef(object):
+    """
+      A lightweight, picklable reference to a BAG.
+
+      It holds the file name and open mode only, and opens the BAG the first
+      time open() is called in a process.  A reference that reaches another
+      process, pickled or inherited through fork(), opens a handle of its own
+      there rather than using the HDF5 handles of its parent.
+    """
+
+    # Datasets inherited through fork().  They are kept rather than closed,
+    # so a child never closes or flushes handles that belong to its parent.
+    _inherited = []
+
+    def __init__(self, fileName, openMode=BAG_OPEN_READONLY):
+        self.fileName = fileName
+        self.openMode = openMode
+        self._dataset = None
+        self._pid = None
+
+    def open(self):
+        """
+          The Dataset referred to, opened in this process on first use.
+        """
+        import os
+        if self._dataset is not None and self._pid != os.getpid():
+            DatasetRef._inherited.append(self._dataset)
+            self._dataset = None
+
+        if self._dataset is None:
+            self._dataset = Dataset.openDataset(self.fileName, self.openMode)
+            self._pid = os.getpid()
+
+        return self._dataset
+
+    def close(self):
+        """
+          Close the Dataset if this process opened it.
+        """
+        import os
+        if self._dataset is not None and self._pid == os.getpid():
+            self._dataset.close()
+        self._dataset = None
+        self._pid = None
+
+    def __getstate__(self):
+        return {'fileName': self.fileName, 'openMode': self.openMode}
+
+    def __setstate__(self, state):
+        self.__init__(state['fileName'], state['openMode'])
+
+    def __eq__(self, other):
+        return isinstance(other, DatasetRef) and \
+            (self.fileName, self.openMode) == (other.fileName, other.openMode)
+
+    def __hash__(self):
+        return hash((self.fileName, self.openMode))
+
+    def __repr__(self):
+        return "DatasetRef(%r, %r)" % (self.fileName, self.openMode)
+
+
+class ChunkWindow(object):
+    """
+      A picklable task: one window of one layer of a BAG.
+
+      Made by Layer.chunk_windows().  The rows and columns are inclusive, as
+      for Layer.read().
+    """
+
+    def __init__(self, datasetRef, layerType, layerName, rowStart,
+                 columnStart, rowEnd, columnEnd):
+        self.datasetRef = datasetRef
+        self.layerType = layerType
+        self.layerName = layerName
+        self.rowStart = rowStart
+        self.columnStart = columnStart
+        self.rowEnd = rowEnd
+        self.columnEnd = columnEnd
+
+    @property
+    def shape(self):
+        return (self.rowEnd - self.rowStart + 1,
+                self.columnEnd - self.columnStart + 1)
+
+    def layer(self):
+        """
+          The layer, from the Dataset opened in this process.
+        """
+        return self.datasetRef.open().getLayer(self.layerType, self.layerName)
+
+    def read(self):
+        return self.layer().read(self.rowStart, self.columnStart,
+                                 self.rowEnd, self.columnEnd)
+
+    def read_numpy(self):
+        return self.layer().read_numpy(self.rowStart, self.columnStart,
+                                       self.rowEnd, self.columnEnd)
+
+    def write(self, items):
+        self.layer().write(self.rowStart, self.columnStart, self.rowEnd,
+                           self.columnEnd, items)
+
+    def __eq__(self, other):
+        return isinstance(other, ChunkWindow) and \
+            self.__getstate__() == other.__getstate__()
+
+    def __hash__(self):
+        return hash((self.datasetRef, self.layerType, self.layerName,
+                     self.rowStart, self.columnStart, self.rowEnd,
+                     self.columnEnd))
+
+    def __getstate__(self):
+        return dict(self.__dict__)
+
+    def __repr__(self):
+        return "ChunkWindow(%r, %r, %r, %d, %d, %d, %d)" % (
+            self.datasetRef, self.layerType, self.layerName, self.rowStart,
+            self.columnStart, self.rowEnd, self.columnEnd)
+%}
+#endif
+
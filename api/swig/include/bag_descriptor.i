@@ -53,6 +53,7 @@ namespace BAG {
 
         std::vector<LayerType> getLayerTypes() const;
         bool isReadOnly() const noexcept;
+        bool isChecksummed() const noexcept;
         std::vector<uint32_t> getLayerIds() const noexcept;
         const std::vector<std::weak_ptr<const LayerDescriptor>>&
             getLayerDescriptors() const & noexcept;
@@ -83,6 +84,7 @@ namespace BAG {
         Descriptor& setHorizontalReferenceSystem(
             const std::string& horizontalReferenceSystem) & noexcept;
         Descriptor& setReadOnly(bool readOnly) & noexcept;
+        Descriptor& setChecksummed(bool checksummed) & noexcept;
         Descriptor& setVersion(std::string inVersion) & noexcept;
     };
 }
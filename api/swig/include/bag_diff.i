@@ -0,0 +1,57 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_diff
+
+%{
+#include "bag_diff.h"
+%}
+
+%import "bag_dataset.i"
+
+%include <std_string.i>
+%include <stdint.i>
+
+%include <std_shared_ptr.i>
+%shared_ptr(BAG::Dataset)
+
+%include <std_vector.i>
+%template(ChunkChanges) std::vector<BAG::ChunkChange>;
+
+
+#define final
+
+namespace BAG
+{
+    struct ChunkChange final
+    {
+        uint32_t rowStart = 0;
+        uint32_t columnStart = 0;
+        uint32_t rowEnd = 0;
+        uint32_t columnEnd = 0;
+        uint64_t numCompared = 0;
+        uint64_t numChanged = 0;
+        float minDifference = 0.f;
+        float maxDifference = 0.f;
+        double meanDifference = 0.;
+        double rmsDifference = 0.;
+    };
+
+    class SurfaceDiff final
+    {
+    public:
+        static std::vector<ChunkChange> diff(const Dataset& base,
+            const Dataset& updated, const std::string& differenceFileName,
+            const std::string& patchFileName, float tolerance = 0.f,
+            int compressionLevel = 5, unsigned int numThreads = 0);
+
+        static std::vector<ChunkChange> applyPatch(Dataset& target,
+            const std::string& patchFileName, unsigned int numThreads = 0);
+    };
+}
+
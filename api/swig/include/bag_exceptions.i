@@ -31,12 +31,15 @@
 #define FOR_EACH_EXCEPTION(ACTION) \
    ACTION(BAG,CompressionNeedsChunkingSet) \
    ACTION(BAG,UnsupportedAttributeType) \
+   ACTION(BAG,CorruptChunk) \
    ACTION(BAG,InvalidType) \
    ACTION(BAG,InvalidDescriptor) \
    ACTION(BAG,InvalidKeyType) \
    ACTION(BAG,NameRequired) \
    ACTION(BAG,DatasetNotFound) \
    ACTION(BAG,InvalidLayerId) \
+   ACTION(BAG,PatchMismatch) \
+   ACTION(BAG,EmptyExtraction) \
    ACTION(BAG,UnsupportedGroupType) \
    ACTION(BAG,InvalidBuffer) \
    ACTION(BAG,InvalidReadSize) \
@@ -53,16 +56,22 @@
    ACTION(BAG,InvalidDatumError) \
    ACTION(BAG,InvalidEllipsoidError) \
    ACTION(BAG,CoordSysError) \
+   ACTION(BAG,IncompatibleGrids) \
    ACTION(BAG,MetadataNotFound) \
    ACTION(BAG,UknownMetadataProfile) \
    ACTION(BAG,UnrecognizedMetadataProfile) \
    ACTION(BAG,ErrorLoadingMetadata) \
+   ACTION(BAG,InvalidResolution) \
    ACTION(BAG,UnsupportedDataType) \
    ACTION(BAG,TooManyCorrections) \
    ACTION(BAG,UnknownSurfaceType) \
    ACTION(BAG,CannotReadNumCorrections) \
    ACTION(BAG,InvalidCorrector) \
    ACTION(BAG,UnsupportedSurfaceType) \
+   ACTION(BAG,InvalidTileSize) \
+   ACTION(BAG,InvalidSortOrder) \
+   ACTION(BAG,TrackingListNotLoaded) \
+   ACTION(BAG,TrackingListSorted) \
    ACTION(BAG,FieldNotFound) \
    ACTION(BAG,InvalidValue) \
    ACTION(BAG,InvalidValueSize) \
@@ -70,6 +79,8 @@
    ACTION(BAG,DatasetRequiresVariableResolution) \
    ACTION(BAG,InvalidValueKey) \
    ACTION(BAG,ValueNotFound) \
+   ACTION(BAG,InvalidRuleFactor) \
+   ACTION(BAG,InvalidSupercellSize) \
    ACTION(BAG,InvalidVRRefinementDimensions) \
 /**/
 %}
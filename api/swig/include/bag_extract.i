@@ -0,0 +1,35 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_extract
+
+%{
+#include "bag_extract.h"
+%}
+
+%import "bag_dataset.i"
+
+%include <std_string.i>
+
+%include <std_shared_ptr.i>
+%shared_ptr(BAG::Dataset)
+
+
+#define final
+
+namespace BAG
+{
+    class Extractor final
+    {
+    public:
+        static std::shared_ptr<Dataset> extract(const Dataset& dataset,
+            double xMin, double yMin, double xMax, double yMax,
+            const std::string& outFileName, unsigned int numThreads = 0);
+    };
+}
+
@@ -51,7 +51,7 @@ public:
 
     std::weak_ptr<Dataset> getDataset() const &;
     const RecordDefinition& getDefinition() const & noexcept;
-    GeorefMetadataProfile getProfile();
+    GeorefMetadataProfile getProfile() const noexcept;
 };
 
 }  // namespace BAG
@@ -12,6 +12,8 @@
 %{
 #include <memory>
 
+#include "bag_dataset.h"
+#include "bag_exceptions.h"
 #include "bag_layer.h"
 %}
 
@@ -60,6 +62,10 @@ public:
     void writeAttributes() const;
 };
 
+#ifdef SWIGPYTHON
+%newobject Layer::_readBuffer;
+#endif
+
 %extend Layer
 {
     LayerItems read(
@@ -81,7 +87,151 @@ public:
     {
         $self->write(rowStart, columnStart, rowEnd, columnEnd, items.data());
     }
+
+#ifdef SWIGPYTHON
+    //! The file name of the Dataset this layer belongs to.
+    std::string _getDatasetFileName() const
+    {
+        const auto pDataset = $self->getDataset().lock();
+        if (!pDataset)
+            throw BAG::DatasetNotFound{};
+
+        return pDataset->getFileName();
+    }
+
+    //! The mode the Dataset this layer belongs to was opened with.
+    BAG::OpenMode _getDatasetOpenMode() const
+    {
+        const auto pDataset = $self->getDataset().lock();
+        if (!pDataset)
+            throw BAG::DatasetNotFound{};
+
+        return pDataset->getOpenMode();
+    }
+#endif
+
+#ifdef SWIGPYTHON
+    //! Read a section of the layer into a buffer Python owns.
+    BAG::UInt8Array* _readBuffer(
+        uint32_t rowStart,
+        uint32_t columnStart,
+        uint32_t rowEnd,
+        uint32_t columnEnd) const
+    {
+        return new BAG::UInt8Array{$self->read(rowStart, columnStart, rowEnd,
+            columnEnd)};
+    }
+
+    %pythoncode %{
+        def read_numpy(self, rowStart, columnStart, rowEnd, columnEnd):
+            """
+              Read a section of the layer as a NumPy array of rows and columns.
+
+              The array shares memory with the buffer the layer was read into,
+              so nothing is copied.  Variable resolution layers give
+              structured arrays with the fields of their items.
+            """
+            import numpy
+            dtype = _numpyLayerDType(self.getDescriptor())
+            buffer = self._readBuffer(rowStart, columnStart, rowEnd, columnEnd)
+
+            return numpy.asarray(buffer).view(dtype).reshape(
+                (rowEnd - rowStart + 1, columnEnd - columnStart + 1))
+
+        def chunk_windows(self, rowsPerWindow=0, columnsPerWindow=0):
+            """
+              Split the layer into windows that can be processed separately.
+
+              Returns a list of ChunkWindow, which are picklable and can be
+              handed to multiprocessing or dask workers; each opens the BAG
+              again in the worker that reads or writes it.  Windows follow
+              the chunks of the layer; rowsPerWindow and columnsPerWindow,
+              when given, are rounded up to whole chunks.
+            """
+            descriptor = self.getDescriptor()
+            rows, columns = descriptor.getDims()
+            chunkSize = descriptor.getChunkSize() or max(rows, columns, 1)
+
+            def toWholeChunks(size):
+                if size <= 0:
+                    return chunkSize
+                return (size + chunkSize - 1) // chunkSize * chunkSize
+
+            windowRows = toWholeChunks(rowsPerWindow)
+            windowColumns = toWholeChunks(columnsPerWindow)
+
+            datasetRef = DatasetRef(self._getDatasetFileName(),
+                                    self._getDatasetOpenMode())
+            layerType = descriptor.getLayerType()
+            layerName = descriptor.getName()
+
+            return [ChunkWindow(datasetRef, layerType, layerName, rowStart,
+                                columnStart,
+                                min(rows, rowStart + windowRows) - 1,
+                                min(columns, columnStart + windowColumns) - 1)
+                    for rowStart in range(0, rows, windowRows)
+                    for columnStart in range(0, columns, windowColumns)]
+
+        def read_async(self, rowStart, columnStart, rowEnd, columnEnd,
+                       executor=None):
+            """
+              Read a section of the layer on a worker thread.
+
+              Call it from a coroutine; it returns an awaitable for the
+              LayerItems.  The read runs in executor, or the event loop's
+              default thread pool if it is None.  The GIL is released while
+              the layer is read, so several reads overlap.
+            """
+            import asyncio
+            return asyncio.get_running_loop().run_in_executor(executor,
+                self.read, rowStart, columnStart, rowEnd, columnEnd)
+
+        def read_numpy_async(self, rowStart, columnStart, rowEnd, columnEnd,
+                             executor=None):
+            """
+              Read a section of the layer as a NumPy array on a worker thread.
+
+              Returns an awaitable for the array; see read_async().
+            """
+            import asyncio
+            return asyncio.get_running_loop().run_in_executor(executor,
+                self.read_numpy, rowStart, columnStart, rowEnd, columnEnd)
+    %}
+#endif
 }
 
 }  // namespace BAG
 
+#ifdef SWIGPYTHON
+%pythoncode %{
+def _numpyLayerDType(descriptor):
+    """
+      The NumPy dtype of the items of a layer.
+    """
+    import numpy
+
+    itemTypes = {
+        VarRes_Metadata: BagVRMetadataItem,
+        VarRes_Node: BagVRNodeItem,
+        VarRes_Refinement: BagVRRefinementsItem,
+    }
+    layerType = descriptor.getLayerType()
+    if layerType in itemTypes:
+        return itemTypes[layerType].numpy_dtype()
+
+    dataTypes = {
+        DT_BOOLEAN: numpy.bool_,
+        DT_FLOAT32: numpy.float32,
+        DT_UINT8: numpy.uint8,
+        DT_UINT16: numpy.uint16,
+        DT_UINT32: numpy.uint32,
+        DT_UINT64: numpy.uint64,
+    }
+    dataType = descriptor.getDataType()
+    if dataType not in dataTypes:
+        raise TypeError("The layer has no NumPy dtype.")
+
+    return numpy.dtype(dataTypes[dataType])
+%}
+#endif
+
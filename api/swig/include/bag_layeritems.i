@@ -65,8 +65,23 @@ public:
         return $self->data()[pos];
     }
 
+    /**
+     * The address of the first byte, for the NumPy array interface.
+     */
+    size_t _address() const {
+        return reinterpret_cast<size_t>($self->data());
+    }
+
     %pythoncode %{
 
+    @property
+    def __array_interface__(self):
+        """
+          Expose the bytes to NumPy, read only, without copying them.
+        """
+        return {'shape': (len(self),), 'typestr': '|u1',
+                'data': (self._address(), True), 'version': 3}
+
     def __iter__(self):
         """
           Implement iterator using yield
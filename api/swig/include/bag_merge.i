@@ -0,0 +1,62 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_merge
+
+%{
+#include "bag_merge.h"
+%}
+
+%import "bag_dataset.i"
+
+%include <std_string.i>
+%include <stdint.i>
+
+%include <std_shared_ptr.i>
+%shared_ptr(BAG::Dataset)
+
+%include <std_vector.i>
+namespace std
+{
+    %template(DatasetVector) vector<shared_ptr<BAG::Dataset>>;
+}
+
+
+#define final
+
+namespace BAG
+{
+    enum class MergeRule
+    {
+        Priority,
+        Shoalest,
+        UncertaintyWeighted,
+    };
+
+    class Merger final
+    {
+    };
+}
+
+%extend BAG::Merger
+{
+    static std::shared_ptr<BAG::Dataset> merge(
+        const std::vector<std::shared_ptr<BAG::Dataset>>& inputs,
+        const std::string& outFileName,
+        BAG::MergeRule rule = BAG::MergeRule::Priority,
+        uint64_t chunkSize = 100, int compressionLevel = 5,
+        unsigned int numThreads = 0)
+    {
+        const std::vector<std::shared_ptr<const BAG::Dataset>> constInputs{
+            inputs.begin(), inputs.end()};
+
+        return BAG::Merger::merge(constInputs, outFileName, rule, chunkSize,
+            compressionLevel, numThreads);
+    }
+}
+
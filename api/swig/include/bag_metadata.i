@@ -51,6 +51,12 @@ public:
     void loadFromFile(const std::string& fileName);
     void loadFromBuffer(const std::string& xmlBuffer);
 
+    void setGridExtent(uint32_t rows, uint32_t columns, double llCornerX,
+        double llCornerY) noexcept;
+    void setGeographicExtent(double westLongitude, double eastLongitude,
+        double southLatitude, double northLatitude) noexcept;
+    void setResolution(double rowResolution, double columnResolution) noexcept;
+
     size_t getXMLlength() const noexcept;
 };
 
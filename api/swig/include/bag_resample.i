@@ -0,0 +1,43 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_resample
+
+%{
+#include "bag_resample.h"
+%}
+
+%import "bag_dataset.i"
+
+%include <std_string.i>
+%include <stdint.i>
+
+%include <std_shared_ptr.i>
+%shared_ptr(BAG::Dataset)
+
+
+#define final
+
+namespace BAG
+{
+    enum class ResampleRule
+    {
+        Nearest,
+        Minimum,
+        Mean,
+    };
+
+    class Resampler final
+    {
+    public:
+        static std::shared_ptr<Dataset> resample(const Dataset& dataset,
+            const std::string& outFileName, double resolution,
+            ResampleRule rule = ResampleRule::Mean, uint64_t chunkSize = 100,
+            int compressionLevel = 5, unsigned int numThreads = 0);
+    };
+}
@@ -0,0 +1,43 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_revert
+
+%{
+#include "bag_revert.h"
+%}
+
+%include <stdint.i>
+
+
+#define final
+
+namespace BAG
+{
+    class Dataset;
+
+    struct RevertFilter final
+    {
+        bool filterCode = false;
+        uint8_t code = 0;
+        bool filterSeries = false;
+        uint16_t series = 0;
+        bool filterBox = false;
+        uint32_t rowStart = 0;
+        uint32_t columnStart = 0;
+        uint32_t rowEnd = 0;
+        uint32_t columnEnd = 0;
+    };
+
+    class Reverter final
+    {
+    public:
+        static size_t revert(Dataset& dataset, const RevertFilter& filter,
+            unsigned int numThreads = 0);
+    };
+}
@@ -15,7 +15,9 @@
 #define final
 
 %import "bag_layer.i"
+%import "bag_layeritems.i"
 %import "bag_types.i"
+%import "bag_uint8array.i"
 
 %include <std_shared_ptr.i>
 %shared_ptr(BAG::SimpleLayer)
@@ -31,4 +33,35 @@ namespace BAG {
         bool operator==(const SimpleLayer &rhs) const noexcept;
         bool operator!=(const SimpleLayer &rhs) const noexcept;
     };
-}
\ No newline at end of file
+
+#ifdef SWIGPYTHON
+    %newobject SimpleLayer::_readBuffer;
+#endif
+
+    %extend SimpleLayer
+    {
+        LayerItems readChunked(
+            uint32_t rowStart,
+            uint32_t columnStart,
+            uint32_t rowEnd,
+            uint32_t columnEnd) const
+        {
+            return BAG::LayerItems{$self->readChunked(rowStart, columnStart,
+                rowEnd, columnEnd)};
+        }
+
+#ifdef SWIGPYTHON
+        //! Read a section of the layer into a buffer Python owns, without
+        //! holding the HDF5 lock while decompressing.
+        BAG::UInt8Array* _readBuffer(
+            uint32_t rowStart,
+            uint32_t columnStart,
+            uint32_t rowEnd,
+            uint32_t columnEnd) const
+        {
+            return new BAG::UInt8Array{$self->readChunked(rowStart,
+                columnStart, rowEnd, columnEnd)};
+        }
+#endif
+    }
+}
@@ -0,0 +1,38 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_tile
+
+%{
+#include "bag_tile.h"
+%}
+
+%import "bag_dataset.i"
+
+%include <std_string.i>
+%include <std_vector.i>
+%include <stdint.i>
+
+%template(StringVector) std::vector<std::string>;
+
+
+#define final
+
+namespace BAG
+{
+    class Tiler final
+    {
+    public:
+        static std::vector<std::string> tile(const Dataset& master,
+            uint32_t tileRows, uint32_t tileColumns,
+            const std::string& outPrefix, unsigned int numThreads = 0);
+
+        static std::string getTileFileName(const std::string& outPrefix,
+            uint32_t tileRow, uint32_t tileColumn);
+    };
+}
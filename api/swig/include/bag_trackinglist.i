@@ -10,10 +10,14 @@
 
 %{
 #include "bag_trackinglist.h"
+
+#include <cstring>
 %}
 
 %import "bag_types.i"
+%import "bag_uint8array.i"
 
+%include <stdint.i>
 %include <std_vector.i>
 
 %template(TrackingItems) std::vector<BagTrackingItem>;
@@ -25,6 +29,15 @@ namespace BAG
 {
     class Dataset;
 
+    enum class TrackingListOrder : uint8_t
+    {
+        Unsorted = 0,
+        Node = 1,
+        SubPosition = 2,
+        Code = 3,
+        Series = 4,
+    };
+
     class TrackingList final
     {
     public:
@@ -67,7 +80,48 @@ namespace BAG
 
         %rename(at) operator[](size_t index) & noexcept;
         reference operator[](size_t index) & noexcept;
+        void set(size_t index, const value_type& value) noexcept;
+        void markChanged(size_t first, size_t last) noexcept;
+
+        std::vector<value_type> findNode(uint32_t row, uint32_t col) const;
+        std::vector<value_type> findCode(uint8_t code) const;
+        std::vector<value_type> findSeries(uint16_t series) const;
+
+        bool isLoaded() const noexcept;
+        TrackingListOrder getSortOrder() const noexcept;
+        void sortBy(TrackingListOrder order, unsigned int numThreads = 0);
+        bool isReordered() const noexcept;
+        void markReordered() noexcept;
 
         void write() const;
     };
+
+    #ifdef SWIGPYTHON
+    %newobject TrackingList::_copyBuffer;
+
+    %extend TrackingList
+    {
+        //! Copy the items into a buffer Python owns.
+        BAG::UInt8Array* _copyBuffer() const
+        {
+            const auto numBytes = $self->size() * sizeof(BagTrackingItem);
+            auto* pBuffer = new BAG::UInt8Array{numBytes};
+            if (numBytes > 0)
+                std::memcpy(pBuffer->data(), $self->data(), numBytes);
+
+            return pBuffer;
+        }
+
+        %pythoncode %{
+            def to_numpy(self):
+                """
+                  Copy the items into a structured NumPy array.  The array does
+                  not follow later changes to the list.
+                """
+                import numpy
+                return numpy.asarray(self._copyBuffer()).view(
+                    BagTrackingItem.numpy_dtype())
+        %}
+    };
+    #endif
 }
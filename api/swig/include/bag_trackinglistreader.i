@@ -0,0 +1,82 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_trackinglistreader
+
+%{
+#include "bag_trackinglistreader.h"
+%}
+
+%import "bag_types.i"
+%import "bag_trackinglist.i"
+%import "bag_vrtrackinglist.i"
+
+%include <stdint.i>
+%include <std_vector.i>
+
+%include <std_shared_ptr.i>
+%shared_ptr(BAG::TrackingListReader)
+%shared_ptr(BAG::VRTrackingListReader)
+
+
+#define final
+
+namespace BAG
+{
+    class TrackingListReader final
+    {
+    public:
+        using value_type = TrackingItem;
+
+        TrackingListReader(const TrackingListReader&) = delete;
+        TrackingListReader(TrackingListReader&&) = delete;
+
+        TrackingListReader& operator=(const TrackingListReader&) = delete;
+        TrackingListReader& operator=(TrackingListReader&&) = delete;
+
+        size_t size() const noexcept;
+
+        value_type read(size_t index) const;
+        std::vector<value_type> read(size_t indexStart, size_t indexEnd) const;
+
+        static size_t getBlockSize() noexcept;
+        size_t getNumBlocks() const noexcept;
+        std::vector<value_type> readBlock(size_t block) const;
+
+        std::vector<value_type> findCode(uint8_t code) const;
+        std::vector<value_type> findSeries(uint16_t series) const;
+        std::vector<value_type> findBox(uint32_t rowStart,
+            uint32_t columnStart, uint32_t rowEnd, uint32_t columnEnd) const;
+    };
+
+    class VRTrackingListReader final
+    {
+    public:
+        using value_type = VRTrackingItem;
+
+        VRTrackingListReader(const VRTrackingListReader&) = delete;
+        VRTrackingListReader(VRTrackingListReader&&) = delete;
+
+        VRTrackingListReader& operator=(const VRTrackingListReader&) = delete;
+        VRTrackingListReader& operator=(VRTrackingListReader&&) = delete;
+
+        size_t size() const noexcept;
+
+        value_type read(size_t index) const;
+        std::vector<value_type> read(size_t indexStart, size_t indexEnd) const;
+
+        static size_t getBlockSize() noexcept;
+        size_t getNumBlocks() const noexcept;
+        std::vector<value_type> readBlock(size_t block) const;
+
+        std::vector<value_type> findCode(uint8_t code) const;
+        std::vector<value_type> findSeries(uint16_t series) const;
+        std::vector<value_type> findBox(uint32_t rowStart,
+            uint32_t columnStart, uint32_t rowEnd, uint32_t columnEnd) const;
+    };
+}
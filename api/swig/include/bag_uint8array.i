@@ -48,5 +48,30 @@ public:
     size_t size() const noexcept;
 };
 
+#ifdef SWIGPYTHON
+%extend UInt8Array
+{
+    //! The address of the first byte, for the NumPy array interface.
+    size_t _address() const noexcept
+    {
+        return reinterpret_cast<size_t>($self->data());
+    }
+
+    %pythoncode %{
+        @property
+        def __array_interface__(self):
+            """
+              Expose the bytes to NumPy without copying them.  Arrays made
+              from this object keep it alive.
+            """
+            return {'shape': (self.size(),), 'typestr': '|u1',
+                    'data': (self._address(), False), 'version': 3}
+
+        def __len__(self):
+            return self.size()
+    %}
+};
+#endif
+
 }  // namespace BAG
 
@@ -0,0 +1,36 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_upgrade
+
+%{
+#include "bag_upgrade.h"
+%}
+
+%import "bag_dataset.i"
+
+%include <std_string.i>
+%include <stdint.i>
+
+%include <std_shared_ptr.i>
+%shared_ptr(BAG::Dataset)
+
+
+#define final
+
+namespace BAG
+{
+    class Upgrader final
+    {
+    public:
+        static std::shared_ptr<Dataset> upgrade(const Dataset& dataset,
+            const std::string& outFileName, uint64_t chunkSize = 0,
+            int compressionLevel = -1, unsigned int numThreads = 0);
+    };
+}
+
@@ -0,0 +1,46 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_verify
+
+%{
+#include "bag_verify.h"
+%}
+
+%include <std_string.i>
+%include <stdint.i>
+%include <std_vector.i>
+
+%template(ChunkFaults) std::vector<BAG::ChunkFault>;
+
+
+#define final
+
+namespace BAG
+{
+    class Dataset;
+
+    struct ChunkFault final
+    {
+        std::string path;
+        uint64_t chunkIndex = 0;
+        uint32_t rowStart = 0;
+        uint32_t columnStart = 0;
+        uint32_t rowEnd = 0;
+        uint32_t columnEnd = 0;
+        std::string message;
+    };
+
+    class Verifier final
+    {
+    public:
+        static std::vector<ChunkFault> verify(const Dataset& dataset,
+            unsigned int numThreads = 0);
+    };
+}
+
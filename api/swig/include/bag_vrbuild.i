@@ -0,0 +1,43 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_vrbuild
+
+%{
+#include "bag_vrbuild.h"
+%}
+
+%import "bag_dataset.i"
+
+%include <std_string.i>
+%include <stdint.i>
+
+%include <std_shared_ptr.i>
+%shared_ptr(BAG::Dataset)
+
+
+#define final
+
+namespace BAG
+{
+    enum class VRResolutionRule
+    {
+        Depth,
+        Density,
+    };
+
+    class VRBuilder final
+    {
+    public:
+        static std::shared_ptr<Dataset> build(const Dataset& source,
+            const std::string& outFileName, uint32_t supercellSize,
+            VRResolutionRule rule = VRResolutionRule::Depth,
+            double ruleFactor = 0.1, uint64_t chunkSize = 100,
+            int compressionLevel = 5, unsigned int numThreads = 0);
+    };
+}
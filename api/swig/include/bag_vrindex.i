@@ -0,0 +1,99 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_vrindex
+
+%{
+#include "bag_vrindex.h"
+%}
+
+%import "bag_types.i"
+
+%include <stdint.i>
+%include <std_pair.i>
+%include <std_vector.i>
+
+%include <std_shared_ptr.i>
+%shared_ptr(BAG::VRIndex)
+
+%template(VRSamples) std::vector<BAG::VRSample>;
+%template(VRPoints) std::vector<std::pair<double, double>>;
+
+
+#define final
+
+namespace BAG
+{
+    struct VRSample final
+    {
+        double x = 0.;
+        double y = 0.;
+        uint32_t row = 0;
+        uint32_t column = 0;
+        uint32_t subRow = 0;
+        uint32_t subColumn = 0;
+        uint32_t index = 0;
+        float depth = BAG_NULL_ELEVATION;
+        float uncertainty = BAG_NULL_UNCERTAINTY;
+        bool found = false;
+    };
+
+    class VRIndex final
+    {
+    public:
+        VRIndex(const VRIndex&) = delete;
+        VRIndex(VRIndex&&) = delete;
+
+        VRIndex& operator=(const VRIndex&) = delete;
+        VRIndex& operator=(VRIndex&&) = delete;
+
+        uint32_t getRows() const noexcept;
+        uint32_t getColumns() const noexcept;
+        uint64_t getNumRefinedSupercells() const noexcept;
+
+        const VRMetadataItem* getSupercell(uint32_t row, uint32_t column) const noexcept;
+
+        std::vector<VRSample> queryBox(double xMin, double yMin, double xMax,
+            double yMax) const;
+
+        // Output arguments; query() reports the supercell of each point.
+        //bool findSupercell(double x, double y, uint32_t& row,
+        //    uint32_t& column) const noexcept;
+
+        // Converted to std::pair<T, T> below.
+        //Point getNodePosition(uint32_t row, uint32_t column, uint32_t subRow,
+        //    uint32_t subColumn) const noexcept;
+        //std::vector<VRSample> query(const std::vector<Point>& points,
+        //    bool bilinear = false) const;
+    };
+
+    %extend VRIndex
+    {
+        std::pair<double, double> getNodePosition(uint32_t row,
+            uint32_t column, uint32_t subRow, uint32_t subColumn) const noexcept
+        {
+            double x = 0., y = 0.;
+            std::tie(x, y) = $self->getNodePosition(row, column, subRow,
+                subColumn);
+            return {x, y};
+        }
+
+        std::vector<BAG::VRSample> query(
+            const std::vector<std::pair<double, double>>& points,
+            bool bilinear = false) const
+        {
+            std::vector<BAG::VRIndex::Point> tuples;
+            tuples.reserve(points.size());
+
+            for (const auto& point : points)
+                tuples.emplace_back(point.first, point.second);
+
+            return $self->query(tuples, bilinear);
+        }
+    }
+}
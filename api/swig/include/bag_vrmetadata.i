@@ -14,12 +14,34 @@
 
 %import "bag_layer.i"
 
+%include <stdint.i>
+%include <std_vector.i>
+
 %include <std_shared_ptr.i>
 %shared_ptr(BAG::VRMetadata)
 
+%template(VRResolutionCounts) std::vector<BAG::VRResolutionCount>;
+
+#define final
 
 namespace BAG {
 
+struct VRResolutionCount final
+{
+    float resolution = 0.f;
+    uint64_t count = 0;
+};
+
+struct VRStatistics final
+{
+    uint64_t numRefinedSupercells = 0;
+    uint64_t numRefinements = 0;
+    uint32_t minRefinements = 0;
+    uint32_t maxRefinements = 0;
+    double refinedArea = 0.;
+    std::vector<VRResolutionCount> resolutions;
+};
+
 class VRMetadataDescriptor;
 
 class BAG_API VRMetadata final : public Layer
@@ -36,6 +58,8 @@ public:
 
     std::shared_ptr<VRMetadataDescriptor> getDescriptor() & noexcept;
     std::shared_ptr<const VRMetadataDescriptor> getDescriptor() const & noexcept;
+
+    VRStatistics recomputeStatistics(unsigned int numThreads = 0);
 };
 
 }  // namespace BAG
@@ -35,6 +35,9 @@ public:
 
     std::shared_ptr<VRNodeDescriptor> getDescriptor() & noexcept;
     std::shared_ptr<const VRNodeDescriptor> getDescriptor() const & noexcept;
+
+    void recomputeStatistics(unsigned int numThreads = 0);
+    void reserve(uint32_t numItems);
 };
 
 }  // namespace BAG
@@ -0,0 +1,56 @@
+%begin %{
+#ifdef _MSC_VER
+#ifdef SWIGPYTHON
+#define SWIG_PYTHON_INTERPRETER_NO_DEBUG
+#endif
+#endif
+%}
+
+%module bag_vrrecords
+
+%{
+#include "bag_vrrecords.h"
+%}
+
+%import "bag_dataset.i"
+
+%include <stdint.i>
+%include <std_vector.i>
+
+%include <std_shared_ptr.i>
+%shared_ptr(BAG::Dataset)
+
+%template(VRRecords) std::vector<BAG::VRRecord>;
+
+
+#define final
+
+namespace BAG
+{
+    struct VRRecord final
+    {
+        float depth = 0.f;
+        float depth_uncrt = 0.f;
+        float hyp_strength = 0.f;
+        uint32_t num_hypotheses = 0;
+        uint32_t n_samples = 0;
+    };
+
+    struct VRSupercellRecords final
+    {
+        uint32_t rows = 0;
+        uint32_t columns = 0;
+        std::vector<VRRecord> items;
+        std::vector<uint64_t> offsets;
+    };
+
+    class VRRecordReader final
+    {
+    public:
+        static std::vector<VRRecord> read(const Dataset& dataset,
+            uint32_t indexStart, uint32_t indexEnd);
+        static VRSupercellRecords readSupercells(const Dataset& dataset,
+            uint32_t rowStart, uint32_t columnStart, uint32_t rowEnd,
+            uint32_t columnEnd);
+    };
+}
@@ -16,11 +16,24 @@
 
 %import "bag_layer.i"
 
+%include <stdint.i>
+%include <std_vector.i>
+
 %include <std_shared_ptr.i>
 %shared_ptr(BAG::VRRefinements)
 
+%template(UInt64Vector) std::vector<uint64_t>;
+
 namespace BAG {
 
+struct VRSupercellRefinements final
+{
+    uint32_t rows = 0;
+    uint32_t columns = 0;
+    std::vector<BagVRRefinementsItem> items;
+    std::vector<uint64_t> offsets;
+};
+
 class VRRefinementsDescriptor;
 
 class VRRefinements final : public Layer
@@ -37,6 +50,12 @@ public:
 
     std::shared_ptr<VRRefinementsDescriptor> getDescriptor() & noexcept;
     std::shared_ptr<const VRRefinementsDescriptor> getDescriptor() const & noexcept;
+
+    VRSupercellRefinements readSupercells(uint32_t rowStart,
+        uint32_t columnStart, uint32_t rowEnd, uint32_t columnEnd) const;
+
+    void recomputeStatistics(unsigned int numThreads = 0);
+    void reserve(uint32_t numItems);
 };
 
 }  // namespace BAG
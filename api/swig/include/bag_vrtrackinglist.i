@@ -10,9 +10,13 @@
 
 %{
 #include "bag_vrtrackinglist.h"
+
+#include <cstring>
 %}
 
 %import "bag_types.i"
+%import "bag_trackinglist.i"
+%import "bag_uint8array.i"
 
 %include <std_vector.i>
 %include <stdint.i>
@@ -80,10 +84,55 @@ public:
     reference operator[](size_t index) & noexcept;
     //%rename(__getitem__) operator[](size_t index) const & noexcept;
     //const_reference operator[](size_t index) const & noexcept;
+    void set(size_t index, const value_type& value) noexcept;
+    void markChanged(size_t first, size_t last) noexcept;
+
+    std::vector<value_type> findNode(uint32_t row, uint32_t col) const;
+    std::vector<value_type> findSubNode(uint32_t row, uint32_t col,
+        uint32_t subRow, uint32_t subCol) const;
+    std::vector<value_type> findSubPosition(uint32_t subRow,
+        uint32_t subCol) const;
+    std::vector<value_type> findCode(uint8_t code) const;
+    std::vector<value_type> findSeries(uint16_t series) const;
+
+    bool isLoaded() const noexcept;
+    TrackingListOrder getSortOrder() const noexcept;
+    void sortBy(TrackingListOrder order, unsigned int numThreads = 0);
+    bool isReordered() const noexcept;
+    void markReordered() noexcept;
 
     void write() const;
 };
 
+#ifdef SWIGPYTHON
+%newobject VRTrackingList::_copyBuffer;
+
+%extend VRTrackingList
+{
+    //! Copy the items into a buffer Python owns.
+    BAG::UInt8Array* _copyBuffer() const
+    {
+        const auto numBytes = $self->size() * sizeof(BagVRTrackingItem);
+        auto* pBuffer = new BAG::UInt8Array{numBytes};
+        if (numBytes > 0)
+            std::memcpy(pBuffer->data(), $self->data(), numBytes);
+
+        return pBuffer;
+    }
+
+    %pythoncode %{
+        def to_numpy(self):
+            """
+              Copy the items into a structured NumPy array.  The array does
+              not follow later changes to the list.
+            """
+            import numpy
+            return numpy.asarray(self._copyBuffer()).view(
+                BagVRTrackingItem.numpy_dtype())
+    %}
+};
+#endif
+
 #if 0
 %extend VRTrackingList
 {
@@ -5,6 +5,13 @@
 #pragma warning(push)
 #pragma warning(disable: 4286)  // Exception caught by a base class
 #endif
+
+// Other threads may only enter HDF5 while a call holds no GIL if HDF5 was
+// built thread-safe; otherwise keep the GIL for every call.
+#include <H5pubconf.h>
+#ifndef H5_HAVE_THREADSAFE
+#define SWIG_PYTHON_NO_THREADS
+#endif
 %}
 
 /*
@@ -12,11 +19,74 @@
     This simplifies the building and generating of python files,
     and simplified the use of those python files.
 */
-%module bagpy
+%module(threads="1") bagpy
 
 // Ignore warnings about shadowing superclass methods
 #pragma SWIG nowarn=512
 
+//! Keep the GIL by default, and release it around the calls below, which
+//! spend their time in HDF5 I/O, (de)compression or computation.  Threads
+//! each working on their own Dataset then run concurrently.
+%nothread;
+
+%thread BAG::Dataset::open;
+%thread BAG::Dataset::create;
+%thread BAG::Dataset::close;
+%thread BAG::Dataset::createVR;
+%thread BAG::Dataset::getCoverage;
+%thread BAG::Dataset::verify;
+%thread BAG::Dataset::extract;
+%thread BAG::Dataset::revertEdits;
+%thread BAG::Dataset::getVRIndex;
+%thread BAG::Metadata::loadFromFile;
+%thread BAG::Layer::read;
+%thread BAG::Layer::write;
+%thread BAG::Layer::writeAttributes;
+%thread BAG::Layer::_readBuffer;
+%thread BAG::SimpleLayer::readChunked;
+%thread BAG::SimpleLayer::_readBuffer;
+%thread BAG::GeorefMetadataLayer::readVR;
+%thread BAG::GeorefMetadataLayer::writeVR;
+%thread BAG::SurfaceCorrections::readCorrected;
+%thread BAG::SurfaceCorrections::readCorrectedRow;
+%thread BAG::ValueTable::addRecord;
+%thread BAG::ValueTable::addRecords;
+%thread BAG::ValueTable::setValue;
+%thread BAG::TrackingList::write;
+%thread BAG::VRTrackingList::write;
+%thread BAG::VRRefinements::readSupercells;
+%thread BAG::VRRefinements::recomputeStatistics;
+%thread BAG::VRNode::recomputeStatistics;
+%thread BAG::VRMetadata::recomputeStatistics;
+%thread BAG::VRIndex::query;
+%thread BAG::VRIndex::queryBox;
+%thread BAG::Coverage::compute;
+%thread BAG::Verifier::verify;
+%thread BAG::Merger::merge;
+%thread BAG::SurfaceDiff::diff;
+%thread BAG::SurfaceDiff::applyPatch;
+%thread BAG::Repacker::repack;
+%thread BAG::Extractor::extract;
+%thread BAG::Tiler::tile;
+%thread BAG::Upgrader::upgrade;
+%thread BAG::Resampler::resample;
+%thread BAG::Reverter::revert;
+%thread BAG::VRRecordReader::read;
+%thread BAG::VRRecordReader::readSupercells;
+%thread BAG::VRBuilder::build;
+%thread BAG::TrackingList::sortBy;
+%thread BAG::VRTrackingList::sortBy;
+%thread BAG::TrackingListReader::read;
+%thread BAG::TrackingListReader::readBlock;
+%thread BAG::TrackingListReader::findCode;
+%thread BAG::TrackingListReader::findSeries;
+%thread BAG::TrackingListReader::findBox;
+%thread BAG::VRTrackingListReader::read;
+%thread BAG::VRTrackingListReader::readBlock;
+%thread BAG::VRTrackingListReader::findCode;
+%thread BAG::VRTrackingListReader::findSeries;
+%thread BAG::VRTrackingListReader::findBox;
+
 %feature("autodoc", "3");
 
 %{
@@ -67,9 +137,23 @@ namespace std
 
 %include "../include/bag_trackinglist.i"
 %include "../include/bag_vrtrackinglist.i"
+%include "../include/bag_trackinglistreader.i"
 %include "../include/bag_descriptor.i"
+%include "../include/bag_coverage.i"
+%include "../include/bag_verify.i"
+%include "../include/bag_vrindex.i"
+%include "../include/bag_revert.i"
 
 %include "../include/bag_dataset.i"
+%include "../include/bag_merge.i"
+%include "../include/bag_diff.i"
+%include "../include/bag_repack.i"
+%include "../include/bag_extract.i"
+%include "../include/bag_tile.i"
+%include "../include/bag_upgrade.i"
+%include "../include/bag_resample.i"
+%include "../include/bag_vrrecords.i"
+%include "../include/bag_vrbuild.i"
 %include "../include/bag_metadata.i"
 %include "../include/bag_metadataprofiles.i"
 
@@ -0,0 +1,143 @@
+/*! \file bag_diff.cpp
+ * \brief Compare two BAG files of the same area, chunk by chunk.
+ *
+ * Reports the change in each chunk of the grid, and optionally writes a
+ * difference BAG and a patch file of the changed chunks that bag_patch can
+ * apply to a copy of the base BAG.
+ *
+ * Open Navigation Surface Working Group, 2024.  Visit the project website at
+ * http://www.opennavsurf.org
+ */
+
+#include "getopt.h"
+
+#include <bag_dataset.h>
+#include <bag_diff.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+
+namespace {
+
+enum Cmd {
+    BASE_BAG = 1,
+    UPDATED_BAG,
+    ARGC_EXPECTED
+};
+
+}  // namespace
+
+int main(
+    int argc,
+    char* argv[])
+{
+    bool generateHelp = false;
+    bool listChunks = false;
+    std::string differenceFileName;
+    std::string patchFileName;
+    float tolerance = 0.f;
+    int compressionLevel = 5;
+    unsigned int numThreads = 0;
+
+    const auto options = const_cast<char *>("hld:p:e:z:t:");
+    int c = getopt(argc, argv, options);
+
+    while (c != EOF)
+    {
+        switch (c)
+        {
+        case 'h':
+            generateHelp = true;
+            break;
+        case 'l':
+            listChunks = true;
+            break;
+        case 'd':
+            differenceFileName = optarg;
+            break;
+        case 'p':
+            patchFileName = optarg;
+            break;
+        case 'e':
+            tolerance = static_cast<float>(std::atof(optarg));
+            break;
+        case 'z':
+            compressionLevel = std::atoi(optarg);
+            break;
+        case 't':
+            numThreads = static_cast<unsigned int>(std::atoi(optarg));
+            break;
+        case '?':  //[[fallthrough]]
+        default:
+            std::cerr << "error: unknown option flag '" << +optopt << "'\n";
+            break;
+        }
+
+        c = getopt(argc, argv, options);
+    }
+
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if (argc != ARGC_EXPECTED || generateHelp)
+    {
+        std::cout << "bag_diff [" << __DATE__ << R"(] - Compare two BAG files on the same grid.
+Syntax: bag_diff [opt] <base_file> <updated_file>
+Options:
+ -h Generate this help information.
+ -l List the change in every changed chunk.
+ -d <file> Write the difference (updated - base) to a new BAG.
+ -p <file> Write the changed chunks to a patch file for bag_patch.
+ -e <value> The largest change that is not counted as one (default 0).
+ -z <level> The compression level of the outputs (default 5).
+ -t <count> The number of threads to use (default all).
+)";
+
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const auto base = BAG::Dataset::open(argv[BASE_BAG], BAG_OPEN_READONLY);
+        const auto updated = BAG::Dataset::open(argv[UPDATED_BAG],
+            BAG_OPEN_READONLY);
+
+        const auto changes = BAG::SurfaceDiff::diff(*base, *updated,
+            differenceFileName, patchFileName, tolerance, compressionLevel,
+            numThreads);
+
+        size_t numChangedChunks = 0;
+        uint64_t numChangedCells = 0;
+
+        for (const auto& change : changes)
+        {
+            if (change.numChanged == 0)
+                continue;
+
+            ++numChangedChunks;
+            numChangedCells += change.numChanged;
+
+            if (listChunks)
+                std::cout << "rows " << change.rowStart << '-' << change.rowEnd
+                    << " columns " << change.columnStart << '-'
+                    << change.columnEnd << ": " << change.numChanged
+                    << " changed, difference min " << change.minDifference
+                    << " max " << change.maxDifference << " mean "
+                    << change.meanDifference << " rms " << change.rmsDifference
+                    << '\n';
+        }
+
+        std::cout << numChangedChunks << " of " << changes.size()
+            << " chunks changed (" << numChangedCells << " cells).\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,101 @@
+/*! \file bag_extract.cpp
+ * \brief Copy the part of a BAG file inside a bounding box into a new BAG file.
+ *
+ * The new BAG holds every layer, clipped to the nodes inside the box, with
+ * the metadata, variable resolution structure, georeferenced metadata and
+ * tracking lists to match.
+ *
+ * Open Navigation Surface Working Group, 2024.  Visit the project website at
+ * http://www.opennavsurf.org
+ */
+
+#include "getopt.h"
+
+#include <bag_dataset.h>
+#include <bag_metadata.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+
+namespace {
+
+enum Cmd {
+    INPUT_BAG = 1,
+    OUTPUT_BAG,
+    X_MIN,
+    Y_MIN,
+    X_MAX,
+    Y_MAX,
+    ARGC_MINIMUM
+};
+
+}  // namespace
+
+int main(
+    int argc,
+    char* argv[])
+{
+    bool generateHelp = false;
+    unsigned int numThreads = 0;
+
+    const auto options = const_cast<char *>("ht:");
+    int c = getopt(argc, argv, options);
+
+    while (c != EOF)
+    {
+        switch (c)
+        {
+        case 'h':
+            generateHelp = true;
+            break;
+        case 't':
+            numThreads = static_cast<unsigned int>(std::atoi(optarg));
+            break;
+        case '?':  //[[fallthrough]]
+        default:
+            std::cerr << "error: unknown option flag '" << +optopt << "'\n";
+            break;
+        }
+
+        c = getopt(argc, argv, options);
+    }
+
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if (argc < ARGC_MINIMUM || generateHelp)
+    {
+        std::cout << "bag_extract [" << __DATE__ << R"(] - Copy the part of a BAG file inside a box into a new BAG file.
+Syntax: bag_extract [opt] <input_file> <output_file> <xmin> <ymin> <xmax> <ymax>
+Options:
+ -h Generate this help information.
+ -t <count> The number of threads to use (default all).
+The box is in the coordinate reference system of the input BAG.
+)";
+
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const auto input = BAG::Dataset::open(argv[INPUT_BAG], BAG_OPEN_READONLY);
+
+        const auto output = input->extract(std::atof(argv[X_MIN]),
+            std::atof(argv[Y_MIN]), std::atof(argv[X_MAX]),
+            std::atof(argv[Y_MAX]), argv[OUTPUT_BAG], numThreads);
+
+        const auto& metadata = output->getMetadata();
+        std::cout << "Extracted " << metadata.rows() << " rows and "
+            << metadata.columns() << " columns, from ("
+            << metadata.llCornerX() << ", " << metadata.llCornerY() << ").\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+/*! \file bag_merge.cpp
+ * \brief Merge several BAG files on the same grid into one.
+ *
+ * The inputs are given highest priority first.  They must share a coordinate
+ * reference system, resolution and grid alignment; the output covers all of
+ * them.
+ *
+ * Open Navigation Surface Working Group, 2024.  Visit the project website at
+ * http://www.opennavsurf.org
+ */
+
+#include "getopt.h"
+
+#include <bag_dataset.h>
+#include <bag_merge.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+enum Cmd {
+    OUTPUT_BAG = 1,
+    FIRST_INPUT_BAG,
+    ARGC_MINIMUM
+};
+
+}  // namespace
+
+int main(
+    int argc,
+    char* argv[])
+{
+    bool generateHelp = false;
+    bool badOption = false;
+    BAG::MergeRule rule = BAG::MergeRule::Priority;
+    uint64_t chunkSize = 100;
+    int compressionLevel = 5;
+    unsigned int numThreads = 0;
+
+    const auto options = const_cast<char *>("hr:c:z:t:");
+    int c = getopt(argc, argv, options);
+
+    while (c != EOF)
+    {
+        switch (c)
+        {
+        case 'h':
+            generateHelp = true;
+            break;
+        case 'r':
+            if (std::strcmp(optarg, "priority") == 0)
+                rule = BAG::MergeRule::Priority;
+            else if (std::strcmp(optarg, "shoalest") == 0)
+                rule = BAG::MergeRule::Shoalest;
+            else if (std::strcmp(optarg, "weighted") == 0)
+                rule = BAG::MergeRule::UncertaintyWeighted;
+            else
+            {
+                std::cerr << "error: unknown merge rule '" << optarg << "'\n";
+                badOption = true;
+            }
+            break;
+        case 'c':
+            chunkSize = std::strtoull(optarg, nullptr, 10);
+            break;
+        case 'z':
+            compressionLevel = std::atoi(optarg);
+            break;
+        case 't':
+            numThreads = static_cast<unsigned int>(std::atoi(optarg));
+            break;
+        case '?':  //[[fallthrough]]
+        default:
+            std::cerr << "error: unknown option flag '" << +optopt << "'\n";
+            break;
+        }
+
+        c = getopt(argc, argv, options);
+    }
+
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if (argc < ARGC_MINIMUM || generateHelp || badOption || chunkSize == 0)
+    {
+        std::cout << "bag_merge [" << __DATE__ << R"(] - Merge BAG files on the same grid.
+Syntax: bag_merge [opt] <output_file> <input_file> [<input_file>...]
+Inputs are given highest priority first.
+Options:
+ -h Generate this help information.
+ -r <rule> How overlapping cells are combined; priority (default), shoalest
+    or weighted (by uncertainty).
+ -c <size> The chunk size of the output (default 100).
+ -z <level> The compression level of the output (default 5).
+ -t <count> The number of threads to use (default all).
+)";
+
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::vector<std::shared_ptr<const BAG::Dataset>> inputs;
+        for (int i = FIRST_INPUT_BAG; i < argc; ++i)
+            inputs.push_back(BAG::Dataset::open(argv[i], BAG_OPEN_READONLY));
+
+        auto dataset = BAG::Merger::merge(inputs, argv[OUTPUT_BAG], rule,
+            chunkSize, compressionLevel, numThreads);
+
+        const auto& metadata = dataset->getMetadata();
+        std::cout << "Merged " << inputs.size() << " BAGs into a grid of "
+            << metadata.rows() << " rows by " << metadata.columns()
+            << " columns.\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,91 @@
+/*! \file bag_patch.cpp
+ * \brief Apply a patch file made by bag_diff to a BAG file.
+ *
+ * Only the chunks in the patch are rewritten; the BAG is updated in place.
+ *
+ * Open Navigation Surface Working Group, 2024.  Visit the project website at
+ * http://www.opennavsurf.org
+ */
+
+#include "getopt.h"
+
+#include <bag_dataset.h>
+#include <bag_diff.h>
+
+#include <cstdlib>
+#include <iostream>
+
+
+namespace {
+
+enum Cmd {
+    TARGET_BAG = 1,
+    PATCH_FILE,
+    ARGC_EXPECTED
+};
+
+}  // namespace
+
+int main(
+    int argc,
+    char* argv[])
+{
+    bool generateHelp = false;
+    unsigned int numThreads = 0;
+
+    const auto options = const_cast<char *>("ht:");
+    int c = getopt(argc, argv, options);
+
+    while (c != EOF)
+    {
+        switch (c)
+        {
+        case 'h':
+            generateHelp = true;
+            break;
+        case 't':
+            numThreads = static_cast<unsigned int>(std::atoi(optarg));
+            break;
+        case '?':  //[[fallthrough]]
+        default:
+            std::cerr << "error: unknown option flag '" << +optopt << "'\n";
+            break;
+        }
+
+        c = getopt(argc, argv, options);
+    }
+
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if (argc != ARGC_EXPECTED || generateHelp)
+    {
+        std::cout << "bag_patch [" << __DATE__ << R"(] - Apply a patch file to a BAG file in place.
+Syntax: bag_patch [opt] <bag_file> <patch_file>
+Options:
+ -h Generate this help information.
+ -t <count> The number of threads to use (default all).
+)";
+
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const auto target = BAG::Dataset::open(argv[TARGET_BAG],
+            BAG_OPEN_READ_WRITE);
+
+        const auto changes = BAG::SurfaceDiff::applyPatch(*target,
+            argv[PATCH_FILE], numThreads);
+
+        std::cout << "Rewrote " << changes.size() << " chunks.\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
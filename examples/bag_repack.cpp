@@ -0,0 +1,113 @@
+/*! \file bag_repack.cpp
+ * \brief Copy a BAG file into a new, compact file.
+ *
+ * Every layer, the georeferenced metadata, variable resolution structure,
+ * tracking lists and metadata are copied, optionally with a new chunk size
+ * and compression level.  Space left by removed layers is reclaimed.
+ *
+ * Open Navigation Surface Working Group, 2024.  Visit the project website at
+ * http://www.opennavsurf.org
+ */
+
+#include "getopt.h"
+
+#include <bag_dataset.h>
+#include <bag_repack.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+namespace {
+
+enum Cmd {
+    INPUT_BAG = 1,
+    OUTPUT_BAG,
+    ARGC_MINIMUM
+};
+
+//! Retrieve the size of a file, in bytes.
+std::streamoff getFileSize(const char* fileName)
+{
+    std::ifstream file{fileName, std::ios::binary | std::ios::ate};
+
+    return file ? static_cast<std::streamoff>(file.tellg()) : 0;
+}
+
+}  // namespace
+
+int main(
+    int argc,
+    char* argv[])
+{
+    bool generateHelp = false;
+    uint64_t chunkSize = 0;
+    int compressionLevel = -1;
+    unsigned int numThreads = 0;
+
+    const auto options = const_cast<char *>("hc:z:t:");
+    int c = getopt(argc, argv, options);
+
+    while (c != EOF)
+    {
+        switch (c)
+        {
+        case 'h':
+            generateHelp = true;
+            break;
+        case 'c':
+            chunkSize = std::strtoull(optarg, nullptr, 10);
+            break;
+        case 'z':
+            compressionLevel = std::atoi(optarg);
+            break;
+        case 't':
+            numThreads = static_cast<unsigned int>(std::atoi(optarg));
+            break;
+        case '?':  //[[fallthrough]]
+        default:
+            std::cerr << "error: unknown option flag '" << +optopt << "'\n";
+            break;
+        }
+
+        c = getopt(argc, argv, options);
+    }
+
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if (argc < ARGC_MINIMUM || generateHelp)
+    {
+        std::cout << "bag_repack [" << __DATE__ << R"(] - Copy a BAG file into a new, compact file.
+Syntax: bag_repack [opt] <input_file> <output_file>
+Options:
+ -h Generate this help information.
+ -c <size> The chunk size of the grid layers (default unchanged).
+ -z <level> The compression level, 0 to 9 (default unchanged).
+ -t <count> The number of threads to use (default all).
+)";
+
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const auto input = BAG::Dataset::open(argv[INPUT_BAG], BAG_OPEN_READONLY);
+
+        BAG::Repacker::repack(*input, argv[OUTPUT_BAG], chunkSize,
+            compressionLevel, numThreads);
+
+        std::cout << "Repacked " << getFileSize(argv[INPUT_BAG])
+            << " bytes into " << getFileSize(argv[OUTPUT_BAG]) << " bytes.\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,97 @@
+/*! \file bag_tile.cpp
+ * \brief Cut a BAG file into a grid of tiles, each its own BAG file.
+ *
+ * Every simple layer and the tracking list are tiled, and each tile gets
+ * the metadata of the input moved to its grid.  Tiles are named
+ * <prefix>_<row>_<column>.bag, counted from the south west.
+ *
+ * Open Navigation Surface Working Group, 2024.  Visit the project website at
+ * http://www.opennavsurf.org
+ */
+
+#include "getopt.h"
+
+#include <bag_dataset.h>
+#include <bag_tile.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+
+namespace {
+
+enum Cmd {
+    INPUT_BAG = 1,
+    OUTPUT_PREFIX,
+    TILE_ROWS,
+    TILE_COLUMNS,
+    ARGC_MINIMUM
+};
+
+}  // namespace
+
+int main(
+    int argc,
+    char* argv[])
+{
+    bool generateHelp = false;
+    unsigned int numThreads = 0;
+
+    const auto options = const_cast<char *>("ht:");
+    int c = getopt(argc, argv, options);
+
+    while (c != EOF)
+    {
+        switch (c)
+        {
+        case 'h':
+            generateHelp = true;
+            break;
+        case 't':
+            numThreads = static_cast<unsigned int>(std::atoi(optarg));
+            break;
+        case '?':  //[[fallthrough]]
+        default:
+            std::cerr << "error: unknown option flag '" << +optopt << "'\n";
+            break;
+        }
+
+        c = getopt(argc, argv, options);
+    }
+
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if (argc < ARGC_MINIMUM || generateHelp)
+    {
+        std::cout << "bag_tile [" << __DATE__ << R"(] - Cut a BAG file into a grid of tiles.
+Syntax: bag_tile [opt] <input_file> <output_prefix> <tile_rows> <tile_columns>
+Options:
+ -h Generate this help information.
+ -t <count> The number of threads to use (default all).
+)";
+
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const auto input = BAG::Dataset::open(argv[INPUT_BAG], BAG_OPEN_READONLY);
+
+        const auto tiles = BAG::Tiler::tile(*input,
+            static_cast<uint32_t>(std::strtoul(argv[TILE_ROWS], nullptr, 10)),
+            static_cast<uint32_t>(std::strtoul(argv[TILE_COLUMNS], nullptr, 10)),
+            argv[OUTPUT_PREFIX], numThreads);
+
+        for (const auto& tile : tiles)
+            std::cout << tile << '\n';
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+/*! \file bag_upgrade.cpp
+ * \brief Migrate a legacy BAG file into a BAG 2.0 file.
+ *
+ * The interleaved NODE and ELEVATION groups of BAG 1.5 and 1.6 files are
+ * split into separate layers, each written once across a pool of threads.
+ * Everything else is copied, optionally with a new chunk size and
+ * compression level.
+ *
+ * Open Navigation Surface Working Group, 2024.  Visit the project website at
+ * http://www.opennavsurf.org
+ */
+
+#include "getopt.h"
+
+#include <bag_dataset.h>
+#include <bag_layerdescriptor.h>
+#include <bag_upgrade.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+
+namespace {
+
+enum Cmd {
+    INPUT_BAG = 1,
+    OUTPUT_BAG,
+    ARGC_MINIMUM
+};
+
+}  // namespace
+
+int main(
+    int argc,
+    char* argv[])
+{
+    bool generateHelp = false;
+    uint64_t chunkSize = 0;
+    int compressionLevel = -1;
+    unsigned int numThreads = 0;
+
+    const auto options = const_cast<char *>("hc:z:t:");
+    int c = getopt(argc, argv, options);
+
+    while (c != EOF)
+    {
+        switch (c)
+        {
+        case 'h':
+            generateHelp = true;
+            break;
+        case 'c':
+            chunkSize = std::strtoull(optarg, nullptr, 10);
+            break;
+        case 'z':
+            compressionLevel = std::atoi(optarg);
+            break;
+        case 't':
+            numThreads = static_cast<unsigned int>(std::atoi(optarg));
+            break;
+        case '?':  //[[fallthrough]]
+        default:
+            std::cerr << "error: unknown option flag '" << +optopt << "'\n";
+            break;
+        }
+
+        c = getopt(argc, argv, options);
+    }
+
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if (argc < ARGC_MINIMUM || generateHelp)
+    {
+        std::cout << "bag_upgrade [" << __DATE__ << R"(] - Migrate a legacy BAG file into a BAG 2.0 file.
+Syntax: bag_upgrade [opt] <input_file> <output_file>
+Options:
+ -h Generate this help information.
+ -c <size> The chunk size of the grid layers (default unchanged; new
+    layers are chunked like the elevation layer).
+ -z <level> The compression level, 0 to 9 (default unchanged; new layers
+    are compressed like the elevation layer).
+ -t <count> The number of threads to use (default all).
+)";
+
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const auto input = BAG::Dataset::open(argv[INPUT_BAG], BAG_OPEN_READONLY);
+
+        const auto output = BAG::Upgrader::upgrade(*input, argv[OUTPUT_BAG],
+            chunkSize, compressionLevel, numThreads);
+
+        std::cout << "Upgraded BAG " << input->getDescriptor().getVersion()
+            << " to BAG " << output->getDescriptor().getVersion()
+            << ", with layers:\n";
+        for (const auto& layer : output->getLayers())
+            std::cout << "  " << layer->getDescriptor()->getName() << '\n';
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,106 @@
+/*! \file bag_verify.cpp
+ * \brief Check every chunk of one or more BAG files.
+ *
+ * Each chunk that fails its checksum, or cannot be inflated, is reported with
+ * the DataSet and the rows and columns it covers.
+ *
+ * Open Navigation Surface Working Group, 2024.  Visit the project website at
+ * http://www.opennavsurf.org
+ */
+
+#include "getopt.h"
+
+#include <bag_dataset.h>
+#include <bag_verify.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+enum Cmd {
+    FIRST_INPUT_BAG = 1,
+    ARGC_MINIMUM
+};
+
+}  // namespace
+
+int main(
+    int argc,
+    char* argv[])
+{
+    bool generateHelp = false;
+    unsigned int numThreads = 0;
+
+    const auto options = const_cast<char *>("ht:");
+    int c = getopt(argc, argv, options);
+
+    while (c != EOF)
+    {
+        switch (c)
+        {
+        case 'h':
+            generateHelp = true;
+            break;
+        case 't':
+            numThreads = static_cast<unsigned int>(std::atoi(optarg));
+            break;
+        case '?':  //[[fallthrough]]
+        default:
+            std::cerr << "error: unknown option flag '" << +optopt << "'\n";
+            break;
+        }
+
+        c = getopt(argc, argv, options);
+    }
+
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if (argc < ARGC_MINIMUM || generateHelp)
+    {
+        std::cout << "bag_verify [" << __DATE__ << R"(] - Check every chunk of BAG files.
+Syntax: bag_verify [opt] <input_file> [<input_file>...]
+Options:
+ -h Generate this help information.
+ -t <count> The number of threads to use (default all).
+)";
+
+        return EXIT_FAILURE;
+    }
+
+    size_t numFaults = 0;
+
+    for (int i = FIRST_INPUT_BAG; i < argc; ++i)
+    {
+        try
+        {
+            const auto dataset = BAG::Dataset::open(argv[i], BAG_OPEN_READONLY);
+            const auto faults = dataset->verify(numThreads);
+
+            for (const auto& fault : faults)
+                std::cout << argv[i] << ": " << fault.path << " chunk "
+                    << fault.chunkIndex << " (rows " << fault.rowStart << '-'
+                    << fault.rowEnd << ", columns " << fault.columnStart << '-'
+                    << fault.columnEnd << "): " << fault.message << '\n';
+
+            std::cout << argv[i] << ": "
+                << (dataset->getDescriptor().isChecksummed() ?
+                    "checksummed" : "not checksummed") << ", "
+                << faults.size() << " bad chunk(s).\n";
+
+            numFaults += faults.size();
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << argv[i] << ": " << e.what() << '\n';
+            ++numFaults;
+        }
+    }
+
+    return numFaults == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
@@ -0,0 +1,125 @@
+/*! \file bag_vr_resample.cpp
+ * \brief Resample a variable resolution BAG file onto a single resolution grid.
+ *
+ * The refinements of the supercells are binned into the cells of a regular
+ * grid, combined by the nearest node, the minimum or the mean, and written
+ * as the elevation and uncertainty layers of a new BAG file.
+ *
+ * Open Navigation Surface Working Group, 2024.  Visit the project website at
+ * http://www.opennavsurf.org
+ */
+
+#include "getopt.h"
+
+#include <bag_dataset.h>
+#include <bag_metadata.h>
+#include <bag_resample.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+
+namespace {
+
+enum Cmd {
+    INPUT_BAG = 1,
+    OUTPUT_BAG,
+    RESOLUTION,
+    ARGC_MINIMUM
+};
+
+}  // namespace
+
+int main(
+    int argc,
+    char* argv[])
+{
+    bool generateHelp = false;
+    auto rule = BAG::ResampleRule::Mean;
+    uint64_t chunkSize = 100;
+    int compressionLevel = 5;
+    unsigned int numThreads = 0;
+
+    const auto options = const_cast<char *>("hr:c:z:t:");
+    int c = getopt(argc, argv, options);
+
+    while (c != EOF)
+    {
+        switch (c)
+        {
+        case 'h':
+            generateHelp = true;
+            break;
+        case 'r':
+            if (std::strcmp(optarg, "nearest") == 0)
+                rule = BAG::ResampleRule::Nearest;
+            else if (std::strcmp(optarg, "min") == 0)
+                rule = BAG::ResampleRule::Minimum;
+            else if (std::strcmp(optarg, "mean") == 0)
+                rule = BAG::ResampleRule::Mean;
+            else
+            {
+                std::cerr << "error: unknown rule '" << optarg << "'\n";
+                generateHelp = true;
+            }
+            break;
+        case 'c':
+            chunkSize = std::strtoull(optarg, nullptr, 10);
+            break;
+        case 'z':
+            compressionLevel = std::atoi(optarg);
+            break;
+        case 't':
+            numThreads = static_cast<unsigned int>(std::atoi(optarg));
+            break;
+        case '?':  //[[fallthrough]]
+        default:
+            std::cerr << "error: unknown option flag '" << +optopt << "'\n";
+            break;
+        }
+
+        c = getopt(argc, argv, options);
+    }
+
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if (argc < ARGC_MINIMUM || generateHelp)
+    {
+        std::cout << "bag_vr_resample [" << __DATE__ << R"(] - Resample a variable resolution BAG file onto a single resolution grid.
+Syntax: bag_vr_resample [opt] <input_file> <output_file> <resolution>
+Options:
+ -h Generate this help information.
+ -r <rule> How the refinements in one cell combine: nearest, min or mean
+    (default mean).
+ -c <size> The chunk size of the output (default 100).
+ -z <level> The compression level of the output, 0 to 9 (default 5).
+ -t <count> The number of threads to use (default all).
+)";
+
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const auto input = BAG::Dataset::open(argv[INPUT_BAG], BAG_OPEN_READONLY);
+
+        const auto output = BAG::Resampler::resample(*input, argv[OUTPUT_BAG],
+            std::strtod(argv[RESOLUTION], nullptr), rule, chunkSize,
+            compressionLevel, numThreads);
+
+        const auto& metadata = output->getMetadata();
+        std::cout << "Resampled to " << metadata.rows() << " rows by "
+            << metadata.columns() << " columns at "
+            << metadata.rowResolution() << '\n';
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+import argparse
+import concurrent.futures
+import time
+
+import bagPy as BAG
+
+
+def readLayer(fileName: str, numBands: int, band: int, useChunked: bool) -> int:
+    """
+      Read one horizontal band of the elevation layer through a Dataset of
+      its own, returning the number of bytes read.
+    """
+    dataset: BAG.Dataset = BAG.Dataset.openDataset(fileName, BAG.BAG_OPEN_READONLY)
+    layer: BAG.SimpleLayer = dataset.getSimpleLayer(BAG.Elevation)
+    rows: int = dataset.getMetadata().rows()
+    columns: int = dataset.getMetadata().columns()
+
+    rowsPerBand: int = (rows + numBands - 1) // numBands
+    rowStart: int = band * rowsPerBand
+    rowEnd: int = min(rows, rowStart + rowsPerBand) - 1
+    if rowStart > rowEnd:
+        return 0
+
+    if useChunked:
+        items = layer.readChunked(rowStart, 0, rowEnd, columns - 1)
+    else:
+        items = layer.read(rowStart, 0, rowEnd, columns - 1)
+
+    numBytes: int = items.size()
+    dataset.close()
+
+    return numBytes
+
+
+def timeReads(fileName: str, numThreads: int, numBands: int, repeat: int,
+              useChunked: bool) -> float:
+    """
+      The best time, over repeat runs, to read the whole elevation layer in
+      numBands bands spread over numThreads threads.
+    """
+    best: float = float('inf')
+    with concurrent.futures.ThreadPoolExecutor(max_workers=numThreads) as executor:
+        for _ in range(repeat):
+            start: float = time.perf_counter()
+            futures = [executor.submit(readLayer, fileName, numBands, band, useChunked)
+                       for band in range(numBands)]
+            for future in futures:
+                future.result()
+            best = min(best, time.perf_counter() - start)
+
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Time reading the elevation layer of a BAG from a '
+                                                 'pool of threads, each with its own Dataset.')
+    parser.add_argument('bagFileName', metavar='bagFileName', help='The BAG to read')
+    parser.add_argument('-t', '--threads', type=int, default=4,
+                        help='The largest number of threads to time (default: 4)')
+    parser.add_argument('-b', '--bands', type=int, default=16,
+                        help='The number of bands the layer is read in (default: 16)')
+    parser.add_argument('-r', '--repeat', type=int, default=3,
+                        help='The number of runs to take the best of (default: 3)')
+    parser.add_argument('--hyperslab', action='store_true',
+                        help='Read with Layer.read() instead of SimpleLayer.readChunked()')
+    args = parser.parse_args()
+
+    useChunked: bool = not args.hyperslab
+    print(f"Reading {args.bagFileName} in {args.bands} bands with "
+          f"{'readChunked' if useChunked else 'read'}")
+
+    serial: float = timeReads(args.bagFileName, 1, args.bands, args.repeat, useChunked)
+    print(f"{1:>3} thread(s): {serial:8.3f} s")
+
+    numThreads: int = 2
+    while numThreads <= args.threads:
+        elapsed: float = timeReads(args.bagFileName, numThreads, args.bands, args.repeat,
+                                   useChunked)
+        print(f"{numThreads:>3} thread(s): {elapsed:8.3f} s  "
+              f"speedup {serial / elapsed:5.2f}x")
+        numThreads *= 2
+
+    return 0
+
+
+if __name__ == '__main__':
+    main()
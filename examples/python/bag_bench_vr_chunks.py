@@ -0,0 +1,140 @@
+import argparse
+import os
+import random
+import tempfile
+import time
+
+import h5py
+import numpy as np
+
+import bagPy as BAG
+
+
+kRefinementsPath: str = '/BAG_root/varres_refinements'
+
+
+def createBag(fileName: str, xmlFileName: str, compressionLevel: int):
+    """
+      Create a variable resolution BAG whose refinements are replaced later.
+    """
+    metadata: BAG.Metadata = BAG.Metadata()
+    metadata.loadFromFile(xmlFileName)
+
+    dataset: BAG.Dataset = BAG.Dataset.create(fileName, metadata, 100, compressionLevel)
+    dataset.createVR(100, compressionLevel, False)
+    dataset.close()
+
+
+def writeRefinements(fileName: str, chunks: tuple, numRecords: int,
+                     compressionLevel: int) -> float:
+    """
+      Replace the refinements of a BAG with numRecords records chunked as
+      given, returning the time taken to write them.
+
+      The library only creates refinements chunked a row of records at a
+      time, so every layout is written with h5py to keep the times
+      comparable.
+    """
+    dtype = BAG.BagVRRefinementsItem.numpy_dtype()
+    records = np.empty(numRecords, dtype=dtype)
+    records['depth'] = -10.0 - 0.001 * np.arange(numRecords, dtype=np.float32)
+    records['depth_uncrt'] = np.random.default_rng(0).uniform(0.1, 1.0, numRecords)
+
+    with h5py.File(fileName, 'r+') as h5file:
+        attributes = dict(h5file[kRefinementsPath].attrs)
+        del h5file[kRefinementsPath]
+
+        start: float = time.perf_counter()
+        h5dataSet = h5file.create_dataset(kRefinementsPath, shape=(1, numRecords),
+                                          maxshape=(None, None), dtype=dtype,
+                                          chunks=chunks, compression='gzip',
+                                          compression_opts=compressionLevel)
+        h5dataSet[0, :] = records
+        h5file.flush()
+        elapsed: float = time.perf_counter() - start
+
+        for name, value in attributes.items():
+            h5dataSet.attrs[name] = value
+
+    return elapsed
+
+
+def timeReads(fileName: str, numReads: int, recordsPerRead: int,
+              repeat: int) -> tuple:
+    """
+      The best times, over repeat runs, to read all the refinements through
+      the library, and to read numReads random runs of recordsPerRead
+      records, about the refinements of a supercell each.
+    """
+    dataset: BAG.Dataset = BAG.Dataset.openDataset(fileName, BAG.BAG_OPEN_READONLY)
+    refinements: BAG.VRRefinements = dataset.getVRRefinements()
+    numRecords: int = refinements.getDescriptor().getDims()[1]
+
+    starts = random.Random(0).choices(range(numRecords - recordsPerRead + 1),
+                                      k=numReads)
+
+    bestFull: float = float('inf')
+    bestRandom: float = float('inf')
+    for _ in range(repeat):
+        start: float = time.perf_counter()
+        refinements.read_numpy(0, 0, 0, numRecords - 1)
+        bestFull = min(bestFull, time.perf_counter() - start)
+
+        start = time.perf_counter()
+        for first in starts:
+            refinements.read(0, first, 0, first + recordsPerRead - 1)
+        bestRandom = min(bestRandom, time.perf_counter() - start)
+
+    dataset.close()
+
+    return bestFull, bestRandom
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare square and row chunking of the variable '
+                                                 'resolution refinements: write time, read times '
+                                                 'and file size.')
+    parser.add_argument('xmlFileName', metavar='xmlFileName',
+                        help='File containing XML metadata for the BAGs')
+    parser.add_argument('-n', '--records', type=int, default=4000000,
+                        help='The number of refinements (default: 4000000)')
+    parser.add_argument('-s', '--chunk-size', type=int, default=100,
+                        help='The size of the square chunks (default: 100)')
+    parser.add_argument('-l', '--lengths', type=int, nargs='+', default=[1024, 4096, 10000],
+                        help='The row chunk lengths, in records (default: 1024 4096 10000)')
+    parser.add_argument('-c', '--compression', type=int, default=6,
+                        help='The gzip compression level (default: 6)')
+    parser.add_argument('--reads', type=int, default=20000,
+                        help='The number of random reads (default: 20000)')
+    parser.add_argument('--read-length', type=int, default=16,
+                        help='The records in each random read (default: 16)')
+    parser.add_argument('-r', '--repeat', type=int, default=3,
+                        help='The number of read runs to take the best of (default: 3)')
+    args = parser.parse_args()
+
+    layouts = [(f"{args.chunk_size} x {args.chunk_size}", (args.chunk_size, args.chunk_size))]
+    layouts += [(f"1 x {length}", (1, length)) for length in args.lengths]
+
+    print(f"{args.records} refinements, gzip {args.compression}, "
+          f"{args.reads} random reads of {args.read_length} records")
+    print(f"{'chunks':>12} {'write':>9} {'full read':>10} {'random reads':>13} {'size':>10}")
+
+    with tempfile.TemporaryDirectory() as directory:
+        for name, chunks in layouts:
+            fileName: str = os.path.join(directory, f"bench_{chunks[0]}x{chunks[1]}.bag")
+
+            createBag(fileName, args.xmlFileName, args.compression)
+            writeTime: float = writeRefinements(fileName, chunks, args.records,
+                                                args.compression)
+            fullTime, randomTime = timeReads(fileName, args.reads, args.read_length,
+                                             args.repeat)
+            size: float = os.path.getsize(fileName) / 1e6
+
+            print(f"{name:>12} {writeTime:8.2f}s {fullTime:9.2f}s {randomTime:12.2f}s "
+                  f"{size:7.1f} MB")
+
+    return 0
+
+
+if __name__ == '__main__':
+    main()
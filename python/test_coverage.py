@@ -0,0 +1,60 @@
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+import bagMetadataSamples, testUtils
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+chunkSize = 32
+compressionLevel = 6
+
+
+class TestCoverage(unittest.TestCase):
+    def testCompute(self):
+        tmpFile = testUtils.RandomFileGuard("name")
+
+        metadata = Metadata()
+        metadata.loadFromBuffer(bagMetadataSamples.kMetadataXML)
+
+        dataset = Dataset.create(tmpFile.getName(), metadata, chunkSize, compressionLevel)
+        self.assertIsNotNone(dataset)
+
+        # A 4x5 block of data with a hole in the middle.
+        buffer = FloatLayerItems((-1.0, -1.0, -1.0, -1.0, -1.0,
+                                  -1.0, -1.0, BAG_NULL_ELEVATION, -1.0, -1.0,
+                                  -1.0, -1.0, -1.0, -1.0, -1.0,
+                                  -1.0, -1.0, -1.0, -1.0, -1.0))
+        dataset.getSimpleLayer(Elevation).write(30, 30, 33, 34, buffer)
+
+        coverage = Coverage.compute(dataset)
+        self.assertFalse(coverage.empty())
+        self.assertEqual(coverage.getNumCells(), 19)
+        self.assertAlmostEqual(coverage.getArea(), 1900.0)
+        self.assertTrue(coverage.contains(30, 30))
+        self.assertFalse(coverage.contains(31, 32))
+        self.assertEqual(coverage.getGridBounds(), ((30, 30), (33, 34)))
+
+        holidays = coverage.getHolidays()
+        self.assertEqual(len(holidays), 1)
+        self.assertEqual(holidays[0].numCells, 1)
+
+        # The outer ring and the hole.
+        self.assertEqual(len(coverage.getFootprint()), 2)
+
+        # Cached in the BAG.
+        cached = dataset.getCoverage()
+        self.assertEqual(cached.getNumCells(), 19)
+
+        del dataset #ensure dataset is deleted before tmpFile
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
@@ -0,0 +1,67 @@
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+import bagMetadataSamples, testUtils
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+chunkSize = 32
+compressionLevel = 6
+
+
+def createSurface(fileName, update):
+    metadata = Metadata()
+    metadata.loadFromBuffer(bagMetadataSamples.kMetadataXML)
+    rows = metadata.rows()
+    columns = metadata.columns()
+
+    dataset = Dataset.create(fileName, metadata, chunkSize, compressionLevel)
+
+    elevations = [-10.0] * (rows * columns)
+    if update:
+        elevations[45 * columns + 45] = -8.0
+    dataset.getSimpleLayer(Elevation).write(0, 0, rows - 1, columns - 1,
+                                            FloatLayerItems(tuple(elevations)))
+    dataset.getSimpleLayer(Uncertainty).write(0, 0, rows - 1, columns - 1,
+                                              FloatLayerItems((1.0,) * (rows * columns)))
+
+    return dataset
+
+
+class TestDiff(unittest.TestCase):
+    def testDiffAndPatch(self):
+        baseFile = testUtils.RandomFileGuard("name")
+        updatedFile = testUtils.RandomFileGuard("name")
+        targetFile = testUtils.RandomFileGuard("name")
+        patchFile = testUtils.RandomFileGuard("name")
+
+        base = createSurface(baseFile.getName(), False)
+        updated = createSurface(updatedFile.getName(), True)
+
+        changes = SurfaceDiff.diff(base, updated, "", patchFile.getName())
+        changed = [change for change in changes if change.numChanged > 0]
+        self.assertEqual(len(changed), 1)
+        self.assertAlmostEqual(changed[0].maxDifference, 2.0)
+
+        target = createSurface(targetFile.getName(), False)
+        applied = SurfaceDiff.applyPatch(target, patchFile.getName())
+        self.assertEqual(len(applied), 1)
+
+        elevation = target.getSimpleLayer(Elevation)
+        self.assertEqual(elevation.read(45, 45, 45, 45).asFloatItems()[0], -8.0)
+
+        del target #ensure datasets are deleted before the files
+        del updated
+        del base
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
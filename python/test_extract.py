@@ -0,0 +1,64 @@
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+import testUtils
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+
+
+class TestExtract(unittest.TestCase):
+    def testExtractGeorefMetadata(self):
+        outFile = testUtils.RandomFileGuard("name")
+
+        source = Dataset.openDataset(datapath + "/bag_georefmetadata_layer.bag",
+                                     BAG_OPEN_READONLY)
+        metadata = source.getMetadata()
+        llX = metadata.llCornerX()
+        llY = metadata.llCornerY()
+        resX = metadata.columnResolution()
+        resY = metadata.rowResolution()
+
+        # The nodes of the first 10 rows and 20 columns.
+        extracted = source.extract(llX, llY, llX + 19.5 * resX,
+                                   llY + 9.5 * resY, outFile.getName())
+
+        self.assertEqual(extracted.getMetadata().rows(), 10)
+        self.assertEqual(extracted.getMetadata().columns(), 20)
+        self.assertEqual(len(extracted.getGeorefMetadataLayers()),
+                         len(source.getGeorefMetadataLayers()))
+
+        expected = source.getSimpleLayer(Elevation).read(0, 0, 9, 19)
+        actual = extracted.getSimpleLayer(Elevation).read(0, 0, 9, 19)
+        self.assertEqual(list(actual.asFloatItems()),
+                         list(expected.asFloatItems()))
+
+        del extracted #ensure datasets are deleted before the files
+        del source
+
+    def testExtractOutside(self):
+        outFile = testUtils.RandomFileGuard("name")
+
+        source = Dataset.openDataset(datapath + "/bag_georefmetadata_layer.bag",
+                                     BAG_OPEN_READONLY)
+        metadata = source.getMetadata()
+        llX = metadata.llCornerX()
+        llY = metadata.llCornerY()
+
+        with self.assertRaises(Exception):
+            Extractor.extract(source, llX - 100.0, llY - 100.0, llX - 50.0,
+                              llY - 50.0, outFile.getName())
+
+        del source
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
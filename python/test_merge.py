@@ -0,0 +1,79 @@
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+import bagMetadataSamples, testUtils
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+chunkSize = 32
+compressionLevel = 6
+
+
+def createFlatBag(fileName, rowOffset, columnOffset, elevation, uncertainty):
+    metadata = Metadata()
+    metadata.loadFromBuffer(bagMetadataSamples.kMetadataXML)
+    metadata.setGridExtent(metadata.rows(), metadata.columns(),
+                           metadata.llCornerX() + columnOffset * metadata.columnResolution(),
+                           metadata.llCornerY() + rowOffset * metadata.rowResolution())
+
+    dataset = Dataset.create(fileName, metadata, chunkSize, compressionLevel)
+
+    numCells = metadata.rows() * metadata.columns()
+    dataset.getSimpleLayer(Elevation).write(0, 0, metadata.rows() - 1, metadata.columns() - 1,
+                                            FloatLayerItems((elevation,) * numCells))
+    dataset.getSimpleLayer(Uncertainty).write(0, 0, metadata.rows() - 1, metadata.columns() - 1,
+                                              FloatLayerItems((uncertainty,) * numCells))
+
+    return dataset
+
+
+class TestMerge(unittest.TestCase):
+    def testMergePriority(self):
+        deepFile = testUtils.RandomFileGuard("name")
+        shoalFile = testUtils.RandomFileGuard("name")
+        outFile = testUtils.RandomFileGuard("name")
+
+        deep = createFlatBag(deepFile.getName(), 0, 0, -10.0, 1.0)
+        shoal = createFlatBag(shoalFile.getName(), 20, 50, -5.0, 2.0)
+
+        merged = Merger.merge(DatasetVector((deep, shoal)), outFile.getName(),
+                              MergeRule_Priority, chunkSize, compressionLevel)
+        self.assertIsNotNone(merged)
+
+        metadata = merged.getMetadata()
+        self.assertEqual(metadata.rows(), deep.getMetadata().rows() + 20)
+        self.assertEqual(metadata.columns(), deep.getMetadata().columns() + 50)
+
+        elevation = merged.getSimpleLayer(Elevation)
+        self.assertEqual(elevation.read(50, 60, 50, 60).asFloatItems()[0], -10.0)
+        self.assertEqual(elevation.read(110, 140, 110, 140).asFloatItems()[0], -5.0)
+
+        del merged #ensure datasets are deleted before the files
+        del shoal
+        del deep
+
+    def testIncompatibleGrids(self):
+        firstFile = testUtils.RandomFileGuard("name")
+        secondFile = testUtils.RandomFileGuard("name")
+        outFile = testUtils.RandomFileGuard("name")
+
+        first = createFlatBag(firstFile.getName(), 0, 0, -10.0, 1.0)
+        second = createFlatBag(secondFile.getName(), 0, 10.5, -5.0, 2.0)
+
+        with self.assertRaises(Exception):
+            Merger.merge(DatasetVector((first, second)), outFile.getName())
+
+        del second #ensure datasets are deleted before the files
+        del first
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
@@ -0,0 +1,98 @@
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+import bagMetadataSamples, testUtils
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+chunkSize = 100
+compressionLevel = 6
+
+
+@unittest.skipIf(numpy is None, "NumPy is not installed")
+class TestNumpy(unittest.TestCase):
+    def testReadSimpleLayer(self):
+        dataset = Dataset.openDataset(datapath + "/sample.bag", BAG_OPEN_READONLY)
+        elevation = dataset.getSimpleLayer(Elevation)
+
+        array = elevation.read_numpy(1, 2, 3, 5)
+        self.assertEqual(array.shape, (3, 4))
+        self.assertEqual(array.dtype, numpy.float32)
+
+        expected = elevation.read(1, 2, 3, 5).asFloatItems()
+        self.assertEqual(list(array.ravel()), list(expected))
+
+        # The array is a view of the buffer it was read into.
+        self.assertIsNotNone(array.base)
+        self.assertFalse(array.flags.owndata)
+
+        del dataset
+
+    def testArrayInterface(self):
+        dataset = Dataset.openDataset(datapath + "/sample.bag", BAG_OPEN_READONLY)
+
+        items = dataset.getSimpleLayer(Elevation).read(0, 0, 0, 3)
+        array = numpy.asarray(items)
+        self.assertEqual(array.dtype, numpy.uint8)
+        self.assertEqual(len(array), 16)
+        self.assertFalse(array.flags.writeable)
+        self.assertEqual(list(array.view(numpy.float32)), list(items.asFloatItems()))
+
+        del dataset
+
+    def testReadVRRefinements(self):
+        dataset = Dataset.openDataset(datapath + "/test_vr.bag", BAG_OPEN_READONLY)
+        refinements = dataset.getVRRefinements()
+
+        array = refinements.read_numpy(0, 0, 0, 9)
+        self.assertEqual(array.shape, (1, 10))
+        self.assertEqual(array.dtype.names, ('depth', 'depth_uncrt'))
+        self.assertEqual(array.dtype.itemsize, 8)
+
+        expected = refinements.read(0, 0, 0, 9).asVRRefinementsItems()
+        for item, value in zip(expected, array[0]):
+            self.assertAlmostEqual(item.depth, value['depth'], places=5)
+            self.assertAlmostEqual(item.depth_uncrt, value['depth_uncrt'], places=5)
+
+        metadata = dataset.getVRMetadata().read_numpy(0, 0, 1, 1)
+        self.assertEqual(metadata.shape, (2, 2))
+        self.assertEqual(metadata.dtype.itemsize, 28)
+
+        del dataset
+
+    def testTrackingList(self):
+        tmpFile = testUtils.RandomFileGuard("name")
+        metadata = Metadata()
+        metadata.loadFromBuffer(bagMetadataSamples.kMetadataXML)
+
+        dataset = Dataset.create(tmpFile.getName(), metadata,
+                                 chunkSize, compressionLevel)
+
+        trackingList = dataset.getTrackingList()
+        trackingList.push_back(BagTrackingItem(1, 2, 3.5, 0.5, 7, 8))
+        trackingList.push_back(BagTrackingItem(11, 22, 33.5, 1.5, 77, 88))
+
+        array = trackingList.to_numpy()
+        self.assertEqual(array.dtype.itemsize, 20)
+        self.assertEqual(list(array['row']), [1, 11])
+        self.assertEqual(list(array['depth']), [3.5, 33.5])
+        self.assertEqual(list(array['list_series']), [8, 88])
+
+        del dataset #ensure dataset is deleted before tmpFile
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
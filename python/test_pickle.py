@@ -0,0 +1,80 @@
+import concurrent.futures
+import pickle
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+bagFileName = datapath + "/sample.bag"
+
+
+def sumWindow(window):
+    return sum(window.read().asFloatItems())
+
+
+class TestPickle(unittest.TestCase):
+    def testDatasetRef(self):
+        dataset = Dataset.openDataset(bagFileName, BAG_OPEN_READONLY)
+        self.assertEqual(dataset.getFileName(), bagFileName)
+        self.assertEqual(dataset.getOpenMode(), BAG_OPEN_READONLY)
+
+        ref = pickle.loads(pickle.dumps(dataset.reference()))
+        self.assertEqual(ref, DatasetRef(bagFileName, BAG_OPEN_READONLY))
+
+        reopened = ref.open()
+        self.assertIs(ref.open(), reopened)
+        self.assertEqual(reopened.getMetadata().rows(),
+                         dataset.getMetadata().rows())
+
+        ref.close()
+        del reopened
+        del dataset
+
+    def testPickleDataset(self):
+        dataset = Dataset.openDataset(bagFileName, BAG_OPEN_READONLY)
+        copy = pickle.loads(pickle.dumps(dataset))
+
+        self.assertEqual(copy.getFileName(), bagFileName)
+        self.assertEqual(list(copy.getSimpleLayer(Elevation).read(0, 0, 1, 1).asFloatItems()),
+                         list(dataset.getSimpleLayer(Elevation).read(0, 0, 1, 1).asFloatItems()))
+
+        del copy
+        del dataset
+
+    def testChunkWindows(self):
+        dataset = Dataset.openDataset(bagFileName, BAG_OPEN_READONLY)
+        elevation = dataset.getSimpleLayer(Elevation)
+        rows, columns = elevation.getDescriptor().getDims()
+
+        windows = elevation.chunk_windows()
+        self.assertEqual(sum(w.shape[0] * w.shape[1] for w in windows),
+                         rows * columns)
+
+        window = pickle.loads(pickle.dumps(windows[-1]))
+        self.assertEqual(window, windows[-1])
+        self.assertEqual(window.rowEnd, rows - 1)
+        self.assertEqual(window.columnEnd, columns - 1)
+        self.assertEqual(
+            list(window.read().asFloatItems()),
+            list(elevation.read(window.rowStart, window.columnStart,
+                                window.rowEnd, window.columnEnd).asFloatItems()))
+
+        expected = sum(elevation.read(0, 0, rows - 1, columns - 1).asFloatItems())
+        with concurrent.futures.ProcessPoolExecutor(max_workers=2) as executor:
+            actual = sum(executor.map(sumWindow, windows))
+        self.assertAlmostEqual(actual, expected, delta=abs(expected) * 1e-9)
+
+        del elevation
+        del dataset
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
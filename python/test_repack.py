@@ -0,0 +1,38 @@
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+import testUtils
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+
+
+class TestRepack(unittest.TestCase):
+    def testRepackVR(self):
+        outFile = testUtils.RandomFileGuard("name")
+
+        source = Dataset.openDataset(datapath + "/test_vr.bag", BAG_OPEN_READONLY)
+        repacked = Repacker.repack(source, outFile.getName(), 16, 9)
+
+        self.assertEqual(len(repacked.getLayerTypes()),
+                         len(source.getLayerTypes()))
+        self.assertEqual(repacked.getVRRefinements().getDescriptor().getDims(),
+                         source.getVRRefinements().getDescriptor().getDims())
+
+        descriptor = repacked.getSimpleLayer(Elevation).getDescriptor()
+        self.assertEqual(descriptor.getCompressionLevel(), 9)
+
+        del repacked #ensure datasets are deleted before the files
+        del source
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
@@ -0,0 +1,61 @@
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+import testUtils
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+vrBagFileName = datapath + "/test_vr.bag"
+
+
+class TestResample(unittest.TestCase):
+    def testResampleMean(self):
+        outFile = testUtils.RandomFileGuard("name")
+
+        dataset = Dataset.openDataset(vrBagFileName, BAG_OPEN_READONLY)
+        metadata = dataset.getMetadata()
+        resolution = metadata.columnResolution()
+
+        resampled = Resampler.resample(dataset, outFile.getName(), resolution,
+                                       ResampleRule_Mean, 2, 5, 2)
+        self.assertIsNotNone(resampled)
+
+        outMetadata = resampled.getMetadata()
+        self.assertEqual(outMetadata.rows(), metadata.rows())
+        self.assertEqual(outMetadata.columns(), metadata.columns())
+        self.assertAlmostEqual(outMetadata.rowResolution(), resolution)
+
+        # Each cell is the mean of the refinements of its supercell.
+        index = dataset.getVRIndex()
+        supercell = index.getSupercell(0, 0)
+        count = supercell.dimensions_x * supercell.dimensions_y
+        refinements = dataset.getVRRefinements().read(
+            0, supercell.index, 0, supercell.index + count - 1).asVRRefinementsItems()
+        expected = sum(item.depth for item in refinements) / count
+
+        elevation = resampled.getSimpleLayer(Elevation).read(0, 0, 0, 0).asFloatItems()[0]
+        self.assertAlmostEqual(elevation, expected, places=3)
+
+        del resampled #ensure datasets are deleted before the files
+        del dataset
+
+    def testResampleWithoutVR(self):
+        outFile = testUtils.RandomFileGuard("name")
+
+        dataset = Dataset.openDataset(datapath + "/sample.bag", BAG_OPEN_READONLY)
+        with self.assertRaises(Exception):
+            Resampler.resample(dataset, outFile.getName(), 10.0)
+
+        del dataset
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
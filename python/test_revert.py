@@ -0,0 +1,55 @@
+import unittest
+
+import xmlrunner
+
+from bagPy import *
+
+import bagMetadataSamples, testUtils
+
+
+# define constants used in multiple tests
+chunkSize = 100
+compressionLevel = 6
+
+
+class TestRevert(unittest.TestCase):
+    def testRevertEdits(self):
+        tmpFile = testUtils.RandomFileGuard("name")
+
+        metadata = Metadata()
+        metadata.loadFromBuffer(bagMetadataSamples.kMetadataXML)
+
+        dataset = Dataset.create(tmpFile.getName(), metadata, chunkSize,
+                                 compressionLevel)
+        self.assertIsNotNone(dataset)
+
+        elevation = dataset.getSimpleLayer(Elevation)
+        uncertainty = dataset.getSimpleLayer(Uncertainty)
+        elevation.write(1, 2, 1, 2, FloatLayerItems((-10.0,)))
+        uncertainty.write(1, 2, 1, 2, FloatLayerItems((1.0,)))
+
+        # Edit the node, recording its value before in the tracking list.
+        trackingList = dataset.getTrackingList()
+        trackingList.push_back(BagTrackingItem(1, 2, -10.0, 1.0, 3, 7))
+        trackingList.write()
+        elevation.write(1, 2, 1, 2, FloatLayerItems((-20.0,)))
+
+        revertFilter = RevertFilter()
+        revertFilter.filterSeries = True
+        revertFilter.series = 6
+        self.assertEqual(dataset.revertEdits(revertFilter), 0)
+
+        revertFilter.series = 7
+        self.assertEqual(dataset.revertEdits(revertFilter, 2), 1)
+        self.assertEqual(trackingList.size(), 0)
+        self.assertEqual(list(elevation.read(1, 2, 1, 2).asFloatItems()),
+                         [-10.0])
+
+        del dataset #ensure dataset is deleted before tmpFile
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
@@ -0,0 +1,76 @@
+import asyncio
+import concurrent.futures
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+bagFileName = datapath + "/sample.bag"
+
+
+def readElevation(rowStart, rowEnd):
+    dataset = Dataset.openDataset(bagFileName, BAG_OPEN_READONLY)
+    columns = dataset.getMetadata().columns()
+    items = dataset.getSimpleLayer(Elevation).readChunked(rowStart, 0, rowEnd,
+                                                          columns - 1)
+    values = list(items.asFloatItems())
+    del dataset
+    return values
+
+
+class TestThreads(unittest.TestCase):
+    def testReadChunked(self):
+        dataset = Dataset.openDataset(bagFileName, BAG_OPEN_READONLY)
+        elevation = dataset.getSimpleLayer(Elevation)
+
+        expected = elevation.read(1, 2, 3, 5).asFloatItems()
+        actual = elevation.readChunked(1, 2, 3, 5).asFloatItems()
+        self.assertEqual(list(actual), list(expected))
+
+        with self.assertRaises(InvalidReadSize):
+            elevation.readChunked(3, 0, 1, 0)
+
+        del dataset
+
+    def testConcurrentReads(self):
+        dataset = Dataset.openDataset(bagFileName, BAG_OPEN_READONLY)
+        rows = dataset.getMetadata().rows()
+        columns = dataset.getMetadata().columns()
+        expected = list(dataset.getSimpleLayer(Elevation).read(
+            0, 0, rows - 1, columns - 1).asFloatItems())
+        del dataset
+
+        bands = [(row, min(rows, row + 2) - 1) for row in range(0, rows, 2)]
+        with concurrent.futures.ThreadPoolExecutor(max_workers=4) as executor:
+            results = list(executor.map(lambda band: readElevation(*band), bands))
+
+        actual = [value for result in results for value in result]
+        self.assertEqual(actual, expected)
+
+    def testAsync(self):
+        async def readAsync():
+            dataset = await Dataset.open_async(bagFileName, BAG_OPEN_READONLY)
+            elevation = dataset.getSimpleLayer(Elevation)
+            items = await elevation.read_async(1, 2, 3, 5)
+            values = list(items.asFloatItems())
+            del dataset
+            return values
+
+        dataset = Dataset.openDataset(bagFileName, BAG_OPEN_READONLY)
+        expected = list(dataset.getSimpleLayer(Elevation).read(
+            1, 2, 3, 5).asFloatItems())
+        del dataset
+
+        self.assertEqual(asyncio.run(readAsync()), expected)
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
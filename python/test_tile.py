@@ -0,0 +1,50 @@
+import os
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+import testUtils
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+
+
+class TestTile(unittest.TestCase):
+    def testTile(self):
+        outPrefix = testUtils.RandomFileGuard("name")
+
+        master = Dataset.openDataset(datapath + "/bag_georefmetadata_layer.bag",
+                                     BAG_OPEN_READONLY)
+        rows = master.getMetadata().rows()
+        columns = master.getMetadata().columns()
+
+        tileNames = Tiler.tile(master, 60, 60, outPrefix.getName(), 2)
+        numTileRows = (rows + 59) // 60
+        numTileColumns = (columns + 59) // 60
+        self.assertEqual(len(tileNames), numTileRows * numTileColumns)
+        self.assertEqual(tileNames[0], Tiler.getTileFileName(outPrefix.getName(), 0, 0))
+
+        tile = Dataset.openDataset(tileNames[0], BAG_OPEN_READONLY)
+        self.assertEqual(tile.getMetadata().rows(), min(rows, 60))
+        self.assertEqual(tile.getMetadata().columns(), min(columns, 60))
+
+        expected = master.getSimpleLayer(Elevation).read(0, 0, 9, 9)
+        actual = tile.getSimpleLayer(Elevation).read(0, 0, 9, 9)
+        self.assertEqual(list(actual.asFloatItems()),
+                         list(expected.asFloatItems()))
+
+        del tile #ensure datasets are deleted before the files
+        del master
+        for tileName in tileNames:
+            os.remove(tileName)
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
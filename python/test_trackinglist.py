@@ -101,6 +101,89 @@ class TestTrackingList(unittest.TestCase):
 
         del dataset #ensure dataset is deleted before tmpFile
 
+    def testFind(self):
+        tmpFile = testUtils.RandomFileGuard("name")
+
+        dataset = Dataset.create(tmpFile.getName(), Metadata(),
+                                 chunkSize, compressionLevel)
+        self.assertIsNotNone(dataset)
+
+        trackingList = dataset.getTrackingList()
+        for i in range(30):
+            trackingList.push_back(BagTrackingItem(i % 3, i % 5, float(i), 0.5,
+                                                   i % 2, i // 10))
+
+        items = trackingList.findNode(1, 1)
+        self.assertEqual([item.depth for item in items], [1.0, 16.0])
+
+        self.assertEqual(len(trackingList.findCode(1)), 15)
+        self.assertEqual(len(trackingList.findSeries(2)), 10)
+        self.assertEqual(len(trackingList.findNode(3, 0)), 0)
+
+        del dataset #ensure dataset is deleted before tmpFile
+
+    def testSortBy(self):
+        tmpFile = testUtils.RandomFileGuard("name")
+
+        dataset = Dataset.create(tmpFile.getName(), Metadata(),
+                                 chunkSize, compressionLevel)
+        self.assertIsNotNone(dataset)
+
+        trackingList = dataset.getTrackingList()
+        for i in range(30):
+            trackingList.push_back(BagTrackingItem(i % 3, i % 5, float(i), 0.5,
+                                                   i % 2, 9 - i // 10))
+        self.assertEqual(trackingList.getSortOrder(), TrackingListOrder_Unsorted)
+
+        trackingList.sortBy(TrackingListOrder_Series)
+        self.assertEqual(trackingList.getSortOrder(), TrackingListOrder_Series)
+        self.assertEqual(trackingList.front().list_series, 7)
+        self.assertEqual(trackingList.front().depth, 20.0)
+
+        with self.assertRaises(Exception):
+            trackingList.sortBy(TrackingListOrder_SubPosition)
+
+        trackingList.write()
+
+        del dataset #ensure dataset is deleted before tmpFile
+
+    def testStreaming(self):
+        tmpFile = testUtils.RandomFileGuard("name")
+
+        dataset = Dataset.create(tmpFile.getName(), Metadata(),
+                                 chunkSize, compressionLevel)
+        self.assertIsNotNone(dataset)
+
+        trackingList = dataset.getTrackingList()
+        for i in range(30):
+            trackingList.push_back(BagTrackingItem(i % 3, i % 5, float(i), 0.5,
+                                                   i % 2, i // 10))
+        trackingList.write()
+        dataset.close()
+        del dataset
+
+        dataset = Dataset.openDataset(tmpFile.getName(), BAG_OPEN_READONLY,
+                                      True)
+        self.assertIsNotNone(dataset)
+
+        trackingList = dataset.getTrackingList()
+        self.assertFalse(trackingList.isLoaded())
+        self.assertTrue(trackingList.empty())
+
+        reader = dataset.getTrackingListReader()
+        self.assertEqual(reader.size(), 30)
+        self.assertEqual(reader.getNumBlocks(), 1)
+        self.assertEqual(reader.read(12).depth, 12.0)
+        self.assertEqual(len(reader.readBlock(0)), 30)
+        self.assertEqual(len(reader.findCode(1)), 15)
+        self.assertEqual(len(reader.findSeries(2)), 10)
+        self.assertEqual(len(reader.findBox(0, 0, 1, 1)), 8)
+
+        with self.assertRaises(Exception):
+            reader.read(30)
+
+        del dataset #ensure dataset is deleted before tmpFile
+
 
 if __name__ == '__main__':
     unittest.main(
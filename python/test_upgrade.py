@@ -0,0 +1,39 @@
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+import testUtils
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+
+
+class TestUpgrade(unittest.TestCase):
+    def testUpgrade(self):
+        outFile = testUtils.RandomFileGuard("name")
+
+        source = Dataset.openDataset(datapath + "/sample.bag", BAG_OPEN_READONLY)
+        upgraded = Upgrader.upgrade(source, outFile.getName(), 0, -1, 2)
+
+        self.assertEqual(len(upgraded.getLayerTypes()),
+                         len(source.getLayerTypes()))
+        self.assertTrue(upgraded.getDescriptor().getVersion().startswith("2."))
+
+        expected = source.getSimpleLayer(Elevation).read(0, 0, 4, 4)
+        actual = upgraded.getSimpleLayer(Elevation).read(0, 0, 4, 4)
+        self.assertEqual(list(actual.asFloatItems()),
+                         list(expected.asFloatItems()))
+
+        del upgraded #ensure datasets are deleted before the files
+        del source
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
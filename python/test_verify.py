@@ -0,0 +1,56 @@
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+import bagMetadataSamples, testUtils
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+chunkSize = 32
+compressionLevel = 6
+
+
+def createSurface(fileName, checksum):
+    metadata = Metadata()
+    metadata.loadFromBuffer(bagMetadataSamples.kMetadataXML)
+    rows = metadata.rows()
+    columns = metadata.columns()
+
+    dataset = Dataset.create(fileName, metadata, chunkSize, compressionLevel,
+                             checksum)
+
+    dataset.getSimpleLayer(Elevation).write(0, 0, rows - 1, columns - 1,
+                                            FloatLayerItems((-10.0,) * (rows * columns)))
+    dataset.getSimpleLayer(Uncertainty).write(0, 0, rows - 1, columns - 1,
+                                              FloatLayerItems((1.0,) * (rows * columns)))
+
+    return dataset
+
+
+class TestVerify(unittest.TestCase):
+    def testVerify(self):
+        plainFile = testUtils.RandomFileGuard("name")
+        checkedFile = testUtils.RandomFileGuard("name")
+
+        plain = createSurface(plainFile.getName(), False)
+        checked = createSurface(checkedFile.getName(), True)
+
+        self.assertFalse(plain.getDescriptor().isChecksummed())
+        self.assertTrue(checked.getDescriptor().isChecksummed())
+
+        self.assertEqual(len(plain.verify()), 0)
+        self.assertEqual(len(checked.verify(2)), 0)
+
+        del checked #ensure datasets are deleted before the files
+        del plain
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
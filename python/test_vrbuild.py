@@ -0,0 +1,58 @@
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+import testUtils
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+
+
+class TestVRBuild(unittest.TestCase):
+    def testBuildByDepth(self):
+        outFile = testUtils.RandomFileGuard("name")
+
+        dataset = Dataset.openDataset(datapath + "/sample.bag", BAG_OPEN_READONLY)
+        metadata = dataset.getMetadata()
+
+        built = VRBuilder.build(dataset, outFile.getName(), 4,
+                                VRResolutionRule_Depth, 0.1, 10, 5, 2)
+        self.assertIsNotNone(built)
+
+        outMetadata = built.getMetadata()
+        self.assertEqual(outMetadata.rows(), metadata.rows() // 4)
+        self.assertEqual(outMetadata.columns(), metadata.columns() // 4)
+        self.assertAlmostEqual(outMetadata.rowResolution(),
+                               metadata.rowResolution() * 4)
+
+        # The first supercell is refined down to the source cells.
+        supercell = built.getVRIndex().getSupercell(0, 0)
+        self.assertEqual(supercell.index, 0)
+        self.assertEqual(supercell.dimensions_x, 4)
+        self.assertEqual(supercell.dimensions_y, 4)
+
+        self.assertIsNotNone(built.getVRRefinements())
+        self.assertIsNotNone(built.getVRNode())
+
+        del built #ensure datasets are deleted before the files
+        del dataset
+
+    def testBuildInvalidSupercellSize(self):
+        outFile = testUtils.RandomFileGuard("name")
+
+        dataset = Dataset.openDataset(datapath + "/sample.bag", BAG_OPEN_READONLY)
+        with self.assertRaises(Exception):
+            VRBuilder.build(dataset, outFile.getName(), 0)
+
+        del dataset
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
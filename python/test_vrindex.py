@@ -0,0 +1,69 @@
+import unittest
+import pathlib
+
+import xmlrunner
+
+from bagPy import *
+
+
+# define constants used in multiple tests
+datapath = str(pathlib.Path(__file__).parent.absolute()) + "/../examples/sample-data"
+vrBagFileName = datapath + "/test_vr.bag"
+
+
+class TestVRIndex(unittest.TestCase):
+    def testNoIndex(self):
+        dataset = Dataset.openDataset(datapath + "/sample.bag", BAG_OPEN_READONLY)
+        self.assertIsNone(dataset.getVRIndex())
+        del dataset
+
+    def testQuery(self):
+        dataset = Dataset.openDataset(vrBagFileName, BAG_OPEN_READONLY)
+        index = dataset.getVRIndex()
+        self.assertIsNotNone(index)
+        self.assertEqual(index.getRows(), 4)
+        self.assertEqual(index.getColumns(), 6)
+
+        supercell = index.getSupercell(0, 0)
+        self.assertIsNotNone(supercell)
+
+        point = index.getNodePosition(0, 0, 1, 1)
+        samples = index.query([point])
+        self.assertEqual(len(samples), 1)
+        self.assertTrue(samples[0].found)
+        self.assertEqual(samples[0].index,
+                         supercell.index + supercell.dimensions_x + 1)
+
+        refinements = dataset.getVRRefinements().read(
+            0, samples[0].index, 0, samples[0].index)
+        expected = refinements.asVRRefinementsItems()[0]
+        self.assertAlmostEqual(samples[0].depth, expected.depth, places=5)
+        self.assertAlmostEqual(samples[0].uncertainty, expected.depth_uncrt,
+                               places=5)
+
+        # Outside the grid.
+        samples = index.query([(point[0] - 1.0e6, point[1])], True)
+        self.assertFalse(samples[0].found)
+
+        del dataset
+
+    def testQueryBox(self):
+        dataset = Dataset.openDataset(vrBagFileName, BAG_OPEN_READONLY)
+        index = dataset.getVRIndex()
+
+        x0, y0 = index.getNodePosition(0, 0, 0, 0)
+        x1, y1 = index.getNodePosition(0, 0, 1, 1)
+        samples = index.queryBox(x0, y0, x1, y1)
+
+        self.assertEqual(len(samples), 4)
+        for sample in samples:
+            self.assertEqual((sample.row, sample.column), (0, 0))
+
+        del dataset
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
@@ -181,6 +181,28 @@ class TestVRMetadata(unittest.TestCase):
         # Force a close.
         del dataset
 
+    def testRecomputeStatistics(self):
+        dataset = Dataset.openDataset(datapath + "/test_vr.bag", BAG_OPEN_READONLY)
+        vrMetadata = dataset.getVRMetadata()
+        self.assertIsNotNone(vrMetadata)
+
+        statistics = vrMetadata.recomputeStatistics()
+        self.assertGreater(statistics.numRefinedSupercells, 0)
+        self.assertGreaterEqual(statistics.numRefinements,
+                                statistics.numRefinedSupercells)
+        self.assertLessEqual(statistics.minRefinements, statistics.maxRefinements)
+        self.assertGreater(statistics.refinedArea, 0.0)
+        self.assertEqual(sum(r.count for r in statistics.resolutions),
+                         statistics.numRefinedSupercells)
+
+        # The refinements are recomputed in memory; the file is read only.
+        vrRefinements = dataset.getVRRefinements()
+        vrRefinements.recomputeStatistics(2)
+        minDepth, maxDepth = vrRefinements.getDescriptor().getMinMaxDepth()
+        self.assertLessEqual(minDepth, maxDepth)
+
+        del dataset
+
 
 if __name__ == '__main__':
     unittest.main(
@@ -0,0 +1,61 @@
+import unittest
+
+import xmlrunner
+
+from bagPy import *
+
+import bagMetadataSamples, testUtils
+
+
+# define constants used in multiple tests
+chunkSize = 100
+compressionLevel = 6
+
+
+class TestVRRecords(unittest.TestCase):
+    def testRead(self):
+        tmpBagFile = testUtils.RandomFileGuard("name")
+
+        metadata = Metadata()
+        metadata.loadFromBuffer(bagMetadataSamples.kMetadataXML)
+
+        dataset = Dataset.create(tmpBagFile.getName(), metadata,
+                                 chunkSize, compressionLevel)
+        self.assertIsNotNone(dataset)
+
+        dataset.createVR(chunkSize, compressionLevel, True)
+
+        refinements = (BagVRRefinementsItem(9.8, 0.654),
+                       BagVRRefinementsItem(-7.5, 0.25),
+                       BagVRRefinementsItem(1.25, 1.5))
+        nodes = (BagVRNodeItem(123.456, 42, 1701),
+                 BagVRNodeItem(0.5, 1, 7),
+                 BagVRNodeItem(2.5, 3, 11))
+
+        dataset.getVRRefinements().write(0, 0, 0, 2,
+                                         VRRefinementsLayerItems(refinements))
+        dataset.getVRNode().write(0, 0, 0, 2, VRNodeLayerItems(nodes))
+
+        records = VRRecordReader.read(dataset, 1, 2)
+        self.assertEqual(len(records), 2)
+
+        for record, refinement, node in zip(records, refinements[1:], nodes[1:]):
+            self.assertAlmostEqual(record.depth, refinement.depth, places=5)
+            self.assertAlmostEqual(record.depth_uncrt, refinement.depth_uncrt,
+                                   places=5)
+            self.assertAlmostEqual(record.hyp_strength, node.hyp_strength,
+                                   places=5)
+            self.assertEqual(record.num_hypotheses, node.num_hypotheses)
+            self.assertEqual(record.n_samples, node.n_samples)
+
+        with self.assertRaises(Exception):
+            VRRecordReader.read(dataset, 2, 3)
+
+        del dataset
+
+
+if __name__ == '__main__':
+    unittest.main(
+        testRunner=xmlrunner.XMLTestRunner(output='test-reports'),
+        failfast=False, buffer=False, catchbreak=False
+    )
@@ -128,6 +128,29 @@ class TestVRRefinements(unittest.TestCase):
         # Force a close.
         del dataset
 
+    def testReadSupercells(self):
+        dataset = Dataset.openDataset(datapath + "/test_vr.bag", BAG_OPEN_READONLY)
+        vrRefinements = dataset.getVRRefinements()
+        self.assertIsNotNone(vrRefinements)
+
+        result = vrRefinements.readSupercells(0, 0, 1, 2)
+        self.assertEqual(result.rows, 2)
+        self.assertEqual(result.columns, 3)
+        self.assertEqual(len(result.offsets), 7)
+        self.assertEqual(result.offsets[-1], len(result.items))
+
+        # The first supercell's refinements match a plain read of its range.
+        supercell = dataset.getVRMetadata().read(0, 0, 0, 0).asVRMetadataItems()[0]
+        count = supercell.dimensions_x * supercell.dimensions_y
+        self.assertEqual(result.offsets[1], count)
+
+        expected = vrRefinements.read(0, supercell.index, 0,
+                                      supercell.index + count - 1).asVRRefinementsItems()
+        for i in range(count):
+            self.assertEqual(result.items[i].depth, expected[i].depth)
+
+        del dataset
+
 
 if __name__ == '__main__':
     unittest.main(
@@ -0,0 +1,207 @@
+
+#include "test_utils.h"
+#include <bag_coverage.h>
+#include <bag_dataset.h>
+#include <bag_metadata.h>
+#include <bag_simplelayer.h>
+
+#include <catch2/catch_all.hpp>
+#include <cstdlib>  // std::getenv
+#include <string>
+#include <vector>
+
+
+using BAG::Coverage;
+using BAG::Dataset;
+using BAG::Metadata;
+
+namespace {
+
+constexpr uint32_t kRows = 100;
+constexpr uint32_t kColumns = 100;
+
+//! Create a BAG whose elevations are null except for one block, with a
+//! hole punched in it.
+std::shared_ptr<Dataset> createBlockBag(
+    const std::string& fileName,
+    uint64_t chunkSize)
+{
+    Metadata metadata;
+    metadata.loadFromFile(std::string{std::getenv("BAG_SAMPLES_PATH")} +
+        "/sample.xml");
+
+    auto pDataset = Dataset::create(fileName, std::move(metadata), chunkSize, 6);
+
+    // Data in rows 10-59, columns 20-79; a 3x4 hole at rows 30-32, columns
+    // 40-43, and a lone empty cell at row 50, column 70.
+    std::vector<float> elevations(kRows * kColumns, BAG_NULL_ELEVATION);
+    for (uint32_t row = 10; row < 60; ++row)
+        for (uint32_t column = 20; column < 80; ++column)
+            elevations[row * kColumns + column] = -static_cast<float>(row);
+    for (uint32_t row = 30; row < 33; ++row)
+        for (uint32_t column = 40; column < 44; ++column)
+            elevations[row * kColumns + column] = BAG_NULL_ELEVATION;
+    elevations[50 * kColumns + 70] = BAG_NULL_ELEVATION;
+
+    pDataset->getSimpleLayer(Elevation)->write(0, 0, kRows - 1, kColumns - 1,
+        reinterpret_cast<const uint8_t*>(elevations.data()));
+
+    return pDataset;
+}
+
+//! The signed area of a ring (shoelace formula).
+double ringArea(const Coverage::Ring& ring)
+{
+    double area = 0.;
+
+    for (size_t i = 0; i + 1 < ring.size(); ++i)
+        area += std::get<0>(ring[i]) * std::get<1>(ring[i + 1]) -
+            std::get<0>(ring[i + 1]) * std::get<1>(ring[i]);
+
+    return area / 2.;
+}
+
+}  // namespace
+
+//  static Coverage compute(const Dataset& dataset, unsigned int numThreads = 0);
+TEST_CASE("test coverage compute", "[coverage][compute]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    // A chunk size that does not divide the grid, so runs cross chunks.
+    auto pDataset = createBlockBag(tmpFileName, 16);
+    REQUIRE(pDataset);
+
+    for (unsigned int numThreads : {1u, 4u})
+    {
+        const auto coverage = Coverage::compute(*pDataset, numThreads);
+
+        CHECK(coverage.getRows() == kRows);
+        CHECK(coverage.getColumns() == kColumns);
+        CHECK_FALSE(coverage.empty());
+
+        // 50 rows of one run, except 3 rows split by the hole and one row
+        // split by the lone empty cell.
+        CHECK(coverage.getRuns().size() == 54);
+        CHECK(coverage.getNumCells() == 50 * 60 - 12 - 1);
+        CHECK(coverage.getArea() == Catch::Approx((50 * 60 - 13) * 100.));
+
+        CHECK(coverage.contains(10, 20));
+        CHECK(coverage.contains(59, 79));
+        CHECK_FALSE(coverage.contains(31, 41));
+        CHECK_FALSE(coverage.contains(50, 70));
+        CHECK_FALSE(coverage.contains(9, 20));
+        CHECK_FALSE(coverage.contains(10, 80));
+
+        uint32_t rowStart = 0, columnStart = 0, rowEnd = 0, columnEnd = 0;
+        std::tie(rowStart, columnStart, rowEnd, columnEnd) = coverage.getGridBounds();
+        CHECK(rowStart == 10);
+        CHECK(columnStart == 20);
+        CHECK(rowEnd == 59);
+        CHECK(columnEnd == 79);
+
+        double xMin = 0., yMin = 0., xMax = 0., yMax = 0.;
+        std::tie(xMin, yMin, xMax, yMax) = coverage.getBounds();
+        CHECK(xMin == Catch::Approx(687910. + 195.));
+        CHECK(yMin == Catch::Approx(5554620. + 95.));
+        CHECK(xMax == Catch::Approx(687910. + 795.));
+        CHECK(yMax == Catch::Approx(5554620. + 595.));
+    }
+}
+
+//  std::vector<CoverageHoliday> getHolidays(uint64_t maxCells) const;
+TEST_CASE("test coverage holidays", "[coverage][getHolidays]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    auto pDataset = createBlockBag(tmpFileName, 32);
+    REQUIRE(pDataset);
+
+    const auto coverage = Coverage::compute(*pDataset);
+
+    const auto holidays = coverage.getHolidays();
+    REQUIRE(holidays.size() == 2);
+
+    CHECK(holidays[0].rowStart == 30);
+    CHECK(holidays[0].columnStart == 40);
+    CHECK(holidays[0].rowEnd == 32);
+    CHECK(holidays[0].columnEnd == 43);
+    CHECK(holidays[0].numCells == 12);
+
+    CHECK(holidays[1].rowStart == 50);
+    CHECK(holidays[1].columnStart == 70);
+    CHECK(holidays[1].numCells == 1);
+
+    // Only the single cell hole.
+    CHECK(coverage.getHolidays(1).size() == 1);
+}
+
+//  std::vector<Ring> getFootprint() const;
+TEST_CASE("test coverage footprint", "[coverage][getFootprint]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    auto pDataset = createBlockBag(tmpFileName, 100);
+    REQUIRE(pDataset);
+
+    const auto coverage = Coverage::compute(*pDataset);
+    const auto footprint = coverage.getFootprint();
+
+    // The outer boundary plus two holes.
+    REQUIRE(footprint.size() == 3);
+
+    double totalArea = 0.;
+    size_t numOuter = 0;
+
+    for (const auto& ring : footprint)
+    {
+        REQUIRE(ring.size() >= 5);
+        CHECK(ring.front() == ring.back());
+
+        const auto area = ringArea(ring);
+        if (area > 0.)
+        {
+            ++numOuter;
+            CHECK(ring.size() == 5);  // A rectangle.
+        }
+
+        totalArea += area;
+    }
+
+    CHECK(numOuter == 1);
+    CHECK(totalArea == Catch::Approx(coverage.getArea()));
+}
+
+//  Coverage getCoverage(unsigned int numThreads = 0) const;
+TEST_CASE("test coverage caching", "[coverage][dataset][getCoverage]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    {
+        auto pDataset = createBlockBag(tmpFileName, 32);
+        REQUIRE(pDataset);
+
+        const auto coverage = pDataset->getCoverage();
+        CHECK(coverage.getNumCells() == 50 * 60 - 13);
+    }
+
+    {
+        // The cached coverage is read back.
+        auto pDataset = Dataset::open(tmpFileName, BAG_OPEN_READ_WRITE);
+        REQUIRE(pDataset);
+
+        auto coverage = pDataset->getCoverage();
+        CHECK(coverage.getRuns().size() == 54);
+        CHECK(coverage.getNumCells() == 50 * 60 - 13);
+
+        // Filling the hole invalidates the cache.
+        const std::vector<float> patch(12, -1.f);
+        pDataset->getSimpleLayer(Elevation)->write(30, 40, 32, 43,
+            reinterpret_cast<const uint8_t*>(patch.data()));
+
+        coverage = pDataset->getCoverage();
+        CHECK(coverage.getNumCells() == 50 * 60 - 1);
+        CHECK(coverage.getHolidays().size() == 1);
+    }
+}
+
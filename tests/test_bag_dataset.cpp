@@ -1,6 +1,7 @@
 
 #include "test_utils.h"
 #include <bag_dataset.h>
+#include <bag_simplelayer.h>
 
 #include <catch2/catch_all.hpp>
 #include <cstdlib>  // std::getenv
@@ -579,3 +580,33 @@ TEST_CASE("test get descriptor", "[dataset][getDescriptor]")
 
     CHECK(descriptor.isReadOnly() == false);
 }
+
+//  const std::string& getFileName() const & noexcept;
+//  OpenMode getOpenMode() const noexcept;
+TEST_CASE("test get file name and open mode", "[dataset][getFileName][getOpenMode]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    {
+        BAG::Metadata metadata;
+        metadata.loadFromBuffer(kMetadataXML);
+
+        const auto dataset = Dataset::create(tmpFileName, std::move(metadata),
+            100, 6);
+        REQUIRE(dataset);
+
+        CHECK(dataset->getFileName() == static_cast<std::string>(tmpFileName));
+        CHECK(dataset->getOpenMode() == BAG_OPEN_READ_WRITE);
+    }
+
+    const auto dataset = Dataset::open(tmpFileName, BAG_OPEN_READONLY);
+    REQUIRE(dataset);
+
+    CHECK(dataset->getFileName() == static_cast<std::string>(tmpFileName));
+    CHECK(dataset->getOpenMode() == BAG_OPEN_READONLY);
+
+    // A layer knows the Dataset it belongs to.
+    const auto pLayer = dataset->getSimpleLayer(Elevation);
+    REQUIRE(pLayer);
+    CHECK(pLayer->getDataset().lock() == dataset);
+}
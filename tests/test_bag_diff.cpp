@@ -0,0 +1,183 @@
+
+#include "test_utils.h"
+#include <bag_dataset.h>
+#include <bag_diff.h>
+#include <bag_exceptions.h>
+#include <bag_simplelayer.h>
+
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <string>
+#include <vector>
+
+
+using BAG::ChunkChange;
+using BAG::Dataset;
+using BAG::SurfaceDiff;
+
+namespace {
+
+constexpr uint32_t kRows = 100;
+constexpr uint32_t kColumns = 100;
+constexpr uint64_t kChunkSize = 32;
+
+//! Create a BAG of the sample grid at 10 m, with a flat base surface.
+/*!
+\param fileName
+    The name of the BAG.
+\param update
+    Raise a 10x10 block by 2 m and remove one elevation.
+\param columnOffset
+    The number of columns to move the grid east.
+*/
+std::shared_ptr<Dataset> createSurface(
+    const std::string& fileName,
+    bool update,
+    uint32_t columnOffset = 0)
+{
+    return TestUtils::createSurface(fileName, kRows, kColumns, kChunkSize,
+        [update](uint32_t row, uint32_t column) -> float {
+            if (!update)
+                return -10.f;
+            if (row == 90 && column == 90)
+                return BAG_NULL_ELEVATION;
+
+            return row >= 40 && row < 50 && column >= 40 && column < 50 ?
+                -8.f : -10.f;
+        }, false, columnOffset);
+}
+
+//! Read one value of a layer.
+float readCell(
+    const Dataset& dataset,
+    BAG::LayerType type,
+    uint32_t row,
+    uint32_t column)
+{
+    const auto buffer = dataset.getSimpleLayer(type)->read(row, column, row,
+        column);
+
+    return *reinterpret_cast<const float*>(buffer.data());
+}
+
+//! Count the chunks that changed.
+size_t countChanged(const std::vector<ChunkChange>& changes)
+{
+    size_t numChanged = 0;
+    for (const auto& change : changes)
+        if (change.numChanged > 0)
+            ++numChanged;
+
+    return numChanged;
+}
+
+}  // namespace
+
+//  static std::vector<ChunkChange> diff(...);
+TEST_CASE("test surface diff", "[diff][statistics]")
+{
+    const TestUtils::RandomFileGuard baseFileName;
+    const TestUtils::RandomFileGuard updatedFileName;
+    const TestUtils::RandomFileGuard differenceFileName;
+
+    const auto pBase = createSurface(baseFileName, false);
+    const auto pUpdated = createSurface(updatedFileName, true);
+
+    const auto changes = SurfaceDiff::diff(*pBase, *pUpdated,
+        differenceFileName, {}, 0.01f, 6, 4);
+
+    // A 4x4 grid of chunks; the block and the lost elevation each touch one.
+    REQUIRE(changes.size() == 16);
+    CHECK(countChanged(changes) == 2);
+
+    const auto& block = changes[5];
+    CHECK(block.rowStart == 32);
+    CHECK(block.columnStart == 32);
+    CHECK(block.rowEnd == 63);
+    CHECK(block.columnEnd == 63);
+    CHECK(block.numCompared == 32 * 32);
+    CHECK(block.numChanged == 100);
+    CHECK(block.minDifference == 0.f);
+    CHECK(block.maxDifference == 2.f);
+    CHECK(block.meanDifference == Catch::Approx(200. / (32 * 32)));
+
+    const auto& lost = changes[10];
+    CHECK(lost.numCompared == 32 * 32 - 1);
+    CHECK(lost.numChanged == 1);
+
+    CHECK(changes.back().rowEnd == kRows - 1);
+    CHECK(changes.back().columnEnd == kColumns - 1);
+    CHECK(changes.back().numChanged == 0);
+
+    // The difference BAG.
+    const auto pDifference = Dataset::open(differenceFileName,
+        BAG_OPEN_READONLY);
+    REQUIRE(pDifference);
+
+    CHECK(readCell(*pDifference, Elevation, 0, 0) == 0.f);
+    CHECK(readCell(*pDifference, Elevation, 45, 45) == 2.f);
+    CHECK(readCell(*pDifference, Uncertainty, 45, 45) ==
+        Catch::Approx(std::sqrt(2.f)));
+    CHECK(readCell(*pDifference, Elevation, 90, 90) == BAG_NULL_ELEVATION);
+    CHECK(readCell(*pDifference, Uncertainty, 90, 90) == BAG_NULL_UNCERTAINTY);
+
+    // Changes within the tolerance are not counted.
+    CHECK(countChanged(SurfaceDiff::diff(*pBase, *pUpdated, {}, {}, 3.f)) == 1);
+}
+
+//  static std::vector<ChunkChange> applyPatch(...);
+TEST_CASE("test surface patch", "[diff][applyPatch]")
+{
+    const TestUtils::RandomFileGuard baseFileName;
+    const TestUtils::RandomFileGuard updatedFileName;
+    const TestUtils::RandomFileGuard targetFileName;
+    const TestUtils::RandomFileGuard patchFileName;
+
+    const auto pBase = createSurface(baseFileName, false);
+    const auto pUpdated = createSurface(updatedFileName, true);
+
+    SurfaceDiff::diff(*pBase, *pUpdated, {}, patchFileName, 0.f, 6, 4);
+
+    // A copy of the base, with its coverage cached.
+    auto pTarget = createSurface(targetFileName, false);
+    CHECK(pTarget->getCoverage().getNumCells() == kRows * kColumns);
+
+    const auto applied = SurfaceDiff::applyPatch(*pTarget, patchFileName, 4);
+    REQUIRE(applied.size() == 2);
+    CHECK(applied[0].rowStart == 32);
+    CHECK(applied[0].numChanged == 100);
+    CHECK(applied[1].rowStart == 64);
+    CHECK(applied[1].numChanged == 1);
+
+    CHECK(readCell(*pTarget, Elevation, 0, 0) == -10.f);
+    CHECK(readCell(*pTarget, Elevation, 45, 45) == -8.f);
+    CHECK(readCell(*pTarget, Elevation, 90, 90) == BAG_NULL_ELEVATION);
+    CHECK(pTarget->getCoverage().getNumCells() == kRows * kColumns - 1);
+
+    const auto minMax = pTarget->getSimpleLayer(Elevation)->getDescriptor()->getMinMax();
+    CHECK(std::get<1>(minMax) >= -8.f);
+
+    // The target now matches the update.
+    CHECK(countChanged(SurfaceDiff::diff(*pTarget, *pUpdated, {}, {})) == 0);
+}
+
+//  static std::vector<ChunkChange> applyPatch(...);
+TEST_CASE("test surface patch mismatch", "[diff][PatchMismatch]")
+{
+    const TestUtils::RandomFileGuard baseFileName;
+    const TestUtils::RandomFileGuard updatedFileName;
+    const TestUtils::RandomFileGuard otherFileName;
+    const TestUtils::RandomFileGuard patchFileName;
+
+    const auto pBase = createSurface(baseFileName, false);
+    const auto pUpdated = createSurface(updatedFileName, true);
+    SurfaceDiff::diff(*pBase, *pUpdated, {}, patchFileName);
+
+    auto pOther = createSurface(otherFileName, false, 10);
+
+    REQUIRE_THROWS_AS(SurfaceDiff::applyPatch(*pOther, patchFileName),
+        BAG::PatchMismatch);
+    REQUIRE_THROWS_AS(SurfaceDiff::diff(*pBase, *pOther, {}, {}),
+        BAG::IncompatibleGrids);
+}
+
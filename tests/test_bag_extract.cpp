@@ -0,0 +1,394 @@
+#include "test_utils.h"
+#include <bag_dataset.h>
+#include <bag_exceptions.h>
+#include <bag_extract.h>
+#include <bag_georefmetadatalayer.h>
+#include <bag_georefmetadatalayerdescriptor.h>
+#include <bag_layerdescriptor.h>
+#include <bag_metadata.h>
+#include <bag_simplelayer.h>
+#include <bag_trackinglist.h>
+#include <bag_trackinglistreader.h>
+#include <bag_valuetable.h>
+#include <bag_vrmetadata.h>
+#include <bag_vrnode.h>
+#include <bag_vrrefinements.h>
+#include <bag_vrrefinementsdescriptor.h>
+#include <bag_vrtrackinglist.h>
+
+#include <catch2/catch_all.hpp>
+#include <cstdlib>  // std::getenv
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+using BAG::Dataset;
+using BAG::Extractor;
+
+namespace {
+
+constexpr uint32_t kRows = 100;
+constexpr uint32_t kColumns = 100;
+constexpr uint64_t kChunkSize = 32;
+
+//! Create a BAG of the sample grid with a sloping surface and a tracking list.
+std::shared_ptr<Dataset> createSurface(
+    const std::string& fileName)
+{
+    auto pDataset = TestUtils::createSurface(fileName, kRows, kColumns,
+        kChunkSize);
+
+    auto& trackingList = pDataset->getTrackingList();
+    trackingList.push_back(BAG::TrackingItem{10, 10, -1.f, 0.5f, 1, 1});
+    trackingList.push_back(BAG::TrackingItem{40, 70, -2.f, 0.5f, 2, 1});
+    trackingList.push_back(BAG::TrackingItem{90, 20, -3.f, 0.5f, 3, 1});
+    trackingList.write();
+
+    return pDataset;
+}
+
+//! Extract a window of nodes, using a box slightly larger than the nodes.
+std::shared_ptr<Dataset> extractNodes(
+    const Dataset& dataset,
+    uint32_t rowStart,
+    uint32_t columnStart,
+    uint32_t rowEnd,
+    uint32_t columnEnd,
+    const std::string& outFileName,
+    unsigned int numThreads = 0)
+{
+    const auto& metadata = dataset.getMetadata();
+    const double llX = metadata.llCornerX();
+    const double llY = metadata.llCornerY();
+    const double resX = metadata.columnResolution();
+    const double resY = metadata.rowResolution();
+
+    return dataset.extract(llX + (columnStart - 0.25) * resX,
+        llY + (rowStart - 0.25) * resY, llX + (columnEnd + 0.25) * resX,
+        llY + (rowEnd + 0.25) * resY, outFileName, numThreads);
+}
+
+//! Check a simple layer of an extracted BAG holds a window of the source.
+void checkWindow(
+    const Dataset& source,
+    const Dataset& extracted,
+    BAG::LayerType type,
+    uint32_t rowStart,
+    uint32_t columnStart,
+    uint32_t rowEnd,
+    uint32_t columnEnd)
+{
+    const auto expected = source.getSimpleLayer(type)->read(rowStart,
+        columnStart, rowEnd, columnEnd);
+    const auto actual = extracted.getSimpleLayer(type)->read(0, 0,
+        rowEnd - rowStart, columnEnd - columnStart);
+
+    REQUIRE(actual.size() == expected.size());
+    CHECK(std::memcmp(actual.data(), expected.data(), actual.size()) == 0);
+}
+
+//! Read a georeferenced metadata key of any key type.
+uint64_t getKey(
+    const uint8_t* keys,
+    size_t index,
+    size_t keySize)
+{
+    uint64_t key = 0;
+    switch (keySize)
+    {
+    case 1:
+        key = keys[index];
+        break;
+    case 2:
+        key = reinterpret_cast<const uint16_t*>(keys)[index];
+        break;
+    case 4:
+        key = reinterpret_cast<const uint32_t*>(keys)[index];
+        break;
+    default:
+        key = reinterpret_cast<const uint64_t*>(keys)[index];
+        break;
+    }
+
+    return key;
+}
+
+}  // namespace
+
+//  static std::shared_ptr<Dataset> extract(...);
+TEST_CASE("test extract aligned window", "[extract][raw]")
+{
+    const TestUtils::RandomFileGuard sourceFileName;
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pSource = createSurface(sourceFileName);
+    const auto pExtracted = extractNodes(*pSource, 32, 64, 95, 99, outFileName,
+        4);
+    REQUIRE(pExtracted);
+
+    const auto& metadata = pExtracted->getMetadata();
+    const auto& sourceMetadata = pSource->getMetadata();
+    CHECK(metadata.rows() == 64);
+    CHECK(metadata.columns() == 36);
+    CHECK(metadata.llCornerX() == Catch::Approx(sourceMetadata.llCornerX() +
+        64 * sourceMetadata.columnResolution()));
+    CHECK(metadata.llCornerY() == Catch::Approx(sourceMetadata.llCornerY() +
+        32 * sourceMetadata.rowResolution()));
+
+    for (const auto type : {Elevation, Uncertainty})
+        checkWindow(*pSource, *pExtracted, type, 32, 64, 95, 99);
+
+    // The range is that of the window.
+    const auto minMax =
+        pExtracted->getSimpleLayer(Elevation)->getDescriptor()->getMinMax();
+    CHECK(std::get<0>(minMax) ==
+        Catch::Approx(TestUtils::surfaceElevation(9599)));
+    CHECK(std::get<1>(minMax) ==
+        Catch::Approx(TestUtils::surfaceElevation(3264)));
+
+    // Only the tracking list item inside the box is kept.
+    const auto& trackingList = pExtracted->getTrackingList();
+    REQUIRE(trackingList.size() == 1);
+    CHECK(trackingList[0].row == 8);
+    CHECK(trackingList[0].col == 6);
+    CHECK(trackingList[0].track_code == 2);
+
+    // The output must not exist.
+    REQUIRE_THROWS(extractNodes(*pSource, 32, 64, 95, 99, outFileName));
+}
+
+TEST_CASE("test extract streamed tracking list", "[extract][stream]")
+{
+    const TestUtils::RandomFileGuard sourceFileName;
+    const TestUtils::RandomFileGuard outFileName;
+
+    createSurface(sourceFileName)->close();
+
+    const auto pSource = Dataset::open(sourceFileName, BAG_OPEN_READONLY,
+        true);
+    REQUIRE(pSource);
+    REQUIRE_FALSE(pSource->getTrackingList().isLoaded());
+
+    const auto pExtracted = extractNodes(*pSource, 32, 64, 95, 99, outFileName);
+    REQUIRE(pExtracted);
+
+    // The item inside the box is found on disk.
+    const auto& trackingList = pExtracted->getTrackingList();
+    REQUIRE(trackingList.size() == 1);
+    CHECK(trackingList[0].row == 8);
+    CHECK(trackingList[0].col == 6);
+    CHECK(trackingList[0].track_code == 2);
+}
+
+//  static std::shared_ptr<Dataset> extract(...);
+TEST_CASE("test extract unaligned window", "[extract][transcode]")
+{
+    const TestUtils::RandomFileGuard sourceFileName;
+
+    const auto pSource = createSurface(sourceFileName);
+
+    for (unsigned int numThreads : {1u, 4u})
+    {
+        const TestUtils::RandomFileGuard outFileName;
+
+        const auto pExtracted = extractNodes(*pSource, 5, 7, 40, 58,
+            outFileName, numThreads);
+        REQUIRE(pExtracted);
+
+        CHECK(pExtracted->getMetadata().rows() == 36);
+        CHECK(pExtracted->getMetadata().columns() == 52);
+
+        for (const auto type : {Elevation, Uncertainty})
+            checkWindow(*pSource, *pExtracted, type, 5, 7, 40, 58);
+
+        const auto& trackingList = pExtracted->getTrackingList();
+        REQUIRE(trackingList.size() == 1);
+        CHECK(trackingList[0].row == 5);
+        CHECK(trackingList[0].col == 3);
+    }
+}
+
+//  static std::shared_ptr<Dataset> extract(...);
+TEST_CASE("test extract outside the grid", "[extract][EmptyExtraction]")
+{
+    const TestUtils::RandomFileGuard sourceFileName;
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pSource = createSurface(sourceFileName);
+    const auto& metadata = pSource->getMetadata();
+    const double llX = metadata.llCornerX();
+    const double llY = metadata.llCornerY();
+
+    REQUIRE_THROWS_AS(pSource->extract(llX - 100., llY, llX - 50., llY + 100.,
+        outFileName), BAG::EmptyExtraction);
+
+    // Between two nodes.
+    const double resX = metadata.columnResolution();
+    REQUIRE_THROWS_AS(pSource->extract(llX + 0.25 * resX, llY,
+        llX + 0.75 * resX, llY + 100., outFileName), BAG::EmptyExtraction);
+}
+
+//  static std::shared_ptr<Dataset> extract(...);
+TEST_CASE("test extract VR", "[extract][VR]")
+{
+    const TestUtils::RandomFileGuard sourceFileName;
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pSource = createSurface(sourceFileName);
+    pSource->createVR(kChunkSize, 6, true);
+
+    // Every third supercell is not refined; the others have 2 by 2 nodes.
+    std::vector<BAG::VRMetadataItem> supercells(kRows * kColumns);
+    std::vector<BAG::VRRefinementsItem> sourceRefinements;
+    std::vector<BAG::VRNodeItem> sourceNodes;
+    for (uint32_t i = 0; i < kRows * kColumns; ++i)
+    {
+        if (i % 3 == 0)
+            continue;
+
+        supercells[i] = {static_cast<uint32_t>(sourceRefinements.size()), 2, 2,
+            1.f, 1.f, 0.f, 0.f};
+        for (uint32_t node = 0; node < 4; ++node)
+        {
+            sourceRefinements.push_back({-static_cast<float>(i), 0.5f});
+            sourceNodes.push_back({1.f, 1, i});
+        }
+    }
+
+    pSource->getVRMetadata()->write(0, 0, kRows - 1, kColumns - 1,
+        reinterpret_cast<const uint8_t*>(supercells.data()));
+    pSource->getVRRefinements()->write(0, 0, 0,
+        static_cast<uint32_t>(sourceRefinements.size() - 1),
+        reinterpret_cast<const uint8_t*>(sourceRefinements.data()));
+    pSource->getVRNode()->write(0, 0, 0,
+        static_cast<uint32_t>(sourceNodes.size() - 1),
+        reinterpret_cast<const uint8_t*>(sourceNodes.data()));
+
+    auto& vrTrackingList = *pSource->getVRTrackingList();
+    vrTrackingList.push_back(BAG::VRTrackingItem{45, 25, 1, 0, -1.f, 0.5f, 1, 1});
+    vrTrackingList.push_back(BAG::VRTrackingItem{10, 10, 1, 1, -2.f, 0.5f, 2, 1});
+    vrTrackingList.write();
+
+    constexpr uint32_t kRowStart = 40;
+    constexpr uint32_t kColumnStart = 20;
+    constexpr uint32_t kRowEnd = 70;
+    constexpr uint32_t kColumnEnd = 50;
+    constexpr uint32_t kWindowRows = kRowEnd - kRowStart + 1;
+    constexpr uint32_t kWindowColumns = kColumnEnd - kColumnStart + 1;
+
+    const auto pExtracted = extractNodes(*pSource, kRowStart, kColumnStart,
+        kRowEnd, kColumnEnd, outFileName);
+    REQUIRE(pExtracted);
+
+    const auto pMetadata = pExtracted->getVRMetadata();
+    const auto pRefinements = pExtracted->getVRRefinements();
+    const auto pNode = pExtracted->getVRNode();
+    REQUIRE(pMetadata);
+    REQUIRE(pRefinements);
+    REQUIRE(pNode);
+
+    const auto buffer = pMetadata->read(0, 0, kWindowRows - 1,
+        kWindowColumns - 1);
+    const auto* items =
+        reinterpret_cast<const BAG::VRMetadataItem*>(buffer.data());
+
+    // Each supercell has the refinements it had in the source, packed.
+    uint32_t numRefinements = 0;
+    for (uint32_t row = 0; row < kWindowRows; ++row)
+    {
+        for (uint32_t column = 0; column < kWindowColumns; ++column)
+        {
+            const auto& item = items[row * kWindowColumns + column];
+            const uint32_t sourceIndex = (row + kRowStart) * kColumns +
+                column + kColumnStart;
+            const auto& sourceItem = supercells[sourceIndex];
+
+            CHECK(item.dimensions_x == sourceItem.dimensions_x);
+            CHECK(item.dimensions_y == sourceItem.dimensions_y);
+
+            const uint32_t count = item.dimensions_x * item.dimensions_y;
+            if (count == 0)
+                continue;
+
+            CHECK(item.index == numRefinements);
+            numRefinements += count;
+
+            const auto refinements = pRefinements->read(0, item.index, 0,
+                item.index + count - 1);
+            const auto* refinementItems =
+                reinterpret_cast<const BAG::VRRefinementsItem*>(
+                    refinements.data());
+            CHECK(refinementItems[0].depth == -static_cast<float>(sourceIndex));
+
+            const auto nodes = pNode->read(0, item.index, 0,
+                item.index + count - 1);
+            CHECK(reinterpret_cast<const BAG::VRNodeItem*>(
+                nodes.data())[count - 1].n_samples == sourceIndex);
+        }
+    }
+
+    REQUIRE(numRefinements > 0);
+    CHECK(std::get<1>(pRefinements->getDescriptor()->getDims()) ==
+        numRefinements);
+
+    // Only the VR tracking list item inside the box is kept.
+    const auto& extractedTrackingList = *pExtracted->getVRTrackingList();
+    REQUIRE(extractedTrackingList.size() == 1);
+    CHECK(extractedTrackingList[0].row == 5);
+    CHECK(extractedTrackingList[0].col == 5);
+    CHECK(extractedTrackingList[0].sub_row == 1);
+}
+
+//  static std::shared_ptr<Dataset> extract(...);
+TEST_CASE("test extract georeferenced metadata",
+    "[extract][GeorefMetadataLayer]")
+{
+    const std::string bagFileName{std::string{std::getenv("BAG_SAMPLES_PATH")} +
+        "/bag_georefmetadata_layer.bag"};
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pSource = Dataset::open(bagFileName, BAG_OPEN_READONLY);
+    REQUIRE(pSource);
+
+    const auto sourceLayers = pSource->getGeorefMetadataLayers();
+    REQUIRE(!sourceLayers.empty());
+
+    const auto& sourceMetadata = pSource->getMetadata();
+    const uint32_t rowEnd = sourceMetadata.rows() / 2;
+    const uint32_t columnEnd = sourceMetadata.columns() / 2;
+
+    const auto pExtracted = extractNodes(*pSource, 0, 0, rowEnd, columnEnd,
+        outFileName);
+    REQUIRE(pExtracted);
+
+    const auto layers = pExtracted->getGeorefMetadataLayers();
+    REQUIRE(layers.size() == sourceLayers.size());
+
+    const auto& sourceLayer = *sourceLayers[0];
+    const auto& layer = *layers[0];
+    const auto keySize = layer.getDescriptor()->getElementSize();
+    CHECK(keySize == sourceLayer.getDescriptor()->getElementSize());
+
+    const auto keys = layer.read(0, 0, rowEnd, columnEnd);
+    const auto sourceKeys = sourceLayer.read(0, 0, rowEnd, columnEnd);
+    REQUIRE(keys.size() == sourceKeys.size());
+
+    // Every key refers to a record equal to the one it referred to.
+    const auto& records = layer.getValueTable().getRecords();
+    const auto& sourceRecords = sourceLayer.getValueTable().getRecords();
+    CHECK(records.size() <= sourceRecords.size());
+
+    for (size_t i = 0; i < keys.size() / keySize; ++i)
+    {
+        const auto key = getKey(keys.data(), i, keySize);
+        const auto sourceKey = getKey(sourceKeys.data(), i, keySize);
+        CHECK((key == 0) == (sourceKey == 0));
+        if (key == 0)
+            continue;
+
+        REQUIRE(key < records.size());
+        CHECK(records[key] == sourceRecords[sourceKey]);
+    }
+}
+
@@ -6,7 +6,9 @@
 
 #include <array>
 #include <catch2/catch_all.hpp>
+#include <cstdint>
 #include <cstdlib>  // std::getenv
+#include <cstring>
 #include <string>
 
 
@@ -43,3 +45,92 @@ TEST_CASE("test interleaved legacy layer read", "[interleavedlegacylayer][read]"
         CHECK(kExpectedBuffer[i] == Approx(floats[i]));
 }
 
+
+//  virtual UInt8Array read(uint32_t rowStart,
+//      uint32_t columnStart, uint32_t rowEnd, uint32_t columnEnd) const;
+TEST_CASE("test interleaved legacy layers share read windows",
+    "[interleavedlegacylayer][read]")
+{
+    constexpr uint32_t kRows = 40;
+    constexpr uint32_t kColumns = 30;
+
+    const TestUtils::RandomFileGuard tmpFileName;
+    TestUtils::createLegacyBag(tmpFileName, kRows, kColumns);
+
+    const auto pDataset = Dataset::open(tmpFileName, BAG_OPEN_READONLY);
+    REQUIRE(pDataset);
+
+    // Check a window of a layer against the records written.
+    const auto checkWindow = [&pDataset](BAG::LayerType type, uint32_t rowStart,
+        uint32_t columnStart, uint32_t rowEnd, uint32_t columnEnd) {
+        INFO("Layer type " << type << " window " << rowStart << ',' <<
+            columnStart << " to " << rowEnd << ',' << columnEnd);
+
+        const auto buffer = pDataset->getLayer(type).read(rowStart,
+            columnStart, rowEnd, columnEnd);
+        REQUIRE(buffer);
+
+        const auto* values = buffer.data();
+        for (uint32_t row = rowStart; row <= rowEnd; ++row)
+        {
+            for (uint32_t column = columnStart; column <= columnEnd; ++column)
+            {
+                const auto i = row * kColumns + column;
+                const auto node = TestUtils::legacyNodeRecord(i);
+                const auto elevation = TestUtils::legacyElevationRecord(i);
+
+                float floatValue = 0.f;
+                uint32_t uintValue = 0;
+                int32_t intValue = 0;
+
+                switch (type)
+                {
+                case Hypothesis_Strength:
+                    std::memcpy(&floatValue, values, sizeof(float));
+                    CHECK(floatValue == node.hyp_strength);
+                    break;
+                case Num_Hypotheses:
+                    std::memcpy(&uintValue, values, sizeof(uint32_t));
+                    CHECK(uintValue == node.num_hypotheses);
+                    break;
+                case Shoal_Elevation:
+                    std::memcpy(&floatValue, values, sizeof(float));
+                    CHECK(floatValue == elevation.shoal_elevation);
+                    break;
+                case Std_Dev:
+                    std::memcpy(&floatValue, values, sizeof(float));
+                    CHECK(floatValue == elevation.stddev);
+                    break;
+                case Num_Soundings:
+                    std::memcpy(&intValue, values, sizeof(int32_t));
+                    CHECK(intValue == elevation.num_soundings);
+                    break;
+                default:
+                    FAIL("Unexpected layer type");
+                }
+
+                values += 4;
+            }
+        }
+    };
+
+    // Every layer of each group, over the same window.
+    for (const auto type : {Hypothesis_Strength, Num_Hypotheses,
+        Shoal_Elevation, Std_Dev, Num_Soundings})
+        checkWindow(type, 5, 3, 25, 20);
+
+    // Windows inside, overlapping and outside the one read.
+    checkWindow(Num_Hypotheses, 6, 4, 6, 4);
+    checkWindow(Std_Dev, 10, 3, 25, 10);
+    checkWindow(Shoal_Elevation, 20, 15, 39, 29);
+    checkWindow(Num_Soundings, 0, 0, kRows - 1, kColumns - 1);
+    checkWindow(Hypothesis_Strength, 0, 0, 4, 2);
+
+    // Interleave the groups, evicting the windows read.
+    for (uint32_t row = 0; row < kRows; row += 4)
+    {
+        checkWindow(Shoal_Elevation, row, 0, row + 3, 9);
+        checkWindow(Hypothesis_Strength, row, 10, row + 3, 29);
+        checkWindow(Num_Soundings, row, 0, row + 3, 9);
+    }
+}
@@ -0,0 +1,187 @@
+
+#include "test_utils.h"
+#include <bag_dataset.h>
+#include <bag_exceptions.h>
+#include <bag_layerdescriptor.h>
+#include <bag_merge.h>
+#include <bag_metadata.h>
+#include <bag_simplelayer.h>
+
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <cstdlib>  // std::getenv
+#include <string>
+#include <vector>
+
+
+using BAG::Dataset;
+using BAG::Merger;
+using BAG::MergeRule;
+using BAG::Metadata;
+
+namespace {
+
+constexpr uint32_t kRows = 100;
+constexpr uint32_t kColumns = 100;
+constexpr double kResolution = 10.;
+constexpr double kLlCornerX = 687910.;
+constexpr double kLlCornerY = 5554620.;
+
+//! Create a BAG full of one elevation and uncertainty.
+/*!
+\param fileName
+    The name of the BAG.
+\param rowOffset
+    The number of rows to move the sample grid north.
+\param columnOffset
+    The number of columns to move the sample grid east.
+\param elevation
+    The elevation of every cell.
+\param uncertainty
+    The uncertainty of every cell.
+*/
+std::shared_ptr<const Dataset> createFlatBag(
+    const std::string& fileName,
+    double rowOffset,
+    double columnOffset,
+    float elevation,
+    float uncertainty)
+{
+    Metadata metadata;
+    metadata.loadFromFile(std::string{std::getenv("BAG_SAMPLES_PATH")} +
+        "/sample.xml");
+    metadata.setGridExtent(kRows, kColumns,
+        kLlCornerX + columnOffset * kResolution,
+        kLlCornerY + rowOffset * kResolution);
+
+    auto pDataset = Dataset::create(fileName, std::move(metadata), 32, 6);
+
+    const std::vector<float> elevations(kRows * kColumns, elevation);
+    pDataset->getSimpleLayer(Elevation)->write(0, 0, kRows - 1, kColumns - 1,
+        reinterpret_cast<const uint8_t*>(elevations.data()));
+
+    const std::vector<float> uncertainties(kRows * kColumns, uncertainty);
+    pDataset->getSimpleLayer(Uncertainty)->write(0, 0, kRows - 1, kColumns - 1,
+        reinterpret_cast<const uint8_t*>(uncertainties.data()));
+
+    return pDataset;
+}
+
+//! Read one value of a layer.
+float readCell(
+    const Dataset& dataset,
+    BAG::LayerType type,
+    uint32_t row,
+    uint32_t column)
+{
+    const auto buffer = dataset.getSimpleLayer(type)->read(row, column, row,
+        column);
+
+    return *reinterpret_cast<const float*>(buffer.data());
+}
+
+}  // namespace
+
+//  static std::shared_ptr<Dataset> merge(...);
+TEST_CASE("test merge priority", "[merge][priority]")
+{
+    const TestUtils::RandomFileGuard deepFileName;
+    const TestUtils::RandomFileGuard shoalFileName;
+
+    // The second BAG is 20 rows north and 50 columns east of the first.
+    const auto pDeep = createFlatBag(deepFileName, 0., 0., -10.f, 1.f);
+    const auto pShoal = createFlatBag(shoalFileName, 20., 50., -5.f, 2.f);
+
+    for (unsigned int numThreads : {1u, 4u})
+    {
+        const TestUtils::RandomFileGuard outFileName;
+
+        // A chunk size that does not divide the output or the inputs.
+        auto pMerged = Merger::merge({pDeep, pShoal}, outFileName,
+            MergeRule::Priority, 16, 6, numThreads);
+        REQUIRE(pMerged);
+
+        const auto& metadata = pMerged->getMetadata();
+        CHECK(metadata.rows() == kRows + 20);
+        CHECK(metadata.columns() == kColumns + 50);
+        CHECK(metadata.llCornerX() == Catch::Approx(kLlCornerX));
+        CHECK(metadata.llCornerY() == Catch::Approx(kLlCornerY));
+        CHECK(metadata.urCornerX() ==
+            Catch::Approx(kLlCornerX + (kColumns + 49) * kResolution));
+
+        // Only the first; both, first wins; only the second; neither.
+        CHECK(readCell(*pMerged, Elevation, 0, 0) == -10.f);
+        CHECK(readCell(*pMerged, Elevation, 50, 60) == -10.f);
+        CHECK(readCell(*pMerged, Uncertainty, 50, 60) == 1.f);
+        CHECK(readCell(*pMerged, Elevation, 110, 140) == -5.f);
+        CHECK(readCell(*pMerged, Elevation, 110, 10) == BAG_NULL_ELEVATION);
+        CHECK(readCell(*pMerged, Uncertainty, 110, 10) == BAG_NULL_UNCERTAINTY);
+
+        const auto minMax = pMerged->getSimpleLayer(Elevation)->getDescriptor()->getMinMax();
+        CHECK(std::get<0>(minMax) == -10.f);
+        CHECK(std::get<1>(minMax) == -5.f);
+
+        CHECK(pMerged->getCoverage().getNumCells() ==
+            2 * kRows * kColumns - 80 * 50);
+    }
+}
+
+//  static std::shared_ptr<Dataset> merge(...);
+TEST_CASE("test merge shoalest", "[merge][shoalest]")
+{
+    const TestUtils::RandomFileGuard deepFileName;
+    const TestUtils::RandomFileGuard shoalFileName;
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pDeep = createFlatBag(deepFileName, 0., 0., -10.f, 1.f);
+    const auto pShoal = createFlatBag(shoalFileName, 20., 50., -5.f, 2.f);
+
+    auto pMerged = Merger::merge({pDeep, pShoal}, outFileName,
+        MergeRule::Shoalest, 32, 6);
+    REQUIRE(pMerged);
+
+    CHECK(readCell(*pMerged, Elevation, 0, 0) == -10.f);
+    CHECK(readCell(*pMerged, Elevation, 50, 60) == -5.f);
+    CHECK(readCell(*pMerged, Uncertainty, 50, 60) == 2.f);
+}
+
+//  static std::shared_ptr<Dataset> merge(...);
+TEST_CASE("test merge uncertainty weighted", "[merge][weighted]")
+{
+    const TestUtils::RandomFileGuard deepFileName;
+    const TestUtils::RandomFileGuard shoalFileName;
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pDeep = createFlatBag(deepFileName, 0., 0., -10.f, 1.f);
+    const auto pShoal = createFlatBag(shoalFileName, 20., 50., -5.f, 2.f);
+
+    auto pMerged = Merger::merge({pDeep, pShoal}, outFileName,
+        MergeRule::UncertaintyWeighted, 32, 6);
+    REQUIRE(pMerged);
+
+    // Weights of 1 and 1/4.
+    CHECK(readCell(*pMerged, Elevation, 0, 0) == -10.f);
+    CHECK(readCell(*pMerged, Uncertainty, 0, 0) == 1.f);
+    CHECK(readCell(*pMerged, Elevation, 50, 60) == Catch::Approx(-9.f));
+    CHECK(readCell(*pMerged, Uncertainty, 50, 60) ==
+        Catch::Approx(std::sqrt(1. / 1.25)));
+    CHECK(readCell(*pMerged, Elevation, 110, 140) == -5.f);
+}
+
+//  static std::shared_ptr<Dataset> merge(...);
+TEST_CASE("test merge incompatible grids", "[merge][IncompatibleGrids]")
+{
+    const TestUtils::RandomFileGuard firstFileName;
+    const TestUtils::RandomFileGuard secondFileName;
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pFirst = createFlatBag(firstFileName, 0., 0., -10.f, 1.f);
+
+    // Half a cell off the grid of the first.
+    const auto pSecond = createFlatBag(secondFileName, 0., 10.5, -5.f, 2.f);
+
+    REQUIRE_THROWS_AS(Merger::merge({pFirst, pSecond}, outFileName),
+        BAG::IncompatibleGrids);
+    REQUIRE_THROWS_AS(Merger::merge({}, outFileName), BAG::DatasetNotFound);
+}
+
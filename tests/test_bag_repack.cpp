@@ -0,0 +1,205 @@
+
+#include "test_utils.h"
+#include <bag_dataset.h>
+#include <bag_diff.h>
+#include <bag_georefmetadatalayer.h>
+#include <bag_layerdescriptor.h>
+#include <bag_metadata.h>
+#include <bag_repack.h>
+#include <bag_simplelayer.h>
+#include <bag_valuetable.h>
+#include <bag_vrrefinements.h>
+#include <bag_vrrefinementsdescriptor.h>
+
+#include <catch2/catch_all.hpp>
+#include <cstdlib>  // std::getenv
+#include <cstring>
+#include <fstream>
+#include <H5Cpp.h>
+#include <string>
+#include <vector>
+
+
+using BAG::ChunkChange;
+using BAG::Dataset;
+using BAG::Repacker;
+using BAG::SurfaceDiff;
+
+namespace {
+
+constexpr uint32_t kRows = 100;
+constexpr uint32_t kColumns = 100;
+constexpr uint64_t kChunkSize = 32;
+
+//! Retrieve the size of a file, in bytes.
+std::streamoff getFileSize(const std::string& fileName)
+{
+    std::ifstream file{fileName, std::ios::binary | std::ios::ate};
+
+    return static_cast<std::streamoff>(file.tellg());
+}
+
+//! Count the chunks that changed.
+size_t countChanged(const std::vector<ChunkChange>& changes)
+{
+    size_t numChanged = 0;
+    for (const auto& change : changes)
+        if (change.numChanged > 0)
+            ++numChanged;
+
+    return numChanged;
+}
+
+}  // namespace
+
+//  static std::shared_ptr<Dataset> repack(...);
+TEST_CASE("test repack unchanged", "[repack][raw]")
+{
+    const TestUtils::RandomFileGuard sourceFileName;
+    const TestUtils::RandomFileGuard outFileName;
+
+    TestUtils::createSurface(sourceFileName, kRows, kColumns, kChunkSize, {},
+        true);
+
+    // The space of a removed DataSet is never returned by HDF5.
+    {
+        const ::H5::H5File h5file{sourceFileName, H5F_ACC_RDWR};
+        const hsize_t kScratchSize = 1 << 20;
+        const ::H5::DataSpace h5dataSpace{1, &kScratchSize};
+        const std::vector<uint8_t> scratch(kScratchSize, 1);
+        h5file.createDataSet("/BAG_root/scratch", ::H5::PredType::NATIVE_UINT8,
+            h5dataSpace).write(scratch.data(), ::H5::PredType::NATIVE_UINT8);
+
+        // Space freed at the end of the file would be truncated.
+        const hsize_t kTailSize = 1024;
+        const ::H5::DataSpace h5tailSpace{1, &kTailSize};
+        h5file.createDataSet("/BAG_root/tail", ::H5::PredType::NATIVE_UINT8,
+            h5tailSpace).write(scratch.data(), ::H5::PredType::NATIVE_UINT8);
+    }
+    {
+        const ::H5::H5File h5file{sourceFileName, H5F_ACC_RDWR};
+        h5file.unlink("/BAG_root/scratch");
+    }
+
+    const auto pSource = Dataset::open(sourceFileName, BAG_OPEN_READONLY);
+    const auto pRepacked = Repacker::repack(*pSource, outFileName);
+    REQUIRE(pRepacked);
+
+    CHECK(pRepacked->getDescriptor().isChecksummed());
+    CHECK(pRepacked->getLayerTypes() == pSource->getLayerTypes());
+    CHECK(pRepacked->getMetadata().rows() == kRows);
+
+    const auto& descriptor =
+        *pRepacked->getSimpleLayer(Elevation)->getDescriptor();
+    CHECK(descriptor.getChunkSize() == kChunkSize);
+    CHECK(descriptor.getCompressionLevel() == 6);
+    CHECK(descriptor.getMinMax() ==
+        pSource->getSimpleLayer(Elevation)->getDescriptor()->getMinMax());
+
+    CHECK(countChanged(SurfaceDiff::diff(*pSource, *pRepacked, {}, {})) == 0);
+    CHECK(pRepacked->verify().empty());
+
+    // The output must not exist.
+    REQUIRE_THROWS(Repacker::repack(*pSource, outFileName));
+
+    // The unused space is not carried over.
+    pSource->close();
+    pRepacked->close();
+    CHECK(getFileSize(sourceFileName) > (1 << 20));
+    CHECK(getFileSize(outFileName) < (1 << 20));
+}
+
+//  static std::shared_ptr<Dataset> repack(...);
+TEST_CASE("test repack rechunk", "[repack][transcode]")
+{
+    const TestUtils::RandomFileGuard sourceFileName;
+
+    const auto pSource = TestUtils::createSurface(sourceFileName, kRows,
+        kColumns, kChunkSize, {}, true);
+
+    for (unsigned int numThreads : {1u, 4u})
+    {
+        const TestUtils::RandomFileGuard outFileName;
+
+        const auto pRepacked = Repacker::repack(*pSource, outFileName, 64, 9,
+            numThreads);
+        REQUIRE(pRepacked);
+
+        for (const auto type : {Elevation, Uncertainty})
+        {
+            const auto& descriptor =
+                *pRepacked->getSimpleLayer(type)->getDescriptor();
+            CHECK(descriptor.getChunkSize() == 64);
+            CHECK(descriptor.getCompressionLevel() == 9);
+        }
+
+        CHECK(pRepacked->getDescriptor().isChecksummed());
+        CHECK(countChanged(SurfaceDiff::diff(*pSource, *pRepacked, {}, {})) == 0);
+        CHECK(pRepacked->verify().empty());
+    }
+}
+
+//  static std::shared_ptr<Dataset> repack(...);
+TEST_CASE("test repack VR", "[repack][VR]")
+{
+    const std::string bagFileName{std::string{std::getenv("BAG_SAMPLES_PATH")} +
+        "/test_vr.bag"};
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pSource = Dataset::open(bagFileName, BAG_OPEN_READONLY);
+    REQUIRE(pSource);
+
+    const auto pRepacked = Repacker::repack(*pSource, outFileName, 16, 1, 4);
+    REQUIRE(pRepacked);
+
+    CHECK(pRepacked->getLayerTypes().size() == pSource->getLayerTypes().size());
+    CHECK(pRepacked->getDescriptor().getVersion() == "1.6.2");
+
+    const auto pSourceRefinements = pSource->getVRRefinements();
+    const auto pRefinements = pRepacked->getVRRefinements();
+    REQUIRE(pRefinements);
+    CHECK(pRefinements->getDescriptor()->getDims() ==
+        pSourceRefinements->getDescriptor()->getDims());
+
+    const auto refinements = pRefinements->read(0, 0, 0, 555);
+    const auto sourceRefinements = pSourceRefinements->read(0, 0, 0, 555);
+    REQUIRE(refinements.size() == sourceRefinements.size());
+    CHECK(std::memcmp(refinements.data(), sourceRefinements.data(),
+        refinements.size()) == 0);
+
+    // The refinements are chunked a row of 16 x 16 records at a time.
+    CHECK(pRefinements->getDescriptor()->getChunkSize() == 256);
+    pRepacked->close();
+
+    const ::H5::H5File h5file{outFileName, H5F_ACC_RDONLY};
+    hsize_t chunkDims[2]{};
+    h5file.openDataSet("/BAG_root/varres_refinements").getCreatePlist()
+        .getChunk(2, chunkDims);
+    CHECK(chunkDims[0] == 1);
+    CHECK(chunkDims[1] == 256);
+}
+
+//  static std::shared_ptr<Dataset> repack(...);
+TEST_CASE("test repack georeferenced metadata", "[repack][GeorefMetadataLayer]")
+{
+    const std::string bagFileName{std::string{std::getenv("BAG_SAMPLES_PATH")} +
+        "/bag_georefmetadata_layer.bag"};
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pSource = Dataset::open(bagFileName, BAG_OPEN_READONLY);
+    REQUIRE(pSource);
+
+    const auto pRepacked = Repacker::repack(*pSource, outFileName, 0, 9);
+    REQUIRE(pRepacked);
+
+    const auto sourceLayers = pSource->getGeorefMetadataLayers();
+    const auto layers = pRepacked->getGeorefMetadataLayers();
+    REQUIRE(!sourceLayers.empty());
+    REQUIRE(layers.size() == sourceLayers.size());
+
+    const auto& records = layers[0]->getValueTable().getRecords();
+    const auto& sourceRecords = sourceLayers[0]->getValueTable().getRecords();
+    REQUIRE(records.size() == sourceRecords.size());
+    CHECK(records == sourceRecords);
+}
+
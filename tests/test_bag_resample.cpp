@@ -0,0 +1,222 @@
+#include "test_utils.h"
+#include <bag_dataset.h>
+#include <bag_exceptions.h>
+#include <bag_layerdescriptor.h>
+#include <bag_metadata.h>
+#include <bag_resample.h>
+#include <bag_simplelayer.h>
+#include <bag_vrindex.h>
+
+#include <algorithm>
+#include <catch2/catch_all.hpp>
+#include <cstdlib>  // std::getenv
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+using BAG::Dataset;
+using BAG::ResampleRule;
+using BAG::Resampler;
+
+namespace {
+
+constexpr uint32_t kRows = 20;
+constexpr uint32_t kColumns = 30;
+
+//! Read a whole float layer of a Dataset.
+std::vector<float> readLayer(
+    const Dataset& dataset,
+    BAG::LayerType type)
+{
+    const auto& metadata = dataset.getMetadata();
+    const auto buffer = dataset.getSimpleLayer(type)->read(0, 0,
+        metadata.rows() - 1, metadata.columns() - 1);
+    const auto* values = reinterpret_cast<const float*>(buffer.data());
+
+    return {values, values + metadata.rows() * metadata.columns()};
+}
+
+}  // namespace
+
+//  static std::shared_ptr<Dataset> resample(const Dataset& dataset,
+//      const std::string& outFileName, double resolution,
+//      ResampleRule rule = ResampleRule::Mean, uint64_t chunkSize = 100,
+//      int compressionLevel = 5, unsigned int numThreads = 0);
+TEST_CASE("test resample at the supercell resolution", "[resample]")
+{
+    const TestUtils::RandomFileGuard vrFileName;
+    const auto pDataset = TestUtils::createVRBag(vrFileName, kRows, kColumns);
+    const auto pIndex = pDataset->getVRIndex();
+    REQUIRE(pIndex);
+
+    const auto& metadata = pDataset->getMetadata();
+    const double resolution = metadata.columnResolution();
+    REQUIRE(metadata.rowResolution() == resolution);
+
+    for (const auto rule : {ResampleRule::Nearest, ResampleRule::Minimum,
+        ResampleRule::Mean})
+    {
+        INFO("Rule " << static_cast<int>(rule));
+
+        // Each cell holds the refinements of one supercell.
+        const TestUtils::RandomFileGuard outFileName;
+        const auto pOutput = Resampler::resample(*pDataset, outFileName,
+            resolution, rule, 8, 5, 3);
+        REQUIRE(pOutput);
+
+        const auto& outMetadata = pOutput->getMetadata();
+        REQUIRE(outMetadata.rows() == kRows);
+        REQUIRE(outMetadata.columns() == kColumns);
+        CHECK(outMetadata.llCornerX() == Approx(metadata.llCornerX()));
+        CHECK(outMetadata.llCornerY() == Approx(metadata.llCornerY()));
+        CHECK(outMetadata.rowResolution() == resolution);
+
+        const auto elevations = readLayer(*pOutput, Elevation);
+        const auto uncertainties = readLayer(*pOutput, Uncertainty);
+
+        for (uint32_t row = 0; row < kRows; ++row)
+        {
+            for (uint32_t column = 0; column < kColumns; ++column)
+            {
+                INFO("Cell " << row << ", " << column);
+                const auto i = row * kColumns + column;
+                const auto* pItem = pIndex->getSupercell(row, column);
+
+                if (!pItem)
+                {
+                    CHECK(elevations[i] == BAG_NULL_ELEVATION);
+                    CHECK(uncertainties[i] == BAG_NULL_UNCERTAINTY);
+                    continue;
+                }
+
+                const auto count = pItem->dimensions_x * pItem->dimensions_y;
+
+                switch (rule)
+                {
+                case ResampleRule::Nearest:
+                {
+                    // Only grids with a middle node have a single nearest one.
+                    if (pItem->dimensions_x % 2 == 0 ||
+                        pItem->dimensions_y % 2 == 0)
+                        break;
+
+                    const auto middle = pItem->index + (pItem->dimensions_y / 2) *
+                        pItem->dimensions_x + pItem->dimensions_x / 2;
+                    CHECK(elevations[i] ==
+                        TestUtils::vrRefinement(middle).depth);
+                    CHECK(uncertainties[i] ==
+                        TestUtils::vrRefinement(middle).depth_uncrt);
+                    break;
+                }
+                case ResampleRule::Minimum:
+                {
+                    const auto last = pItem->index + count - 1;
+                    CHECK(elevations[i] == TestUtils::vrRefinement(last).depth);
+                    CHECK(uncertainties[i] ==
+                        TestUtils::vrRefinement(last).depth_uncrt);
+                    break;
+                }
+                case ResampleRule::Mean:
+                {
+                    double depth = 0., uncertainty = 0.;
+                    for (uint32_t j = 0; j < count; ++j)
+                    {
+                        depth += TestUtils::vrRefinement(pItem->index + j).depth;
+                        uncertainty +=
+                            TestUtils::vrRefinement(pItem->index + j).depth_uncrt;
+                    }
+
+                    CHECK(elevations[i] == Approx(depth / count));
+                    CHECK(uncertainties[i] == Approx(uncertainty / count));
+                    break;
+                }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("test resample to a coarser grid", "[resample]")
+{
+    const TestUtils::RandomFileGuard vrFileName;
+    const auto pDataset = TestUtils::createVRBag(vrFileName, kRows, kColumns);
+    const auto pIndex = pDataset->getVRIndex();
+    REQUIRE(pIndex);
+
+    const auto& metadata = pDataset->getMetadata();
+    const double resolution = 2.5 * metadata.columnResolution();
+    const double westEdge = metadata.llCornerX() -
+        metadata.columnResolution() / 2.;
+    const double southEdge = metadata.llCornerY() -
+        metadata.rowResolution() / 2.;
+
+    // 20 x 30 supercells make 8 x 12 cells.
+    constexpr uint32_t kOutRows = 8;
+    constexpr uint32_t kOutColumns = 12;
+
+    const TestUtils::RandomFileGuard outFileName;
+    const auto pOutput = Resampler::resample(*pDataset, outFileName,
+        resolution, ResampleRule::Mean, 5);
+    REQUIRE(pOutput);
+    REQUIRE(pOutput->getMetadata().rows() == kOutRows);
+    REQUIRE(pOutput->getMetadata().columns() == kOutColumns);
+
+    // Bin every node the slow way.
+    std::vector<double> sums(kOutRows * kOutColumns, 0.);
+    std::vector<uint32_t> counts(kOutRows * kOutColumns, 0);
+    for (uint32_t row = 0; row < kRows; ++row)
+        for (uint32_t column = 0; column < kColumns; ++column)
+        {
+            const auto* pItem = pIndex->getSupercell(row, column);
+            if (!pItem)
+                continue;
+
+            for (uint32_t subRow = 0; subRow < pItem->dimensions_y; ++subRow)
+                for (uint32_t subColumn = 0; subColumn < pItem->dimensions_x;
+                    ++subColumn)
+                {
+                    double x = 0., y = 0.;
+                    std::tie(x, y) = pIndex->getNodePosition(row, column,
+                        subRow, subColumn);
+
+                    const auto cell = static_cast<uint32_t>(
+                        (y - southEdge) / resolution) * kOutColumns +
+                        static_cast<uint32_t>((x - westEdge) / resolution);
+
+                    sums[cell] += TestUtils::vrRefinement(pItem->index +
+                        subRow * pItem->dimensions_x + subColumn).depth;
+                    ++counts[cell];
+                }
+        }
+
+    const auto elevations = readLayer(*pOutput, Elevation);
+    for (uint32_t i = 0; i < kOutRows * kOutColumns; ++i)
+    {
+        INFO("Cell " << i);
+        REQUIRE(counts[i] > 0);
+        CHECK(elevations[i] == Approx(sums[i] / counts[i]));
+    }
+
+    float minValue = 0.f, maxValue = 0.f;
+    std::tie(minValue, maxValue) =
+        pOutput->getSimpleLayer(Elevation)->getDescriptor()->getMinMax();
+    CHECK(minValue == *std::min_element(elevations.begin(), elevations.end()));
+    CHECK(maxValue == *std::max_element(elevations.begin(), elevations.end()));
+}
+
+TEST_CASE("test resample errors", "[resample]")
+{
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pSample = Dataset::open(std::string{std::getenv(
+        "BAG_SAMPLES_PATH")} + "/sample.bag", BAG_OPEN_READONLY);
+    REQUIRE(pSample);
+    REQUIRE_THROWS_AS(Resampler::resample(*pSample, outFileName, 10.),
+        BAG::LayerNotFound);
+
+    const TestUtils::RandomFileGuard vrFileName;
+    const auto pDataset = TestUtils::createVRBag(vrFileName, kRows, kColumns);
+    REQUIRE_THROWS_AS(Resampler::resample(*pDataset, outFileName, 0.),
+        BAG::InvalidResolution);
+}
@@ -0,0 +1,354 @@
+#include "test_utils.h"
+#include <bag.h>
+#include <bag_dataset.h>
+#include <bag_exceptions.h>
+#include <bag_metadata.h>
+#include <bag_revert.h>
+#include <bag_simplelayer.h>
+#include <bag_trackinglist.h>
+#include <bag_vrmetadata.h>
+#include <bag_vrnode.h>
+#include <bag_vrrefinements.h>
+#include <bag_vrtrackinglist.h>
+
+#include <catch2/catch_all.hpp>
+#include <H5Cpp.h>
+#include <string>
+#include <vector>
+
+
+using BAG::Dataset;
+using BAG::RevertFilter;
+
+namespace {
+
+constexpr uint32_t kRows = 100;
+constexpr uint32_t kColumns = 100;
+constexpr uint64_t kChunkSize = 20;
+
+//! The elevation of a node before any edit.
+float originalElevation(uint32_t row, uint32_t column) noexcept
+{
+    return TestUtils::surfaceElevation(row * kColumns + column);
+}
+
+//! Create a BAG of the sample grid with a sloping surface.
+std::shared_ptr<Dataset> createSurface(
+    const std::string& fileName)
+{
+    return TestUtils::createSurface(fileName, kRows, kColumns, kChunkSize);
+}
+
+//! Read a node of a simple layer.
+float readNode(
+    const Dataset& dataset,
+    BAG::LayerType type,
+    uint32_t row,
+    uint32_t column)
+{
+    const auto buffer = dataset.getSimpleLayer(type)->read(row, column, row,
+        column);
+
+    return *reinterpret_cast<const float*>(buffer.data());
+}
+
+//! Edit a node, recording its value before the edit in the tracking list.
+void editNode(
+    Dataset& dataset,
+    uint32_t row,
+    uint32_t column,
+    float elevation,
+    uint8_t code,
+    uint16_t series)
+{
+    dataset.getTrackingList().push_back(BAG::TrackingItem{row, column,
+        readNode(dataset, Elevation, row, column),
+        readNode(dataset, Uncertainty, row, column), code, series});
+
+    const float uncertainty = 2.f;
+    dataset.getSimpleLayer(Elevation)->write(row, column, row, column,
+        reinterpret_cast<const uint8_t*>(&elevation));
+    dataset.getSimpleLayer(Uncertainty)->write(row, column, row, column,
+        reinterpret_cast<const uint8_t*>(&uncertainty));
+}
+
+}  // namespace
+
+//  static size_t revert(...);
+TEST_CASE("test revert edits", "[revert]")
+{
+    const TestUtils::RandomFileGuard fileName;
+    const auto pDataset = createSurface(fileName);
+
+    // The first session edits nodes in several chunks, one of them twice.
+    editNode(*pDataset, 5, 5, -1.f, 1, 1);
+    editNode(*pDataset, 5, 5, -2.f, 1, 1);
+    editNode(*pDataset, 50, 70, -3.f, 2, 1);
+    editNode(*pDataset, 99, 99, -4.f, 1, 1);
+
+    // The second session edits one of them again, and a new node.
+    editNode(*pDataset, 50, 70, -5.f, 1, 2);
+    editNode(*pDataset, 21, 40, -6.f, 1, 2);
+    pDataset->getTrackingList().write();
+
+    UNSCOPED_INFO("Check reverting the second session keeps the first.");
+    RevertFilter filter;
+    filter.filterSeries = true;
+    filter.series = 2;
+    CHECK(pDataset->revertEdits(filter, 4) == 2);
+
+    CHECK(readNode(*pDataset, Elevation, 50, 70) == -3.f);
+    CHECK(readNode(*pDataset, Uncertainty, 50, 70) == 2.f);
+    CHECK(readNode(*pDataset, Elevation, 21, 40) == originalElevation(21, 40));
+    CHECK(readNode(*pDataset, Uncertainty, 21, 40) == 1.f);
+    CHECK(readNode(*pDataset, Elevation, 5, 5) == -2.f);
+    CHECK(pDataset->getTrackingList().size() == 4);
+
+    UNSCOPED_INFO("Check the code and box criteria combine.");
+    filter = {};
+    filter.filterCode = true;
+    filter.code = 1;
+    filter.filterBox = true;
+    filter.rowStart = 0;
+    filter.columnStart = 0;
+    filter.rowEnd = 60;
+    filter.columnEnd = 80;
+    CHECK(pDataset->revertEdits(filter) == 2);
+
+    UNSCOPED_INFO("Check the first item of a node holds its original value.");
+    CHECK(readNode(*pDataset, Elevation, 5, 5) == originalElevation(5, 5));
+    CHECK(readNode(*pDataset, Elevation, 50, 70) == -3.f);
+    CHECK(readNode(*pDataset, Elevation, 99, 99) == -4.f);
+
+    UNSCOPED_INFO("Check an empty filter reverts everything left.");
+    CHECK(pDataset->revertEdits({}) == 2);
+    CHECK(pDataset->getTrackingList().empty());
+    CHECK(pDataset->revertEdits({}) == 0);
+
+    const auto elevations = pDataset->getSimpleLayer(Elevation)->read(0, 0,
+        kRows - 1, kColumns - 1);
+    const auto* values = reinterpret_cast<const float*>(elevations.data());
+    size_t numChanged = 0;
+    for (uint32_t row = 0; row < kRows; ++row)
+        for (uint32_t column = 0; column < kColumns; ++column)
+            if (values[row * kColumns + column] !=
+                originalElevation(row, column))
+                ++numChanged;
+    CHECK(numChanged == 0);
+
+    // The range holds the restored values.
+    const auto minMax =
+        pDataset->getSimpleLayer(Elevation)->getDescriptor()->getMinMax();
+    CHECK(std::get<0>(minMax) <= originalElevation(kRows - 1, kColumns - 1));
+
+    UNSCOPED_INFO("Check the reverted list was written.");
+    pDataset->close();
+
+    const auto pReopened = Dataset::open(fileName, BAG_OPEN_READONLY);
+    REQUIRE(pReopened);
+    CHECK(pReopened->getTrackingList().empty());
+    CHECK(readNode(*pReopened, Elevation, 50, 70) ==
+        originalElevation(50, 70));
+}
+
+//  static size_t revert(...);
+TEST_CASE("test revert edits removes the cached coverage", "[revert][coverage]")
+{
+    const TestUtils::RandomFileGuard fileName;
+
+    {
+        const auto pDataset = createSurface(fileName);
+
+        // The node had no depth before it was edited.
+        const float nullElevation = BAG_NULL_ELEVATION;
+        pDataset->getSimpleLayer(Elevation)->write(5, 5, 5, 5,
+            reinterpret_cast<const uint8_t*>(&nullElevation));
+        editNode(*pDataset, 5, 5, -1.f, 1, 1);
+        pDataset->getTrackingList().write();
+
+        CHECK(pDataset->getCoverage().getNumCells() == kRows * kColumns);
+
+        CHECK(pDataset->revertEdits({}) == 1);
+        CHECK(readNode(*pDataset, Elevation, 5, 5) == BAG_NULL_ELEVATION);
+
+        pDataset->close();
+    }
+
+    UNSCOPED_INFO("Check the coverage cached before the revert is gone.");
+    {
+        const ::H5::H5File h5file{fileName, H5F_ACC_RDONLY};
+        CHECK_FALSE(h5file.nameExists("/BAG_root/coverage_mask"));
+    }
+
+    const auto pDataset = Dataset::open(fileName, BAG_OPEN_READONLY);
+    REQUIRE(pDataset);
+    CHECK(pDataset->getCoverage().getNumCells() == kRows * kColumns - 1);
+}
+
+//  static size_t revert(...);
+TEST_CASE("test revert VR edits", "[revert][VR]")
+{
+    const TestUtils::RandomFileGuard fileName;
+    const auto pDataset = createSurface(fileName);
+    pDataset->createVR(kChunkSize, 6, true);
+
+    // Every supercell of the first row has 2 by 2 nodes.
+    std::vector<BAG::VRMetadataItem> supercells(kColumns);
+    std::vector<BAG::VRRefinementsItem> refinements;
+    std::vector<BAG::VRNodeItem> nodes;
+    for (uint32_t i = 0; i < kColumns; ++i)
+    {
+        supercells[i] = {static_cast<uint32_t>(refinements.size()), 2, 2, 1.f,
+            1.f, 0.f, 0.f};
+        for (uint32_t node = 0; node < 4; ++node)
+        {
+            refinements.push_back({-static_cast<float>(i), 0.5f});
+            nodes.push_back({1.f, 1, i});
+        }
+    }
+
+    pDataset->getVRMetadata()->write(0, 0, 0, kColumns - 1,
+        reinterpret_cast<const uint8_t*>(supercells.data()));
+    pDataset->getVRRefinements()->write(0, 0, 0,
+        static_cast<uint32_t>(refinements.size() - 1),
+        reinterpret_cast<const uint8_t*>(refinements.data()));
+    pDataset->getVRNode()->write(0, 0, 0,
+        static_cast<uint32_t>(nodes.size() - 1),
+        reinterpret_cast<const uint8_t*>(nodes.data()));
+
+    // Edited refinements; the tracking list holds their values before.
+    const BAG::VRRefinementsItem edited{-100.f, 3.f};
+    for (const uint32_t index : {1u, 2u, 250u})
+        pDataset->getVRRefinements()->write(0, index, 0, index,
+            reinterpret_cast<const uint8_t*>(&edited));
+
+    auto& vrTrackingList = *pDataset->getVRTrackingList();
+    vrTrackingList.push_back(BAG::VRTrackingItem{0, 0, 0, 1, -0.f, 0.5f, 1, 1});
+    vrTrackingList.push_back(BAG::VRTrackingItem{0, 0, 1, 0, -0.f, 0.5f, 1, 1});
+    vrTrackingList.push_back(BAG::VRTrackingItem{0, 62, 1, 0, -62.f, 0.5f, 2,
+        1});
+    vrTrackingList.write();
+
+    RevertFilter filter;
+    filter.filterCode = true;
+    filter.code = 2;
+    CHECK(pDataset->revertEdits(filter) == 1);
+    CHECK(vrTrackingList.size() == 2);
+
+    const auto readRefinement = [&pDataset](uint32_t index) {
+        const auto buffer = pDataset->getVRRefinements()->read(0, index, 0,
+            index);
+        return *reinterpret_cast<const BAG::VRRefinementsItem*>(buffer.data());
+    };
+
+    CHECK(readRefinement(250).depth == -62.f);
+    CHECK(readRefinement(250).depth_uncrt == 0.5f);
+    CHECK(readRefinement(1).depth == -100.f);
+
+    CHECK(pDataset->revertEdits({}) == 2);
+    CHECK(readRefinement(1).depth == 0.f);
+    CHECK(readRefinement(2).depth == 0.f);
+    CHECK(vrTrackingList.empty());
+
+    UNSCOPED_INFO("Check an item outside its supercell changes nothing.");
+    vrTrackingList.push_back(BAG::VRTrackingItem{0, 3, 2, 0, 5.f, 0.5f, 1, 1});
+    REQUIRE_THROWS_AS(pDataset->revertEdits({}), BAG::InvalidReadSize);
+    CHECK(vrTrackingList.size() == 1);
+}
+
+//  static size_t revert(...);
+TEST_CASE("test revert edits errors", "[revert][ReadOnlyError]")
+{
+    const TestUtils::RandomFileGuard fileName;
+
+    {
+        const auto pDataset = createSurface(fileName);
+        editNode(*pDataset, 5, 5, -1.f, 1, 1);
+        pDataset->getTrackingList().push_back(BAG::TrackingItem{kRows, 0, -1.f,
+            0.5f, 2, 1});
+        pDataset->getTrackingList().write();
+
+        UNSCOPED_INFO("Check an item outside the grid changes nothing.");
+        REQUIRE_THROWS_AS(pDataset->revertEdits({}), BAG::InvalidReadSize);
+        CHECK(readNode(*pDataset, Elevation, 5, 5) == -1.f);
+        CHECK(pDataset->getTrackingList().size() == 2);
+
+        pDataset->close();
+    }
+
+    {
+        const auto pDataset = Dataset::open(fileName, BAG_OPEN_READONLY);
+        REQUIRE(pDataset);
+        REQUIRE_THROWS_AS(pDataset->revertEdits({}), BAG::ReadOnlyError);
+    }
+
+    const auto pDataset = Dataset::open(fileName, BAG_OPEN_READ_WRITE, true);
+    REQUIRE(pDataset);
+    REQUIRE_THROWS_AS(pDataset->revertEdits({}),
+        BAG::TrackingListNotLoaded);
+}
+
+//  static size_t revert(...);
+TEST_CASE("test revert edits of a sorted tracking list",
+    "[revert][TrackingListSorted]")
+{
+    const TestUtils::RandomFileGuard fileName;
+    const auto pDataset = createSurface(fileName);
+
+    // Sorting by code puts the second edit of the node first.
+    editNode(*pDataset, 5, 5, -1.f, 2, 1);
+    editNode(*pDataset, 5, 5, -2.f, 1, 1);
+    auto& trackingList = pDataset->getTrackingList();
+    trackingList.sortBy(BAG::TrackingListOrder::Code);
+    trackingList.write();
+
+    const auto& constList = static_cast<const BAG::TrackingList&>(trackingList);
+    REQUIRE(constList[0].depth == -1.f);
+
+    UNSCOPED_INFO("Check a sorted list changes nothing.");
+    REQUIRE_THROWS_AS(pDataset->revertEdits({}), BAG::TrackingListSorted);
+    CHECK(readNode(*pDataset, Elevation, 5, 5) == -2.f);
+    CHECK(trackingList.size() == 2);
+
+    UNSCOPED_INFO("Check a filter matching no item of the list still reverts.");
+    RevertFilter filter;
+    filter.filterSeries = true;
+    filter.series = 2;
+    CHECK(pDataset->revertEdits(filter) == 0);
+}
+
+//  static size_t revert(...);
+TEST_CASE("test revert edits of a tracking list sorted through the C API",
+    "[revert][TrackingListSorted]")
+{
+    const TestUtils::RandomFileGuard fileName;
+
+    {
+        const auto pDataset = createSurface(fileName);
+
+        // Sorting descending by code puts the second edit of the node first.
+        editNode(*pDataset, 5, 5, -1.f, 1, 1);
+        editNode(*pDataset, 5, 5, -2.f, 2, 1);
+        pDataset->getTrackingList().write();
+        pDataset->close();
+    }
+
+    BagHandle* handle = nullptr;
+    REQUIRE(bagFileOpen(&handle, BAG_OPEN_READ_WRITE,
+        static_cast<const std::string&>(fileName).c_str()) == BAG_SUCCESS);
+    CHECK(bagSortTrackingListByCode(handle) == BAG_SUCCESS);
+    REQUIRE(bagFileClose(handle) == BAG_SUCCESS);
+
+    const auto pDataset = Dataset::open(fileName, BAG_OPEN_READ_WRITE);
+    REQUIRE(pDataset);
+    auto& trackingList = pDataset->getTrackingList();
+    CHECK(trackingList.isReordered());
+
+    UNSCOPED_INFO("Check a later edit does not hide the reordering.");
+    editNode(*pDataset, 6, 6, -3.f, 1, 1);
+    CHECK(trackingList.getSortOrder() == BAG::TrackingListOrder::Unsorted);
+
+    REQUIRE_THROWS_AS(pDataset->revertEdits({}), BAG::TrackingListSorted);
+    CHECK(readNode(*pDataset, Elevation, 5, 5) == -2.f);
+    CHECK(trackingList.size() == 3);
+}
@@ -1,14 +1,17 @@
 
 #include "test_utils.h"
 #include <bag_dataset.h>
+#include <bag_exceptions.h>
 #include <bag_metadata.h>
 #include <bag_simplelayer.h>
 #include <bag_types.h>
 
+#include <algorithm>
 #include <array>
 #include <catch2/catch_all.hpp>
 #include <cstdlib>  // std::getenv
 #include <string>
+#include <tuple>
 
 
 using BAG::Dataset;
@@ -374,6 +377,38 @@ TEST_CASE("test simple layer read", "[simplelayer][read]")
         CHECK(kExpectedBuffer[i] == floats[i]);
 }
 
+//  UInt8Array readChunked(uint32_t rowStart, uint32_t columnStart,
+//      uint32_t rowEnd, uint32_t columnEnd) const;
+TEST_CASE("test simple layer read chunked", "[simplelayer][read][readChunked]")
+{
+    const std::string bagFileName{std::string{std::getenv("BAG_SAMPLES_PATH")} +
+        "/NAVO_data/JD211_public_Release_1-4_UTM.bag"};
+
+    const auto pDataset = Dataset::open(bagFileName, BAG_OPEN_READONLY);
+    REQUIRE(pDataset);
+
+    const auto pLayer = pDataset->getSimpleLayer(Elevation);
+    REQUIRE(pLayer);
+
+    uint32_t rows = 0, columns = 0;
+    std::tie(rows, columns) = pLayer->getDescriptor()->getDims();
+
+    // A window that crosses chunk boundaries in both directions.
+    const uint32_t rowStart = 3, columnStart = 5;
+    const uint32_t rowEnd = rows - 4, columnEnd = columns - 2;
+
+    const auto expected = pLayer->read(rowStart, columnStart, rowEnd, columnEnd);
+    const auto buffer = pLayer->readChunked(rowStart, columnStart, rowEnd,
+        columnEnd);
+
+    REQUIRE(buffer.size() == expected.size());
+    CHECK(std::equal(buffer.data(), buffer.data() + buffer.size(),
+        expected.data()));
+
+    CHECK_THROWS_AS(pLayer->readChunked(1, 0, 0, 0), BAG::InvalidReadSize);
+    CHECK_THROWS_AS(pLayer->readChunked(0, 0, rows, 0), BAG::InvalidReadSize);
+}
+
 //  virtual void write(uint32_t rowStart, uint32_t columnStart, uint32_t rowEnd,
 //      uint32_t columnEnd, const uint8_t* buffer) const;
 TEST_CASE("test simple layer write", "[simplelayer][write]")
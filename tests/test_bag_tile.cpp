@@ -0,0 +1,175 @@
+#include "test_utils.h"
+#include <bag_dataset.h>
+#include <bag_exceptions.h>
+#include <bag_layerdescriptor.h>
+#include <bag_metadata.h>
+#include <bag_simplelayer.h>
+#include <bag_tile.h>
+#include <bag_trackinglist.h>
+
+#include <catch2/catch_all.hpp>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+using BAG::Dataset;
+using BAG::Tiler;
+
+namespace {
+
+constexpr uint32_t kRows = 100;
+constexpr uint32_t kColumns = 100;
+constexpr uint64_t kChunkSize = 20;
+
+//! Create a BAG of the sample grid with a sloping surface and a tracking list.
+std::shared_ptr<Dataset> createMaster(
+    const std::string& fileName)
+{
+    auto pDataset = TestUtils::createSurface(fileName, kRows, kColumns,
+        kChunkSize);
+
+    auto& trackingList = pDataset->getTrackingList();
+    trackingList.push_back(BAG::TrackingItem{10, 10, -1.f, 0.5f, 1, 1});
+    trackingList.push_back(BAG::TrackingItem{45, 95, -2.f, 0.5f, 2, 1});
+    trackingList.write();
+
+    return pDataset;
+}
+
+//! Removes the tiles of a test when it ends.
+struct TileGuard final
+{
+    ~TileGuard()
+    {
+        for (const auto& fileName : fileNames)
+            std::remove(fileName.c_str());
+    }
+
+    std::vector<std::string> fileNames;
+};
+
+}  // namespace
+
+//  static std::vector<std::string> tile(...);
+TEST_CASE("test tile", "[tile]")
+{
+    const TestUtils::RandomFileGuard masterFileName;
+    const auto pMaster = createMaster(masterFileName);
+    const auto& masterMetadata = pMaster->getMetadata();
+
+    // Tiles of two and a half chunks; 40, 40 and 20 rows and columns.
+    constexpr uint32_t kTileSize = 40;
+
+    for (unsigned int numThreads : {1u, 4u})
+    {
+        const TestUtils::RandomFileGuard outPrefix;
+        TileGuard tiles;
+        tiles.fileNames = Tiler::tile(*pMaster, kTileSize, kTileSize,
+            outPrefix, numThreads);
+        REQUIRE(tiles.fileNames.size() == 9);
+        CHECK(tiles.fileNames[5] == Tiler::getTileFileName(outPrefix, 1, 2));
+
+        for (uint32_t tileRow = 0; tileRow < 3; ++tileRow)
+        {
+            for (uint32_t tileColumn = 0; tileColumn < 3; ++tileColumn)
+            {
+                const auto pTile = Dataset::open(
+                    tiles.fileNames[tileRow * 3 + tileColumn], BAG_OPEN_READONLY);
+                REQUIRE(pTile);
+
+                const uint32_t rowStart = tileRow * kTileSize;
+                const uint32_t columnStart = tileColumn * kTileSize;
+                const uint32_t rows = tileRow < 2 ? kTileSize : 20;
+                const uint32_t columns = tileColumn < 2 ? kTileSize : 20;
+
+                const auto& metadata = pTile->getMetadata();
+                CHECK(metadata.rows() == rows);
+                CHECK(metadata.columns() == columns);
+                CHECK(metadata.llCornerX() == Catch::Approx(
+                    masterMetadata.llCornerX() +
+                    columnStart * masterMetadata.columnResolution()));
+                CHECK(metadata.llCornerY() == Catch::Approx(
+                    masterMetadata.llCornerY() +
+                    rowStart * masterMetadata.rowResolution()));
+
+                for (const auto type : {Elevation, Uncertainty})
+                {
+                    const auto expected = pMaster->getSimpleLayer(type)->read(
+                        rowStart, columnStart, rowStart + rows - 1,
+                        columnStart + columns - 1);
+                    const auto actual = pTile->getSimpleLayer(type)->read(0, 0,
+                        rows - 1, columns - 1);
+                    REQUIRE(actual.size() == expected.size());
+                    CHECK(std::memcmp(actual.data(), expected.data(),
+                        actual.size()) == 0);
+                }
+
+                // The range of each tile is its own.
+                const auto minMax =
+                    pTile->getSimpleLayer(Elevation)->getDescriptor()->getMinMax();
+                const uint32_t last = (rowStart + rows - 1) * kColumns +
+                    columnStart + columns - 1;
+                CHECK(std::get<0>(minMax) == Catch::Approx(
+                    TestUtils::surfaceElevation(last)));
+                CHECK(std::get<1>(minMax) == Catch::Approx(
+                    TestUtils::surfaceElevation(rowStart * kColumns +
+                    columnStart)));
+
+                const size_t expectedItems =
+                    (tileRow == 0 && tileColumn == 0) ||
+                    (tileRow == 1 && tileColumn == 2) ? 1 : 0;
+                CHECK(pTile->getTrackingList().size() == expectedItems);
+            }
+        }
+
+        const auto pTile = Dataset::open(tiles.fileNames[5], BAG_OPEN_READONLY);
+        const auto& item = pTile->getTrackingList()[0];
+        CHECK(item.row == 5);
+        CHECK(item.col == 15);
+    }
+}
+
+//  static std::vector<std::string> tile(...);
+TEST_CASE("test tile streamed tracking list", "[tile][stream]")
+{
+    const TestUtils::RandomFileGuard masterFileName;
+    createMaster(masterFileName)->close();
+
+    const auto pMaster = Dataset::open(masterFileName, BAG_OPEN_READONLY, true);
+    REQUIRE(pMaster);
+    REQUIRE_FALSE(pMaster->getTrackingList().isLoaded());
+
+    const TestUtils::RandomFileGuard outPrefix;
+    TileGuard tiles;
+    tiles.fileNames = Tiler::tile(*pMaster, 40, 40, outPrefix);
+    REQUIRE(tiles.fileNames.size() == 9);
+
+    // The items are found on disk, one row of tiles at a time.
+    for (size_t i = 0; i < tiles.fileNames.size(); ++i)
+    {
+        const auto pTile = Dataset::open(tiles.fileNames[i], BAG_OPEN_READONLY);
+        REQUIRE(pTile);
+        CHECK(pTile->getTrackingList().size() == (i == 0 || i == 5 ? 1u : 0u));
+    }
+
+    const auto pTile = Dataset::open(tiles.fileNames[5], BAG_OPEN_READONLY);
+    const auto& item = pTile->getTrackingList()[0];
+    CHECK(item.row == 5);
+    CHECK(item.col == 15);
+}
+
+//  static std::vector<std::string> tile(...);
+TEST_CASE("test tile invalid size", "[tile][InvalidTileSize]")
+{
+    const TestUtils::RandomFileGuard masterFileName;
+    const TestUtils::RandomFileGuard outPrefix;
+    const auto pMaster = createMaster(masterFileName);
+
+    REQUIRE_THROWS_AS(Tiler::tile(*pMaster, 0, 10, outPrefix),
+        BAG::InvalidTileSize);
+    REQUIRE_THROWS_AS(Tiler::tile(*pMaster, 10, 0, outPrefix),
+        BAG::InvalidTileSize);
+}
+
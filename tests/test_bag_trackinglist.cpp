@@ -1,11 +1,17 @@
 
 #include "test_utils.h"
+#include <bag.h>
 #include <bag_dataset.h>
+#include <bag_exceptions.h>
 #include <bag_metadata.h>
 #include <bag_trackinglist.h>
+#include <bag_trackinglistreader.h>
 
+#include <algorithm>
 #include <catch2/catch_all.hpp>
+#include <H5Cpp.h>
 #include <string>
+#include <vector>
 
 
 using BAG::Dataset;
@@ -452,3 +458,451 @@ TEST_CASE("test tracking list construction (create)", "[trackinglist][constructo
     CHECK(kExpectedItem1.list_series == item1.list_series);
 }
 
+//  void reserve(size_t newCapacity);
+//  void write() const;
+TEST_CASE("test tracking list growth and trim", "[trackinglist][write]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    constexpr size_t kNumItems = 300;
+    {
+        BAG::Metadata metadata;
+        metadata.loadFromBuffer(kMetadataXML);
+
+        const auto pDataset = Dataset::create(tmpFileName, std::move(metadata),
+            100, 6);
+        REQUIRE(pDataset);
+
+        auto& trackingList = pDataset->getTrackingList();
+        trackingList.reserve(kNumItems / 2);
+
+        // Write the list as it grows.
+        for (size_t i = 0; i < kNumItems; ++i)
+        {
+            trackingList.emplace_back(TrackingList::value_type{
+                static_cast<uint32_t>(i), 2, 3.4f, 5.6f, 7, 8});
+            trackingList.write();
+        }
+
+        {
+            const ::H5::H5File h5file{tmpFileName, H5F_ACC_RDONLY};
+            hsize_t extent = 0;
+            h5file.openDataSet("/BAG_root/tracking_list").getSpace()
+                .getSimpleExtentDims(&extent);
+
+            UNSCOPED_INFO("Check the DataSet grew ahead of the list.");
+            CHECK(extent >= kNumItems);
+            CHECK(extent < 2 * kNumItems);
+        }
+
+        // Shrink the list; the DataSet keeps its room until closed.
+        trackingList.resize(kNumItems - 10);
+        trackingList.write();
+
+        pDataset->close();
+    }
+
+    const ::H5::H5File h5file{tmpFileName, H5F_ACC_RDONLY};
+    hsize_t extent = 0;
+    h5file.openDataSet("/BAG_root/tracking_list").getSpace()
+        .getSimpleExtentDims(&extent);
+
+    UNSCOPED_INFO("Check closing trimmed the DataSet to the list.");
+    CHECK(extent == kNumItems - 10);
+
+    const auto pDataset = Dataset::open(tmpFileName, BAG_OPEN_READONLY);
+    const auto& trackingList = pDataset->getTrackingList();
+    REQUIRE(trackingList.size() == kNumItems - 10);
+    CHECK(trackingList.back().row == kNumItems - 11);
+}
+
+//  std::vector<value_type> findNode(uint32_t row, uint32_t col) const;
+//  std::vector<value_type> findCode(uint8_t code) const;
+//  std::vector<value_type> findSeries(uint16_t series) const;
+TEST_CASE("test tracking list find", "[trackinglist][find]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    BAG::Metadata metadata;
+    metadata.loadFromBuffer(kMetadataXML);
+
+    const auto pDataset = Dataset::create(tmpFileName, std::move(metadata),
+        100, 6);
+    REQUIRE(pDataset);
+
+    auto& trackingList = pDataset->getTrackingList();
+
+    // Items of 10 x 10 nodes, three to a node, out of order.
+    for (uint32_t i = 0; i < 300; ++i)
+        trackingList.emplace_back(TrackingList::value_type{(i * 7) % 10,
+            (i * 3) % 10, static_cast<float>(i), 0.5f,
+            static_cast<uint8_t>(i % 4), static_cast<uint16_t>(i / 100)});
+
+    const auto checkNode = [&trackingList](uint32_t row, uint32_t col) {
+        std::vector<uint32_t> expected;
+        for (const auto& item : static_cast<const TrackingList&>(trackingList))
+            if (item.row == row && item.col == col)
+                expected.push_back(static_cast<uint32_t>(item.depth));
+
+        std::vector<uint32_t> found;
+        for (const auto& item : trackingList.findNode(row, col))
+            found.push_back(static_cast<uint32_t>(item.depth));
+
+        CHECK(found == expected);
+    };
+
+    checkNode(0, 0);
+    checkNode(7, 3);
+    CHECK(trackingList.findNode(10, 0).empty());
+
+    UNSCOPED_INFO("Check the code and series lookups.");
+    CHECK(trackingList.findCode(1).size() == 75);
+    CHECK(trackingList.findCode(9).empty());
+    CHECK(trackingList.findSeries(2).size() == 100);
+    CHECK(trackingList.findSeries(2).front().depth == 200.f);
+
+    UNSCOPED_INFO("Check appended items are found.");
+    trackingList.emplace_back(TrackingList::value_type{7, 3, 1000.f, 0.5f, 9,
+        3});
+    checkNode(7, 3);
+    CHECK(trackingList.findNode(7, 3).back().depth == 1000.f);
+    CHECK(trackingList.findCode(9).size() == 1);
+
+    UNSCOPED_INFO("Check items changed in place are found.");
+    trackingList[0].row = 10;
+    trackingList.markChanged(0, 1);
+    CHECK(trackingList.findNode(10, 0).size() == 1);
+    checkNode(0, 0);
+
+    trackingList.resize(10);
+    CHECK(trackingList.findSeries(3).empty());
+    checkNode(7, 3);
+}
+
+//  void write() const;
+TEST_CASE("test tracking list incremental write", "[trackinglist][write]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    const auto makeItem = [](uint32_t i) {
+        return TrackingList::value_type{i, i + 1, static_cast<float>(i), 0.5f,
+            1, 2};
+    };
+
+    {
+        BAG::Metadata metadata;
+        metadata.loadFromBuffer(kMetadataXML);
+
+        const auto pDataset = Dataset::create(tmpFileName, std::move(metadata),
+            100, 6);
+        REQUIRE(pDataset);
+
+        auto& trackingList = pDataset->getTrackingList();
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            trackingList.push_back(makeItem(i));
+            trackingList.write();
+        }
+
+        // Change written items, and append more.
+        trackingList[5].depth = -5.f;
+        trackingList.markChanged(5, 6);
+        auto last = trackingList.back();
+        last.depth = -99.f;
+        trackingList.set(trackingList.size() - 1, last);
+        trackingList.push_back(makeItem(100));
+        trackingList.write();
+
+        // Shrink and grow again.
+        trackingList.resize(50);
+        trackingList.write();
+        trackingList.push_back(makeItem(1000));
+        trackingList.write();
+
+        // Change every item.
+        for (auto& item : trackingList)
+            item.uncertainty = 1.5f;
+        trackingList.markChanged(0, trackingList.size());
+        trackingList.write();
+
+        pDataset->close();
+    }
+
+    {
+        const auto pDataset = Dataset::open(tmpFileName, BAG_OPEN_READ_WRITE);
+        auto& trackingList = pDataset->getTrackingList();
+        REQUIRE(trackingList.size() == 51);
+
+        CHECK(trackingList[0].depth == 0.f);
+        CHECK(trackingList[5].depth == -5.f);
+        CHECK(trackingList[49].depth == 49.f);
+        CHECK(trackingList[50].depth == 1000.f);
+        CHECK(trackingList[50].uncertainty == 1.5f);
+        CHECK(trackingList[20].uncertainty == 1.5f);
+
+        // Edit an opened list.
+        trackingList[3].track_code = 9;
+        trackingList.markChanged(3, 4);
+        trackingList.write();
+
+        trackingList.clear();
+        trackingList.push_back(makeItem(7));
+        trackingList.push_back(makeItem(8));
+        trackingList.write();
+
+        pDataset->close();
+    }
+
+    const auto pDataset = Dataset::open(tmpFileName, BAG_OPEN_READONLY);
+    const auto& trackingList = pDataset->getTrackingList();
+    REQUIRE(trackingList.size() == 2);
+    CHECK(trackingList[0].depth == 7.f);
+    CHECK(trackingList[1].depth == 8.f);
+    CHECK(trackingList[1].uncertainty == 0.5f);
+}
+
+//  TrackingListOrder getSortOrder() const noexcept;
+//  void sortBy(TrackingListOrder order, unsigned int numThreads = 0);
+TEST_CASE("test tracking list sort", "[trackinglist][sort]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    // Enough items to sort in several pieces.
+    constexpr uint32_t kNumItems = 70000;
+
+    std::vector<TrackingList::value_type> expected;
+    {
+        BAG::Metadata metadata;
+        metadata.loadFromBuffer(kMetadataXML);
+
+        const auto pDataset = Dataset::create(tmpFileName, std::move(metadata),
+            100, 6);
+        REQUIRE(pDataset);
+
+        auto& trackingList = pDataset->getTrackingList();
+        CHECK(trackingList.getSortOrder() == BAG::TrackingListOrder::Unsorted);
+
+        REQUIRE_THROWS_AS(trackingList.sortBy(
+            BAG::TrackingListOrder::SubPosition), BAG::InvalidSortOrder);
+
+        for (uint32_t i = 0; i < kNumItems; ++i)
+            trackingList.emplace_back(TrackingList::value_type{(i * 7919) % 97,
+                (i * 104729) % 89, static_cast<float>(i), 0.5f,
+                static_cast<uint8_t>(i % 5), static_cast<uint16_t>(i % 3)});
+        trackingList.write();
+
+        expected.assign(trackingList.cbegin(), trackingList.cend());
+        std::stable_sort(expected.begin(), expected.end(),
+            [](const TrackingList::value_type& lhs,
+                const TrackingList::value_type& rhs) {
+                return lhs.row < rhs.row ||
+                    (lhs.row == rhs.row && lhs.col < rhs.col);
+            });
+
+        CHECK_FALSE(trackingList.isReordered());
+        trackingList.sortBy(BAG::TrackingListOrder::Node, 4);
+        CHECK(trackingList.getSortOrder() == BAG::TrackingListOrder::Node);
+        CHECK(trackingList.isReordered());
+
+        UNSCOPED_INFO("Check the sort is by node, and stable.");
+        REQUIRE(trackingList.size() == kNumItems);
+        bool sameOrder = true;
+        for (uint32_t i = 0; i < kNumItems; ++i)
+            sameOrder = sameOrder && trackingList.cbegin()[i].depth ==
+                expected[i].depth;
+        CHECK(sameOrder);
+
+        CHECK(trackingList.findNode(3, 5).size() ==
+            static_cast<size_t>(std::count_if(expected.begin(), expected.end(),
+                [](const TrackingList::value_type& item) {
+                    return item.row == 3 && item.col == 5;
+                })));
+
+        trackingList.write();
+        pDataset->close();
+    }
+
+    {
+        const auto pDataset = Dataset::open(tmpFileName, BAG_OPEN_READ_WRITE);
+        auto& trackingList = pDataset->getTrackingList();
+
+        UNSCOPED_INFO("Check the sort order was recorded.");
+        CHECK(trackingList.getSortOrder() == BAG::TrackingListOrder::Node);
+        REQUIRE(trackingList.size() == kNumItems);
+        CHECK(trackingList.cbegin()[kNumItems - 1].depth ==
+            expected.back().depth);
+
+        UNSCOPED_INFO("Check appending loses the sort order, but not that "
+            "the list was reordered.");
+        trackingList.emplace_back(TrackingList::value_type{0, 0, -1.f, 0.5f,
+            0, 0});
+        CHECK(trackingList.getSortOrder() == BAG::TrackingListOrder::Unsorted);
+        CHECK(trackingList.isReordered());
+
+        trackingList.sortBy(BAG::TrackingListOrder::Series);
+        CHECK(trackingList.front().list_series == 0);
+        CHECK(trackingList.back().list_series == 2);
+
+        trackingList.sortBy(BAG::TrackingListOrder::Code, 1);
+        trackingList.write();
+
+        UNSCOPED_INFO("Check reading through the non-const accessors keeps "
+            "the sort order.");
+        size_t numItems = 0;
+        for (auto& item : trackingList)
+            numItems += item.track_code < 5 ? 1 : 0;
+        CHECK(numItems == trackingList.size());
+        CHECK(trackingList.front().track_code == 0);
+        CHECK(trackingList.getSortOrder() == BAG::TrackingListOrder::Code);
+
+        pDataset->close();
+    }
+
+    const auto pDataset = Dataset::open(tmpFileName, BAG_OPEN_READONLY);
+    const auto& trackingList = pDataset->getTrackingList();
+    CHECK(trackingList.getSortOrder() == BAG::TrackingListOrder::Code);
+    CHECK(std::is_sorted(trackingList.cbegin(), trackingList.cend(),
+        [](const TrackingList::value_type& lhs,
+            const TrackingList::value_type& rhs) {
+            return lhs.track_code < rhs.track_code;
+        }));
+    CHECK(trackingList.findCode(4).size() == kNumItems / 5);
+}
+
+//  BagError bagSortTrackingListByNode(BagHandle* handle);
+TEST_CASE("test tracking list C node sort", "[trackinglist][sort]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    std::vector<TrackingList::value_type> expected;
+    {
+        BAG::Metadata metadata;
+        metadata.loadFromBuffer(kMetadataXML);
+
+        const auto pDataset = Dataset::create(tmpFileName, std::move(metadata),
+            100, 6);
+        REQUIRE(pDataset);
+
+        auto& trackingList = pDataset->getTrackingList();
+        for (uint32_t i = 0; i < 500; ++i)
+            trackingList.emplace_back(TrackingList::value_type{(i * 7919) % 13,
+                (i * 104729) % 11, static_cast<float>(i), 0.5f, 0, 0});
+        trackingList.write();
+
+        expected.assign(trackingList.cbegin(), trackingList.cend());
+        std::stable_sort(expected.begin(), expected.end(),
+            [](const TrackingList::value_type& lhs,
+                const TrackingList::value_type& rhs) {
+                return lhs.row > rhs.row ||
+                    (lhs.row == rhs.row && lhs.col > rhs.col);
+            });
+
+        pDataset->close();
+    }
+
+    BagHandle* handle = nullptr;
+    REQUIRE(bagFileOpen(&handle, BAG_OPEN_READ_WRITE,
+        static_cast<const std::string&>(tmpFileName).c_str()) == BAG_SUCCESS);
+    CHECK(bagSortTrackingListByNode(handle) == BAG_SUCCESS);
+    REQUIRE(bagFileClose(handle) == BAG_SUCCESS);
+
+    UNSCOPED_INFO("Check the sort is descending by node, and stable.");
+    const auto pDataset = Dataset::open(tmpFileName, BAG_OPEN_READONLY);
+    const auto& trackingList = pDataset->getTrackingList();
+    REQUIRE(trackingList.size() == expected.size());
+    bool sameOrder = true;
+    for (size_t i = 0; i < expected.size(); ++i)
+        sameOrder = sameOrder && trackingList[i].depth == expected[i].depth;
+    CHECK(sameOrder);
+}
+
+//  static std::shared_ptr<Dataset> open(..., bool streamTrackingLists);
+TEST_CASE("test tracking list streaming", "[trackinglist][stream]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    // More items than a block, so scans cross blocks.
+    const size_t kNumItems = BAG::TrackingListReader::getBlockSize() * 2 + 100;
+
+    {
+        BAG::Metadata metadata;
+        metadata.loadFromBuffer(kMetadataXML);
+
+        const auto pDataset = Dataset::create(tmpFileName, std::move(metadata),
+            100, 6);
+        REQUIRE(pDataset);
+
+        auto& trackingList = pDataset->getTrackingList();
+        for (size_t i = 0; i < kNumItems; ++i)
+            trackingList.emplace_back(TrackingList::value_type{
+                static_cast<uint32_t>(i % 97), static_cast<uint32_t>(i % 89),
+                static_cast<float>(i), 0.5f, static_cast<uint8_t>(i % 5),
+                static_cast<uint16_t>(i % 7)});
+
+        trackingList.write();
+        pDataset->close();
+    }
+
+    const auto pLoaded = Dataset::open(tmpFileName, BAG_OPEN_READONLY);
+    REQUIRE(pLoaded);
+    const auto& loadedList = pLoaded->getTrackingList();
+    CHECK(loadedList.isLoaded());
+
+    const auto pDataset = Dataset::open(tmpFileName, BAG_OPEN_READONLY, true);
+    REQUIRE(pDataset);
+
+    UNSCOPED_INFO("Check a streamed tracking list is left on disk.");
+    auto& trackingList = pDataset->getTrackingList();
+    CHECK_FALSE(trackingList.isLoaded());
+    CHECK(trackingList.empty());
+    REQUIRE_THROWS_AS(trackingList.write(), BAG::TrackingListNotLoaded);
+
+    const auto pReader = pDataset->getTrackingListReader();
+    REQUIRE(pReader);
+    REQUIRE(pReader->size() == kNumItems);
+    CHECK(pReader->getNumBlocks() == 3);
+
+    UNSCOPED_INFO("Check the items are read by index.");
+    CHECK(pReader->read(0).depth == 0.f);
+    CHECK(pReader->read(kNumItems - 1).depth ==
+        static_cast<float>(kNumItems - 1));
+    CHECK(pReader->read(70000).row == 70000 % 97);
+    REQUIRE_THROWS_AS(pReader->read(kNumItems), BAG::InvalidReadSize);
+    REQUIRE_THROWS_AS(pReader->read(5, 4), BAG::InvalidReadSize);
+
+    const auto range = pReader->read(10, 19);
+    REQUIRE(range.size() == 10);
+    CHECK(range.back().depth == 19.f);
+
+    UNSCOPED_INFO("Check the blocks hold the whole list, in order.");
+    size_t numRead = 0;
+    for (size_t block = 0; block < pReader->getNumBlocks(); ++block)
+    {
+        const auto items = pReader->readBlock(block);
+        CHECK(items.front().depth == static_cast<float>(numRead));
+        numRead += items.size();
+    }
+    CHECK(numRead == kNumItems);
+    REQUIRE_THROWS_AS(pReader->readBlock(3), BAG::InvalidReadSize);
+
+    UNSCOPED_INFO("Check the scans match the lookups of the loaded list.");
+    const auto depths = [](const std::vector<TrackingList::value_type>& items) {
+        std::vector<float> result;
+        for (const auto& item : items)
+            result.push_back(item.depth);
+
+        return result;
+    };
+
+    CHECK(depths(pReader->findCode(3)) == depths(loadedList.findCode(3)));
+    CHECK(depths(pReader->findSeries(6)) == depths(loadedList.findSeries(6)));
+    CHECK(pReader->findCode(9).empty());
+
+    std::vector<float> expected;
+    for (const auto& item : loadedList)
+        if (item.row >= 10 && item.row <= 12 && item.col >= 40 &&
+            item.col <= 41)
+            expected.push_back(item.depth);
+
+    CHECK(depths(pReader->findBox(10, 40, 12, 41)) == expected);
+}
@@ -0,0 +1,122 @@
+#include "test_utils.h"
+#include <bag_dataset.h>
+#include <bag_interleavedlegacylayer.h>
+#include <bag_layerdescriptor.h>
+#include <bag_simplelayer.h>
+#include <bag_upgrade.h>
+#include <bag_version.h>
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <cstdlib>  // std::getenv
+#include <cstring>
+#include <memory>
+#include <string>
+#include <tuple>
+
+
+using BAG::Dataset;
+using BAG::Upgrader;
+
+namespace {
+
+constexpr uint32_t kRows = 50;
+constexpr uint32_t kColumns = 70;
+
+const std::array<BAG::LayerType, 5> kLegacyTypes{Hypothesis_Strength,
+    Num_Hypotheses, Shoal_Elevation, Std_Dev, Num_Soundings};
+
+}  // namespace
+
+//  static std::shared_ptr<Dataset> upgrade(const Dataset& dataset,
+//      const std::string& outFileName, uint64_t chunkSize = 0,
+//      int compressionLevel = -1, unsigned int numThreads = 0);
+TEST_CASE("test upgrade interleaved layers", "[upgrade]")
+{
+    const TestUtils::RandomFileGuard legacyFileName;
+    const TestUtils::RandomFileGuard upgradedFileName;
+
+    TestUtils::createLegacyBag(legacyFileName, kRows, kColumns);
+
+    const auto pLegacy = Dataset::open(legacyFileName, BAG_OPEN_READONLY);
+    REQUIRE(pLegacy);
+
+    for (const auto type : kLegacyTypes)
+    {
+        INFO("Layer type " << type);
+        REQUIRE(std::dynamic_pointer_cast<BAG::InterleavedLegacyLayer>(
+            pLegacy->getLayer(type, {})));
+    }
+
+    const auto pUpgraded = Upgrader::upgrade(*pLegacy, upgradedFileName, 0,
+        -1, 3);
+    REQUIRE(pUpgraded);
+
+    CHECK(pLegacy->getDescriptor().getVersion() == "1.6.2");
+    CHECK(pUpgraded->getDescriptor().getVersion() == BAG_VERSION);
+
+    for (const auto type : kLegacyTypes)
+    {
+        INFO("Layer type " << type);
+
+        const auto pLayer = pUpgraded->getSimpleLayer(type);
+        REQUIRE(pLayer);
+        CHECK(pLayer->getDescriptor()->getChunkSize() == 10);
+
+        const auto expected = pLegacy->getLayer(type, {})->read(0, 0,
+            kRows - 1, kColumns - 1);
+        const auto actual = pLayer->read(0, 0, kRows - 1, kColumns - 1);
+        REQUIRE(actual.size() == expected.size());
+        CHECK(std::memcmp(actual.data(), expected.data(), actual.size()) == 0);
+    }
+
+    float minValue = 0.f, maxValue = 0.f;
+    std::tie(minValue, maxValue) =
+        pUpgraded->getSimpleLayer(Shoal_Elevation)->getDescriptor()->getMinMax();
+    CHECK(minValue == Approx(-20.f - 0.1f * (kRows * kColumns - 1)));
+    CHECK(maxValue == Approx(-20.f));
+
+    std::tie(minValue, maxValue) =
+        pUpgraded->getSimpleLayer(Num_Soundings)->getDescriptor()->getMinMax();
+    CHECK(minValue == 0.f);
+    CHECK(maxValue == 10.f);
+
+    // The upgraded BAG reads back without interleaved layers.
+    const auto pReopened = Dataset::open(upgradedFileName, BAG_OPEN_READONLY);
+    REQUIRE(pReopened);
+    CHECK(pReopened->getDescriptor().getVersion() == BAG_VERSION);
+    for (const auto& pLayer : pReopened->getLayers())
+        CHECK_FALSE(std::dynamic_pointer_cast<const BAG::InterleavedLegacyLayer>(
+            pLayer));
+
+    const auto expected = pLegacy->getLayer(Num_Hypotheses, {})->read(3, 4, 20,
+        60);
+    const auto actual = pReopened->getSimpleLayer(Num_Hypotheses)->read(3, 4,
+        20, 60);
+    REQUIRE(actual.size() == expected.size());
+    CHECK(std::memcmp(actual.data(), expected.data(), actual.size()) == 0);
+
+    std::tie(minValue, maxValue) =
+        pReopened->getSimpleLayer(Num_Hypotheses)->getDescriptor()->getMinMax();
+    CHECK(minValue == 0.f);
+    CHECK(maxValue == 6.f);
+}
+
+TEST_CASE("test upgrade of a BAG without interleaved layers", "[upgrade]")
+{
+    const TestUtils::RandomFileGuard upgradedFileName;
+
+    const auto pDataset = Dataset::open(std::string{std::getenv(
+        "BAG_SAMPLES_PATH")} + "/sample.bag", BAG_OPEN_READONLY);
+    REQUIRE(pDataset);
+
+    const auto pUpgraded = Upgrader::upgrade(*pDataset, upgradedFileName);
+    REQUIRE(pUpgraded);
+
+    CHECK(pUpgraded->getLayerTypes() == pDataset->getLayerTypes());
+
+    const auto expected = pDataset->getSimpleLayer(Elevation)->read(0, 0, 9, 9);
+    const auto actual = pUpgraded->getSimpleLayer(Elevation)->read(0, 0, 9, 9);
+    CHECK(std::memcmp(actual.data(), expected.data(), actual.size()) == 0);
+}
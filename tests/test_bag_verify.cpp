@@ -0,0 +1,193 @@
+
+#include "test_utils.h"
+#include <bag_dataset.h>
+#include <bag_simplelayer.h>
+#include <bag_verify.h>
+
+#include <catch2/catch_all.hpp>
+#include <H5Cpp.h>
+#include <string>
+#include <utility>  // std::swap
+#include <vector>
+
+
+using BAG::Dataset;
+
+namespace {
+
+constexpr uint32_t kRows = 100;
+constexpr uint32_t kColumns = 100;
+constexpr uint64_t kChunkSize = 32;
+
+//! Flip one byte in the middle of a stored chunk, bypassing its filters.
+/*!
+\param fileName
+    The name of the BAG.
+\param path
+    The path of the HDF5 DataSet.
+\param row
+    The first row of the chunk.
+\param column
+    The first column of the chunk.
+*/
+void corruptChunk(
+    const std::string& fileName,
+    const std::string& path,
+    hsize_t row,
+    hsize_t column)
+{
+    const ::H5::H5File h5file{fileName, H5F_ACC_RDWR};
+    const auto h5dataSet = h5file.openDataSet(path);
+
+    const hsize_t offset[2] = {row, column};
+    hsize_t numBytes = 0;
+    REQUIRE(H5Dget_chunk_storage_size(h5dataSet.getId(), offset,
+        &numBytes) >= 0);
+    REQUIRE(numBytes > 8);
+
+    std::vector<uint8_t> buffer(numBytes);
+    uint32_t filterMask = 0;
+    REQUIRE(H5Dread_chunk(h5dataSet.getId(), H5P_DEFAULT, offset, &filterMask,
+        buffer.data()) >= 0);
+
+    buffer[numBytes / 2] ^= 0xFF;
+
+    REQUIRE(H5Dwrite_chunk(h5dataSet.getId(), H5P_DEFAULT, filterMask, offset,
+        numBytes, buffer.data()) >= 0);
+}
+
+//! Rewrite the Fletcher32 checksum of a stored chunk as HDF5 did before 1.6.3.
+/*!
+    Those versions swapped the bytes of each 16 bit half of the sum.
+
+\param fileName
+    The name of the BAG.
+\param path
+    The path of the HDF5 DataSet.
+\param row
+    The first row of the chunk.
+\param column
+    The first column of the chunk.
+*/
+void makeLegacyChecksum(
+    const std::string& fileName,
+    const std::string& path,
+    hsize_t row,
+    hsize_t column)
+{
+    const ::H5::H5File h5file{fileName, H5F_ACC_RDWR};
+    const auto h5dataSet = h5file.openDataSet(path);
+
+    const hsize_t offset[2] = {row, column};
+    hsize_t numBytes = 0;
+    REQUIRE(H5Dget_chunk_storage_size(h5dataSet.getId(), offset,
+        &numBytes) >= 0);
+    REQUIRE(numBytes > 8);
+
+    std::vector<uint8_t> buffer(numBytes);
+    uint32_t filterMask = 0;
+    REQUIRE(H5Dread_chunk(h5dataSet.getId(), H5P_DEFAULT, offset, &filterMask,
+        buffer.data()) >= 0);
+
+    // The checksum is the last four bytes.
+    auto* sum = buffer.data() + numBytes - 4;
+    std::swap(sum[0], sum[1]);
+    std::swap(sum[2], sum[3]);
+
+    REQUIRE(H5Dwrite_chunk(h5dataSet.getId(), H5P_DEFAULT, filterMask, offset,
+        numBytes, buffer.data()) >= 0);
+}
+
+}  // namespace
+
+//  static std::shared_ptr<Dataset> create(..., bool checksum);
+//  bool isChecksummed() const noexcept;
+TEST_CASE("test checksummed dataset", "[verify][isChecksummed]")
+{
+    const TestUtils::RandomFileGuard plainFileName;
+    const TestUtils::RandomFileGuard checkedFileName;
+
+    TestUtils::createSurface(plainFileName, kRows, kColumns, kChunkSize);
+    TestUtils::createSurface(checkedFileName, kRows, kColumns, kChunkSize, {},
+        true);
+
+    const auto pPlain = Dataset::open(plainFileName, BAG_OPEN_READONLY);
+    REQUIRE(pPlain);
+    CHECK_FALSE(pPlain->getDescriptor().isChecksummed());
+
+    const auto pChecked = Dataset::open(checkedFileName, BAG_OPEN_READONLY);
+    REQUIRE(pChecked);
+    CHECK(pChecked->getDescriptor().isChecksummed());
+
+    // The checksum is transparent to readers.
+    const auto buffer = pChecked->getSimpleLayer(Elevation)->read(1, 2, 1, 2);
+    CHECK(*reinterpret_cast<const float*>(buffer.data()) ==
+        Catch::Approx(TestUtils::surfaceElevation(kColumns + 2)));
+}
+
+//  std::vector<ChunkFault> verify(unsigned int numThreads) const;
+TEST_CASE("test verify", "[verify][ChunkFault]")
+{
+    const TestUtils::RandomFileGuard plainFileName;
+    const TestUtils::RandomFileGuard checkedFileName;
+
+    TestUtils::createSurface(plainFileName, kRows, kColumns, kChunkSize);
+    TestUtils::createSurface(checkedFileName, kRows, kColumns, kChunkSize, {},
+        true);
+
+    for (unsigned int numThreads : {1u, 4u})
+    {
+        CHECK(Dataset::open(plainFileName, BAG_OPEN_READONLY)->verify(
+            numThreads).empty());
+        CHECK(Dataset::open(checkedFileName, BAG_OPEN_READONLY)->verify(
+            numThreads).empty());
+    }
+
+    // The chunk covering rows 32-63 and columns 64-95.
+    corruptChunk(checkedFileName, "/BAG_root/elevation", 32, 64);
+
+    const auto faults = Dataset::open(checkedFileName,
+        BAG_OPEN_READONLY)->verify(4);
+
+    REQUIRE(faults.size() == 1);
+    CHECK(faults[0].path == "/BAG_root/elevation");
+    CHECK(faults[0].chunkIndex == 6);
+    CHECK(faults[0].rowStart == 32);
+    CHECK(faults[0].columnStart == 64);
+    CHECK(faults[0].rowEnd == 63);
+    CHECK(faults[0].columnEnd == 95);
+    CHECK_FALSE(faults[0].message.empty());
+
+    // The other layers are untouched.
+    corruptChunk(checkedFileName, "/BAG_root/uncertainty", 96, 96);
+    const auto moreFaults = Dataset::open(checkedFileName,
+        BAG_OPEN_READONLY)->verify();
+
+    REQUIRE(moreFaults.size() == 2);
+    CHECK(moreFaults[0].path == "/BAG_root/elevation");
+    CHECK(moreFaults[1].path == "/BAG_root/uncertainty");
+    CHECK(moreFaults[1].chunkIndex == 15);
+    CHECK(moreFaults[1].rowEnd == kRows - 1);
+    CHECK(moreFaults[1].columnEnd == kColumns - 1);
+}
+
+//  std::vector<ChunkFault> verify(unsigned int numThreads) const;
+TEST_CASE("test verify legacy checksum", "[verify][ChunkFault]")
+{
+    const TestUtils::RandomFileGuard fileName;
+    TestUtils::createSurface(fileName, kRows, kColumns, kChunkSize, {}, true);
+
+    // The chunk covering rows 32-63 and columns 64-95.
+    makeLegacyChecksum(fileName, "/BAG_root/elevation", 32, 64);
+
+    const auto pDataset = Dataset::open(fileName, BAG_OPEN_READONLY);
+    REQUIRE(pDataset);
+    CHECK(pDataset->verify(4).empty());
+
+    // HDF5 accepts the legacy checksum too.
+    const auto buffer = pDataset->getSimpleLayer(Elevation)->read(32, 64, 32,
+        64);
+    CHECK(*reinterpret_cast<const float*>(buffer.data()) ==
+        Catch::Approx(TestUtils::surfaceElevation(32 * kColumns + 64)));
+}
+
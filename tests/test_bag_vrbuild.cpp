@@ -0,0 +1,265 @@
+#include "test_utils.h"
+#include <bag_dataset.h>
+#include <bag_exceptions.h>
+#include <bag_metadata.h>
+#include <bag_simplelayer.h>
+#include <bag_vrbuild.h>
+#include <bag_vrmetadata.h>
+#include <bag_vrmetadatadescriptor.h>
+#include <bag_vrnode.h>
+#include <bag_vrnodedescriptor.h>
+#include <bag_vrrefinements.h>
+#include <bag_vrrefinementsdescriptor.h>
+
+#include <catch2/catch_all.hpp>
+#include <cstdlib>  // std::getenv
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+using BAG::Dataset;
+using BAG::Metadata;
+using BAG::VRBuilder;
+using BAG::VRResolutionRule;
+
+namespace {
+
+constexpr uint32_t kRows = 40;
+constexpr uint32_t kColumns = 50;
+constexpr uint32_t kSupercellSize = 8;
+
+//! The elevation of a source cell; deeper to the east.
+float getElevation(
+    uint32_t row,
+    uint32_t column) noexcept
+{
+    // Supercell (1, 2) has no data.
+    if (row >= 8 && row < 16 && column >= 16 && column < 24)
+        return BAG_NULL_ELEVATION;
+
+    return -5.f - 2.f * column - 0.01f * row;
+}
+
+//! Create a dense source BAG of 10 m cells, optionally with a Num_Soundings
+//! layer.
+std::shared_ptr<Dataset> createSource(
+    const std::string& fileName,
+    uint32_t numSoundings)
+{
+    Metadata metadata;
+    metadata.loadFromFile(std::string{std::getenv("BAG_SAMPLES_PATH")} +
+        "/sample.xml");
+    metadata.setGridExtent(kRows, kColumns, metadata.llCornerX(),
+        metadata.llCornerY());
+
+    auto pDataset = Dataset::create(fileName, std::move(metadata), 16, 6);
+
+    std::vector<float> elevations(kRows * kColumns);
+    for (uint32_t row = 0; row < kRows; ++row)
+        for (uint32_t column = 0; column < kColumns; ++column)
+            elevations[row * kColumns + column] = getElevation(row, column);
+
+    pDataset->getSimpleLayer(Elevation)->write(0, 0, kRows - 1, kColumns - 1,
+        reinterpret_cast<const uint8_t*>(elevations.data()));
+
+    const std::vector<float> uncertainties(kRows * kColumns, 0.5f);
+    pDataset->getSimpleLayer(Uncertainty)->write(0, 0, kRows - 1, kColumns - 1,
+        reinterpret_cast<const uint8_t*>(uncertainties.data()));
+
+    if (numSoundings > 0)
+    {
+        const std::vector<uint32_t> soundings(kRows * kColumns, numSoundings);
+        pDataset->createSimpleLayer(Num_Soundings, 16, 6).write(0, 0,
+            kRows - 1, kColumns - 1,
+            reinterpret_cast<const uint8_t*>(soundings.data()));
+    }
+
+    return pDataset;
+}
+
+//! Read the variable resolution metadata of a whole BAG.
+std::vector<BAG::VRMetadataItem> readSupercells(
+    const Dataset& dataset)
+{
+    const auto& metadata = dataset.getMetadata();
+    const auto buffer = dataset.getVRMetadata()->read(0, 0,
+        metadata.rows() - 1, metadata.columns() - 1);
+    const auto* items =
+        reinterpret_cast<const BAG::VRMetadataItem*>(buffer.data());
+
+    return {items, items + metadata.rows() * metadata.columns()};
+}
+
+}  // namespace
+
+//  static std::shared_ptr<Dataset> build(const Dataset& source,
+//      const std::string& outFileName, uint32_t supercellSize,
+//      VRResolutionRule rule = VRResolutionRule::Depth,
+//      double ruleFactor = 0.1, uint64_t chunkSize = 100,
+//      int compressionLevel = 5, unsigned int numThreads = 0);
+TEST_CASE("test vr build by depth", "[vrbuild]")
+{
+    const TestUtils::RandomFileGuard sourceFileName;
+    const TestUtils::RandomFileGuard outFileName;
+    const TestUtils::RandomFileGuard serialFileName;
+
+    const auto pSource = createSource(sourceFileName, 0);
+
+    // The node spacing aims at the shoalest depth of each supercell.
+    const auto pBuilt = VRBuilder::build(*pSource, outFileName, kSupercellSize,
+        VRResolutionRule::Depth, 1., 4, 6, 3);
+    REQUIRE(pBuilt);
+
+    const auto& metadata = pBuilt->getMetadata();
+    CHECK(metadata.rows() == 5);
+    CHECK(metadata.columns() == 7);
+    CHECK(metadata.rowResolution() == Approx(80.));
+    CHECK(metadata.columnResolution() == Approx(80.));
+
+    // The first supercell is centred on its source cells.
+    const auto& sourceMetadata = pSource->getMetadata();
+    CHECK(metadata.llCornerX() == Approx(sourceMetadata.llCornerX() + 35.));
+    CHECK(metadata.llCornerY() == Approx(sourceMetadata.llCornerY() + 35.));
+
+    const auto supercells = readSupercells(*pBuilt);
+
+    // Depths 5 m, 21 m, 37 m and 53 m at the west of the first supercells
+    // make 10 m (the source cells), 26.7 m, 40 m and 80 m nodes.
+    CHECK(supercells[0].dimensions_x == 8);
+    CHECK(supercells[0].dimensions_y == 8);
+    CHECK(supercells[1].dimensions_x == 3);
+    CHECK(supercells[2].dimensions_x == 2);
+    CHECK(supercells[3].dimensions_x == 1);
+    CHECK(supercells[1].resolution_x == Approx(80.f / 3.f));
+    CHECK(supercells[1].sw_corner_x == Approx(40.f / 3.f));
+
+    // The last column of supercells covers two source columns.
+    CHECK(supercells[6].dimensions_x == 1);
+    CHECK(supercells[6].resolution_x == Approx(20.f));
+
+    // The supercell without data is not refined.
+    CHECK(supercells[7 + 2].dimensions_x == 0);
+    CHECK(supercells[7 + 2].index == std::numeric_limits<uint32_t>::max());
+
+    // The refinements are indexed contiguously, row by row.
+    uint32_t index = 0;
+    for (const auto& supercell : supercells)
+    {
+        if (supercell.dimensions_x == 0)
+            continue;
+
+        CHECK(supercell.index == index);
+        index += supercell.dimensions_x * supercell.dimensions_y;
+    }
+
+    const auto pRefinements = pBuilt->getVRRefinements();
+    REQUIRE(pRefinements);
+    CHECK(pRefinements->getDescriptor()->getDims() ==
+        std::make_tuple(1u, index));
+
+    const auto pNode = pBuilt->getVRNode();
+    REQUIRE(pNode);
+    CHECK(std::get<1>(pNode->getDescriptor()->getDims()) == index);
+
+    // Refined to the source cells, the first supercell holds them.
+    const auto refinementsBuffer = pRefinements->read(0, 0, 0, index - 1);
+    const auto* refinements = reinterpret_cast<const BAG::VRRefinementsItem*>(
+        refinementsBuffer.data());
+
+    for (uint32_t row = 0; row < kSupercellSize; ++row)
+        for (uint32_t column = 0; column < kSupercellSize; ++column)
+        {
+            const auto& refinement = refinements[row * kSupercellSize + column];
+            CHECK(refinement.depth == getElevation(row, column));
+            CHECK(refinement.depth_uncrt == 0.5f);
+        }
+
+    const auto nodesBuffer = pNode->read(0, 0, 0, index - 1);
+    const auto* nodes =
+        reinterpret_cast<const BAG::VRNodeItem*>(nodesBuffer.data());
+    CHECK(nodes[0].n_samples == 1);
+    CHECK(nodes[0].num_hypotheses == 1);
+
+    // The low resolution grid holds the mean of each supercell.
+    const auto elevationBuffer = pBuilt->getSimpleLayer(Elevation)->read(0, 0,
+        0, 0);
+    float mean = 0.f;
+    for (uint32_t row = 0; row < kSupercellSize; ++row)
+        for (uint32_t column = 0; column < kSupercellSize; ++column)
+            mean += getElevation(row, column) / (kSupercellSize * kSupercellSize);
+    CHECK(reinterpret_cast<const float*>(elevationBuffer.data())[0] ==
+        Approx(mean));
+
+    // The statistics skip the supercell that is not refined.
+    uint32_t minDimX = 0, minDimY = 0;
+    std::tie(minDimX, minDimY) =
+        pBuilt->getVRMetadata()->getDescriptor()->getMinDimensions();
+    CHECK(minDimX == 1);
+
+    // The output does not depend on the number of threads.
+    const auto pSerial = VRBuilder::build(*pSource, serialFileName,
+        kSupercellSize, VRResolutionRule::Depth, 1., 4, 6, 1);
+    REQUIRE(pSerial);
+
+    const auto serialSupercells = readSupercells(*pSerial);
+    REQUIRE(serialSupercells.size() == supercells.size());
+    CHECK(std::memcmp(serialSupercells.data(), supercells.data(),
+        supercells.size() * sizeof(BAG::VRMetadataItem)) == 0);
+
+    const auto serialRefinements = pSerial->getVRRefinements()->read(0, 0, 0,
+        index - 1);
+    REQUIRE(serialRefinements.size() == refinementsBuffer.size());
+    CHECK(std::memcmp(serialRefinements.data(), refinementsBuffer.data(),
+        refinementsBuffer.size()) == 0);
+}
+
+TEST_CASE("test vr build by density", "[vrbuild]")
+{
+    const TestUtils::RandomFileGuard sourceFileName;
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pSource = createSource(sourceFileName, 4);
+
+    // 256 soundings in a whole supercell make 4 x 4 nodes of 16 soundings.
+    const auto pBuilt = VRBuilder::build(*pSource, outFileName, kSupercellSize,
+        VRResolutionRule::Density, 16.);
+    REQUIRE(pBuilt);
+
+    const auto supercells = readSupercells(*pBuilt);
+    CHECK(supercells[0].dimensions_x == 4);
+    CHECK(supercells[0].dimensions_y == 4);
+    CHECK(supercells[0].resolution_x == Approx(20.f));
+
+    // The last column of supercells has 64 soundings, so 2 x 2 nodes.
+    CHECK(supercells[6].dimensions_x == 2);
+    CHECK(supercells[6].dimensions_y == 2);
+    CHECK(supercells[6].resolution_x == Approx(10.f));
+    CHECK(supercells[6].resolution_y == Approx(40.f));
+
+    const auto nodesBuffer = pBuilt->getVRNode()->read(0, 0, 0, 15);
+    const auto* nodes =
+        reinterpret_cast<const BAG::VRNodeItem*>(nodesBuffer.data());
+    for (uint32_t i = 0; i < 16; ++i)
+        CHECK(nodes[i].n_samples == 16);
+
+    // The mean of the 2 x 2 source cells of the first node.
+    const auto refinementsBuffer = pBuilt->getVRRefinements()->read(0, 0, 0, 0);
+    CHECK(reinterpret_cast<const BAG::VRRefinementsItem*>(
+        refinementsBuffer.data())->depth == Approx((getElevation(0, 0) +
+        getElevation(0, 1) + getElevation(1, 0) + getElevation(1, 1)) / 4.f));
+}
+
+TEST_CASE("test vr build invalid parameters", "[vrbuild]")
+{
+    const TestUtils::RandomFileGuard sourceFileName;
+    const TestUtils::RandomFileGuard outFileName;
+
+    const auto pSource = createSource(sourceFileName, 0);
+
+    REQUIRE_THROWS_AS(VRBuilder::build(*pSource, outFileName, 0),
+        BAG::InvalidSupercellSize);
+    REQUIRE_THROWS_AS(VRBuilder::build(*pSource, outFileName, kSupercellSize,
+        VRResolutionRule::Depth, 0.), BAG::InvalidRuleFactor);
+}
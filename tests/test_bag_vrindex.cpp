@@ -0,0 +1,221 @@
+#include "test_utils.h"
+#include <bag_dataset.h>
+#include <bag_metadata.h>
+#include <bag_vrindex.h>
+#include <bag_vrmetadata.h>
+
+#include <catch2/catch_all.hpp>
+#include <cstdlib>  // std::getenv
+#include <string>
+#include <vector>
+
+
+using BAG::Dataset;
+using BAG::VRIndex;
+
+namespace {
+
+constexpr uint32_t kRows = 20;
+constexpr uint32_t kColumns = 30;
+
+}  // namespace
+
+//  std::shared_ptr<const VRIndex> getVRIndex() const;
+TEST_CASE("test VR index build", "[vrindex]")
+{
+    const auto pSample = Dataset::open(std::string{std::getenv(
+        "BAG_SAMPLES_PATH")} + "/sample.bag", BAG_OPEN_READONLY);
+    REQUIRE(pSample);
+    CHECK_FALSE(pSample->getVRIndex());
+
+    const TestUtils::RandomFileGuard tmpFileName;
+    const auto pDataset = TestUtils::createVRBag(tmpFileName, kRows, kColumns);
+
+    const auto pIndex = pDataset->getVRIndex();
+    REQUIRE(pIndex);
+    CHECK(pDataset->getVRIndex() == pIndex);
+
+    CHECK(pIndex->getRows() == kRows);
+    CHECK(pIndex->getColumns() == kColumns);
+
+    const auto& metadata = pDataset->getMetadata();
+    uint64_t numRefined = 0;
+    uint32_t index = 0;
+    for (uint32_t row = 0; row < kRows; ++row)
+    {
+        for (uint32_t column = 0; column < kColumns; ++column)
+        {
+            const auto expected = TestUtils::vrSupercell(row, column,
+                metadata.rowResolution(), metadata.columnResolution());
+            const auto* pItem = pIndex->getSupercell(row, column);
+
+            if (expected.dimensions_x == 0)
+            {
+                CHECK_FALSE(pItem);
+                continue;
+            }
+
+            REQUIRE(pItem);
+            CHECK(pItem->index == index);
+            CHECK(pItem->dimensions_x == expected.dimensions_x);
+            CHECK(pItem->dimensions_y == expected.dimensions_y);
+
+            index += pItem->dimensions_x * pItem->dimensions_y;
+            ++numRefined;
+        }
+    }
+
+    CHECK(pIndex->getNumRefinedSupercells() == numRefined);
+    CHECK_FALSE(pIndex->getSupercell(kRows, 0));
+
+    // Writing the metadata makes a new index.
+    const BAG::VRMetadataItem empty{0, 0, 0, -1.f, -1.f, -1.f, -1.f};
+    pDataset->getVRMetadata()->write(0, 1, 0, 1,
+        reinterpret_cast<const uint8_t*>(&empty));
+
+    const auto pRebuilt = pDataset->getVRIndex();
+    REQUIRE(pRebuilt);
+    CHECK(pRebuilt != pIndex);
+    CHECK(pRebuilt->getNumRefinedSupercells() == numRefined - 1);
+    CHECK_FALSE(pRebuilt->getSupercell(0, 1));
+}
+
+//  std::vector<VRSample> query(const std::vector<Point>& points,
+//      bool bilinear = false) const;
+TEST_CASE("test VR index point query", "[vrindex]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+    const auto pDataset = TestUtils::createVRBag(tmpFileName, kRows, kColumns);
+    const auto pIndex = pDataset->getVRIndex();
+    REQUIRE(pIndex);
+
+    const auto& metadata = pDataset->getMetadata();
+    const double columnResolution = metadata.columnResolution();
+
+    // Every node of a few supercells, plus positions off the refined grids.
+    std::vector<VRIndex::Point> points;
+    std::vector<uint32_t> expectedIndices;
+    for (const auto& cell : {std::make_pair(0u, 1u), std::make_pair(3u, 7u),
+        std::make_pair(19u, 28u), std::make_pair(10u, 15u)})
+    {
+        const auto* pItem = pIndex->getSupercell(cell.first, cell.second);
+        REQUIRE(pItem);
+
+        for (uint32_t subRow = 0; subRow < pItem->dimensions_y; ++subRow)
+            for (uint32_t subColumn = 0; subColumn < pItem->dimensions_x;
+                ++subColumn)
+            {
+                points.push_back(pIndex->getNodePosition(cell.first,
+                    cell.second, subRow, subColumn));
+                expectedIndices.push_back(pItem->index +
+                    subRow * pItem->dimensions_x + subColumn);
+            }
+    }
+
+    const auto numNodes = points.size();
+
+    // Not refined; (0, 0) and (1, 3) are every fourth supercell.
+    points.push_back(pIndex->getNodePosition(1, 3, 0, 0));
+    // Outside the grid.
+    points.push_back(VRIndex::Point{metadata.llCornerX() -
+        2 * columnResolution, metadata.llCornerY()});
+
+    const auto samples = pIndex->query(points);
+    REQUIRE(samples.size() == points.size());
+
+    for (size_t i = 0; i < numNodes; ++i)
+    {
+        INFO("Point " << i);
+        const auto& sample = samples[i];
+        REQUIRE(sample.found);
+        CHECK(sample.index == expectedIndices[i]);
+        CHECK(sample.depth == TestUtils::vrRefinement(sample.index).depth);
+        CHECK(sample.uncertainty ==
+            TestUtils::vrRefinement(sample.index).depth_uncrt);
+    }
+
+    for (size_t i = numNodes; i < samples.size(); ++i)
+    {
+        CHECK_FALSE(samples[i].found);
+        CHECK(samples[i].depth == BAG_NULL_ELEVATION);
+    }
+
+    // Halfway between the four first nodes of a refined grid.
+    const auto* pItem = pIndex->getSupercell(3, 7);
+    REQUIRE(pItem);
+
+    double x = 0., y = 0.;
+    std::tie(x, y) = pIndex->getNodePosition(3, 7, 0, 0);
+    const VRIndex::Point middle{x + pItem->resolution_x / 2.,
+        y + pItem->resolution_y / 2.};
+
+    const auto nearest = pIndex->query({middle});
+    const auto interpolated = pIndex->query({middle}, true);
+    REQUIRE(nearest.size() == 1);
+    REQUIRE(interpolated.size() == 1);
+    REQUIRE(interpolated[0].found);
+
+    const auto dx = pItem->dimensions_x;
+    const double expected = -(pItem->index + 0.5 + dx / 2.);
+    CHECK(interpolated[0].depth == Approx(expected));
+    CHECK(interpolated[0].index == nearest[0].index);
+    CHECK(interpolated[0].depth != nearest[0].depth);
+}
+
+//  std::vector<VRSample> queryBox(double xMin, double yMin, double xMax,
+//      double yMax) const;
+TEST_CASE("test VR index box query", "[vrindex]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+    const auto pDataset = TestUtils::createVRBag(tmpFileName, kRows, kColumns);
+    const auto pIndex = pDataset->getVRIndex();
+    REQUIRE(pIndex);
+
+    const auto& metadata = pDataset->getMetadata();
+    const double xMin = metadata.llCornerX() + 4.3 * metadata.columnResolution();
+    const double yMin = metadata.llCornerY() + 2.1 * metadata.rowResolution();
+    const double xMax = metadata.llCornerX() + 9.6 * metadata.columnResolution();
+    const double yMax = metadata.llCornerY() + 6.8 * metadata.rowResolution();
+
+    // Every node in the box, found the slow way.
+    std::vector<uint32_t> expectedIndices;
+    for (uint32_t row = 0; row < kRows; ++row)
+        for (uint32_t column = 0; column < kColumns; ++column)
+        {
+            const auto* pItem = pIndex->getSupercell(row, column);
+            if (!pItem)
+                continue;
+
+            for (uint32_t subRow = 0; subRow < pItem->dimensions_y; ++subRow)
+                for (uint32_t subColumn = 0; subColumn < pItem->dimensions_x;
+                    ++subColumn)
+                {
+                    double x = 0., y = 0.;
+                    std::tie(x, y) = pIndex->getNodePosition(row, column,
+                        subRow, subColumn);
+                    if (x >= xMin && x <= xMax && y >= yMin && y <= yMax)
+                        expectedIndices.push_back(pItem->index +
+                            subRow * pItem->dimensions_x + subColumn);
+                }
+        }
+
+    const auto samples = pIndex->queryBox(xMin, yMin, xMax, yMax);
+    REQUIRE(!expectedIndices.empty());
+    REQUIRE(samples.size() == expectedIndices.size());
+
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        const auto& sample = samples[i];
+        CHECK(sample.index == expectedIndices[i]);
+        CHECK(sample.depth == TestUtils::vrRefinement(sample.index).depth);
+        CHECK(sample.x >= xMin);
+        CHECK(sample.x <= xMax);
+        CHECK(sample.y >= yMin);
+        CHECK(sample.y <= yMax);
+    }
+
+    CHECK(pIndex->queryBox(xMax, yMin, xMin, yMax).empty());
+    CHECK(pIndex->queryBox(metadata.llCornerX() - 10 *
+        metadata.columnResolution(), yMin, metadata.llCornerX() - 5 *
+        metadata.columnResolution(), yMax).empty());
+}
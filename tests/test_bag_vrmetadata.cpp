@@ -5,8 +5,12 @@
 #include <bag_vrmetadata.h>
 #include <bag_vrmetadatadescriptor.h>
 
+#include <algorithm>
 #include <catch2/catch_all.hpp>
+#include <limits>
+#include <map>
 #include <string>
+#include <tuple>
 
 
 using BAG::Dataset;
@@ -476,3 +480,98 @@ TEST_CASE("test vr metadata write read", "[vrmetadata][write][read]")
     }
 }
 
+
+//  VRStatistics recomputeStatistics(unsigned int numThreads = 0);
+TEST_CASE("test vr metadata recompute statistics", "[vrmetadata][statistics]")
+{
+    constexpr uint32_t kRows = 20;
+    constexpr uint32_t kColumns = 30;
+
+    const TestUtils::RandomFileGuard tmpBagFile;
+    {
+        const auto pDataset = TestUtils::createVRBag(tmpBagFile, kRows,
+            kColumns);
+        REQUIRE(pDataset);
+
+        const auto pVrMetadata = pDataset->getVRMetadata();
+        REQUIRE(pVrMetadata);
+
+        // Writing counted the supercells that are not refined.
+        uint32_t minDimX = 0, minDimY = 0;
+        std::tie(minDimX, minDimY) =
+            pVrMetadata->getDescriptor()->getMinDimensions();
+        CHECK(minDimX == 0);
+
+        // The statistics, found the slow way.
+        const auto& metadata = pDataset->getMetadata();
+        BAG::VRStatistics expected;
+        expected.minRefinements = std::numeric_limits<uint32_t>::max();
+        std::map<float, uint64_t> resolutions;
+        float minResX = std::numeric_limits<float>::max();
+        float maxResY = 0.f;
+
+        for (uint32_t row = 0; row < kRows; ++row)
+            for (uint32_t column = 0; column < kColumns; ++column)
+            {
+                const auto item = TestUtils::vrSupercell(row, column,
+                    metadata.rowResolution(), metadata.columnResolution());
+                if (item.dimensions_x == 0)
+                    continue;
+
+                const auto count = item.dimensions_x * item.dimensions_y;
+                ++expected.numRefinedSupercells;
+                expected.numRefinements += count;
+                expected.minRefinements = std::min(expected.minRefinements,
+                    count);
+                expected.maxRefinements = std::max(expected.maxRefinements,
+                    count);
+                expected.refinedArea += item.dimensions_x * item.resolution_x *
+                    item.dimensions_y * item.resolution_y;
+                ++resolutions[std::max(item.resolution_x, item.resolution_y)];
+
+                minResX = std::min(minResX, item.resolution_x);
+                maxResY = std::max(maxResY, item.resolution_y);
+            }
+
+        const auto statistics = pVrMetadata->recomputeStatistics(3);
+
+        CHECK(statistics.numRefinedSupercells == expected.numRefinedSupercells);
+        CHECK(statistics.numRefinements == expected.numRefinements);
+        CHECK(statistics.minRefinements == 4);
+        CHECK(statistics.maxRefinements == 12);
+        CHECK(statistics.refinedArea == Approx(expected.refinedArea));
+        // Every refined grid covers its supercell.
+        CHECK(statistics.refinedArea == Approx(expected.numRefinedSupercells *
+            metadata.rowResolution() * metadata.columnResolution()));
+
+        REQUIRE(statistics.resolutions.size() == resolutions.size());
+        auto resolution = resolutions.begin();
+        for (const auto& bin : statistics.resolutions)
+        {
+            CHECK(bin.resolution == resolution->first);
+            CHECK(bin.count == resolution->second);
+            ++resolution;
+        }
+
+        std::tie(minDimX, minDimY) =
+            pVrMetadata->getDescriptor()->getMinDimensions();
+        CHECK(minDimX == 2);
+        CHECK(minDimY == 2);
+        CHECK(std::get<0>(pVrMetadata->getDescriptor()->getMinResolution()) ==
+            minResX);
+        CHECK(std::get<1>(pVrMetadata->getDescriptor()->getMaxResolution()) ==
+            maxResY);
+    }
+
+    // The attributes were rewritten.
+    const auto pDataset = Dataset::open(tmpBagFile, BAG_OPEN_READONLY);
+    REQUIRE(pDataset);
+
+    const auto pDescriptor = pDataset->getVRMetadata()->getDescriptor();
+    CHECK(pDescriptor->getMinDimensions() == std::make_tuple(2u, 2u));
+    CHECK(pDescriptor->getMaxDimensions() == std::make_tuple(4u, 3u));
+    CHECK(std::get<0>(pDescriptor->getMinResolution()) > 0.f);
+
+    // Read only Datasets are recomputed in memory.
+    CHECK(pDataset->getVRMetadata()->recomputeStatistics().numRefinements > 0);
+}
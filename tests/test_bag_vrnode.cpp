@@ -463,3 +463,39 @@ TEST_CASE("test vr node write read", "[vrnode][write][read]")
     CHECK(res->n_samples == kExpectedItem0.n_samples);
 }
 
+
+//  void recomputeStatistics(unsigned int numThreads = 0);
+TEST_CASE("test vr node recompute statistics", "[vrnode][statistics]")
+{
+    const TestUtils::RandomFileGuard tmpBagFile;
+    {
+        const auto pDataset = TestUtils::createVRBag(tmpBagFile, 20, 30);
+        REQUIRE(pDataset);
+
+        const auto pVrNode = pDataset->getVRNode();
+        REQUIRE(pVrNode);
+
+        // A null hypotheses strength, and stale ranges.
+        const BAG::VRNodeItem null{BAG_NULL_GENERIC, 3, 4};
+        pVrNode->write(0, 1, 0, 1, reinterpret_cast<const uint8_t*>(&null));
+
+        const auto pDescriptor = pVrNode->getDescriptor();
+        pDescriptor->setMinMaxNSamples(0, 1000);
+
+        pVrNode->recomputeStatistics(3);
+
+        CHECK(pDescriptor->getMinMaxHypStrength() ==
+            std::make_tuple(0.f, 49.5f));
+        CHECK(pDescriptor->getMinMaxNumHypotheses() ==
+            std::make_tuple(0u, 6u));
+        CHECK(pDescriptor->getMinMaxNSamples() == std::make_tuple(0u, 10u));
+    }
+
+    // The attributes were rewritten.
+    const auto pDataset = Dataset::open(tmpBagFile, BAG_OPEN_READONLY);
+    REQUIRE(pDataset);
+
+    const auto pDescriptor = pDataset->getVRNode()->getDescriptor();
+    CHECK(pDescriptor->getMinMaxHypStrength() == std::make_tuple(0.f, 49.5f));
+    CHECK(pDescriptor->getMinMaxNSamples() == std::make_tuple(0u, 10u));
+}
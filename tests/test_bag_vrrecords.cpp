@@ -0,0 +1,133 @@
+#include "test_utils.h"
+#include <bag_dataset.h>
+#include <bag_exceptions.h>
+#include <bag_metadata.h>
+#include <bag_vrindex.h>
+#include <bag_vrrecords.h>
+#include <bag_vrrefinements.h>
+#include <bag_vrrefinementsdescriptor.h>
+
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <cstdlib>  // std::getenv
+#include <string>
+
+
+using BAG::Dataset;
+using BAG::VRRecordReader;
+
+namespace {
+
+constexpr uint32_t kRows = 20;
+constexpr uint32_t kColumns = 30;
+
+//! Check a record holds the refinement and node at an index of a BAG made by
+//! TestUtils::createVRBag().
+void checkRecord(
+    const BAG::VRRecord& record,
+    uint32_t index)
+{
+    INFO("Index " << index);
+
+    const auto refinement = TestUtils::vrRefinement(index);
+    const auto node = TestUtils::vrNode(index);
+
+    CHECK(record.depth == refinement.depth);
+    CHECK(record.depth_uncrt == refinement.depth_uncrt);
+    CHECK(record.hyp_strength == node.hyp_strength);
+    CHECK(record.num_hypotheses == node.num_hypotheses);
+    CHECK(record.n_samples == node.n_samples);
+}
+
+}  // namespace
+
+//  static std::vector<VRRecord> read(const Dataset& dataset,
+//      uint32_t indexStart, uint32_t indexEnd);
+TEST_CASE("test vr records read", "[vrrecords][read]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+    const auto pDataset = TestUtils::createVRBag(tmpFileName, kRows, kColumns);
+    REQUIRE(pDataset);
+
+    // Across several chunks of the refinements.
+    constexpr uint32_t kStart = 37;
+    constexpr uint32_t kEnd = 1500;
+
+    const auto records = VRRecordReader::read(*pDataset, kStart, kEnd);
+    REQUIRE(records.size() == kEnd - kStart + 1);
+
+    for (uint32_t i = kStart; i <= kEnd; ++i)
+        checkRecord(records[i - kStart], i);
+
+    const auto single = VRRecordReader::read(*pDataset, 5, 5);
+    REQUIRE(single.size() == 1);
+    checkRecord(single[0], 5);
+
+    REQUIRE_THROWS_AS(VRRecordReader::read(*pDataset, 6, 5),
+        BAG::InvalidReadSize);
+
+    const auto numRefinements = std::get<1>(
+        pDataset->getVRRefinements()->getDescriptor()->getDims());
+    REQUIRE_THROWS_AS(VRRecordReader::read(*pDataset, 0, numRefinements),
+        BAG::InvalidReadSize);
+
+    // A BAG without variable resolution layers.
+    const auto pSample = Dataset::open(std::string{std::getenv(
+        "BAG_SAMPLES_PATH")} + "/sample.bag", BAG_OPEN_READONLY);
+    REQUIRE(pSample);
+    REQUIRE_THROWS_AS(VRRecordReader::read(*pSample, 0, 0),
+        BAG::LayerNotFound);
+}
+
+//  static VRSupercellRecords readSupercells(const Dataset& dataset,
+//      uint32_t rowStart, uint32_t columnStart, uint32_t rowEnd,
+//      uint32_t columnEnd);
+TEST_CASE("test vr records read supercells", "[vrrecords][read]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+    const auto pDataset = TestUtils::createVRBag(tmpFileName, kRows, kColumns);
+    REQUIRE(pDataset);
+
+    const auto pIndex = pDataset->getVRIndex();
+    REQUIRE(pIndex);
+
+    constexpr uint32_t kRowStart = 3;
+    constexpr uint32_t kColumnStart = 4;
+    constexpr uint32_t kRowEnd = 9;
+    constexpr uint32_t kColumnEnd = 12;
+
+    const auto result = VRRecordReader::readSupercells(*pDataset, kRowStart,
+        kColumnStart, kRowEnd, kColumnEnd);
+    CHECK(result.rows == kRowEnd - kRowStart + 1);
+    CHECK(result.columns == kColumnEnd - kColumnStart + 1);
+    REQUIRE(result.offsets.size() == result.rows * result.columns + 1);
+    CHECK(result.offsets.back() == result.items.size());
+
+    for (uint32_t row = kRowStart; row <= kRowEnd; ++row)
+    {
+        for (uint32_t column = kColumnStart; column <= kColumnEnd; ++column)
+        {
+            INFO("Supercell " << row << ", " << column);
+
+            const auto i = (row - kRowStart) * result.columns +
+                (column - kColumnStart);
+            const auto numRecords = result.offsets[i + 1] - result.offsets[i];
+            const auto* pSupercell = pIndex->getSupercell(row, column);
+
+            if (!pSupercell)
+            {
+                CHECK(numRecords == 0);
+                continue;
+            }
+
+            REQUIRE(numRecords ==
+                pSupercell->dimensions_x * pSupercell->dimensions_y);
+            for (uint64_t j = 0; j < numRecords; ++j)
+                checkRecord(result.items[result.offsets[i] + j],
+                    static_cast<uint32_t>(pSupercell->index + j));
+        }
+    }
+
+    REQUIRE_THROWS_AS(VRRecordReader::readSupercells(*pDataset, 1, 0, 0, 0),
+        BAG::InvalidReadSize);
+}
@@ -1,12 +1,18 @@
 
 #include "test_utils.h"
 #include <bag_dataset.h>
+#include <bag_exceptions.h>
 #include <bag_metadata.h>
+#include <bag_vrmetadata.h>
+#include <bag_vrnode.h>
+#include <bag_vrnodedescriptor.h>
 #include <bag_vrrefinements.h>
 #include <bag_vrrefinementsdescriptor.h>
 
 #include <catch2/catch_all.hpp>
+#include <H5Cpp.h>
 #include <string>
+#include <vector>
 
 
 using BAG::Dataset;
@@ -495,3 +501,240 @@ TEST_CASE("test vr refinements write read", "[vrrefinements][write][read]")
     CHECK(std::get<1>(vrRefDescDims) == 2);
 }
 
+//  VRSupercellRefinements readSupercells(uint32_t rowStart,
+//      uint32_t columnStart, uint32_t rowEnd, uint32_t columnEnd) const;
+TEST_CASE("test vr refinements read supercells", "[vrrefinements][read]")
+{
+    constexpr uint32_t kRows = 12;
+    constexpr uint32_t kColumns = 15;
+
+    const TestUtils::RandomFileGuard tmpBagFile;
+    const auto pDataset = TestUtils::createVRBag(tmpBagFile, kRows, kColumns);
+    const auto pVrRefinements = pDataset->getVRRefinements();
+    REQUIRE(pVrRefinements);
+
+    const auto& metadata = pDataset->getMetadata();
+
+    // A rectangle whose refinements are in several ranges of the layer.
+    constexpr uint32_t kRowStart = 2;
+    constexpr uint32_t kColumnStart = 3;
+    constexpr uint32_t kRowEnd = 7;
+    constexpr uint32_t kColumnEnd = 9;
+
+    const auto result = pVrRefinements->readSupercells(kRowStart, kColumnStart,
+        kRowEnd, kColumnEnd);
+    CHECK(result.rows == kRowEnd - kRowStart + 1);
+    CHECK(result.columns == kColumnEnd - kColumnStart + 1);
+    REQUIRE(result.offsets.size() == result.rows * result.columns + 1);
+    CHECK(result.offsets.back() == result.items.size());
+
+    // The refinements of the supercells before each one, as createVRBag()
+    // numbers them.
+    std::vector<uint32_t> indices(kRows * kColumns);
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < kRows * kColumns; ++i)
+    {
+        const auto item = TestUtils::vrSupercell(i / kColumns, i % kColumns,
+            metadata.rowResolution(), metadata.columnResolution());
+        indices[i] = index;
+        index += item.dimensions_x * item.dimensions_y;
+    }
+
+    size_t slot = 0;
+    for (uint32_t row = kRowStart; row <= kRowEnd; ++row)
+    {
+        for (uint32_t column = kColumnStart; column <= kColumnEnd; ++column, ++slot)
+        {
+            INFO("Supercell " << row << ", " << column);
+            const auto item = TestUtils::vrSupercell(row, column,
+                metadata.rowResolution(), metadata.columnResolution());
+            const auto count = item.dimensions_x * item.dimensions_y;
+
+            REQUIRE(result.offsets[slot + 1] - result.offsets[slot] == count);
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const auto expected =
+                    TestUtils::vrRefinement(indices[row * kColumns + column] + i);
+                const auto& actual = result.items[result.offsets[slot] + i];
+                CHECK(actual.depth == expected.depth);
+                CHECK(actual.depth_uncrt == expected.depth_uncrt);
+            }
+        }
+    }
+
+    // Supercells sharing refinements each get a copy.
+    const auto firstBuffer = pDataset->getVRMetadata()->read(0, 1, 0, 1);
+    pDataset->getVRMetadata()->write(0, 2, 0, 2, firstBuffer.data());
+
+    const auto shared = pVrRefinements->readSupercells(0, 1, 0, 2);
+    REQUIRE(shared.offsets.size() == 3);
+    REQUIRE(shared.offsets[1] == shared.offsets[2] - shared.offsets[1]);
+    for (uint64_t i = 0; i < shared.offsets[1]; ++i)
+        CHECK(shared.items[i].depth == shared.items[shared.offsets[1] + i].depth);
+
+    REQUIRE_THROWS_AS(pVrRefinements->readSupercells(0, 0, kRows, 0),
+        BAG::InvalidReadSize);
+    REQUIRE_THROWS_AS(pVrRefinements->readSupercells(1, 0, 0, 0),
+        BAG::InvalidReadSize);
+}
+
+//  void reserve(uint32_t numItems);
+TEST_CASE("test vr refinements growth and trim", "[vrrefinements][write]")
+{
+    const TestUtils::RandomFileGuard tmpBagFile;
+
+    constexpr uint32_t kNumItems = 1000;
+
+    // The extent of the refinements in the file.
+    const auto getExtent = [&tmpBagFile]() {
+        const ::H5::H5File h5file{tmpBagFile, H5F_ACC_RDONLY};
+        hsize_t dims[2]{};
+        h5file.openDataSet("/BAG_root/varres_refinements").getSpace()
+            .getSimpleExtentDims(dims);
+
+        return dims[1];
+    };
+
+    {
+        BAG::Metadata metadata;
+        metadata.loadFromBuffer(kMetadataXML);
+
+        const auto pDataset = Dataset::create(tmpBagFile, std::move(metadata),
+            100, 6);
+        REQUIRE(pDataset);
+        pDataset->createVR(100, 6, false);
+
+        auto pVrRefinements = pDataset->getVRRefinements();
+        REQUIRE(pVrRefinements);
+
+        // Append one refinement at a time.
+        for (uint32_t i = 0; i < kNumItems; ++i)
+        {
+            const BAG::VRRefinementsItem item{static_cast<float>(i), 0.5f};
+            pVrRefinements->write(0, i, 0, i,
+                reinterpret_cast<const uint8_t*>(&item));
+        }
+
+        UNSCOPED_INFO("Check the layer is the size written.");
+        CHECK(pVrRefinements->getDescriptor()->getDims() ==
+            std::make_tuple(1u, kNumItems));
+
+        UNSCOPED_INFO("Check the DataSet grew ahead of the writes.");
+        CHECK(getExtent() >= kNumItems);
+        CHECK(getExtent() < 2 * kNumItems);
+
+        UNSCOPED_INFO("Check reserving makes room without changing the size.");
+        pVrRefinements->reserve(5 * kNumItems);
+        CHECK(getExtent() == 5 * kNumItems);
+        CHECK(pVrRefinements->getDescriptor()->getDims() ==
+            std::make_tuple(1u, kNumItems));
+        REQUIRE_THROWS_AS(pVrRefinements->read(0, kNumItems, 0, kNumItems),
+            BAG::InvalidReadSize);
+
+        pDataset->close();
+    }
+
+    UNSCOPED_INFO("Check closing trimmed the DataSet to the size written.");
+    CHECK(getExtent() == kNumItems);
+
+    const auto pDataset = Dataset::open(tmpBagFile, BAG_OPEN_READONLY);
+    const auto pVrRefinements = pDataset->getVRRefinements();
+    REQUIRE(pVrRefinements);
+    CHECK(pVrRefinements->getDescriptor()->getDims() ==
+        std::make_tuple(1u, kNumItems));
+
+    const auto buffer = pVrRefinements->read(0, kNumItems - 1, 0,
+        kNumItems - 1);
+    CHECK(reinterpret_cast<const BAG::VRRefinementsItem*>(
+        buffer.data())->depth == kNumItems - 1);
+}
+
+//  void createVR(uint64_t chunkSize, int compressionLevel, bool makeNode);
+TEST_CASE("test vr refinements chunking", "[vrrefinements][create]")
+{
+    // The chunk dimensions of a variable resolution DataSet in the file.
+    const auto getChunkDims = [](const std::string& fileName,
+        const char* path) {
+        const ::H5::H5File h5file{fileName, H5F_ACC_RDONLY};
+        hsize_t dims[2]{};
+        h5file.openDataSet(path).getCreatePlist().getChunk(2, dims);
+
+        return std::make_tuple(dims[0], dims[1]);
+    };
+
+    for (const uint64_t chunkSize : {10ull, 100ull})
+    {
+        INFO("Chunk size " << chunkSize);
+
+        const TestUtils::RandomFileGuard tmpBagFile;
+
+        // Square chunks of records are capped at kMaxVRChunkLength.
+        const hsize_t expected = chunkSize == 10 ? 100 : 1024;
+        {
+            BAG::Metadata metadata;
+            metadata.loadFromBuffer(kMetadataXML);
+
+            const auto pDataset = Dataset::create(tmpBagFile,
+                std::move(metadata), chunkSize, 6);
+            REQUIRE(pDataset);
+            pDataset->createVR(chunkSize, 6, true);
+
+            CHECK(pDataset->getVRRefinements()->getDescriptor()->getChunkSize()
+                == expected);
+            CHECK(pDataset->getVRNode()->getDescriptor()->getChunkSize() ==
+                expected);
+        }
+
+        CHECK(getChunkDims(tmpBagFile, "/BAG_root/varres_refinements") ==
+            std::make_tuple(hsize_t{1}, expected));
+        CHECK(getChunkDims(tmpBagFile, "/BAG_root/varres_nodes") ==
+            std::make_tuple(hsize_t{1}, expected));
+
+        // The chunk length is read back from the file.
+        const auto pDataset = Dataset::open(tmpBagFile, BAG_OPEN_READONLY);
+        REQUIRE(pDataset);
+        CHECK(pDataset->getVRRefinements()->getDescriptor()->getChunkSize() ==
+            expected);
+    }
+}
+
+//  void recomputeStatistics(unsigned int numThreads = 0);
+TEST_CASE("test vr refinements recompute statistics",
+    "[vrrefinements][statistics]")
+{
+    const TestUtils::RandomFileGuard tmpBagFile;
+    {
+        const auto pDataset = TestUtils::createVRBag(tmpBagFile, 20, 30);
+        REQUIRE(pDataset);
+
+        const auto pVrRefinements = pDataset->getVRRefinements();
+        REQUIRE(pVrRefinements);
+
+        // Writing a null refinement widens the ranges to the null value.
+        const BAG::VRRefinementsItem null{BAG_NULL_ELEVATION,
+            BAG_NULL_UNCERTAINTY};
+        pVrRefinements->write(0, 3, 0, 3,
+            reinterpret_cast<const uint8_t*>(&null));
+
+        const auto pDescriptor = pVrRefinements->getDescriptor();
+        CHECK(std::get<1>(pDescriptor->getMinMaxDepth()) == BAG_NULL_ELEVATION);
+
+        pVrRefinements->recomputeStatistics(3);
+
+        const auto numRefinements = std::get<1>(pDescriptor->getDims());
+        CHECK(pDescriptor->getMinMaxDepth() == std::make_tuple(
+            -static_cast<float>(numRefinements - 1), 0.f));
+        CHECK(std::get<0>(pDescriptor->getMinMaxUncertainty()) == 1.f);
+        CHECK(std::get<1>(pDescriptor->getMinMaxUncertainty()) ==
+            Approx(1.4f));
+    }
+
+    // The attributes were rewritten.
+    const auto pDataset = Dataset::open(tmpBagFile, BAG_OPEN_READONLY);
+    REQUIRE(pDataset);
+
+    const auto pDescriptor = pDataset->getVRRefinements()->getDescriptor();
+    CHECK(std::get<1>(pDescriptor->getMinMaxDepth()) == 0.f);
+    CHECK(std::get<1>(pDescriptor->getMinMaxUncertainty()) == Approx(1.4f));
+}
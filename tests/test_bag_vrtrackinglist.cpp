@@ -1,11 +1,17 @@
 
 #include "test_utils.h"
 #include <bag_dataset.h>
+#include <bag_exceptions.h>
 #include <bag_metadata.h>
+#include <bag_trackinglistreader.h>
 #include <bag_vrtrackinglist.h>
 
+#include <algorithm>
 #include <catch2/catch_all.hpp>
+#include <iterator>
 #include <string>
+#include <tuple>
+#include <vector>
 
 
 using BAG::Dataset;
@@ -425,3 +431,204 @@ TEST_CASE("test VR tracking list construction (create, open)", "[vrtrackinglist]
     CHECK(kExpectedItem1 == (*trackingList)[1]);
 }
 
+
+//  std::vector<value_type> findNode(uint32_t row, uint32_t col) const;
+//  std::vector<value_type> findSubNode(uint32_t row, uint32_t col,
+//      uint32_t subRow, uint32_t subCol) const;
+//  std::vector<value_type> findSubPosition(uint32_t subRow,
+//      uint32_t subCol) const;
+//  std::vector<value_type> findCode(uint8_t code) const;
+//  std::vector<value_type> findSeries(uint16_t series) const;
+TEST_CASE("test VR tracking list find", "[vrtrackinglist][find]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    BAG::Metadata metadata;
+    metadata.loadFromBuffer(kMetadataXML);
+
+    const auto pDataset = Dataset::create(tmpFileName, std::move(metadata),
+        100, 6);
+    REQUIRE(pDataset);
+
+    pDataset->createVR(100, 6, false);
+    const auto trackingList = pDataset->getVRTrackingList();
+    REQUIRE(trackingList);
+
+    // Items of 4 x 4 supercells of 3 x 3 nodes, out of order.
+    for (uint32_t i = 0; i < 288; ++i)
+        trackingList->emplace_back(VRTrackingList::value_type{(i * 3) % 4,
+            (i / 4) % 4, (i * 5) % 3, (i / 16) % 3, static_cast<float>(i),
+            0.5f, static_cast<uint8_t>(i % 2), static_cast<uint16_t>(i / 96)});
+
+    const auto depths = [](const std::vector<VRTrackingList::value_type>& items) {
+        std::vector<uint32_t> result;
+        for (const auto& item : items)
+            result.push_back(static_cast<uint32_t>(item.depth));
+        return result;
+    };
+
+    const auto expected = [&trackingList, &depths](
+        bool (*matches)(const VRTrackingList::value_type&)) {
+        std::vector<VRTrackingList::value_type> result;
+        std::copy_if(trackingList->cbegin(), trackingList->cend(),
+            std::back_inserter(result), matches);
+        return depths(result);
+    };
+
+    const auto found = depths(trackingList->findNode(1, 2));
+    CHECK(found.size() == 18);
+    CHECK(found == expected([](const VRTrackingList::value_type& item) {
+        return item.row == 1 && item.col == 2;
+    }));
+
+    CHECK(depths(trackingList->findSubNode(1, 2, 0, 1)) ==
+        expected([](const VRTrackingList::value_type& item) {
+            return item.row == 1 && item.col == 2 && item.sub_row == 0 &&
+                item.sub_col == 1;
+        }));
+
+    CHECK(depths(trackingList->findSubPosition(2, 0)) ==
+        expected([](const VRTrackingList::value_type& item) {
+            return item.sub_row == 2 && item.sub_col == 0;
+        }));
+
+    CHECK(trackingList->findCode(1).size() == 144);
+    CHECK(trackingList->findSeries(1).size() == 96);
+    CHECK(trackingList->findNode(4, 0).empty());
+
+    UNSCOPED_INFO("Check appended items are found.");
+    trackingList->emplace_back(VRTrackingList::value_type{1, 2, 0, 1, 1000.f,
+        0.5f, 1, 5});
+    CHECK(trackingList->findSubNode(1, 2, 0, 1).back().depth == 1000.f);
+    CHECK(trackingList->findSeries(5).size() == 1);
+}
+
+//  TrackingListOrder getSortOrder() const noexcept;
+//  void sortBy(TrackingListOrder order, unsigned int numThreads = 0);
+TEST_CASE("test VR tracking list sort", "[vrtrackinglist][sort]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    {
+        BAG::Metadata metadata;
+        metadata.loadFromBuffer(kMetadataXML);
+
+        const auto pDataset = Dataset::create(tmpFileName, std::move(metadata),
+            100, 6);
+        REQUIRE(pDataset);
+
+        pDataset->createVR(100, 6, false);
+        const auto trackingList = pDataset->getVRTrackingList();
+        REQUIRE(trackingList);
+
+        for (uint32_t i = 0; i < 500; ++i)
+            trackingList->emplace_back(VRTrackingList::value_type{(i * 3) % 7,
+                (i * 5) % 11, (i * 2) % 3, i % 4, static_cast<float>(i), 0.5f,
+                static_cast<uint8_t>(i % 2), static_cast<uint16_t>(i % 6)});
+
+        REQUIRE_THROWS_AS(trackingList->sortBy(
+            BAG::TrackingListOrder::Unsorted), BAG::InvalidSortOrder);
+
+        const auto expected = trackingList->findSubNode(2, 4, 1, 3);
+
+        trackingList->sortBy(BAG::TrackingListOrder::Node, 2);
+        CHECK(trackingList->getSortOrder() == BAG::TrackingListOrder::Node);
+        CHECK(std::is_sorted(trackingList->cbegin(), trackingList->cend(),
+            [](const VRTrackingList::value_type& lhs,
+                const VRTrackingList::value_type& rhs) {
+                return std::tie(lhs.row, lhs.col, lhs.sub_row, lhs.sub_col) <
+                    std::tie(rhs.row, rhs.col, rhs.sub_row, rhs.sub_col);
+            }));
+
+        UNSCOPED_INFO("Check lookups on the sorted list keep list order.");
+        const auto found = trackingList->findSubNode(2, 4, 1, 3);
+        REQUIRE(found.size() == expected.size());
+        for (size_t i = 0; i < found.size(); ++i)
+            CHECK(found[i] == expected[i]);
+
+        UNSCOPED_INFO("Check replacing an item drops the sort order.");
+        auto item = trackingList->front();
+        item.depth = -7.f;
+        trackingList->set(0, item);
+        CHECK(trackingList->getSortOrder() ==
+            BAG::TrackingListOrder::Unsorted);
+
+        trackingList->sortBy(BAG::TrackingListOrder::SubPosition);
+        trackingList->write();
+        pDataset->close();
+    }
+
+    const auto pDataset = Dataset::open(tmpFileName, BAG_OPEN_READONLY);
+    const auto trackingList = pDataset->getVRTrackingList();
+    REQUIRE(trackingList);
+
+    UNSCOPED_INFO("Check the sort order was recorded.");
+    CHECK(trackingList->getSortOrder() ==
+        BAG::TrackingListOrder::SubPosition);
+    CHECK(trackingList->isReordered());
+    CHECK(trackingList->front().sub_row == 0);
+    CHECK(trackingList->front().sub_col == 0);
+    CHECK(trackingList->getSortOrder() ==
+        BAG::TrackingListOrder::SubPosition);
+    CHECK(trackingList->findSubPosition(2, 3).size() ==
+        static_cast<size_t>(std::count_if(trackingList->cbegin(),
+            trackingList->cend(), [](const VRTrackingList::value_type& item) {
+                return item.sub_row == 2 && item.sub_col == 3;
+            })));
+}
+
+//  static std::shared_ptr<Dataset> open(..., bool streamTrackingLists);
+TEST_CASE("test VR tracking list streaming", "[vrtrackinglist][stream]")
+{
+    const TestUtils::RandomFileGuard tmpFileName;
+
+    {
+        BAG::Metadata metadata;
+        metadata.loadFromBuffer(kMetadataXML);
+
+        const auto pDataset = Dataset::create(tmpFileName, std::move(metadata),
+            100, 6);
+        REQUIRE(pDataset);
+
+        pDataset->createVR(100, 6, false);
+        const auto trackingList = pDataset->getVRTrackingList();
+        REQUIRE(trackingList);
+
+        for (uint32_t i = 0; i < 500; ++i)
+            trackingList->emplace_back(VRTrackingList::value_type{(i * 3) % 7,
+                (i * 5) % 11, (i * 2) % 3, i % 4, static_cast<float>(i), 0.5f,
+                static_cast<uint8_t>(i % 2), static_cast<uint16_t>(i % 6)});
+
+        trackingList->write();
+        pDataset->close();
+    }
+
+    const auto pDataset = Dataset::open(tmpFileName, BAG_OPEN_READONLY, true);
+    REQUIRE(pDataset);
+
+    const auto trackingList = pDataset->getVRTrackingList();
+    REQUIRE(trackingList);
+    CHECK_FALSE(trackingList->isLoaded());
+    CHECK(trackingList->empty());
+    REQUIRE_THROWS_AS(trackingList->write(), BAG::TrackingListNotLoaded);
+
+    const auto pReader = pDataset->getVRTrackingListReader();
+    REQUIRE(pReader);
+    REQUIRE(pReader->size() == 500);
+    CHECK(pReader->getNumBlocks() == 1);
+    CHECK(pReader->readBlock(0).size() == 500);
+
+    const auto item = pReader->read(123);
+    CHECK(item == VRTrackingList::value_type{(123 * 3) % 7, (123 * 5) % 11,
+        (123 * 2) % 3, 123 % 4, 123.f, 0.5f, 1, 123 % 6});
+
+    CHECK(pReader->findCode(1).size() == 250);
+    CHECK(pReader->findSeries(5).size() == 83);
+
+    const auto items = pReader->readBlock(0);
+    const auto found = pReader->findBox(2, 4, 3, 4);
+    CHECK(found.size() == static_cast<size_t>(std::count_if(items.begin(),
+        items.end(), [](const VRTrackingList::value_type& other) {
+            return other.row >= 2 && other.row <= 3 && other.col == 4;
+        })));
+}
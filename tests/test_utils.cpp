@@ -15,6 +15,15 @@
 #include <bag_simplelayer.h>
 #include <bag_surfacecorrections.h>
 #include <bag_surfacecorrectionsdescriptor.h>
+#include <bag_version.h>
+#include <bag_vrmetadata.h>
+#include <bag_vrnode.h>
+#include <bag_vrrefinements.h>
+
+#include <cstdlib>  // std::getenv
+#include <H5Cpp.h>
+#include <limits>
+#include <vector>
 
 
 using BAG::Dataset;
@@ -352,5 +361,219 @@ void create_unknown_metadata(const std::string& elevationLayerName,
                         reinterpret_cast<const uint8_t *>(secondBuffer.data()));
 }
 
-}  // namespace TestUtils
+std::shared_ptr<BAG::Dataset> createSurface(
+    const std::string& fileName,
+    uint32_t rows,
+    uint32_t columns,
+    uint64_t chunkSize,
+    const std::function<float(uint32_t, uint32_t)>& elevation,
+    bool checksum,
+    uint32_t columnOffset)
+{
+    BAG::Metadata metadata;
+    metadata.loadFromFile(std::string{std::getenv("BAG_SAMPLES_PATH")} +
+        "/sample.xml");
+    metadata.setGridExtent(rows, columns,
+        metadata.llCornerX() + columnOffset * metadata.columnResolution(),
+        metadata.llCornerY());
+
+    auto pDataset = Dataset::create(fileName, std::move(metadata), chunkSize,
+        6, checksum);
+
+    std::vector<float> elevations(rows * columns);
+    for (uint32_t row = 0; row < rows; ++row)
+        for (uint32_t column = 0; column < columns; ++column)
+            elevations[row * columns + column] = elevation ?
+                elevation(row, column) :
+                surfaceElevation(row * columns + column);
+
+    pDataset->getSimpleLayer(Elevation)->write(0, 0, rows - 1, columns - 1,
+        reinterpret_cast<const uint8_t*>(elevations.data()));
+
+    const std::vector<float> uncertainties(rows * columns, 1.f);
+    pDataset->getSimpleLayer(Uncertainty)->write(0, 0, rows - 1, columns - 1,
+        reinterpret_cast<const uint8_t*>(uncertainties.data()));
+
+    return pDataset;
+}
+
+namespace {
+
+//! Write an interleaved group as a chunked, compressed compound DataSet,
+//! with the min/max attributes of its members.
+template <typename T>
+void writeLegacyGroup(
+    ::H5::H5File& h5file,
+    const std::string& path,
+    const ::H5::CompType& h5type,
+    uint32_t rows,
+    uint32_t columns,
+    const std::vector<T>& records,
+    const std::vector<std::string>& attributeNames)
+{
+    const std::array<hsize_t, 2> dims{rows, columns};
+    const ::H5::DataSpace h5space{2, dims.data()};
+
+    ::H5::DSetCreatPropList h5createPropList;
+    const std::array<hsize_t, 2> chunkDims{kLegacyChunkSize, kLegacyChunkSize};
+    h5createPropList.setChunk(2, chunkDims.data());
+    h5createPropList.setDeflate(6);
+
+    const auto h5dataSet = h5file.createDataSet(path, h5type, h5space,
+        h5createPropList);
+    h5dataSet.write(records.data(), h5type);
+
+    constexpr float kZero = 0.f;
+    for (const auto& name : attributeNames)
+        h5dataSet.createAttribute(name, ::H5::PredType::NATIVE_FLOAT,
+            ::H5::DataSpace{}).write(::H5::PredType::NATIVE_FLOAT, &kZero);
+}
+
+}  // namespace
+
+void createLegacyBag(
+    const std::string& fileName,
+    uint32_t rows,
+    uint32_t columns)
+{
+    {
+        BAG::Metadata metadata;
+        metadata.loadFromFile(std::string{std::getenv("BAG_SAMPLES_PATH")} +
+            "/sample.xml");
+        metadata.setGridExtent(rows, columns, metadata.llCornerX(),
+            metadata.llCornerY());
+
+        auto pDataset = Dataset::create(fileName, std::move(metadata), 10, 6);
+
+        std::vector<float> elevations(rows * columns);
+        for (uint32_t i = 0; i < rows * columns; ++i)
+            elevations[i] = -10.f - 0.01f * i;
+
+        pDataset->getSimpleLayer(Elevation)->write(0, 0, rows - 1,
+            columns - 1, reinterpret_cast<const uint8_t*>(elevations.data()));
+    }
+
+    std::vector<LegacyNodeRecord> nodes(rows * columns);
+    std::vector<LegacyElevationRecord> elevations(rows * columns);
+    for (uint32_t i = 0; i < rows * columns; ++i)
+    {
+        nodes[i] = legacyNodeRecord(i);
+        elevations[i] = legacyElevationRecord(i);
+    }
+
+    ::H5::H5File h5file{fileName, H5F_ACC_RDWR};
+
+    std::array<char, BAG_VERSION_LENGTH> version{"1.6.2"};
+    h5file.openGroup("/BAG_root").openAttribute("Bag Version").write(
+        ::H5::StrType{0, BAG_VERSION_LENGTH}, version.data());
+
+    ::H5::CompType nodeType{sizeof(LegacyNodeRecord)};
+    nodeType.insertMember("hyp_strength",
+        HOFFSET(LegacyNodeRecord, hyp_strength), ::H5::PredType::NATIVE_FLOAT);
+    nodeType.insertMember("num_hypotheses",
+        HOFFSET(LegacyNodeRecord, num_hypotheses),
+        ::H5::PredType::NATIVE_UINT32);
+    writeLegacyGroup(h5file, "/BAG_root/node", nodeType, rows, columns, nodes,
+        {"min_hyp_strength", "max_hyp_strength", "min_num_hypotheses",
+        "max_num_hypotheses"});
+
+    ::H5::CompType elevationType{sizeof(LegacyElevationRecord)};
+    elevationType.insertMember("shoal_elevation",
+        HOFFSET(LegacyElevationRecord, shoal_elevation),
+        ::H5::PredType::NATIVE_FLOAT);
+    elevationType.insertMember("stddev",
+        HOFFSET(LegacyElevationRecord, stddev), ::H5::PredType::NATIVE_FLOAT);
+    elevationType.insertMember("num_soundings",
+        HOFFSET(LegacyElevationRecord, num_soundings),
+        ::H5::PredType::NATIVE_INT32);
+    writeLegacyGroup(h5file, "/BAG_root/elevation_solution", elevationType,
+        rows, columns, elevations, {"min_shoal_elevation",
+        "max_shoal_elevation", "min_stddev", "max_stddev", "min_num_soundings",
+        "max_num_soundings"});
+}
+
+BAG::VRMetadataItem vrSupercell(
+    uint32_t row,
+    uint32_t column,
+    double rowResolution,
+    double columnResolution)
+{
+    if ((row + column) % 4 == 0)
+        return {0, 0, 0, -1.f, -1.f, -1.f, -1.f};
+
+    BAG::VRMetadataItem item{};
+    item.dimensions_x = 2 + column % 3;
+    item.dimensions_y = 2 + row % 2;
+    item.resolution_x = static_cast<float>(columnResolution / item.dimensions_x);
+    item.resolution_y = static_cast<float>(rowResolution / item.dimensions_y);
+    item.sw_corner_x = item.resolution_x / 2.f;
+    item.sw_corner_y = item.resolution_y / 2.f;
+
+    return item;
+}
+
+std::shared_ptr<BAG::Dataset> createVRBag(
+    const std::string& fileName,
+    uint32_t rows,
+    uint32_t columns,
+    uint64_t chunkSize)
+{
+    BAG::Metadata metadata;
+    metadata.loadFromFile(std::string{std::getenv("BAG_SAMPLES_PATH")} +
+        "/sample.xml");
+    metadata.setGridExtent(rows, columns, metadata.llCornerX(),
+        metadata.llCornerY());
+
+    const auto rowResolution = metadata.rowResolution();
+    const auto columnResolution = metadata.columnResolution();
+
+    auto pDataset = Dataset::create(fileName, std::move(metadata), chunkSize,
+        6);
 
+    std::vector<float> elevations(rows * columns);
+    for (uint32_t i = 0; i < rows * columns; ++i)
+        elevations[i] = -10.f - 0.01f * i;
+
+    pDataset->getSimpleLayer(Elevation)->write(0, 0, rows - 1, columns - 1,
+        reinterpret_cast<const uint8_t*>(elevations.data()));
+
+    pDataset->createVR(chunkSize, 6, true);
+
+    std::vector<BAG::VRMetadataItem> supercells(rows * columns);
+    uint32_t numRefinements = 0;
+    for (uint32_t row = 0; row < rows; ++row)
+    {
+        for (uint32_t column = 0; column < columns; ++column)
+        {
+            auto& item = supercells[row * columns + column];
+            item = vrSupercell(row, column, rowResolution, columnResolution);
+            if (item.dimensions_x == 0)
+            {
+                item.index = std::numeric_limits<uint32_t>::max();
+                continue;
+            }
+
+            item.index = numRefinements;
+            numRefinements += item.dimensions_x * item.dimensions_y;
+        }
+    }
+
+    std::vector<BAG::VRRefinementsItem> refinements(numRefinements);
+    std::vector<BAG::VRNodeItem> nodes(numRefinements);
+    for (uint32_t i = 0; i < numRefinements; ++i)
+    {
+        refinements[i] = vrRefinement(i);
+        nodes[i] = vrNode(i);
+    }
+
+    pDataset->getVRMetadata()->write(0, 0, rows - 1, columns - 1,
+        reinterpret_cast<const uint8_t*>(supercells.data()));
+    pDataset->getVRRefinements()->write(0, 0, 0, numRefinements - 1,
+        reinterpret_cast<const uint8_t*>(refinements.data()));
+    pDataset->getVRNode()->write(0, 0, 0, numRefinements - 1,
+        reinterpret_cast<const uint8_t*>(nodes.data()));
+
+    return pDataset;
+}
+
+}  // namespace TestUtils
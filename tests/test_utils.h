@@ -1,6 +1,7 @@
 
 #include <cstdio>  // std::remove
 #include <cstdlib>
+#include <functional>
 #include <string>
 #include <utility>
 #include <sys/stat.h>  // stat
@@ -71,5 +72,81 @@ void create_NOAA_OCS_Metadata(const std::string& elevationLayerName,
 void create_unknown_metadata(const std::string& elevationLayerName,
                              const std::shared_ptr<BAG::Dataset>& dataset);
 
+//! The elevation of node i, row by row, of the sloping surface made by
+//! createSurface() by default.
+inline float surfaceElevation(uint32_t i) noexcept
+{
+    return -10.f - 0.01f * i;
+}
+
+// Create a BAG of the sample grid with an uncertainty of 1 m at every node.
+// The elevation of a node is elevation(row, column), or surfaceElevation()
+// when none is given.  checksum gives every chunk a checksum, and the grid is
+// moved east by columnOffset columns.
+std::shared_ptr<BAG::Dataset> createSurface(
+    const std::string& fileName, uint32_t rows, uint32_t columns,
+    uint64_t chunkSize,
+    const std::function<float(uint32_t, uint32_t)>& elevation = {},
+    bool checksum = false, uint32_t columnOffset = 0);
+
+//! A record of the legacy NODE group.
+struct LegacyNodeRecord final
+{
+    float hyp_strength;
+    uint32_t num_hypotheses;
+};
+
+//! A record of the legacy ELEVATION group.
+struct LegacyElevationRecord final
+{
+    float shoal_elevation;
+    float stddev;
+    int32_t num_soundings;
+};
+
+//! The value of cell i of the legacy NODE group.
+inline LegacyNodeRecord legacyNodeRecord(uint32_t i) noexcept
+{
+    return {0.5f * i, i % 7};
+}
+
+//! The value of cell i of the legacy ELEVATION group.
+inline LegacyElevationRecord legacyElevationRecord(uint32_t i) noexcept
+{
+    return {-20.f - 0.1f * i, 0.25f + 0.001f * i, static_cast<int32_t>(i % 11)};
+}
+
+//! The chunk size of the interleaved groups of a legacy BAG.
+constexpr uint32_t kLegacyChunkSize = 16;
+
+// Create a BAG with its optional layers interleaved, as BAG 1.5 stored them,
+// with 10x10 chunks in the elevation layer.
+void createLegacyBag(const std::string& fileName, uint32_t rows,
+                     uint32_t columns);
+
+//! The supercell at (row, column) of a BAG made by createVRBag(); the index
+//! is left 0.  Every fourth supercell, diagonally, is not refined.
+BAG::VRMetadataItem vrSupercell(uint32_t row, uint32_t column,
+                                double rowResolution, double columnResolution);
+
+//! The refinement at index i of a BAG made by createVRBag().
+inline BAG::VRRefinementsItem vrRefinement(uint32_t i) noexcept
+{
+    return {-static_cast<float>(i), 1.f + 0.1f * (i % 5)};
+}
+
+//! The node at index i of a BAG made by createVRBag().
+inline BAG::VRNodeItem vrNode(uint32_t i) noexcept
+{
+    return {0.5f * (i % 100), i % 7, i % 11};
+}
+
+// Create a variable resolution BAG of the sample grid; the refined grids of
+// the supercells, from vrSupercell(), are stored row by row, with refinements
+// from vrRefinement() and nodes from vrNode().
+std::shared_ptr<BAG::Dataset> createVRBag(const std::string& fileName,
+                                          uint32_t rows, uint32_t columns,
+                                          uint64_t chunkSize = 10);
+
 }  // namespace TestUtils
 